@@ -56,6 +56,96 @@ namespace avk
 		glm::vec3 mValue;
 	};
 
+	/**	Compressed position or scaling key. The time is stored with single precision and
+	 *	the value is range-quantized to 16 bits per component, w.r.t. the value range of
+	 *	the compressed_vec3_keys collection it is stored in.
+	 */
+	struct compressed_vec3_key
+	{
+		float mTime;
+		std::array<uint16_t, 3> mValue;
+	};
+
+	/**	Compressed rotation key. The time is stored with single precision and the quaternion
+	 *	is quantized into 48 bits using the "smallest three" method: The largest component is
+	 *	dropped (and restored from the unit length constraint), the remaining three components
+	 *	are stored with 15 bits each. The two bits identifying the dropped component are stored
+	 *	in the most significant bits of mValue[0] and mValue[1].
+	 */
+	struct compressed_rotation_key
+	{
+		float mTime;
+		std::array<uint16_t, 3> mValue;
+	};
+
+	/**	A collection of compressed position or scaling keys, plus the value range which
+	 *	all the keys' quantized values refer to.
+	 */
+	struct compressed_vec3_keys
+	{
+		/** Minimum value of all keys, per component */
+		glm::vec3 mRangeMin;
+
+		/** Difference between the maximum value and the minimum value of all keys, per component */
+		glm::vec3 mRangeExtent;
+
+		/** The compressed keys, sorted by their times */
+		std::vector<compressed_vec3_key> mKeys;
+
+		/** Decodes the value of the key at the given index */
+		glm::vec3 value_at(size_t aKeyIndex) const
+		{
+			const auto& v = mKeys[aKeyIndex].mValue;
+			return mRangeMin + mRangeExtent * (glm::vec3{ v[0], v[1], v[2] } * (1.0f / 65535.0f));
+		}
+	};
+
+	/**	A collection of compressed rotation keys.
+	 */
+	struct compressed_rotation_keys
+	{
+		/** The compressed keys, sorted by their times */
+		std::vector<compressed_rotation_key> mKeys;
+
+		/** Decodes the value of the key at the given index */
+		glm::quat value_at(size_t aKeyIndex) const
+		{
+			const auto& v = mKeys[aKeyIndex].mValue;
+			const auto largest = static_cast<int>((v[0] >> 15) | ((v[1] >> 15) << 1));
+			constexpr float cScale = 1.0f / 32767.0f;
+			constexpr float cOneOverSqrt2 = 0.70710678118654752f;
+			const glm::vec3 smallest{
+				(static_cast<float>(v[0] & 0x7FFFu) * cScale * 2.0f - 1.0f) * cOneOverSqrt2,
+				(static_cast<float>(v[1] & 0x7FFFu) * cScale * 2.0f - 1.0f) * cOneOverSqrt2,
+				(static_cast<float>(v[2] & 0x7FFFu) * cScale * 2.0f - 1.0f) * cOneOverSqrt2
+			};
+			const float restored = glm::sqrt(glm::max(0.0f, 1.0f - glm::dot(smallest, smallest)));
+			// Components are stored in x, y, z, w order, with the largest one left out:
+			float xyzw[4];
+			for (int i = 0, j = 0; i < 4; ++i) {
+				xyzw[i] = (i == largest) ? restored : smallest[j++];
+			}
+			return glm::quat(xyzw[3], xyzw[0], xyzw[1], xyzw[2]);
+		}
+	};
+
+	/**	Settings for animation::compress. The error bounds refer to the key reduction
+	 *	step, i.e. keys are only removed if the interpolation of their remaining neighbors
+	 *	reproduces them within the given bounds. Quantization adds an additional error
+	 *	of at most half a quantization step.
+	 */
+	struct animation_compression_config
+	{
+		/** Maximum allowed deviation of translations, in the units of the model. */
+		float mMaxTranslationError = 1e-4f;
+
+		/** Maximum allowed deviation of rotations, as angle in radians. */
+		float mMaxRotationError = 1e-3f;
+
+		/** Maximum allowed deviation of scaling factors. */
+		float mMaxScalingError = 1e-4f;
+	};
+
 	/**	Struct which contains information about a particular bone w.r.t. a particular mesh
 	 *	during animation. I.e. when a certain mesh-specific(!) bone matrix shall be written
 	 *	to its target location, this struct contains the following information:
@@ -165,6 +255,11 @@ namespace avk
 	 */
 	struct animated_node
 	{
+		/**	Name of the node in the model's node hierarchy. Can be used to identify
+		 *	the same node across different animations of the same model.
+		 */
+		std::string mNodeName;
+
 		/**	Animation keys for the positions of this node. */
 		std::vector<position_key> mPositionKeys;
 
@@ -186,6 +281,21 @@ namespace avk
 		 */
 		bool mSameScalingAndPositionKeyTimes;
 
+		/** True if the keys of this node have been compressed via animation::compress.
+		 *	In this case, mPositionKeys, mRotationKeys, and mScalingKeys are empty and
+		 *	the compressed collections are used instead.
+		 */
+		bool mHasCompressedKeys = false;
+
+		/** Compressed animation keys for the positions of this node. (Only used if mHasCompressedKeys is true) */
+		compressed_vec3_keys mCompressedPositionKeys;
+
+		/** Compressed animation keys for the rotations of this node. (Only used if mHasCompressedKeys is true) */
+		compressed_rotation_keys mCompressedRotationKeys;
+
+		/** Compressed animation keys for the scalings of this node. (Only used if mHasCompressedKeys is true) */
+		compressed_vec3_keys mCompressedScalingKeys;
+
 		/** The local transform of this node */
 		glm::mat4 mLocalTransform;
 		
@@ -228,6 +338,84 @@ namespace avk
 		/** Model space is the space of a model (within which meshes are positioned). */
 		model_space,
 	};
+
+	/**	Compact representation of a rigid bone transformation as unit dual quaternion (32 bytes instead
+	 *	of 64 bytes for a glm::mat4). Both quaternions are stored in x, y, z, w order, so that they can
+	 *	be read as vec4 in shaders. Dual quaternions can only represent rotation and translation; any
+	 *	scaling is dropped.
+	 *
+	 *	Possible GLSL code for skinning with dual quaternion linear blending, where the weight of the
+	 *	fourth bone is 1 - the sum of the other three:
+	 *
+	 *	struct dual_quaternion
+	 *	{
+	 *		vec4 mReal;
+	 *		vec4 mDual;
+	 *	};
+	 *
+	 *	dual_quaternion blend_dual_quaternions(dual_quaternion DQ0, dual_quaternion DQ1, dual_quaternion DQ2, dual_quaternion DQ3, vec4 weights)
+	 *	{
+	 *		weights.w = 1.0 - dot(weights.xyz, vec3(1.0, 1.0, 1.0));
+	 *		// q and -q represent the same rotation => make sure that all are in the same hemisphere as DQ0:
+	 *		weights[1] *= sign(dot(DQ0.mReal, DQ1.mReal) + 1e-7);
+	 *		weights[2] *= sign(dot(DQ0.mReal, DQ2.mReal) + 1e-7);
+	 *		weights[3] *= sign(dot(DQ0.mReal, DQ3.mReal) + 1e-7);
+	 *		dual_quaternion result;
+	 *		result.mReal = weights[0] * DQ0.mReal + weights[1] * DQ1.mReal + weights[2] * DQ2.mReal + weights[3] * DQ3.mReal;
+	 *		result.mDual = weights[0] * DQ0.mDual + weights[1] * DQ1.mDual + weights[2] * DQ2.mDual + weights[3] * DQ3.mDual;
+	 *		float invLength = 1.0 / length(result.mReal);
+	 *		result.mReal *= invLength;
+	 *		result.mDual *= invLength;
+	 *		return result;
+	 *	}
+	 *
+	 *	vec3 rotate_by_quaternion(vec4 q, vec3 v)
+	 *	{
+	 *		return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+	 *	}
+	 *
+	 *	vec4 bone_transform(dual_quaternion DQ0, dual_quaternion DQ1, dual_quaternion DQ2, dual_quaternion DQ3, vec4 weights, vec4 positionToTransform)
+	 *	{
+	 *		dual_quaternion dq = blend_dual_quaternions(DQ0, DQ1, DQ2, DQ3, weights);
+	 *		// translation = 2 * dual * conjugate(real):
+	 *		vec3 translation = 2.0 * (dq.mReal.w * dq.mDual.xyz - dq.mDual.w * dq.mReal.xyz + cross(dq.mReal.xyz, dq.mDual.xyz));
+	 *		return vec4(rotate_by_quaternion(dq.mReal, positionToTransform.xyz) + translation * positionToTransform.w, positionToTransform.w);
+	 *	}
+	 *
+	 *	Normals are transformed with rotate_by_quaternion(dq.mReal, normal) only.
+	 */
+	struct bone_dual_quaternion
+	{
+		/** The rotation part */
+		glm::vec4 mReal;
+
+		/** The translation part, i.e., 0.5 * translation * rotation */
+		glm::vec4 mDual;
+
+		/** Converts the given bone matrix into a dual quaternion. Scaling is removed beforehand. */
+		static bone_dual_quaternion from_matrix(const glm::mat4& aBoneMatrix)
+		{
+			const glm::mat3 rotationMatrix{
+				glm::normalize(glm::vec3{ aBoneMatrix[0] }),
+				glm::normalize(glm::vec3{ aBoneMatrix[1] }),
+				glm::normalize(glm::vec3{ aBoneMatrix[2] })
+			};
+			const glm::quat real = glm::normalize(glm::quat_cast(rotationMatrix));
+			const glm::vec3 t{ aBoneMatrix[3] };
+			const glm::quat dual = (glm::quat{ 0.0f, t.x, t.y, t.z } * real) * 0.5f;
+			return bone_dual_quaternion{ glm::vec4{ real.x, real.y, real.z, real.w }, glm::vec4{ dual.x, dual.y, dual.z, dual.w } };
+		}
+	};
+
+	/**	Converts the given bone matrix into a 3x4 affine matrix (48 bytes instead of 64 bytes for a glm::mat4),
+	 *	by storing the first three ROWS of the bone matrix, i.e., the last row (0, 0, 0, 1) is dropped.
+	 *	In GLSL, a position is transformed with such a matrix M via vec4(position, 1.0) * M, which
+	 *	yields a vec3, and a normal via vec4(normal, 0.0) * M.
+	 */
+	inline glm::mat3x4 to_affine_bone_matrix(const glm::mat4& aBoneMatrix)
+	{
+		return glm::mat3x4{ glm::transpose(aBoneMatrix) };
+	}
 	
 	class model_t;
 
@@ -284,8 +472,10 @@ namespace avk
 			for (size_t ai = 0; ai < an; ++ai) {
 				auto& anode = mAnimationData[ai];
 
-				// Get the node-local TRS transformation matrix:
-				auto localTransform = compute_node_local_transform(anode, timeInTicks);
+				// Get the node-local TRS transformation matrix. Nodes within the skipped leaf levels are not sampled, but keep their local transform:
+				auto localTransform = (mSkippedLeafLevels > 0 && mNodeHeights[ai] < mSkippedLeafLevels)
+					? anode.mLocalTransform
+					: compute_node_local_transform(anode, timeInTicks);
 
 				// Calculate the node's global transform, using its local transform and the transforms of its parents:
 				if (anode.mAnimatedParentIndex.has_value()) {
@@ -366,6 +556,16 @@ namespace avk
 		 */
 		glm::mat4 compute_node_local_transform(const animated_node& aNode, double aTimeInTicks) const;
 
+		/**	Computes the node-local translation, rotation, and scale at the given animation time (in ticks).
+		 *	Same as compute_node_local_translation, compute_node_local_rotation, and compute_node_local_scale
+		 *	combined, but the keys are searched only once if their times match.
+		 *	@param	aNode				Node to compute the local translation, rotation, and scale for
+		 *	@param	aTimeInTicks		Animation time that determines the state of the node-local animation
+		 *	@return	Tuple containing translation, rotation, and scale. In case there are no animation keys specified
+		 *			for the node, the returned values will be the decomposed aNode.mLocalTransform.
+		 */
+		std::tuple<glm::vec3, glm::quat, glm::vec3> compute_node_local_translation_rotation_scale(const animated_node& aNode, double aTimeInTicks) const;
+
 		/**	Computes the node-local translation at the given animation time (in ticks).
 		 *	@param	aNode				Node to compute the local translation for
 		 *	@param	aTimeInTicks		Animation time that determines the state of the node-local animation matrix
@@ -456,12 +656,62 @@ namespace avk
 		 */
 		void animate_into_single_target_buffer(const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, glm::mat4* aTargetMemory);
 
+		/**	Same as animate_into_single_target_buffer for glm::mat4 targets, but writes 3x4 affine matrices
+		 *	(see to_affine_bone_matrix), which need 25% less memory and bandwidth.
+		 */
+		void animate_into_single_target_buffer(const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, glm::mat3x4* aTargetMemory);
+
+		/**	Same as animate_into_single_target_buffer for glm::mat4 targets, but writes dual quaternions
+		 *	(see bone_dual_quaternion), which need 50% less memory and bandwidth. Only suitable for
+		 *	animations without scaling.
+		 */
+		void animate_into_single_target_buffer(const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, bone_dual_quaternion* aTargetMemory);
+
+		/**	Same as animate_into_strided_target_per_mesh for glm::mat4 targets, but writes 3x4 affine matrices
+		 *	(see to_affine_bone_matrix). By default, aMatricesStride will be set to sizeof(glm::mat3x4).
+		 */
+		void animate_into_strided_target_per_mesh(const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, glm::mat3x4* aTargetMemory, size_t aMeshStride, std::optional<size_t> aMatricesStride = {}, std::optional<size_t> aMaxMeshes = {}, std::optional<size_t> aMaxBonesPerMesh = {});
+
+		/**	Same as animate_into_strided_target_per_mesh for glm::mat4 targets, but writes dual quaternions
+		 *	(see bone_dual_quaternion). By default, aMatricesStride will be set to sizeof(bone_dual_quaternion).
+		 */
+		void animate_into_strided_target_per_mesh(const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, bone_dual_quaternion* aTargetMemory, size_t aMeshStride, std::optional<size_t> aMatricesStride = {}, std::optional<size_t> aMaxMeshes = {}, std::optional<size_t> aMaxBonesPerMesh = {});
+
 		/**	Returns all the unique keyframe time-values of the given animation.
 		 *	@param	aClip				Animation clip which to extract the unique keyframe time-values from
 		 *	@return	A collection of unique keyframe times in ticks
 		 */
 		std::vector<double> animation_key_times_for_clip_in_ticks(const animation_clip_data& aClip) const;
 
+		/**	Compresses the animation keys of all animated nodes in place. Keys which can be reproduced by
+		 *	interpolating their neighbors within the error bounds of aConfig are removed, rotations are
+		 *	quantized to 48 bits (smallest three), translations and scalings are range-quantized to
+		 *	16 bits per component, and key times are stored with single precision.
+		 *	The full-precision keys are released afterwards. All compute_* methods and animate() sample
+		 *	the compressed keys directly, i.e. no decompressed copy of the animation is created.
+		 *	Calling this method on an animation that has already been compressed has no effect.
+		 *
+		 *	@param	aConfig				Error bounds for the key reduction
+		 */
+		void compress(const animation_compression_config& aConfig = {});
+
+		/**	Returns true if the keys of this animation have been compressed via compress() */
+		bool is_compressed() const;
+
+		/**	Reduces the number of nodes that are sampled during animate(), which can be used to
+		 *	evaluate far away or otherwise less important instances more cheaply. Nodes within the
+		 *	skipped leaf levels are not sampled, but keep their local transform (mLocalTransform);
+		 *	i.e., they rigidly follow their animated parents. Bone matrices are still written for them.
+		 *
+		 *	@param	aSkippedLeafLevels	0 ... all nodes are sampled (default)
+		 *								1 ... leaf nodes (i.e., nodes without animated children) are not sampled
+		 *								n ... nodes whose subtree has a height less than n are not sampled
+		 */
+		void set_skipped_leaf_levels(uint32_t aSkippedLeafLevels);
+
+		/**	Returns the value which has been set via set_skipped_leaf_levels */
+		uint32_t skipped_leaf_levels() const { return mSkippedLeafLevels; }
+
 		/** Returns the total number of animated nodes stored in an animation */
 		size_t number_of_animated_nodes() const;
 		
@@ -560,7 +810,18 @@ namespace avk
 			assert (key2.mTime > key1.mTime);
 			return static_cast<float>((aTime - key1.mTime) / timeDifferenceTicks);
 		}
-		
+
+		/**	Helper function used to sample compressed keys: Finds the two keys between which
+		 *	the given aTime lies, decodes them and returns them along with the interpolation factor.
+		 */
+		template <typename T>
+		auto find_and_decode_compressed_keys(const T& aCompressedKeys, double aTime) const
+		{
+			auto [pos1, pos2] = find_positions_in_keys(aCompressedKeys.mKeys, aTime);
+			auto f = get_interpolation_factor(aCompressedKeys.mKeys[pos1], aCompressedKeys.mKeys[pos2], aTime);
+			return std::make_tuple(aCompressedKeys.value_at(pos1), aCompressedKeys.value_at(pos2), f);
+		}
+
 		/**	All animated nodes, along with their animation data and target storage pointers
 		 */
 		std::vector<animated_node> mAnimationData;
@@ -574,6 +835,12 @@ namespace avk
 		 */
 		size_t mMaxNumBoneMatrices;
 
+		/** Number of leaf levels which are not sampled during animate(), see set_skipped_leaf_levels */
+		uint32_t mSkippedLeafLevels = 0;
+
+		/** Height of each animated node's subtree (0 for leaf nodes), computed by set_skipped_leaf_levels */
+		std::vector<uint32_t> mNodeHeights;
+
 		/** Make serialize a friend, so the serializer can access private data members.
 		 *  (see custom serialization functions in serializer.hpp)
 		 */
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "animation.hpp"
+
+namespace avk
+{
+	/**	Node-local transformation, decomposed into translation, rotation, and scale.
+	 *	This is the representation in which poses are blended by animation_blender.
+	 */
+	struct node_local_trs
+	{
+		glm::vec3 mTranslation;
+		glm::quat mRotation;
+		glm::vec3 mScale;
+	};
+
+	/**	Evaluates blended animations for ONE animated instance.
+	 *
+	 *	Poses are sampled and combined in node-local TRS representation, and the transformation
+	 *	hierarchy is applied only once at the very end (see apply). Blend trees are evaluated in
+	 *	post-order, using the blender's pose stack:
+	 *	 - push_clip/push_rest_pose push a pose onto the stack,
+	 *	 - blend pops two poses and pushes their (optionally masked) cross-fade,
+	 *	 - add pops an additive pose and its reference pose and adds their (optionally masked)
+	 *	   difference onto the pose below them,
+	 *	 - apply computes the bone matrices from the topmost pose and clears the stack.
+	 *
+	 *	All the memory required during evaluation is allocated when the blender is created or
+	 *	when animations and masks are added. There are no allocations per frame. The animations
+	 *	themselves are not modified during evaluation, i.e. they can be shared between
+	 *	multiple instances, each one having its own animation_blender.
+	 *
+	 *	@example Cross-fading from a walk cycle into a run cycle, with a waving layer on top
+	 *	         that only affects the right arm:
+	 *		auto blender = avk::animation_blender(walkAnimation, 4);
+	 *		auto walk = blender.add_animation(walkAnimation);
+	 *		auto run  = blender.add_animation(runAnimation);
+	 *		auto wave = blender.add_animation(waveAnimation);
+	 *		auto arm  = blender.add_mask_for_subtree(blender.find_node_index("RightShoulder").value());
+	 *		// per frame:
+	 *		blender.push_clip(walk, walkClip, t);
+	 *		blender.push_clip(run, runClip, t);
+	 *		blender.blend(fadeFactor);
+	 *		blender.push_clip(wave, waveClip, t);
+	 *		blender.push_clip(wave, waveClip, waveClip.start_time());
+	 *		blender.add(1.0f, arm);
+	 *		blender.apply_into_single_target_buffer(avk::bone_matrices_space::mesh_space, targetMemory);
+	 */
+	class animation_blender
+	{
+	public:
+		/**	Creates a blender which uses the node hierarchy and bone targets of the given animation.
+		 *	Other animations of the same model can be added via add_animation. Their nodes are matched
+		 *	with aSkeleton's nodes by name. Only nodes which are contained in aSkeleton can be animated,
+		 *	hence, pass the animation which contains the most animated nodes.
+		 *
+		 *	@param	aSkeleton			Animation providing the node hierarchy and bone targets. It must outlive the blender.
+		 *	@param	aMaxStackDepth		Maximum number of poses on the stack at the same time. Determines the size of the pose arena.
+		 */
+		animation_blender(const animation& aSkeleton, size_t aMaxStackDepth = 4);
+
+		animation_blender() = delete;
+		animation_blender(animation_blender&&) noexcept = default;
+		animation_blender(const animation_blender&) = default;
+		animation_blender& operator=(animation_blender&&) noexcept = default;
+		animation_blender& operator=(const animation_blender&) = default;
+		~animation_blender() = default;
+
+		/**	Registers an animation which can subsequently be sampled with push_clip.
+		 *	@param	aAnimation			Animation of the same model as the skeleton animation. It must outlive the blender.
+		 *	@return	Index which identifies the animation in push_clip calls
+		 */
+		size_t add_animation(const animation& aAnimation);
+
+		/**	Adds a per-node mask, which can be used with blend and add to restrict their influence.
+		 *	@param	aWeightPerNode		One weight in the range [0..1] per animated node of the skeleton animation.
+		 *	@return	Index which identifies the mask in blend and add calls
+		 */
+		size_t add_mask(std::vector<float> aWeightPerNode);
+
+		/**	Adds a per-node mask which selects the given node and all of its (animated) descendants.
+		 *	@param	aRootNodeIndex		Index of the animated node (w.r.t. the skeleton animation) that forms the root of the masked subtree
+		 *	@param	aWeightInside		Weight assigned to the nodes of the subtree
+		 *	@param	aWeightOutside		Weight assigned to all other nodes
+		 *	@return	Index which identifies the mask in blend and add calls
+		 */
+		size_t add_mask_for_subtree(size_t aRootNodeIndex, float aWeightInside = 1.0f, float aWeightOutside = 0.0f);
+
+		/**	Returns the index of the skeleton animation's node with the given name, or {} if there is no such node. */
+		std::optional<size_t> find_node_index(std::string_view aNodeName) const;
+
+		/**	Samples the given animation at the given time and pushes the resulting pose onto the stack.
+		 *	@param	aAnimationIndex		Index returned by add_animation
+		 *	@param	aClip				Animation clip to use for the animation
+		 *	@param	aTime				Time in seconds to sample the animation at.
+		 */
+		void push_clip(size_t aAnimationIndex, const animation_clip_data& aClip, double aTime);
+
+		/**	Pushes the rest pose (i.e. the nodes' local transforms without any animation applied) onto the stack. */
+		void push_rest_pose();
+
+		/**	Pops the two topmost poses A (below) and B (top), and pushes their cross-fade.
+		 *	@param	aWeight				Blend factor: 0 results in A, 1 results in B
+		 *	@param	aMask				Optional mask index (see add_mask). The blend factor is multiplied by the mask's per-node weights.
+		 */
+		void blend(float aWeight, std::optional<size_t> aMask = {});
+
+		/**	Pops the two topmost poses, namely an additive pose (below) and its reference pose (top),
+		 *	and adds the difference between them onto the pose below them, i.e., stack [..., base, additive, reference] becomes [..., result].
+		 *	@param	aWeight				Factor for the difference: 0 leaves the base pose unchanged, 1 adds the full difference
+		 *	@param	aMask				Optional mask index (see add_mask). The factor is multiplied by the mask's per-node weights.
+		 */
+		void add(float aWeight, std::optional<size_t> aMask = {});
+
+		/**	Applies the node hierarchy to the topmost pose of the stack, and invokes aBoneMatrixCalc for each bone target.
+		 *	The stack is cleared afterwards.
+		 *	@param	aBoneMatrixCalc		Callback-function with the same signature as option 1 of animation::animate, i.e.,
+		 *								void(mesh_bone_info aInfo, const glm::mat4& aInverseMeshRootMatrix, const glm::mat4& aGlobalTransformMatrix, const glm::mat4& aInverseBindPoseMatrix)
+		 */
+		template <typename F>
+		void apply(F&& aBoneMatrixCalc)
+		{
+			compute_global_transforms();
+			for (size_t ai = 0; ai < mNumNodes; ++ai) {
+				for (const auto& target : mSkeleton->get_animated_node_at(ai).get().mBoneMeshTargets) {
+					aBoneMatrixCalc(target.mMeshBoneInfo, target.mInverseMeshRootMatrix, mGlobalTransforms[ai], target.mInverseBindPoseMatrix);
+				}
+			}
+		}
+
+		/**	Same as animation::animate_into_single_target_buffer, but for the blended pose on top of the stack.
+		 *	The stack is cleared afterwards.
+		 *	@param	aTargetSpace		The target space into which the vertices shall be transformed by multiplying them with the bone matrices
+		 *	@param	aTargetMemory		Pointer to the memory location where the first bone matrix shall be written to
+		 */
+		void apply_into_single_target_buffer(bone_matrices_space aTargetSpace, glm::mat4* aTargetMemory);
+
+		/**	Same as animation::animate_into_strided_target_per_mesh, but for the blended pose on top of the stack.
+		 *	The stack is cleared afterwards.
+		 *	@param	aTargetSpace		The target space into which the vertices shall be transformed by multiplying them with the bone matrices
+		 *	@param	aTargetMemory		Pointer to the memory location where the first bone matrix shall be written to
+		 *	@param	aMeshStride			Offset in BYTES between the first memory target location for mesh i, and the first memory target location for mesh i+1
+		 *	@param	aMatricesStride		Offset in BYTES between two consecutive bone matrices that are assigned to the same mesh. By default, it will be set to sizeof(glm::mat4)
+		 */
+		void apply_into_strided_target_per_mesh(bone_matrices_space aTargetSpace, glm::mat4* aTargetMemory, size_t aMeshStride, std::optional<size_t> aMatricesStride = {});
+
+		/**	Returns the number of poses that are currently on the stack. */
+		size_t stack_size() const { return mStackSize; }
+
+		/**	Returns the global transforms computed during the last apply call, one per animated node of the skeleton animation. */
+		const std::vector<glm::mat4>& global_transforms() const { return mGlobalTransforms; }
+
+	private:
+		/** Returns the pose at the given stack position */
+		node_local_trs* pose_at(size_t aStackPosition) { return mPoseArena.data() + aStackPosition * mNumNodes; }
+
+		/** Reserves the next pose on the stack and returns it */
+		node_local_trs* push_pose();
+
+		/** Fills mGlobalTransforms from the topmost pose and clears the stack */
+		void compute_global_transforms();
+
+		/** Animation that provides the node hierarchy and bone targets */
+		const animation* mSkeleton;
+
+		/** Number of animated nodes of mSkeleton */
+		size_t mNumNodes;
+
+		/** Maximum number of poses on the stack */
+		size_t mMaxStackDepth;
+
+		/** Number of poses currently on the stack */
+		size_t mStackSize = 0;
+
+		/** Local transforms of the skeleton's nodes without animation applied */
+		std::vector<node_local_trs> mRestPose;
+
+		/** Storage for mMaxStackDepth poses with mNumNodes entries each */
+		std::vector<node_local_trs> mPoseArena;
+
+		/** Global transform per node, computed by apply */
+		std::vector<glm::mat4> mGlobalTransforms;
+
+		/** Animations which have been added via add_animation */
+		std::vector<const animation*> mAnimations;
+
+		/** Per added animation, the node index in that animation for each of the skeleton's nodes, or -1 if it does not contain the node */
+		std::vector<std::vector<int64_t>> mNodeMappings;
+
+		/** Weights of all masks, mNumNodes entries per mask */
+		std::vector<float> mMasks;
+	};
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "animation.hpp"
+
+namespace avk
+{
+	/** Animated node data in the right format to be uploaded to the GPU
+	 *	and to be used in a GPU buffer like an SSBO.
+	 *	The nodes are stored in the same order as in avk::animation, i.e.,
+	 *	animated parents are always stored before their children.
+	 */
+	struct animated_node_gpu_data
+	{
+		/** The node's mParentTransform, see avk::animated_node */
+		alignas(16) glm::mat4 mParentTransform;
+
+		/** The node's mLocalTransform, which is used if the node has no animation keys */
+		alignas(16) glm::mat4 mLocalTransform;
+
+		/** Index of the animated parent node, or -1 if the node has no animated parent */
+		int32_t mAnimatedParentIndex;
+
+		/** Offset and number of the node's position keys in animation_gpu_data::mKeyTimes/mKeyValues */
+		uint32_t mPositionKeysOffset;
+		uint32_t mPositionKeysCount;
+
+		/** Offset and number of the node's rotation keys in animation_gpu_data::mKeyTimes/mKeyValues */
+		uint32_t mRotationKeysOffset;
+		uint32_t mRotationKeysCount;
+
+		/** Offset and number of the node's scaling keys in animation_gpu_data::mKeyTimes/mKeyValues */
+		uint32_t mScalingKeysOffset;
+		uint32_t mScalingKeysCount;
+
+		uint32_t mPadding;
+	};
+
+	/** Bone target data in the right format to be uploaded to the GPU
+	 *	and to be used in a GPU buffer like an SSBO.
+	 *	For every bone target, the bone matrix is computed as follows:
+	 *	mTargetSpaceMatrix * globalNodeTransform * mInverseBindPoseMatrix
+	 */
+	struct bone_target_gpu_data
+	{
+		/** The inverse mesh root matrix for bone_matrices_space::mesh_space, or the identity for bone_matrices_space::model_space */
+		alignas(16) glm::mat4 mTargetSpaceMatrix;
+
+		/** The inverse bind pose matrix of the bone w.r.t. the target mesh */
+		alignas(16) glm::mat4 mInverseBindPoseMatrix;
+
+		/** Index of the animated node which this bone target belongs to */
+		uint32_t mAnimatedNodeIndex;
+
+		/** Index where the bone matrix is written to, i.e., mGlobalBoneIndexOffset + mMeshLocalBoneIndex */
+		uint32_t mTargetIndex;
+
+		uint32_t mPadding[2];
+	};
+
+	/** All the data of one avk::animation, flattened into arrays that can be
+	 *	uploaded into storage buffers as they are. Keys of all the nodes are
+	 *	stored in two parallel arrays, mKeyTimes and mKeyValues:
+	 *	 - Positions and scalings are stored in .xyz of mKeyValues,
+	 *	 - rotations are stored as quaternions in .xyzw order (i.e., w last).
+	 *	This data can be evaluated by a compute shader, so that the bone matrices
+	 *	are written into GPU buffers directly, instead of computing them with
+	 *	animation::animate on the CPU and uploading them every frame.
+	 */
+	struct animation_gpu_data
+	{
+		std::vector<animated_node_gpu_data> mNodes;
+		std::vector<float> mKeyTimes;
+		std::vector<glm::vec4> mKeyValues;
+		std::vector<bone_target_gpu_data> mBoneTargets;
+
+		/** Number of bone matrices written per animated instance, i.e., the highest mTargetIndex + 1 */
+		uint32_t mNumBoneMatrices = 0;
+	};
+
+	/** Convert the given animation into a format which is suitable for GPU buffer usage.
+	 *	Both, uncompressed and compressed animations (see animation::compress) are supported.
+	 *	@param	aAnimation			The animation to be converted. Key times are stored in ticks, with single precision.
+	 *	@param	aTargetSpace		The target space into which the vertices shall be transformed by the bone matrices
+	 *	@return	The flattened animation data
+	 */
+	extern animation_gpu_data convert_for_gpu_usage(const animation& aAnimation, bone_matrices_space aTargetSpace);
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "animation.hpp"
+
+namespace avk
+{
+	/**	Describes how often, and in how much detail, the animation of an instance is updated
+	 *	while it is within a certain distance range.
+	 */
+	struct animation_lod_level
+	{
+		/** Instances up to this distance (inclusive) use this level. */
+		float mMaxDistance;
+
+		/** The animation is evaluated every mUpdateInterval-th frame; 1 means every frame. */
+		uint32_t mUpdateInterval = 1;
+
+		/** Passed to animation::set_skipped_leaf_levels before evaluating the animation. */
+		uint32_t mSkippedLeafLevels = 0;
+	};
+
+	/**	Throttles the animation updates of animated instances, depending on their distance.
+	 *
+	 *	Near instances are updated every frame, far instances are only updated every N-th frame
+	 *	and/or with fewer sampled nodes, as configured by the LOD levels. In frames where an
+	 *	instance is not updated, its previously written bone matrices shall be reused.
+	 *	To avoid spikes, the throttled updates are spread evenly across frames: Every instance
+	 *	is assigned a phase when it is added, and an instance with an update interval of N
+	 *	is only updated in those frames where frame % N == phase % N.
+	 *
+	 *	@example
+	 *		auto scheduler = avk::animation_update_scheduler({ { 10.0f, 1, 0 }, { 50.0f, 2, 1 }, { 200.0f, 4, 2 } });
+	 *		for (auto& inst : instances) { inst.mSchedulerId = scheduler.add_instance(); }
+	 *		// per frame:
+	 *		scheduler.begin_frame();
+	 *		for (auto& inst : instances) {
+	 *			scheduler.animate_into_single_target_buffer(inst.mSchedulerId, glm::distance(camPos, inst.mPosition),
+	 *				inst.mAnimation, inst.mClip, time, avk::bone_matrices_space::mesh_space, inst.mBoneMatrices.data());
+	 *		}
+	 */
+	class animation_update_scheduler
+	{
+	public:
+		/**	Creates a new scheduler with the given LOD levels.
+		 *	@param	aLevels		LOD levels, sorted by mMaxDistance in ascending order. Instances beyond
+		 *						the last level's mMaxDistance use the last level as well.
+		 */
+		animation_update_scheduler(std::vector<animation_lod_level> aLevels);
+
+		animation_update_scheduler() = delete;
+		animation_update_scheduler(animation_update_scheduler&&) noexcept = default;
+		animation_update_scheduler(const animation_update_scheduler&) = default;
+		animation_update_scheduler& operator=(animation_update_scheduler&&) noexcept = default;
+		animation_update_scheduler& operator=(const animation_update_scheduler&) = default;
+		~animation_update_scheduler() = default;
+
+		/**	Registers a new animated instance.
+		 *	@return	Id of the instance, which must be passed to the per-frame calls
+		 */
+		size_t add_instance();
+
+		/**	Must be invoked once per frame, before any of the instances are updated. */
+		void begin_frame();
+
+		/**	Determines whether the given instance shall be updated in the current frame.
+		 *	An instance that has never been updated before is always due.
+		 *	@param	aInstanceId		Id returned by add_instance
+		 *	@param	aDistance		Distance of the instance, e.g., from the camera
+		 *	@return	The LOD level to evaluate the animation with, or {} if the previous bone matrices shall be reused.
+		 */
+		std::optional<std::reference_wrapper<const animation_lod_level>> level_if_due(size_t aInstanceId, float aDistance);
+
+		/**	Invokes aUpdate if the given instance is due in the current frame.
+		 *	Before that, the skipped leaf levels of the selected LOD level are set on aAnimation.
+		 *	@param	aInstanceId		Id returned by add_instance
+		 *	@param	aDistance		Distance of the instance, e.g., from the camera
+		 *	@param	aAnimation		The instance's animation
+		 *	@param	aUpdate			Callback which evaluates the animation, e.g., via animation::animate_into_single_target_buffer
+		 *	@return	true if aUpdate has been invoked, false if the previous bone matrices shall be reused
+		 */
+		template <typename F>
+		bool update(size_t aInstanceId, float aDistance, animation& aAnimation, F&& aUpdate)
+		{
+			auto level = level_if_due(aInstanceId, aDistance);
+			if (!level.has_value()) {
+				return false;
+			}
+			aAnimation.set_skipped_leaf_levels(level->get().mSkippedLeafLevels);
+			aUpdate();
+			return true;
+		}
+
+		/**	Throttled version of animation::animate_into_single_target_buffer, see update.
+		 *	@return	true if the bone matrices have been written, false if the previous ones shall be reused
+		 */
+		bool animate_into_single_target_buffer(size_t aInstanceId, float aDistance, animation& aAnimation, const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, glm::mat4* aTargetMemory);
+
+		/**	Throttled version of animation::animate_into_strided_target_per_mesh, see update.
+		 *	@return	true if the bone matrices have been written, false if the previous ones shall be reused
+		 */
+		bool animate_into_strided_target_per_mesh(size_t aInstanceId, float aDistance, animation& aAnimation, const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, glm::mat4* aTargetMemory, size_t aMeshStride, std::optional<size_t> aMatricesStride = {}, std::optional<size_t> aMaxMeshes = {}, std::optional<size_t> aMaxBonesPerMesh = {});
+
+		/**	Returns the number of instances that have been updated in the current frame so far. */
+		size_t number_of_updates_in_current_frame() const { return mUpdatesInCurrentFrame; }
+
+		/**	Returns the number of registered instances. */
+		size_t number_of_instances() const { return mLastUpdateFrames.size(); }
+
+	private:
+		/** The LOD levels, sorted by mMaxDistance */
+		std::vector<animation_lod_level> mLevels;
+
+		/** Per instance, the frame in which it has been updated most recently, or {} if never */
+		std::vector<std::optional<uint64_t>> mLastUpdateFrames;
+
+		/** Incremented in begin_frame */
+		uint64_t mCurrentFrame = 0;
+
+		/** Number of instances updated since the last begin_frame */
+		size_t mUpdatesInCurrentFrame = 0;
+	};
+}
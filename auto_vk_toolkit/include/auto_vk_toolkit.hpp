@@ -26,6 +26,7 @@
 #include <typeinfo>
 #include <atomic>
 #include <mutex>
+#include <shared_mutex>
 #include <condition_variable>
 #include <cstdlib>
 #include <typeindex>
@@ -0,0 +1,146 @@
+#pragma once
+
+namespace avk
+{
+	/**	Returns the maximum size of the output of lz4_compress_block for an input of the given size. */
+	extern size_t lz4_compress_bound(size_t aInputSize);
+
+	/**	Compresses a block of data in the LZ4 block format.
+	 *	Every block is compressed independently, i.e., there are no references to previous blocks.
+	 *	@param	aInput		The data to compress
+	 *	@param	aOutput		Target memory with a size of at least lz4_compress_bound(aInput.size()) bytes
+	 *	@return	The size of the compressed data, which has been written to aOutput
+	 */
+	extern size_t lz4_compress_block(std::span<const std::byte> aInput, std::byte* aOutput);
+
+	/**	Decompresses a block of data which has been compressed with lz4_compress_block.
+	 *	@param	aInput		The compressed data
+	 *	@param	aOutput		Target memory, whose size must match the size of the uncompressed data exactly
+	 *	@return	true on success, false if aInput is corrupted or does not decompress to aOutput.size() bytes
+	 */
+	extern bool lz4_decompress_block(std::span<const std::byte> aInput, std::span<std::byte> aOutput);
+
+	/**	Statistics about a block-compressed stream. */
+	struct block_compression_statistics
+	{
+		/** Number of bytes before compression, or after decompression, respectively */
+		std::uint64_t mUncompressedBytes = 0;
+		/** Number of bytes after compression, or before decompression, respectively, including block headers */
+		std::uint64_t mCompressedBytes = 0;
+		/** Number of blocks processed */
+		std::uint64_t mBlocks = 0;
+		/** Time spent compressing or decompressing, summed up over all threads */
+		double mCodecSeconds = 0.0;
+
+		/** Returns uncompressed size / compressed size */
+		double compression_ratio() const { return mCompressedBytes > 0 ? static_cast<double>(mUncompressedBytes) / static_cast<double>(mCompressedBytes) : 1.0; }
+
+		/** Returns the number of uncompressed bytes processed per second and thread */
+		double throughput() const { return mCodecSeconds > 0.0 ? static_cast<double>(mUncompressedBytes) / mCodecSeconds : 0.0; }
+	};
+
+	/**	Returns true if the file at the given path starts with the header of a block-compressed stream. */
+	extern bool is_block_compressed_file(const std::filesystem::path& aPath);
+
+	/**	Reads the header of a block-compressed stream from the given file.
+	 *	@return	The version stored in the header, or {} if the file is not block-compressed
+	 */
+	extern std::optional<std::uint32_t> block_compressed_file_version(const std::filesystem::path& aPath);
+
+	/** @brief block_compressing_streambuf
+	 *
+	 *  An output stream buffer which collects written data in blocks of fixed size, compresses
+	 *  every full block independently with lz4_compress_block, and writes it to a sink. Blocks
+	 *  which do not get smaller are stored uncompressed. The stream starts with a header
+	 *  containing aVersion, which can be queried with block_compressed_file_version.
+	 */
+	class block_compressing_streambuf : public std::streambuf
+	{
+	public:
+		/** @brief Construct, writing the compressed stream into aSink
+		 *
+		 *  @param[in] aSink The stream buffer the compressed data is written to; must outlive this instance
+		 *  @param[in] aVersion Version to store in the header
+		 *  @param[in] aBlockSize Number of uncompressed bytes per block
+		 */
+		block_compressing_streambuf(std::streambuf& aSink, std::uint32_t aVersion, size_t aBlockSize);
+		block_compressing_streambuf(const block_compressing_streambuf&) = delete;
+		block_compressing_streambuf& operator=(const block_compressing_streambuf&) = delete;
+		~block_compressing_streambuf() override;
+
+		/** @brief Returns statistics about the data written so far */
+		const block_compression_statistics& statistics() const { return mStatistics; }
+
+	protected:
+		int_type overflow(int_type aChar) override;
+		int sync() override;
+		pos_type seekoff(off_type aOffset, std::ios_base::seekdir aDirection, std::ios_base::openmode aMode) override;
+
+	private:
+		/** Compresses the data in the put area, writes it to the sink and resets the put area */
+		void write_block();
+
+		std::streambuf& mSink;
+		std::vector<char> mBlock;
+		std::vector<std::byte> mCompressed;
+		block_compression_statistics mStatistics;
+	};
+
+	/** @brief block_decompressing_streambuf
+	 *
+	 *  An input stream buffer which reads a stream written through a block_compressing_streambuf.
+	 *  The blocks are decompressed by worker threads ahead of the reader, so that decompression
+	 *  of the following blocks overlaps with deserialization of the current one.
+	 */
+	class block_decompressing_streambuf : public std::streambuf
+	{
+	public:
+		/** @brief Construct, reading the compressed stream from memory
+		 *
+		 *  @param[in] aSource The compressed stream, including its header; must outlive this instance
+		 *  @param[in] aNumWorkers Number of decompression threads, or 0 to choose one based on the hardware
+		 *  @param[in] aVerifyBlock Invoked by the workers with the data of every block, before it is decompressed;
+		 *                          may throw to report the data as corrupted, which is rethrown to the reader
+		 *  Throws an avk::runtime_error if aSource is not a valid block-compressed stream.
+		 */
+		block_decompressing_streambuf(std::span<const std::byte> aSource, unsigned int aNumWorkers = 0, std::function<void(std::span<const std::byte>)> aVerifyBlock = {});
+		block_decompressing_streambuf(const block_decompressing_streambuf&) = delete;
+		block_decompressing_streambuf& operator=(const block_decompressing_streambuf&) = delete;
+		~block_decompressing_streambuf() override;
+
+		/** @brief Returns statistics about the data decompressed so far */
+		block_compression_statistics statistics() const;
+
+	protected:
+		int_type underflow() override;
+		pos_type seekoff(off_type aOffset, std::ios_base::seekdir aDirection, std::ios_base::openmode aMode) override;
+
+	private:
+		struct block_info
+		{
+			std::span<const std::byte> mData;
+			std::uint64_t mUncompressedOffset;
+			std::uint32_t mUncompressedSize;
+			bool mStoredUncompressed;
+		};
+
+		void worker();
+
+		std::vector<block_info> mBlocks;
+		/** Ring of decompressed blocks; block i is decompressed into slot i % mSlots.size() */
+		std::vector<std::vector<char>> mSlots;
+		/** Per slot, the index of the block it contains, or -1 if none */
+		std::vector<std::int64_t> mSlotBlockIndices;
+		/** Index of the block the reader currently reads from, -1 before the first read */
+		std::int64_t mCurrentBlock = -1;
+		/** Index of the next block to be decompressed by a worker */
+		size_t mNextBlockToDecompress = 0;
+		std::function<void(std::span<const std::byte>)> mVerifyBlock;
+		std::exception_ptr mError;
+		bool mStop = false;
+		block_compression_statistics mStatistics;
+		mutable std::mutex mMutex;
+		std::condition_variable mCondition;
+		std::vector<std::thread> mWorkers;
+	};
+}
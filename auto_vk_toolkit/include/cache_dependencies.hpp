@@ -0,0 +1,92 @@
+#pragma once
+
+namespace avk
+{
+	/**	The state of an input file of a cache file at the time the cache file has been written. */
+	struct cache_file_dependency
+	{
+		std::string mPath;
+		std::uint64_t mSize;
+		/** std::filesystem::last_write_time, as number of ticks since the clock's epoch */
+		std::int64_t mLastWriteTime;
+		/** file_content_hash of the file */
+		std::uint64_t mContentHash;
+
+		/**	Captures the current state of the file at the given path.
+		 *	Throws an avk::runtime_error if the file can not be read.
+		 */
+		static cache_file_dependency from_file(const std::string& aPath);
+
+		/**	Returns true if the file still has the captured state.
+		 *	Size and modification time are compared first. The content hash is only computed and compared
+		 *	if the modification time differs, so that touching a file does not invalidate a cache.
+		 */
+		bool is_up_to_date() const;
+	};
+
+	/**	A setting which influences the content of a cache file, e.g., whether textures are flipped. */
+	struct cache_setting_dependency
+	{
+		std::string mName;
+		std::string mValue;
+
+		bool operator==(const cache_setting_dependency&) const = default;
+	};
+
+	/**	The inputs of a cache file: the files it is generated from and the settings it is generated with.
+	 *	If any of them change, the cache file is stale and must be regenerated, see avk::serializer.
+	 *
+	 *	@example
+	 *		auto serializer = avk::serializer(pathToModel + ".cache", avk::cache_dependencies{}
+	 *			.add_file(pathToModel)
+	 *			.add_setting("flip", aFlip)
+	 *			.add_setting("components", aPreferredNumberOfTextureComponents));
+	 */
+	class cache_dependencies
+	{
+	public:
+		/**	Adds a file from which the cache file's content is generated. Adding the same file twice has no effect. */
+		cache_dependencies& add_file(std::string aPath);
+
+		/**	Adds a setting with which the cache file's content is generated.
+		 *	@param	aName	Unique name of the setting
+		 *	@param	aValue	Value of the setting; must be formattable with std::format
+		 */
+		template <typename T>
+		cache_dependencies& add_setting(std::string_view aName, const T& aValue)
+		{
+			mSettings.push_back(cache_setting_dependency{ std::string(aName), std::format("{}", aValue) });
+			return *this;
+		}
+
+		/**	Returns the paths of all added files. */
+		const std::vector<std::string>& files() const { return mFiles; }
+
+		/**	Returns all added settings. */
+		const std::vector<cache_setting_dependency>& settings() const { return mSettings; }
+
+	private:
+		std::vector<std::string> mFiles;
+		std::vector<cache_setting_dependency> mSettings;
+	};
+
+	/**	Returns the path of the file which records the dependencies of the given cache file. */
+	extern std::string cache_dependency_record_path(std::string_view aCacheFilePath);
+
+	/**	Determines whether the given cache file exists and has been generated from the given dependencies,
+	 *	and from files which have not changed since then.
+	 *	This is the case if the dependency record written by write_cache_dependency_record exists, if it
+	 *	contains all of aDependencies' files and the same settings, if all recorded files are up to date,
+	 *	and if the cache file has not changed since the record has been written.
+	 */
+	extern bool is_cache_up_to_date(std::string_view aCacheFilePath, const cache_dependencies& aDependencies);
+
+	/**	Records the current state of all of aDependencies' files and its settings for the given cache file.
+	 *	Must be invoked after the cache file has been written completely.
+	 *	Throws an avk::runtime_error if a file can not be read or the record can not be written.
+	 */
+	extern void write_cache_dependency_record(std::string_view aCacheFilePath, const cache_dependencies& aDependencies);
+
+	/**	Deletes the dependency record of the given cache file, if it exists, which marks the cache file as stale. */
+	extern void remove_cache_dependency_record(std::string_view aCacheFilePath);
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+namespace avk
+{
+	/** @brief Thrown if the content of a cache file does not match its checksums, or if it is incomplete */
+	class cache_file_corrupted_error : public avk::runtime_error
+	{
+	public:
+		using avk::runtime_error::runtime_error;
+	};
+
+	/**	The checksums stored at the end of a cache file, see checksumming_streambuf. */
+	struct cache_file_checksums
+	{
+		/** Number of bytes before the checksums, i.e., the size of the cache file's actual content */
+		std::uint64_t mPayloadSize = 0;
+		/** Number of bytes covered by each checksum; the last block may be smaller */
+		std::uint64_t mBlockSize = 0;
+		/** content_hash of every block, seeded with the block's index */
+		std::vector<std::uint64_t> mBlockChecksums;
+	};
+
+	/**	Reads the checksums from the end of a cache file and validates them.
+	 *	@param	aFile		The whole cache file
+	 *	@param	aVersion	Version the checksums must have been written with
+	 *	@return	The checksums, or {} if the file does not end with valid checksums of the given version,
+	 *			e.g., because writing it has been aborted
+	 */
+	extern std::optional<cache_file_checksums> read_cache_file_checksums(std::span<const std::byte> aFile, std::uint32_t aVersion);
+
+	/**	Reads the checksums from the end of the cache file at the given path and validates them,
+	 *	see read_cache_file_checksums(std::span<const std::byte>, std::uint32_t).
+	 */
+	extern std::optional<cache_file_checksums> read_cache_file_checksums(const std::filesystem::path& aPath, std::uint32_t aVersion);
+
+	/** @brief checksumming_streambuf
+	 *
+	 *  An output stream buffer which passes all written data on to a sink and computes a checksum
+	 *  of every block of fixed size. finish() appends the checksums, followed by a footer, which
+	 *  can be read with read_cache_file_checksums. A file which has not been finished, e.g.,
+	 *  because the application has crashed while writing it, has no valid footer.
+	 *  sync() only passes complete blocks on to the sink.
+	 */
+	class checksumming_streambuf : public std::streambuf
+	{
+	public:
+		/** @brief Construct, writing to aSink
+		 *
+		 *  @param[in] aSink The stream buffer the data and the checksums are written to; must outlive this instance
+		 *  @param[in] aBlockSize Number of bytes per checksum
+		 */
+		checksumming_streambuf(std::streambuf& aSink, size_t aBlockSize);
+		checksumming_streambuf(const checksumming_streambuf&) = delete;
+		checksumming_streambuf& operator=(const checksumming_streambuf&) = delete;
+		~checksumming_streambuf() override = default;
+
+		/** @brief Writes the remaining data, followed by the checksums and the footer
+		 *  Must be invoked once, after all data has been written. Throws an avk::runtime_error if writing fails.
+		 *  @param[in] aVersion Version to store in the footer
+		 */
+		void finish(std::uint32_t aVersion);
+
+	protected:
+		int_type overflow(int_type aChar) override;
+		int sync() override;
+		pos_type seekoff(off_type aOffset, std::ios_base::seekdir aDirection, std::ios_base::openmode aMode) override;
+
+	private:
+		/** Computes the checksum of the data in the put area, writes it to the sink and resets the put area */
+		void write_block();
+
+		std::streambuf& mSink;
+		std::vector<char> mBlock;
+		std::vector<std::uint64_t> mChecksums;
+		std::uint64_t mPayloadSize = 0;
+	};
+
+	/** @brief checksum_verifier
+	 *
+	 *  Verifies the blocks of a cache file's content against their checksums on a background thread,
+	 *  front to back, so that verification overlaps with deserialization. Readers invoke verify()
+	 *  before they access data, which only blocks if the background thread has not reached it yet.
+	 */
+	class checksum_verifier
+	{
+	public:
+		/** @brief Construct and start verifying
+		 *
+		 *  @param[in] aPayload The content of the cache file, without the checksums; must outlive this instance
+		 *  @param[in] aChecksums The checksums of aPayload
+		 */
+		checksum_verifier(std::span<const std::byte> aPayload, cache_file_checksums aChecksums);
+		checksum_verifier(const checksum_verifier&) = delete;
+		checksum_verifier& operator=(const checksum_verifier&) = delete;
+		~checksum_verifier();
+
+		/** @brief Blocks until all data before aEnd has been verified
+		 *  Throws a cache_file_corrupted_error if any of it does not match its checksum.
+		 *  @param[in] aEnd Pointer into, or one past the end of, the payload
+		 */
+		void verify(const std::byte* aEnd) const
+		{
+			if (static_cast<size_t>(aEnd - mPayload.data()) > mVerifiedBytes.load(std::memory_order_acquire)) {
+				wait_until_verified(static_cast<size_t>(aEnd - mPayload.data()));
+			}
+		}
+
+		/** @brief Returns true if any block verified so far does not match its checksum */
+		bool has_failed() const;
+
+	private:
+		void wait_until_verified(size_t aEnd) const;
+		void worker();
+
+		std::span<const std::byte> mPayload;
+		cache_file_checksums mChecksums;
+		std::atomic<size_t> mVerifiedBytes = 0;
+		std::optional<size_t> mFailedBlock;
+		bool mStop = false;
+		mutable std::mutex mMutex;
+		mutable std::condition_variable mCondition;
+		std::thread mWorker;
+	};
+
+	/** @brief verifying_streambuf
+	 *
+	 *  An input stream buffer which reads the content of a cache file block by block from a source
+	 *  and verifies every block against its checksum before it can be read. Throws a
+	 *  cache_file_corrupted_error from underflow() if a block does not match or is truncated.
+	 */
+	class verifying_streambuf : public std::streambuf
+	{
+	public:
+		/** @brief Construct, reading from aSource
+		 *
+		 *  @param[in] aSource The stream buffer to read the cache file from, positioned at its beginning; must outlive this instance
+		 *  @param[in] aChecksums The checksums of the cache file
+		 */
+		verifying_streambuf(std::streambuf& aSource, cache_file_checksums aChecksums);
+		verifying_streambuf(const verifying_streambuf&) = delete;
+		verifying_streambuf& operator=(const verifying_streambuf&) = delete;
+		~verifying_streambuf() override = default;
+
+		/** @brief Returns true if a block has not matched its checksum */
+		bool has_failed() const { return mFailed; }
+
+	protected:
+		int_type underflow() override;
+		pos_type seekoff(off_type aOffset, std::ios_base::seekdir aDirection, std::ios_base::openmode aMode) override;
+
+	private:
+		std::streambuf& mSource;
+		cache_file_checksums mChecksums;
+		std::vector<char> mBlock;
+		/** Index of the block in the get area, -1 before the first read */
+		std::int64_t mCurrentBlock = -1;
+		bool mFailed = false;
+	};
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "content_hash.hpp"
+#include "memory_mapped_file.hpp"
+#include "serializer.hpp"
+
+namespace avk
+{
+	/**	An entry in the table of contents of a chunked_cache file. */
+	struct chunked_cache_entry
+	{
+		/** Unique name of the entry, which is used to look it up */
+		std::string mName;
+		/** User-defined key, e.g., a hash of the entry's inputs. An entry is only loaded if the requested key matches. */
+		std::uint64_t mKey;
+		/** Offset of the entry's data from the beginning of the file */
+		std::uint64_t mOffset;
+		/** Size of the entry's data in bytes */
+		std::uint64_t mSize;
+		/** content_hash of the entry's data */
+		std::uint64_t mChecksum;
+	};
+
+	template<typename Archive>
+	void serialize(Archive& aArchive, chunked_cache_entry& aValue)
+	{
+		aArchive(
+			aValue.mName,
+			aValue.mKey,
+			aValue.mOffset,
+			aValue.mSize,
+			aValue.mChecksum
+		);
+	}
+
+	/** @brief chunked_cache
+	 *
+	 *  A cache file which consists of independent, named entries, in contrast to the single
+	 *  sequential stream written by avk::serializer. Every entry is serialized separately and
+	 *  listed in a table of contents at the end of the file, together with its key, offset,
+	 *  size and checksum. Hence, entries can be loaded in any order, skipped, and loaded from
+	 *  multiple threads in parallel. If a single entry is missing, stale (i.e., its key does
+	 *  not match) or corrupted, only this entry has to be regenerated and stored again.
+	 *
+	 *  The file is memory mapped for reading. Entries which are stored are kept in memory
+	 *  until save() is invoked, which writes a new file containing all entries. save() is
+	 *  invoked by the destructor if there are unsaved changes.
+	 *
+	 *  load, load_data, and store can be invoked concurrently from multiple threads, but an
+	 *  entry must not be stored or removed while it is being loaded, and save() must not be
+	 *  invoked concurrently with any other function. The data returned by load_data is not
+	 *  copied, hence, it must not be used after the next save() or after the cache has been
+	 *  destroyed, see load_data.
+	 *
+	 *  @example
+	 *		avk::chunked_cache cache(pathToModel + ".chunks");
+	 *		std::vector<glm::vec3> normals;
+	 *		cache.load_or_store("normals", sourceHash, [&]() { normals = avk::get_normals(...); }, normals);
+	 */
+	class chunked_cache
+	{
+	public:
+		/** @brief Opens the chunked cache file at the given path
+		 *
+		 *  If the file does not exist, or if it is not a valid chunked cache file of the current
+		 *  SERIALIZER_CACHE_FILE_VERSION, the cache starts empty and the file will be (re)created on save().
+		 *
+		 *  @param[in] aCacheFilePath The path to the cache file
+		 */
+		chunked_cache(std::string_view aCacheFilePath);
+
+		chunked_cache() = delete;
+		chunked_cache(chunked_cache&&) noexcept = delete;
+		chunked_cache(const chunked_cache&) = delete;
+		chunked_cache& operator=(chunked_cache&&) noexcept = delete;
+		chunked_cache& operator=(const chunked_cache&) = delete;
+		~chunked_cache();
+
+		/** @brief Returns the path to the cache file */
+		const std::string& path() const { return mPath; }
+
+		/** @brief Returns the table of contents entry with the given name, or {} if there is none */
+		std::optional<chunked_cache_entry> find(std::string_view aName) const;
+
+		/** @brief Returns true if there is an entry with the given name and key */
+		bool contains(std::string_view aName, std::uint64_t aKey) const;
+
+		/** @brief Returns all entries of the table of contents, including those which have not been saved yet */
+		std::vector<chunked_cache_entry> entries() const;
+
+		/** @brief Returns the raw data of the entry with the given name
+		 *
+		 *  The data is verified against the entry's checksum. It is not copied: the returned span points
+		 *  into the memory mapped file, or into the in-memory data of an entry which has been stored but
+		 *  not saved yet. Therefore, it only remains valid until
+		 *   - the same entry is stored (via store or store_data) or removed,
+		 *   - save() is invoked, which writes a new file and maps it instead of the previous one, or
+		 *   - the cache is destroyed, which invokes save() if there are unsaved changes.
+		 *  Copy the data if it is needed for longer than that.
+		 *
+		 *  @param[in] aName The entry's name
+		 *  @param[in] aKey The expected key of the entry
+		 *  @return The entry's data, or {} if the entry does not exist, its key does not match, or it is corrupted.
+		 */
+		std::optional<std::span<const std::byte>> load_data(std::string_view aName, std::uint64_t aKey) const;
+
+		/** @brief Adds or replaces the entry with the given name
+		 *
+		 *  @param[in] aName The entry's name
+		 *  @param[in] aKey The entry's key
+		 *  @param[in] aData The entry's raw data
+		 */
+		void store_data(std::string_view aName, std::uint64_t aKey, std::vector<std::byte> aData);
+
+		/** @brief Removes the entry with the given name, if it exists */
+		void remove(std::string_view aName);
+
+		/** @brief Deserializes the given objects from the entry with the given name
+		 *
+		 *  @param[in] aName The entry's name
+		 *  @param[in] aKey The expected key of the entry
+		 *  @param[in] aValues The objects to fill from the entry, in the same order as they were stored
+		 *  @return true if the objects have been deserialized, false if the entry does not exist, its key
+		 *			does not match, or it is corrupted. In the latter case, the objects may be partially filled.
+		 */
+		template<typename... Types>
+		bool load(std::string_view aName, std::uint64_t aKey, Types&... aValues) const
+		{
+			auto data = load_data(aName, aKey);
+			if (!data.has_value()) {
+				return false;
+			}
+			try {
+				mapped_binary_input_archive archive(data->data(), data->data() + data->size());
+				archive(aValues...);
+			}
+			catch (const cereal::Exception& e) {
+				LOG_WARNING(std::format("Unable to deserialize entry '{}' of chunked cache file '{}': {}", aName, mPath, e.what()));
+				return false;
+			}
+			return true;
+		}
+
+		/** @brief Serializes the given objects into a new entry with the given name, replacing an existing one
+		 *
+		 *  @param[in] aName The entry's name
+		 *  @param[in] aKey The entry's key
+		 *  @param[in] aValues The objects to serialize
+		 */
+		template<typename... Types>
+		void store(std::string_view aName, std::uint64_t aKey, Types&&... aValues)
+		{
+			std::vector<std::byte> data;
+			{
+				byte_vector_streambuf buffer(data);
+				std::ostream stream(&buffer);
+				cereal::BinaryOutputArchive archive(stream);
+				archive(std::forward<Types>(aValues)...);
+			}
+			store_data(aName, aKey, std::move(data));
+		}
+
+		/** @brief Loads the given objects from the entry with the given name, or generates and stores them
+		 *
+		 *  If the entry can not be loaded (see load), aGenerate is invoked to fill the objects,
+		 *  and they are stored as a new entry afterwards.
+		 *
+		 *  @param[in] aName The entry's name
+		 *  @param[in] aKey The expected key of the entry
+		 *  @param[in] aGenerate Callback which fills aValues
+		 *  @param[in] aValues The objects to fill
+		 *  @return true if the objects have been loaded from the cache, false if they have been generated
+		 */
+		template<typename F, typename... Types>
+		bool load_or_store(std::string_view aName, std::uint64_t aKey, F&& aGenerate, Types&... aValues)
+		{
+			if (load(aName, aKey, aValues...)) {
+				return true;
+			}
+			aGenerate();
+			store(aName, aKey, aValues...);
+			return false;
+		}
+
+		/** @brief Returns true if entries have been stored or removed since the file has been opened or saved */
+		bool has_unsaved_changes() const;
+
+		/** @brief Writes all entries and the table of contents to the cache file
+		 *
+		 *  The file is written to a temporary file first, which replaces the cache file afterwards.
+		 *  Entries which have not been changed are copied over from the previous file.
+		 *  Throws an avk::runtime_error if the file can not be written or replaced. If replacing fails,
+		 *  the previous cache file remains mapped and the temporary file is removed.
+		 */
+		void save();
+
+	private:
+		/** Appends everything written to it to a vector of bytes */
+		class byte_vector_streambuf : public std::streambuf
+		{
+		public:
+			byte_vector_streambuf(std::vector<std::byte>& aTarget) : mTarget{ aTarget } {}
+
+		protected:
+			std::streamsize xsputn(const char* aData, std::streamsize aCount) override
+			{
+				const auto* bytes = reinterpret_cast<const std::byte*>(aData);
+				mTarget.insert(mTarget.end(), bytes, bytes + aCount);
+				return aCount;
+			}
+
+			int_type overflow(int_type aChar) override
+			{
+				if (!traits_type::eq_int_type(aChar, traits_type::eof())) {
+					mTarget.push_back(static_cast<std::byte>(aChar));
+				}
+				return traits_type::not_eof(aChar);
+			}
+
+		private:
+			std::vector<std::byte>& mTarget;
+		};
+
+		struct entry_state
+		{
+			chunked_cache_entry mEntry;
+			/** Data which has been stored, but not saved yet; empty otherwise */
+			std::vector<std::byte> mUnsavedData;
+			bool mUnsaved;
+		};
+
+		/** Reads the table of contents of the mapped file; returns false if the file is invalid */
+		bool read_table_of_contents();
+
+		std::string mPath;
+		std::optional<memory_mapped_file> mFile;
+		std::map<std::string, entry_state, std::less<>> mEntries;
+		bool mUnsavedChanges = false;
+		mutable std::mutex mMutex;
+	};
+}
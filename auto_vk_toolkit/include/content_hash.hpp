@@ -0,0 +1,26 @@
+#pragma once
+
+namespace avk
+{
+	/**	Computes a fast, non-cryptographic 64-bit hash of a block of memory.
+	 *	The hash is computed with the XXH64 algorithm, i.e., it is suitable for detecting
+	 *	changed or corrupted data, but not for security-related purposes.
+	 *	@param	aData	Pointer to the beginning of the data
+	 *	@param	aSize	Size of the data in bytes
+	 *	@param	aSeed	Seed value, which can be used to chain multiple hashes
+	 *	@return	The 64-bit hash value
+	 */
+	extern uint64_t content_hash(const void* aData, size_t aSize, uint64_t aSeed = 0);
+
+	/**	Computes a fast, non-cryptographic 64-bit hash of a block of memory, see content_hash(const void*, size_t, uint64_t).
+	 */
+	extern uint64_t content_hash(std::span<const std::byte> aData, uint64_t aSeed = 0);
+
+	/**	Computes a fast, non-cryptographic 64-bit hash of the whole content of a file.
+	 *	The file is memory mapped for this purpose. Throws an avk::runtime_error if the file can not be read.
+	 *	@param	aPath	Path to the file
+	 *	@param	aSeed	Seed value, which can be used to chain multiple hashes
+	 *	@return	The 64-bit hash value
+	 */
+	extern uint64_t file_content_hash(const std::filesystem::path& aPath, uint64_t aSeed = 0);
+}
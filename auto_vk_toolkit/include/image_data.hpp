@@ -4,6 +4,7 @@ namespace avk
 {
 	class image_data;
 	class image_data_implementor;
+	struct texture_compression;
 
 
 	/** Interface of image_data type, used for abstraction and implementor in bridge pattern
@@ -369,6 +370,33 @@ namespace avk
 			return !(pimpl && !pimpl->empty());
 		}
 
+		/** Generate all mipmap levels below level 0 on the CPU, down to 1x1 pixels, see generate_mip_levels
+		* The image data must have been loaded. Nothing is generated for image data which contains mipmap levels already, for image data
+		* with array layers, for non-2D image data, and for formats which are not supported by mip_map_pixel_layout_for, e.g., block-compressed ones.
+		* @param aNumThreads	number of threads which compute the rows of each level, or 0 to choose one based on the hardware
+		* @return true if the mipmap levels have been generated, i.e., levels() returns the number of levels of a full mipmap chain
+		*/
+		bool generate_mip_maps(unsigned int aNumThreads = 0);
+
+		/** Encode all mipmap levels and faces to a block-compressed format on the CPU, see choose_texture_block_format and compress_blocks
+		* The image data must have been loaded. Since mipmaps can not be generated for block-compressed formats afterwards, call generate_mip_maps first if they are needed.
+		* Nothing is encoded for image data with array layers, for non-2D image data, and for formats which can not be encoded, e.g., block-compressed ones.
+		* @param aSettings		which block-compressed formats to prefer
+		* @param aIsNormalMap	true if the image data is a normal map, which can be encoded to BC5, depending on aSettings
+		* @param aNumThreads	number of threads which encode blocks, or 0 to choose one based on the hardware
+		* @return true if the image data has been encoded, i.e., get_format() returns a block-compressed format
+		*/
+		bool compress(const texture_compression& aSettings, bool aIsNormalMap = false, unsigned int aNumThreads = 0);
+
+		/** Multiply the color channels of all mipmap levels and faces with their alpha channel on the CPU, see premultiply_alpha in pixel_conversion.hpp
+		* The image data must have been loaded. sRGB-encoded colors are multiplied in linear space. Nothing is multiplied for image data with array layers,
+		* for non-2D image data, and for formats which have no alpha channel or are not supported by mip_map_pixel_layout_for, e.g., block-compressed ones.
+		* Call it before generate_mip_maps, s.t. the levels are filtered without the colors of transparent texels bleeding in, and before compress.
+		* @param aNumThreads	number of threads which multiply the rows of each level, or 0 to choose one based on the hardware
+		* @return true if the colors have been multiplied
+		*/
+		bool premultiply_alpha(unsigned int aNumThreads = 0);
+
 	private:
 		// for the pimpl (pointer-to-implementation) idiom, the following should hold true: 
 		// use unique_ptr
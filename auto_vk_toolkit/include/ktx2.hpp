@@ -0,0 +1,123 @@
+#pragma once
+
+#include "memory_mapped_file.hpp"
+
+namespace avk
+{
+	/** Supercompression schemes of KTX2 files, see the supercompressionScheme field of the KTX2 header */
+	enum struct ktx2_supercompression : uint32_t
+	{
+		none = 0,
+		/** Basis Universal ETC1S payloads; the global data of the file contains the shared codebooks */
+		basis_lz = 1,
+		zstandard = 2,
+		zlib = 3
+	};
+
+	/** The color model of the payload of a KTX2 file, as stated in its data format descriptor */
+	enum struct ktx2_color_model
+	{
+		/** Any format which has a Vulkan format, i.e., the vkFormat field of the header is not VK_FORMAT_UNDEFINED */
+		vulkan_format,
+		/** Basis Universal ETC1S, always with basis_lz supercompression */
+		etc1s,
+		/** Basis Universal UASTC, optionally with zstandard supercompression */
+		uastc
+	};
+
+	/** One entry of the level index of a KTX2 file */
+	struct ktx2_level
+	{
+		/** The (supercompressed) data of all layers and faces of the level, pointing into the mapped file */
+		const std::byte* mData = nullptr;
+		size_t mSize = 0;
+		/** The size of the data of all layers and faces of the level after supercompression has been removed; 0 for basis_lz */
+		size_t mUncompressedSize = 0;
+	};
+
+	/**	A KTX2 file, mapped into memory; see https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+	 *
+	 *	Only the header, the data format descriptor, and the level index are parsed. The data of the levels is
+	 *	not copied, i.e., all pointers point into the mapping and are valid as long as the ktx2_file exists.
+	 */
+	class ktx2_file
+	{
+	public:
+		/**	Maps and parses the KTX2 file at the given path.
+		 *	Throws an avk::runtime_error if the file can not be mapped or is not a valid KTX2 file.
+		 */
+		explicit ktx2_file(const std::filesystem::path& aPath);
+
+		/** Returns true if the file at the given path starts with the KTX2 file identifier */
+		static bool has_ktx2_identifier(const std::filesystem::path& aPath);
+
+		/** The format of the level data, or vk::Format::eUndefined for Basis Universal payloads */
+		vk::Format format() const { return mFormat; }
+		ktx2_supercompression supercompression() const { return mSupercompression; }
+		ktx2_color_model color_model() const { return mColorModel; }
+		/** True if the data format descriptor states the sRGB transfer function */
+		bool is_srgb() const { return mIsSrgb; }
+		/** The number of channels of Basis Universal payloads, 1 to 4; 4 for all other payloads */
+		uint32_t channels() const { return mChannels; }
+		/** True if format() is a floating-point format */
+		bool is_hdr() const;
+		vk::ImageType target() const;
+		vk::Extent3D extent(uint32_t aLevel = 0) const;
+		/** The number of levels stored in the file; a file which requests mipmaps to be generated stores one level */
+		uint32_t levels() const { return static_cast<uint32_t>(mLevels.size()); }
+		/** The number of array layers; 1 if the file does not contain an array */
+		uint32_t layers() const { return mLayers; }
+		uint32_t faces() const { return mFaces; }
+		const ktx2_level& level(uint32_t aLevel) const { return mLevels[aLevel]; }
+		/** The supercompression global data, e.g., the codebooks of basis_lz; empty if the file has none */
+		std::span<const std::byte> global_data() const { return mGlobalData; }
+		/** True if the level data must be transcoded or decompressed before it can be uploaded, see set_ktx2_transcoder */
+		bool requires_transcoding() const { return ktx2_supercompression::none != mSupercompression || ktx2_color_model::vulkan_format != mColorModel; }
+
+	private:
+		memory_mapped_file mFile;
+		vk::Format mFormat = vk::Format::eUndefined;
+		ktx2_supercompression mSupercompression = ktx2_supercompression::none;
+		ktx2_color_model mColorModel = ktx2_color_model::vulkan_format;
+		bool mIsSrgb = false;
+		uint32_t mChannels = 4;
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+		uint32_t mDepth = 0;
+		uint32_t mLayers = 1;
+		uint32_t mFaces = 1;
+		std::vector<ktx2_level> mLevels;
+		std::span<const std::byte> mGlobalData;
+	};
+
+	/**	Transcodes or decompresses all layers and faces of one level of a KTX2 file.
+	 *	@param	aFile			The file
+	 *	@param	aLevel			The level
+	 *	@param	aTargetFormat	The format to transcode to, as returned by ktx2_transcode_target_format
+	 *	@param	aTarget			Target memory of ktx2_transcoded_level_size(aFile, aLevel, aTargetFormat) bytes; layers and
+	 *							faces are stored in the order of the KTX2 specification, i.e., faces of layer 0 first
+	 *	@return	True on success
+	 *	The transcoder is invoked for several levels concurrently, hence, it must be thread-safe.
+	 */
+	using ktx2_transcoder = std::function<bool(const ktx2_file& aFile, uint32_t aLevel, vk::Format aTargetFormat, std::byte* aTarget)>;
+
+	/**	Sets the transcoder which is used for KTX2 files whose level data requires transcoding, e.g., a function which
+	 *	invokes the Basis Universal transcoder and zstd. Without a transcoder, only KTX2 files without supercompression
+	 *	and with a Vulkan format can be loaded. Pass an empty function to remove the transcoder.
+	 */
+	extern void set_ktx2_transcoder(ktx2_transcoder aTranscoder);
+
+	/** Returns the transcoder which has been set with set_ktx2_transcoder, which may be empty */
+	extern const ktx2_transcoder& get_ktx2_transcoder();
+
+	/**	Chooses the format the level data of the given file is transcoded to.
+	 *	Zstandard- or zlib-supercompressed data keeps its Vulkan format. Basis Universal payloads are transcoded to the best
+	 *	block-compressed format for their channels which the physical device can sample from: BC4 for one channel, BC5 for
+	 *	two channels, and BC7 for three or four channels, falling back to BC3 or BC1 if BC7 is not supported. If no block-compressed
+	 *	format is supported, they are transcoded to uncompressed RGBA8. If the context has not been initialized yet, BC support is assumed.
+	 */
+	extern vk::Format ktx2_transcode_target_format(const ktx2_file& aFile);
+
+	/** Returns the size of all layers and faces of the given level, in bytes, after it has been transcoded to the given format */
+	extern size_t ktx2_transcoded_level_size(const ktx2_file& aFile, uint32_t aLevel, vk::Format aTargetFormat);
+}
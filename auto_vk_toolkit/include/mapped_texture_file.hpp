@@ -0,0 +1,76 @@
+#pragma once
+
+#include "memory_mapped_file.hpp"
+
+namespace avk
+{
+	/** Container formats which can be loaded with gli */
+	enum struct texture_container
+	{
+		unknown,
+		dds,
+		/** KTX version 1; KTX2 files are loaded by ktx2_file */
+		ktx,
+		kmg
+	};
+
+	/**	A DDS or KTX (version 1) file, mapped into memory, whose image data is used in place.
+	 *
+	 *	Only the headers are parsed. In contrast to gli::load, the image data is neither read into a
+	 *	user-space buffer nor copied into a gli::texture, i.e., all pointers point into the mapping,
+	 *	and pages are only read from disk when the data is accessed, e.g., when it is copied into a
+	 *	staging buffer. Only 2D textures, 2D texture arrays, and cube maps (arrays) with an uncompressed
+	 *	8-, 16-, or 32-bit format or a BCn format are supported; everything else is left to gli.
+	 */
+	class mapped_texture_file
+	{
+	public:
+		/** Returns the container format of the file at the given path, judged by its identifier */
+		static texture_container identify(const std::filesystem::path& aPath);
+
+		/**	Maps and parses the DDS or KTX file at the given path.
+		 *	@return	The file, or nullptr if it can not be mapped, is neither a DDS nor a KTX file, is truncated,
+		 *			or has a format or layout which is not supported, in which case it can still be loaded with gli.
+		 */
+		static std::unique_ptr<mapped_texture_file> load(const std::filesystem::path& aPath);
+
+		vk::Format format() const { return mFormat; }
+		/** True if format() is a floating-point format */
+		bool is_hdr() const;
+		vk::Extent3D extent(uint32_t aLevel = 0) const;
+		uint32_t levels() const { return static_cast<uint32_t>(mLevels.size()); }
+		/** The number of array layers; 1 if the file does not contain an array */
+		uint32_t layers() const { return mLayers; }
+		uint32_t faces() const { return mFaces; }
+		/** Returns the image data of the given layer, face, and level, which points into the mapping */
+		const std::byte* data(uint32_t aLayer, uint32_t aFace, uint32_t aLevel) const;
+		/** The size of the given level of one layer and face, in bytes */
+		size_t size(uint32_t aLevel) const { return mLevels[aLevel].mSize; }
+		/** The size of all levels, layers, and faces, in bytes */
+		size_t size() const;
+
+	private:
+		/** Where the images of a level are stored in the file */
+		struct level
+		{
+			/** The offset of the level of the first layer and face */
+			size_t mOffset = 0;
+			/** The size of the level of one layer and face */
+			size_t mSize = 0;
+			/** The distance between the level of consecutive layers and faces */
+			size_t mImageStride = 0;
+		};
+
+		explicit mapped_texture_file(memory_mapped_file aFile);
+		bool parse_dds();
+		bool parse_ktx();
+
+		memory_mapped_file mFile;
+		vk::Format mFormat = vk::Format::eUndefined;
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+		uint32_t mLayers = 1;
+		uint32_t mFaces = 1;
+		std::vector<level> mLevels;
+	};
+}
@@ -0,0 +1,352 @@
+#pragma once
+
+#include "material_config.hpp"
+#include "material_gpu_data.hpp"
+
+namespace avk
+{
+	/** The textures of a material, in the order of the texture index members of material_gpu_data */
+	enum struct material_texture_slot : uint32_t
+	{
+		diffuse,
+		specular,
+		ambient,
+		emissive,
+		height,
+		normals,
+		shininess,
+		opacity,
+		displacement,
+		reflection,
+		lightmap,
+		extra
+	};
+
+	static constexpr uint32_t cNumMaterialTextureSlots = 12;
+
+	/** Bits of material_gpu_data_compact::mPresentFields:
+	 *  Bit cPresentTextureShift + t is set if texture slot t has been set in the material config. Its texture index is valid in
+	 *  any case, but refers to a 1x1 px texture if the bit is not set, which shaders need not sample.
+	 *  Bit cPresentOffsetTilingShift + t is set if the offset and tiling of texture slot t are not (0, 0, 1, 1).
+	 *  Bit cPresentColorShift + c is set if color c, in the order of the color members of material_gpu_data, differs from the
+	 *  default of material_config, i.e., (1, 1, 1, 1) for the diffuse, ambient, and specular reflectivity, and zero for all others.
+	 *  Bit cPresentVectorsBit is set if mAnisotropyRotation or mCustomData is not zero.
+	 *  Fields whose bits are not set contain their default values, too; the bits only allow shaders to skip loading them.
+	 */
+	static constexpr uint32_t cPresentTextureShift = 0;
+	static constexpr uint32_t cPresentOffsetTilingShift = 12;
+	static constexpr uint32_t cPresentColorShift = 24;
+	static constexpr uint32_t cPresentVectorsBit = 1u << 31;
+
+	/** The 16 bit texture index of texture slots without a texture */
+	static constexpr uint16_t cNoCompactTexIndex = 0xFFFF;
+
+	/** Material data like material_gpu_data, but in 240 instead of 432 bytes: colors, scalars, and texture offsets and tilings are
+	 *	stored as 16 bit floats, texture indices as 16 bit integers, and a bit mask tells which fields have non-default values.
+	 *	The layout matches std430, i.e., it must be used in an SSBO, not in a UBO.
+	 *	Use it with convert_for_gpu_usage<material_gpu_data_compact>, or convert material_gpu_data with compact_material_gpu_data.
+	 *
+	 *	Possible corresponding GLSL data structures, where unpackMaterial returns the MaterialGpuData of material_gpu_data:
+	 *
+	 *	layout(set = 0, binding = 0) uniform sampler2D textures[];
+	 *
+	 *	struct MaterialGpuDataCompact
+	 *	{
+	 *		uint mPresentFields;
+	 *		uint mOpacityBumpScaling;
+	 *		uint mShininessAndStrength;
+	 *		uint mRefractionIndexReflectivity;
+	 *		uint mMetallicSmoothness;
+	 *		uint mSheenThickness;
+	 *		uint mRoughnessAnisotropy;
+	 *		uint mTexIndices[6];
+	 *
+	 *		uvec2 mDiffuseReflectivity;
+	 *		uvec2 mAmbientReflectivity;
+	 *		uvec2 mSpecularReflectivity;
+	 *		uvec2 mEmissiveColor;
+	 *		uvec2 mTransparentColor;
+	 *		uvec2 mReflectiveColor;
+	 *		uvec2 mAlbedo;
+	 *		uvec2 mAnisotropyRotation;
+	 *		vec4 mCustomData;
+	 *
+	 *		uvec2 mTexOffsetTiling[12];
+	 *	};
+	 *
+	 *	layout(set = 0, binding = 1) buffer Material
+	 *	{
+	 *		MaterialGpuDataCompact materials[];
+	 *	} materialsBuffer;
+	 *
+	 *	vec4 unpackHalf4(uvec2 v)
+	 *	{
+	 *		return vec4(unpackHalf2x16(v.x), unpackHalf2x16(v.y));
+	 *	}
+	 *
+	 *	int unpackTexIndex(uint i, uint slot)
+	 *	{
+	 *		uint texIndex = (materialsBuffer.materials[i].mTexIndices[slot >> 1] >> ((slot & 1u) * 16u)) & 0xFFFFu;
+	 *		return 0xFFFFu == texIndex ? -1 : int(texIndex);
+	 *	}
+	 *
+	 *	vec4 unpackTexOffsetTiling(uint i, uint slot, uint present)
+	 *	{
+	 *		return (present & (1u << (12u + slot))) != 0u ? unpackHalf4(materialsBuffer.materials[i].mTexOffsetTiling[slot]) : vec4(0.0, 0.0, 1.0, 1.0);
+	 *	}
+	 *
+	 *	vec4 unpackColor(uint i, uint color, uint present, vec4 defaultColor)
+	 *	{
+	 *		if ((present & (1u << (24u + color))) == 0u) {
+	 *			return defaultColor;
+	 *		}
+	 *		switch (color) {
+	 *		case 0u: return unpackHalf4(materialsBuffer.materials[i].mDiffuseReflectivity);
+	 *		case 1u: return unpackHalf4(materialsBuffer.materials[i].mAmbientReflectivity);
+	 *		case 2u: return unpackHalf4(materialsBuffer.materials[i].mSpecularReflectivity);
+	 *		case 3u: return unpackHalf4(materialsBuffer.materials[i].mEmissiveColor);
+	 *		case 4u: return unpackHalf4(materialsBuffer.materials[i].mTransparentColor);
+	 *		case 5u: return unpackHalf4(materialsBuffer.materials[i].mReflectiveColor);
+	 *		default: return unpackHalf4(materialsBuffer.materials[i].mAlbedo);
+	 *		}
+	 *	}
+	 *
+	 *	MaterialGpuData unpackMaterial(uint i)
+	 *	{
+	 *		MaterialGpuData m;
+	 *		uint present = materialsBuffer.materials[i].mPresentFields;
+	 *		m.mDiffuseReflectivity  = unpackColor(i, 0u, present, vec4(1.0));
+	 *		m.mAmbientReflectivity  = unpackColor(i, 1u, present, vec4(1.0));
+	 *		m.mSpecularReflectivity = unpackColor(i, 2u, present, vec4(1.0));
+	 *		m.mEmissiveColor        = unpackColor(i, 3u, present, vec4(0.0));
+	 *		m.mTransparentColor     = unpackColor(i, 4u, present, vec4(0.0));
+	 *		m.mReflectiveColor      = unpackColor(i, 5u, present, vec4(0.0));
+	 *		m.mAlbedo               = unpackColor(i, 6u, present, vec4(0.0));
+	 *
+	 *		vec2 v;
+	 *		v = unpackHalf2x16(materialsBuffer.materials[i].mOpacityBumpScaling);          m.mOpacity = v.x;         m.mBumpScaling = v.y;
+	 *		v = unpackHalf2x16(materialsBuffer.materials[i].mShininessAndStrength);        m.mShininess = v.x;       m.mShininessStrength = v.y;
+	 *		v = unpackHalf2x16(materialsBuffer.materials[i].mRefractionIndexReflectivity); m.mRefractionIndex = v.x; m.mReflectivity = v.y;
+	 *		v = unpackHalf2x16(materialsBuffer.materials[i].mMetallicSmoothness);          m.mMetallic = v.x;        m.mSmoothness = v.y;
+	 *		v = unpackHalf2x16(materialsBuffer.materials[i].mSheenThickness);              m.mSheen = v.x;           m.mThickness = v.y;
+	 *		v = unpackHalf2x16(materialsBuffer.materials[i].mRoughnessAnisotropy);         m.mRoughness = v.x;       m.mAnisotropy = v.y;
+	 *
+	 *		bool vectors = (present & (1u << 31)) != 0u;
+	 *		m.mAnisotropyRotation = vectors ? unpackHalf4(materialsBuffer.materials[i].mAnisotropyRotation) : vec4(0.0);
+	 *		m.mCustomData         = vectors ? materialsBuffer.materials[i].mCustomData : vec4(0.0);
+	 *
+	 *		m.mDiffuseTexIndex      = unpackTexIndex(i, 0u);  m.mDiffuseTexOffsetTiling      = unpackTexOffsetTiling(i, 0u, present);
+	 *		m.mSpecularTexIndex     = unpackTexIndex(i, 1u);  m.mSpecularTexOffsetTiling     = unpackTexOffsetTiling(i, 1u, present);
+	 *		m.mAmbientTexIndex      = unpackTexIndex(i, 2u);  m.mAmbientTexOffsetTiling      = unpackTexOffsetTiling(i, 2u, present);
+	 *		m.mEmissiveTexIndex     = unpackTexIndex(i, 3u);  m.mEmissiveTexOffsetTiling     = unpackTexOffsetTiling(i, 3u, present);
+	 *		m.mHeightTexIndex       = unpackTexIndex(i, 4u);  m.mHeightTexOffsetTiling       = unpackTexOffsetTiling(i, 4u, present);
+	 *		m.mNormalsTexIndex      = unpackTexIndex(i, 5u);  m.mNormalsTexOffsetTiling      = unpackTexOffsetTiling(i, 5u, present);
+	 *		m.mShininessTexIndex    = unpackTexIndex(i, 6u);  m.mShininessTexOffsetTiling    = unpackTexOffsetTiling(i, 6u, present);
+	 *		m.mOpacityTexIndex      = unpackTexIndex(i, 7u);  m.mOpacityTexOffsetTiling      = unpackTexOffsetTiling(i, 7u, present);
+	 *		m.mDisplacementTexIndex = unpackTexIndex(i, 8u);  m.mDisplacementTexOffsetTiling = unpackTexOffsetTiling(i, 8u, present);
+	 *		m.mReflectionTexIndex   = unpackTexIndex(i, 9u);  m.mReflectionTexOffsetTiling   = unpackTexOffsetTiling(i, 9u, present);
+	 *		m.mLightmapTexIndex     = unpackTexIndex(i, 10u); m.mLightmapTexOffsetTiling     = unpackTexOffsetTiling(i, 10u, present);
+	 *		m.mExtraTexIndex        = unpackTexIndex(i, 11u); m.mExtraTexOffsetTiling        = unpackTexOffsetTiling(i, 11u, present);
+	 *		return m;
+	 *	}
+	 *
+	 *	Fields which a shader does not use are not loaded. Shaders which only use a few fields can also read them directly, e.g.,
+	 *	sample the diffuse texture only if (present & 1u) != 0u.
+	 */
+	struct material_gpu_data_compact
+	{
+		alignas(4) uint32_t mPresentFields;
+		/** Pairs of 16 bit floats, the first one in the lower bits, as packed by glm::packHalf2x16 */
+		alignas(4) uint32_t mOpacityBumpScaling;
+		alignas(4) uint32_t mShininessAndStrength;
+		alignas(4) uint32_t mRefractionIndexReflectivity;
+		alignas(4) uint32_t mMetallicSmoothness;
+		alignas(4) uint32_t mSheenThickness;
+		alignas(4) uint32_t mRoughnessAnisotropy;
+		/** Indexed by material_texture_slot; cNoCompactTexIndex if a slot has no texture */
+		alignas(4) std::array<uint16_t, cNumMaterialTextureSlots> mTexIndices;
+
+		/** Four 16 bit floats each */
+		alignas(8) glm::uvec2 mDiffuseReflectivity;
+		alignas(8) glm::uvec2 mAmbientReflectivity;
+		alignas(8) glm::uvec2 mSpecularReflectivity;
+		alignas(8) glm::uvec2 mEmissiveColor;
+		alignas(8) glm::uvec2 mTransparentColor;
+		alignas(8) glm::uvec2 mReflectiveColor;
+		alignas(8) glm::uvec2 mAlbedo;
+		alignas(8) glm::uvec2 mAnisotropyRotation;
+		/** Kept in 32 bit floats, since it may contain anything */
+		alignas(16) glm::vec4 mCustomData;
+
+		/** Indexed by material_texture_slot; the offset and the tiling as two 16 bit floats each */
+		alignas(8) std::array<glm::uvec2, cNumMaterialTextureSlots> mTexOffsetTiling;
+	};
+
+	static_assert(sizeof(material_gpu_data_compact) == 240, "material_gpu_data_compact must match the std430 layout of MaterialGpuDataCompact");
+
+	/** Returns the bits of the texture slots which have been set in the given material config, i.e., whose texture path is
+	 *	not empty; bit t corresponds to material_texture_slot t, see cPresentTextureShift.
+	 */
+	static uint32_t present_texture_slots(const material_config& aConfig)
+	{
+		const std::array<const std::string*, cNumMaterialTextureSlots> texPaths{
+			&aConfig.mDiffuseTex, &aConfig.mSpecularTex, &aConfig.mAmbientTex, &aConfig.mEmissiveTex, &aConfig.mHeightTex, &aConfig.mNormalsTex,
+			&aConfig.mShininessTex, &aConfig.mOpacityTex, &aConfig.mDisplacementTex, &aConfig.mReflectionTex, &aConfig.mLightmapTex, &aConfig.mExtraTex
+		};
+		uint32_t result = 0;
+		for (uint32_t slot = 0; slot < cNumMaterialTextureSlots; ++slot) {
+			if (!texPaths[slot]->empty()) {
+				result |= 1u << slot;
+			}
+		}
+		return result;
+	}
+
+	/** Converts the given material data into the compact layout
+	 *	@param	aMaterial			The material data, whose texture indices must be less than cNoCompactTexIndex
+	 *	@param	aPresentTextures	The texture slots which have been set, as returned by present_texture_slots
+	 */
+	static material_gpu_data_compact compact_material_gpu_data(const material_gpu_data& aMaterial, uint32_t aPresentTextures)
+	{
+		auto packHalf4 = [](const glm::vec4& v) {
+			return glm::uvec2{ glm::packHalf2x16(glm::vec2{ v.x, v.y }), glm::packHalf2x16(glm::vec2{ v.z, v.w }) };
+		};
+		auto packHalf2 = [](float x, float y) {
+			return glm::packHalf2x16(glm::vec2{ x, y });
+		};
+
+		const std::array<int32_t, cNumMaterialTextureSlots> texIndices{
+			aMaterial.mDiffuseTexIndex, aMaterial.mSpecularTexIndex, aMaterial.mAmbientTexIndex, aMaterial.mEmissiveTexIndex,
+			aMaterial.mHeightTexIndex, aMaterial.mNormalsTexIndex, aMaterial.mShininessTexIndex, aMaterial.mOpacityTexIndex,
+			aMaterial.mDisplacementTexIndex, aMaterial.mReflectionTexIndex, aMaterial.mLightmapTexIndex, aMaterial.mExtraTexIndex
+		};
+		const std::array<const glm::vec4*, cNumMaterialTextureSlots> offsetTilings{
+			&aMaterial.mDiffuseTexOffsetTiling, &aMaterial.mSpecularTexOffsetTiling, &aMaterial.mAmbientTexOffsetTiling, &aMaterial.mEmissiveTexOffsetTiling,
+			&aMaterial.mHeightTexOffsetTiling, &aMaterial.mNormalsTexOffsetTiling, &aMaterial.mShininessTexOffsetTiling, &aMaterial.mOpacityTexOffsetTiling,
+			&aMaterial.mDisplacementTexOffsetTiling, &aMaterial.mReflectionTexOffsetTiling, &aMaterial.mLightmapTexOffsetTiling, &aMaterial.mExtraTexOffsetTiling
+		};
+		const std::array<const glm::vec4*, 7> colors{
+			&aMaterial.mDiffuseReflectivity, &aMaterial.mAmbientReflectivity, &aMaterial.mSpecularReflectivity, &aMaterial.mEmissiveColor,
+			&aMaterial.mTransparentColor, &aMaterial.mReflectiveColor, &aMaterial.mAlbedo
+		};
+
+		material_gpu_data_compact result{};
+		for (uint32_t slot = 0; slot < cNumMaterialTextureSlots; ++slot) {
+			if (texIndices[slot] >= static_cast<int32_t>(cNoCompactTexIndex)) {
+				throw avk::runtime_error(std::format("Texture index {} does not fit into material_gpu_data_compact", texIndices[slot]));
+			}
+			result.mTexIndices[slot] = texIndices[slot] < 0 ? cNoCompactTexIndex : static_cast<uint16_t>(texIndices[slot]);
+			result.mTexOffsetTiling[slot] = packHalf4(*offsetTilings[slot]);
+			if (*offsetTilings[slot] != glm::vec4{ 0.0f, 0.0f, 1.0f, 1.0f }) {
+				result.mPresentFields |= 1u << (cPresentOffsetTilingShift + slot);
+			}
+		}
+
+		result.mPresentFields |= (aPresentTextures & ((1u << cNumMaterialTextureSlots) - 1u)) << cPresentTextureShift;
+
+		for (uint32_t c = 0; c < static_cast<uint32_t>(colors.size()); ++c) {
+			const auto defaultColor = c < 3 ? glm::vec4{ 1.0f } : glm::vec4{ 0.0f };
+			if (*colors[c] != defaultColor) {
+				result.mPresentFields |= 1u << (cPresentColorShift + c);
+			}
+		}
+		result.mDiffuseReflectivity			= packHalf4(aMaterial.mDiffuseReflectivity);
+		result.mAmbientReflectivity			= packHalf4(aMaterial.mAmbientReflectivity);
+		result.mSpecularReflectivity		= packHalf4(aMaterial.mSpecularReflectivity);
+		result.mEmissiveColor				= packHalf4(aMaterial.mEmissiveColor);
+		result.mTransparentColor			= packHalf4(aMaterial.mTransparentColor);
+		result.mReflectiveColor				= packHalf4(aMaterial.mReflectiveColor);
+		result.mAlbedo						= packHalf4(aMaterial.mAlbedo);
+
+		result.mOpacityBumpScaling			= packHalf2(aMaterial.mOpacity, aMaterial.mBumpScaling);
+		result.mShininessAndStrength		= packHalf2(aMaterial.mShininess, aMaterial.mShininessStrength);
+		result.mRefractionIndexReflectivity	= packHalf2(aMaterial.mRefractionIndex, aMaterial.mReflectivity);
+		result.mMetallicSmoothness			= packHalf2(aMaterial.mMetallic, aMaterial.mSmoothness);
+		result.mSheenThickness				= packHalf2(aMaterial.mSheen, aMaterial.mThickness);
+		result.mRoughnessAnisotropy			= packHalf2(aMaterial.mRoughness, aMaterial.mAnisotropy);
+
+		if (aMaterial.mAnisotropyRotation != glm::vec4{ 0.0f } || aMaterial.mCustomData != glm::vec4{ 0.0f }) {
+			result.mPresentFields |= cPresentVectorsBit;
+		}
+		result.mAnisotropyRotation			= packHalf4(aMaterial.mAnisotropyRotation);
+		result.mCustomData					= aMaterial.mCustomData;
+		return result;
+	}
+
+	/** Converts the given material data into the compact layout
+	 *	@param	aMaterial	The material data, whose texture indices must be less than cNoCompactTexIndex
+	 *	@param	aConfig		The material config which aMaterial has been converted from. It tells which texture slots have been set;
+	 *						if it is not given, all texture slots are marked as set.
+	 */
+	static material_gpu_data_compact compact_material_gpu_data(const material_gpu_data& aMaterial, std::optional<std::reference_wrapper<const material_config>> aConfig = {})
+	{
+		return compact_material_gpu_data(aMaterial, aConfig ? present_texture_slots(aConfig->get()) : (1u << cNumMaterialTextureSlots) - 1u);
+	}
+
+	/** Compares the two `material_gpu_data_compact`s for equality.
+	 */
+	static bool operator ==(const material_gpu_data_compact& left, const material_gpu_data_compact& right)
+	{
+		if (left.mPresentFields					!= right.mPresentFields					) return false;
+		if (left.mOpacityBumpScaling			!= right.mOpacityBumpScaling			) return false;
+		if (left.mShininessAndStrength			!= right.mShininessAndStrength			) return false;
+		if (left.mRefractionIndexReflectivity	!= right.mRefractionIndexReflectivity	) return false;
+		if (left.mMetallicSmoothness			!= right.mMetallicSmoothness			) return false;
+		if (left.mSheenThickness				!= right.mSheenThickness				) return false;
+		if (left.mRoughnessAnisotropy			!= right.mRoughnessAnisotropy			) return false;
+		if (left.mTexIndices					!= right.mTexIndices					) return false;
+
+		if (left.mDiffuseReflectivity			!= right.mDiffuseReflectivity			) return false;
+		if (left.mAmbientReflectivity			!= right.mAmbientReflectivity			) return false;
+		if (left.mSpecularReflectivity			!= right.mSpecularReflectivity			) return false;
+		if (left.mEmissiveColor					!= right.mEmissiveColor					) return false;
+		if (left.mTransparentColor				!= right.mTransparentColor				) return false;
+		if (left.mReflectiveColor				!= right.mReflectiveColor				) return false;
+		if (left.mAlbedo						!= right.mAlbedo						) return false;
+		if (left.mAnisotropyRotation			!= right.mAnisotropyRotation			) return false;
+		if (left.mCustomData					!= right.mCustomData					) return false;
+
+		if (left.mTexOffsetTiling				!= right.mTexOffsetTiling				) return false;
+
+		return true;
+	}
+
+	/** Negated result of operator==, see the equality operator for more details! */
+	static bool operator !=(const material_gpu_data_compact& left, const material_gpu_data_compact& right)
+	{
+		return !(left == right);
+	}
+}
+
+namespace std // Inject hash for `avk::material_gpu_data_compact` into std::
+{
+	template<> struct hash<avk::material_gpu_data_compact>
+	{
+		std::size_t operator()(avk::material_gpu_data_compact const& o) const noexcept
+		{
+			std::size_t h = 0;
+			avk::hash_combine(h,
+				o.mPresentFields,
+				o.mOpacityBumpScaling,
+				o.mShininessAndStrength,
+				o.mRefractionIndexReflectivity,
+				o.mMetallicSmoothness,
+				o.mSheenThickness,
+				o.mRoughnessAnisotropy,
+				o.mDiffuseReflectivity,
+				o.mAmbientReflectivity,
+				o.mSpecularReflectivity,
+				o.mEmissiveColor,
+				o.mTransparentColor,
+				o.mReflectiveColor,
+				o.mAlbedo,
+				o.mAnisotropyRotation,
+				o.mCustomData
+			);
+			for (uint32_t slot = 0; slot < avk::cNumMaterialTextureSlots; ++slot) {
+				avk::hash_combine(h, o.mTexIndices[slot], o.mTexOffsetTiling[slot]);
+			}
+			return h;
+		}
+	};
+}
@@ -2,12 +2,51 @@
 
 #include "image_data.hpp"
 #include "material_gpu_data_ext.hpp"
+#include "material_gpu_data_compact.hpp"
 #include "model.hpp"
 #include "serializer.hpp"
+#include "texture_registry.hpp"
+#include "texture_compression.hpp"
+#include "texture_packing.hpp"
+#include "upload_batcher.hpp"
+#include "texture_streamer.hpp"
 #include "context_vulkan.hpp"
 
 namespace avk
 {
+	/**	Write the data of a 1x1 px texture to a cache file, without creating any GPU resources.
+	 *	The data is written in the same layout as create_1px_texture_cached writes it, which can read it back.
+	 *	@param	aSerializer		A serializer in serialize mode
+	 *	@param	aColor			The color of the single pixel
+	 */
+	static void serialize_1px_texture(avk::serializer& aSerializer, std::array<uint8_t, 4> aColor)
+	{
+		aSerializer.archive_memory(aColor.data(), sizeof(aColor));
+	}
+
+	/**	Read past the data of a 1x1 px texture in a cache file, as written by create_1px_texture_cached, without creating any GPU resources.
+	 *	@param	aSerializer		A serializer in deserialize mode
+	 */
+	static void skip_1px_texture(avk::serializer& aSerializer)
+	{
+		std::array<uint8_t, 4> skipped;
+		aSerializer.archive_memory(skipped.data(), sizeof(skipped));
+	}
+
+	/**	Write or read the key of a texture, see texture_registry. The image usage is not archived.
+	 *	@param	aSerializer		A serializer in serialize or deserialize mode
+	 *	@param	aKey			The key to write, or to read into
+	 */
+	static void archive_texture_key(avk::serializer& aSerializer, texture_key& aKey)
+	{
+		aSerializer.archive(aKey.mContentHash);
+		aSerializer.archive(aKey.mFormat);
+		aSerializer.archive(aKey.mWidth);
+		aSerializer.archive(aKey.mHeight);
+		aSerializer.archive(aKey.mFaces);
+		aSerializer.archive(aKey.mLevels);
+	}
+
 	static std::tuple<avk::image, avk::command::action_type_command> create_1px_texture_cached(std::array<uint8_t, 4> aColor, avk::layout::image_layout aImageLayout, vk::Format aFormat = vk::Format::eR8G8B8A8Unorm, avk::memory_usage aMemoryUsage = avk::memory_usage::device, avk::image_usage aImageUsage = avk::image_usage::general_texture, std::optional<std::reference_wrapper<avk::serializer>> aSerializer = {})
 	{
 		auto stagingBuffer = context().create_buffer(
@@ -25,7 +64,7 @@ namespace avk
 			auto nop = stagingBuffer->fill(aColor.data(), 0);
 			assert(!nop.mBeginFun);
 			assert(!nop.mEndFun);
-			aSerializer->get().archive_memory(aColor.data(), sizeof(aColor));
+			serialize_1px_texture(aSerializer->get(), aColor);
 		}
 		else if (aSerializer && aSerializer->get().mode() == avk::serializer::mode::deserialize) {
 			aSerializer->get().archive_buffer(*stagingBuffer);
@@ -253,9 +292,11 @@ namespace avk
 	* @param aMemoryUsage	the intended memory usage of the returned image resource.
 	* @param aImageUsage	the intended image usage of the returned image resource.
 	* @param aSerializer	a serializer to use for caching data loaded from disk.
+	* @param aUploadBatcher	if set, the data is staged in the batcher's staging buffer and copied by its batches, instead of by the returned commands.
+	*						The returned commands must then be submitted after the batcher has been flushed, see upload_batcher.
 	*/
 	extern std::tuple<avk::image, avk::command::action_type_command> create_image_from_image_data_cached(image_data& aImageData, avk::layout::image_layout aImageLayout, avk::memory_usage aMemoryUsage = avk::memory_usage::device,
-		avk::image_usage aImageUsage = avk::image_usage::general_texture, std::optional<std::reference_wrapper<avk::serializer>> aSerializer = {});
+		avk::image_usage aImageUsage = avk::image_usage::general_texture, std::optional<std::reference_wrapper<avk::serializer>> aSerializer = {}, std::optional<std::reference_wrapper<avk::upload_batcher>> aUploadBatcher = {});
 
 	/** Create image from image_data, with caching
 	* Loads image data from an image_data object or the serializer cache.
@@ -295,8 +336,9 @@ namespace avk
 	* @param aMemoryUsage	the intended memory usage of the returned image resource.
 	* @param aImageUsage	the intended image usage of the returned image resource.
 	* @param aSerializer	a serializer to use for caching data loaded from disk.
+	* @param aUploadBatcher	if set, the data is uploaded by the batcher, see create_image_from_image_data_cached.
 	*/
-	extern std::tuple<avk::image, avk::command::action_type_command> create_image_from_file_cached(const std::string& aPath, bool aLoadHdrIfPossible = true, bool aLoadSrgbIfApplicable = true, bool aFlip = true, int aPreferredNumberOfTextureComponents = 4, avk::layout::image_layout aImageLayout = avk::layout::general, avk::memory_usage aMemoryUsage = avk::memory_usage::device, avk::image_usage aImageUsage = avk::image_usage::general_texture, std::optional<std::reference_wrapper<avk::serializer>> aSerializer = {});
+	extern std::tuple<avk::image, avk::command::action_type_command> create_image_from_file_cached(const std::string& aPath, bool aLoadHdrIfPossible = true, bool aLoadSrgbIfApplicable = true, bool aFlip = true, int aPreferredNumberOfTextureComponents = 4, avk::layout::image_layout aImageLayout = avk::layout::general, avk::memory_usage aMemoryUsage = avk::memory_usage::device, avk::image_usage aImageUsage = avk::image_usage::general_texture, std::optional<std::reference_wrapper<avk::serializer>> aSerializer = {}, std::optional<std::reference_wrapper<avk::upload_batcher>> aUploadBatcher = {});
 
 	/** Create image from a single file, with caching
 	* Loads image data from a file or the serializer cache.
@@ -331,6 +373,62 @@ namespace avk
 		return create_image_from_file_cached(aPath, aLoadHdrIfPossible, aLoadSrgbIfApplicable, aFlip, aPreferredNumberOfTextureComponents, aImageLayout, aMemoryUsage, aImageUsage);
 	}
 
+	/** Write image data to a cache file, without creating any GPU resources
+	* Loads the image data, if it has not been loaded yet, and writes it in the same layout as
+	* create_image_from_image_data_cached writes it, which can read it back.
+	* @param aSerializer	a serializer in serialize mode.
+	* @param aImageData		a valid instance of image_data; it is loaded if it has not been loaded yet.
+	* @param aImageUsage	the intended image usage of the image which will be created from the cache file.
+	*/
+	extern void serialize_image_data(avk::serializer& aSerializer, image_data& aImageData, avk::image_usage aImageUsage = avk::image_usage::general_texture);
+
+	/** Read past image data in a cache file, as written by create_image_from_image_data_cached, without creating any GPU resources
+	* @param aSerializer	a serializer in deserialize mode.
+	*/
+	extern void skip_image_data(avk::serializer& aSerializer);
+
+	/** Generate the mipmaps of image data on the CPU if the image is created with a mip-mapped usage and the image data contains a single level only.
+	* Image data whose format does not allow it, e.g., block-compressed data, is left unchanged; create_image_from_image_data_cached blits its mipmaps on the GPU.
+	* @param aImageData		a valid instance of image_data which has been loaded.
+	* @param aImageUsage	the intended image usage of the image which will be created from the image data.
+	* @return true if mipmaps have been generated.
+	*/
+	extern bool generate_mip_maps_for_usage(image_data& aImageData, avk::image_usage aImageUsage);
+
+	/** Encode image data to a block-compressed format on the CPU, so that create_image_from_image_data_cached uploads and caches the compressed data
+	* Loads the image data, if it has not been loaded yet. If aImageUsage is mip-mapped, the mipmaps are generated on the CPU first, since they can
+	* not be blitted for block-compressed formats. The image data is left unchanged if it can not be encoded, see image_data::compress.
+	* @param aImageData		a valid instance of image_data; it is loaded if it has not been loaded yet.
+	* @param aImageUsage	the intended image usage of the image which will be created from the image data.
+	* @param aSettings		which block-compressed formats to prefer.
+	* @param aIsNormalMap	true if the image data is a normal map.
+	* @param aNumThreads	number of threads which generate mipmaps and encode blocks, or 0 to choose one based on the hardware.
+	* @return true if the image data has been encoded.
+	*/
+	extern bool compress_image_data_for_usage(image_data& aImageData, avk::image_usage aImageUsage, const texture_compression& aSettings, bool aIsNormalMap = false, unsigned int aNumThreads = 0);
+
+	/** Load multiple images in parallel and process them in order
+	* Worker threads load the images, and aForEachLoadedImage is invoked on the calling thread for every image in
+	* the given order, as soon as it has been loaded. While one image is processed, the following ones are loaded.
+	* The number of loaded images which have not been processed yet is limited to the number of worker threads,
+	* which bounds the memory usage. If loading an image fails, the exception is rethrown when it is its turn.
+	* @param aImageData				the images to load; images which have already been loaded are not loaded again.
+	* @param aForEachLoadedImage	invoked on the calling thread with the index of every image after it has been loaded, e.g., to create a GPU image from it.
+	* @param aNumThreads			number of worker threads, or 0 to choose one based on the hardware.
+	*/
+	extern void load_image_data_in_parallel(std::vector<image_data>& aImageData, std::function<void(size_t)> aForEachLoadedImage, unsigned int aNumThreads = 0);
+
+	/** Write multiple images to a cache file, loading them in parallel, without creating any GPU resources
+	* The images are written in the given order, each one as by serialize_image_data. While one image is
+	* written, the following ones are loaded by worker threads, see load_image_data_in_parallel.
+	* @param aSerializer		a serializer in serialize mode.
+	* @param aImageData			the images to load and write; each one is released after it has been written.
+	* @param aImageUsage		the intended image usage of the images which will be created from the cache file.
+	* @param aAfterEachImage	invoked on the calling thread with the index of an image after it has been written, e.g., to write further data belonging to it.
+	* @param aNumThreads		number of worker threads, or 0 to choose one based on the hardware.
+	*/
+	extern void serialize_image_data_in_parallel(avk::serializer& aSerializer, std::vector<image_data>& aImageData, avk::image_usage aImageUsage = avk::image_usage::general_texture, std::function<void(size_t)> aAfterEachImage = {}, unsigned int aNumThreads = 0);
+
 	template <typename... Rest>
 	void add_tuple_or_indices(std::vector<std::tuple<const avk::model_t&, std::vector<avk::mesh_index_t>>>& aResult)
 	{ }
@@ -645,6 +743,28 @@ namespace avk
 		return create_vertex_and_index_buffers<Metas...>(get_vertices_and_indices(aModelsAndSelectedMeshes), aUsageFlags);
 	}
 	
+	/**	Write vertex positions and indices to a cache file, without creating any GPU resources.
+	 *	The data is written in the same layout as create_vertex_and_index_buffers_cached writes it, which can read it back.
+	 *	@param	aSerializer					A serializer in serialize mode
+	 *	@param	aVerticesAndIndices			A tuple of vertex positions and indices
+	 */
+	static void serialize_vertices_and_indices(avk::serializer& aSerializer, std::tuple<std::vector<glm::vec3>, std::vector<uint32_t>>& aVerticesAndIndices)
+	{
+		auto& [positionsData, indicesData] = aVerticesAndIndices;
+		size_t numPositions = positionsData.size();
+		size_t totalPositionsSize = sizeof(std::remove_reference_t<decltype(positionsData)>::value_type) * numPositions;
+		size_t numIndices = indicesData.size();
+		size_t totalIndicesSize = sizeof(std::remove_reference_t<decltype(indicesData)>::value_type) * numIndices;
+
+		aSerializer.archive(numPositions);
+		aSerializer.archive(totalPositionsSize);
+		aSerializer.archive(numIndices);
+		aSerializer.archive(totalIndicesSize);
+
+		aSerializer.archive_memory(positionsData.data(), totalPositionsSize);
+		aSerializer.archive_memory(indicesData.data(), totalIndicesSize);
+	}
+
 	/**	Get a tuple of two buffers, containing vertex positions and index positions, respectively, from the given input data.
 	 *	@param	aSerializer					The serializer used to store the data to or load the data from a cache file, depending on its mode.
 	 *	@param	aVerticesAndIndices			A tuple containing vertex positions data in the first element, and index data in the second element.
@@ -667,18 +787,7 @@ namespace avk
 
 		auto& [positionsData, indicesData] = aVerticesAndIndices;
 		if (aSerializer.mode() == avk::serializer::mode::serialize) {
-			numPositions = positionsData.size();
-			totalPositionsSize = sizeof(std::remove_reference_t<decltype(positionsData)>::value_type) * numPositions;
-			numIndices = indicesData.size();
-			totalIndicesSize = sizeof(std::remove_reference_t<decltype(indicesData)>::value_type) * numIndices;
-
-			aSerializer.archive(numPositions);
-			aSerializer.archive(totalPositionsSize);
-			aSerializer.archive(numIndices);
-			aSerializer.archive(totalIndicesSize);
-
-			aSerializer.archive_memory(positionsData.data(), totalPositionsSize);
-			aSerializer.archive_memory(indicesData.data(), totalIndicesSize);
+			serialize_vertices_and_indices(aSerializer, aVerticesAndIndices);
 
 			return create_vertex_and_index_buffers<Metas...>(std::make_tuple(std::move(positionsData), std::move(indicesData)), aUsageFlags);
 		}
@@ -779,6 +888,23 @@ namespace avk
 
 	}
 
+	/** Write the given buffer data to a cache file, without creating any GPU resources.
+	 *	The data is written in the same layout as create_buffer_cached writes it, which can read it back.
+	 *	@param	aSerializer					A serializer in serialize mode
+	 *	@param	aBufferData					Data to be stored in the buffer, e.g., a std::vector
+	 */
+	template <typename T>
+	void serialize_buffer_data(avk::serializer& aSerializer, T& aBufferData)
+	{
+		size_t numBufferEntries = aBufferData.size();
+		size_t bufferTotalSize = sizeof(typename std::remove_reference_t<decltype(aBufferData)>::value_type) * numBufferEntries;
+
+		aSerializer.archive(numBufferEntries);
+		aSerializer.archive(bufferTotalSize);
+
+		aSerializer.archive_memory(aBufferData.data(), bufferTotalSize);
+	}
+
 	/** Create a device buffer that contains the given input data
 	 *	@param	aSerializer					The serializer used to store the data to or load the data from a cache file, depending on its mode.
 	 *	@param	aBufferData					Data to be stored in the buffer
@@ -797,13 +923,7 @@ namespace avk
 		size_t bufferTotalSize = 0;
 
 		if (aSerializer.mode() == avk::serializer::mode::serialize) {
-			numBufferEntries = aBufferData.size();
-			bufferTotalSize = sizeof(typename std::remove_reference_t<decltype(aBufferData)>::value_type) * numBufferEntries;
-
-			aSerializer.archive(numBufferEntries);
-			aSerializer.archive(bufferTotalSize);
-
-			aSerializer.archive_memory(aBufferData.data(), bufferTotalSize);
+			serialize_buffer_data(aSerializer, aBufferData);
 
 			return create_buffer<T, Metas...>(aBufferData, aContentDescription, aUsageFlags);
 		}
@@ -1452,31 +1572,75 @@ namespace avk
 	 */
 	avk::sampler create_sampler_cached(avk::serializer& aSerializer, avk::filter_mode aFilterMode, avk::border_handling_mode aBorderHandlingMode, float aMipMapMaxLod = VK_LOD_CLAMP_NONE, std::function<void(avk::sampler_t&)> aAlterConfigBeforeCreation = {});
 
-	/**	Convert the given material config into a format that is usable with a GPU buffer for the materials (i.e. properly vec4-aligned),
-	 *	and a set of images and samplers, which are already created on and uploaded to the GPU.
+	/**	Write the configuration of a sampler to a cache file, without creating the sampler.
+	 *	The configuration is written in the same layout as create_sampler_cached writes it, which can read it back.
+	 *	@param	aSerializer					A serializer in serialize mode
+	 *	@param	aFilterMode					Filtering strategy for the sampler
+	 *	@param	aBorderHandlingModes		Border handling strategy for the sampler for u, v, and w coordinates (in that order)
+	 *	@param	aMipMapMaxLod				Default value = house number
+	 */
+	extern void serialize_sampler(avk::serializer& aSerializer, avk::filter_mode aFilterMode, std::array<avk::border_handling_mode, 3> aBorderHandlingModes, float aMipMapMaxLod = VK_LOD_CLAMP_NONE);
+
+	/**	Write the configuration of a sampler to a cache file, without creating the sampler.
+	 *	The configuration is written in the same layout as create_sampler_cached writes it, which can read it back.
+	 *	@param	aSerializer					A serializer in serialize mode
+	 *	@param	aFilterMode					Filtering strategy for the sampler
+	 *	@param	aBorderHandlingModes		Border handling strategy for the sampler for u, and v coordinates (in that order). (The w direction will get the same strategy assigned as v)
+	 *	@param	aMipMapMaxLod				Default value = house number
+	 */
+	extern void serialize_sampler(avk::serializer& aSerializer, avk::filter_mode aFilterMode, std::array<avk::border_handling_mode, 2> aBorderHandlingModes, float aMipMapMaxLod = VK_LOD_CLAMP_NONE);
+
+	/**	Write the configuration of a sampler to a cache file, without creating the sampler.
+	 *	The configuration is written in the same layout as create_sampler_cached writes it, which can read it back.
+	 *	@param	aSerializer					A serializer in serialize mode
+	 *	@param	aFilterMode					Filtering strategy for the sampler
+	 *	@param	aBorderHandlingMode			Border handling strategy for all coordinates u, v, and w.
+	 *	@param	aMipMapMaxLod				Default value = house number
+	 */
+	extern void serialize_sampler(avk::serializer& aSerializer, avk::filter_mode aFilterMode, avk::border_handling_mode aBorderHandlingMode, float aMipMapMaxLod = VK_LOD_CLAMP_NONE);
+
+	/**	The CPU-side result of converting material configs for GPU usage, see gather_for_gpu_usage.
+	 *	The texture index members of the entries in mMaterials are still unassigned; the int pointers in the
+	 *	other members point to them and are used to assign the indices of the image samplers once they exist.
+	 *	Because of these pointers, instances can be moved, but not copied.
+	 */
+	template <typename T>
+	struct gpu_material_conversion
+	{
+		gpu_material_conversion() = default;
+		gpu_material_conversion(gpu_material_conversion&&) noexcept = default;
+		gpu_material_conversion(const gpu_material_conversion&) = delete;
+		gpu_material_conversion& operator=(gpu_material_conversion&&) noexcept = default;
+		gpu_material_conversion& operator=(const gpu_material_conversion&) = delete;
+		~gpu_material_conversion() = default;
+
+		/** The converted materials, one per material config */
+		std::vector<T> mMaterials;
+		/** Texture paths -> border handling modes -> texture index members which refer to that texture and border handling */
+		std::unordered_map<std::string, std::vector<std::tuple<std::array<avk::border_handling_mode, 2>, std::vector<int*>>>> mTextureUsages;
+		/** Texture paths which shall be loaded into an sRGB format */
+		std::set<std::string> mSrgbTextures;
+		/** Texture paths which are used as normal maps */
+		std::set<std::string> mNormalMapTextures;
+		/** Texture index members which shall refer to a 1x1 px white texture */
+		std::vector<int*> mWhiteTextureUsages;
+		/** Texture index members which shall refer to a 1x1 px texture containing a normal pointing straight up */
+		std::vector<int*> mStraightUpNormalTextureUsages;
+	};
+
+	/**	Convert the given material configs into a format that is usable with a GPU buffer for the materials, and
+	 *	gather the textures they reference, without loading any textures or creating any GPU resources.
+	 *	This is the CPU-side part of convert_for_gpu_usage_cached.
 	 *	@param	aMaterialConfigs			The material config in CPU format
-	 *	@param	aLoadTexturesInSrgb			Set to true to load the images in sRGB format if applicable
-	 *	@param	aFlipTextures				Set to true to y-flip images
-	 *	@param	aImageUsage					How this image is going to be used. Can be a combination of different avk::image_usage values
-	 *	@param	aTextureFilterMode			Texture filtering mode for all the textures. Trilinear or anisotropic filtering modes will trigger MIP-maps to be generated.
-	 *	@return	A tuple of three elements:
-	 *			<0>: A collection of structs that contains material data converted to a GPU-suitable format. Image indices refer to the indices of the second tuple element:
-	 *			<1>: A list of image samplers that were loaded from the referenced images in aMaterialConfigs, i.e. these are already actual GPU resources.
-	 *			<2>: Zero, one, or multiple commands that need to be executed to complete the operation. This can include operations like uploading image data, or creating mip maps.
+	 *	@param	aLoadTexturesInSrgb			Set to true to load the diffuse, ambient, and extra textures in sRGB format if applicable
 	 */
 	template <typename T>
-	std::tuple<std::vector<T>, std::vector<avk::image_sampler>, avk::command::action_type_command> convert_for_gpu_usage_cached(
-		const std::vector<avk::material_config>& aMaterialConfigs,
-		bool aLoadTexturesInSrgb,
-		bool aFlipTextures,
-		avk::image_usage aImageUsage,
-		avk::filter_mode aTextureFilterMode,
-		std::optional<std::reference_wrapper<avk::serializer>> aSerializer = {})
+	gpu_material_conversion<T> gather_for_gpu_usage(const std::vector<avk::material_config>& aMaterialConfigs, bool aLoadTexturesInSrgb)
 	{
-		avk::command::action_type_command commandsToReturn{};
+		gpu_material_conversion<T> conversion;
 
 		// These are the texture names loaded from file -> mapped to vector of usage-pointers
-		std::unordered_map<std::string, std::vector<std::tuple<std::array<avk::border_handling_mode, 2>, std::vector<int*>>>> texNamesToBorderHandlingToUsages;
+		auto& texNamesToBorderHandlingToUsages = conversion.mTextureUsages;
 
 		auto addTexUsage = [&texNamesToBorderHandlingToUsages](const std::string& bPath, const std::array<avk::border_handling_mode, 2>& bBhMode, int* bUsage) {
 			auto& vct = texNamesToBorderHandlingToUsages[bPath];
@@ -1491,200 +1655,347 @@ namespace avk
 		};
 
 		// Textures contained in this array shall be loaded into an sRGB format
-		std::set<std::string> srgbTextures;
+		auto& srgbTextures = conversion.mSrgbTextures;
 
 		// However, if some textures are missing, provide 1x1 px textures in those spots
-		std::vector<int*> whiteTexUsages;				// Provide a 1x1 px almost everywhere in those cases,
-		std::vector<int*> straightUpNormalTexUsages;	// except for normal maps, provide a normal pointing straight up there.
-
-		std::vector<T> result;
-		if (!aSerializer ||
-			(aSerializer && (aSerializer->get().mode() == serializer::mode::serialize))) {
-			size_t materialConfigSize = aMaterialConfigs.size();
-			result.reserve(materialConfigSize); // important because of the pointers
-
-			for (auto& mc : aMaterialConfigs) {
-				auto& newEntry = result.emplace_back();
-				if constexpr (std::is_convertible<T&, material_gpu_data&>::value) {
-					material_gpu_data& mgd = static_cast<material_gpu_data&>(newEntry);
-					mgd.mDiffuseReflectivity = mc.mDiffuseReflectivity;
-					mgd.mAmbientReflectivity = mc.mAmbientReflectivity;
-					mgd.mSpecularReflectivity = mc.mSpecularReflectivity;
-					mgd.mEmissiveColor = mc.mEmissiveColor;
-					mgd.mTransparentColor = mc.mTransparentColor;
-					mgd.mReflectiveColor = mc.mReflectiveColor;
-					mgd.mAlbedo = mc.mAlbedo;
-
-					mgd.mOpacity = mc.mOpacity;
-					mgd.mBumpScaling = mc.mBumpScaling;
-					mgd.mShininess = mc.mShininess;
-					mgd.mShininessStrength = mc.mShininessStrength;
-
-					mgd.mRefractionIndex = mc.mRefractionIndex;
-					mgd.mReflectivity = mc.mReflectivity;
-					mgd.mMetallic = mc.mMetallic;
-					mgd.mSmoothness = mc.mSmoothness;
-
-					mgd.mSheen = mc.mSheen;
-					mgd.mThickness = mc.mThickness;
-					mgd.mRoughness = mc.mRoughness;
-					mgd.mAnisotropy = mc.mAnisotropy;
-
-					mgd.mAnisotropyRotation = mc.mAnisotropyRotation;
-					mgd.mCustomData = mc.mCustomData;
-
-					mgd.mDiffuseTexIndex = -1;
-					if (mc.mDiffuseTex.empty()) {
-						whiteTexUsages.push_back(&mgd.mDiffuseTexIndex);
-					}
-					else {
-						auto path = avk::clean_up_path(mc.mDiffuseTex);
-						addTexUsage(path, mc.mDiffuseTexBorderHandlingMode, &mgd.mDiffuseTexIndex);
-						if (aLoadTexturesInSrgb) {
-							srgbTextures.insert(path);
-						}
+		auto& whiteTexUsages = conversion.mWhiteTextureUsages;					// Provide a 1x1 px almost everywhere in those cases,
+		auto& straightUpNormalTexUsages = conversion.mStraightUpNormalTextureUsages;	// except for normal maps, provide a normal pointing straight up there.
+
+		auto& result = conversion.mMaterials;
+		size_t materialConfigSize = aMaterialConfigs.size();
+		result.reserve(materialConfigSize); // important because of the pointers
+
+		for (auto& mc : aMaterialConfigs) {
+			auto& newEntry = result.emplace_back();
+			if constexpr (std::is_convertible<T&, material_gpu_data&>::value) {
+				material_gpu_data& mgd = static_cast<material_gpu_data&>(newEntry);
+				mgd.mDiffuseReflectivity = mc.mDiffuseReflectivity;
+				mgd.mAmbientReflectivity = mc.mAmbientReflectivity;
+				mgd.mSpecularReflectivity = mc.mSpecularReflectivity;
+				mgd.mEmissiveColor = mc.mEmissiveColor;
+				mgd.mTransparentColor = mc.mTransparentColor;
+				mgd.mReflectiveColor = mc.mReflectiveColor;
+				mgd.mAlbedo = mc.mAlbedo;
+
+				mgd.mOpacity = mc.mOpacity;
+				mgd.mBumpScaling = mc.mBumpScaling;
+				mgd.mShininess = mc.mShininess;
+				mgd.mShininessStrength = mc.mShininessStrength;
+
+				mgd.mRefractionIndex = mc.mRefractionIndex;
+				mgd.mReflectivity = mc.mReflectivity;
+				mgd.mMetallic = mc.mMetallic;
+				mgd.mSmoothness = mc.mSmoothness;
+
+				mgd.mSheen = mc.mSheen;
+				mgd.mThickness = mc.mThickness;
+				mgd.mRoughness = mc.mRoughness;
+				mgd.mAnisotropy = mc.mAnisotropy;
+
+				mgd.mAnisotropyRotation = mc.mAnisotropyRotation;
+				mgd.mCustomData = mc.mCustomData;
+
+				mgd.mDiffuseTexIndex = -1;
+				if (mc.mDiffuseTex.empty()) {
+					whiteTexUsages.push_back(&mgd.mDiffuseTexIndex);
+				}
+				else {
+					auto path = avk::clean_up_path(mc.mDiffuseTex);
+					addTexUsage(path, mc.mDiffuseTexBorderHandlingMode, &mgd.mDiffuseTexIndex);
+					if (aLoadTexturesInSrgb) {
+						srgbTextures.insert(path);
 					}
+				}
 
-					mgd.mSpecularTexIndex = -1;
-					if (mc.mSpecularTex.empty()) {
-						whiteTexUsages.push_back(&mgd.mSpecularTexIndex);
-					}
-					else {
-						addTexUsage(avk::clean_up_path(mc.mSpecularTex), mc.mSpecularTexBorderHandlingMode, &mgd.mSpecularTexIndex);
-					}
+				mgd.mSpecularTexIndex = -1;
+				if (mc.mSpecularTex.empty()) {
+					whiteTexUsages.push_back(&mgd.mSpecularTexIndex);
+				}
+				else {
+					addTexUsage(avk::clean_up_path(mc.mSpecularTex), mc.mSpecularTexBorderHandlingMode, &mgd.mSpecularTexIndex);
+				}
 
-					mgd.mAmbientTexIndex = -1;
-					if (mc.mAmbientTex.empty()) {
-						whiteTexUsages.push_back(&mgd.mAmbientTexIndex);
-					}
-					else {
-						auto path = avk::clean_up_path(mc.mAmbientTex);
-						addTexUsage(path, mc.mAmbientTexBorderHandlingMode, &mgd.mAmbientTexIndex);
-						if (aLoadTexturesInSrgb) {
-							srgbTextures.insert(path);
-						}
+				mgd.mAmbientTexIndex = -1;
+				if (mc.mAmbientTex.empty()) {
+					whiteTexUsages.push_back(&mgd.mAmbientTexIndex);
+				}
+				else {
+					auto path = avk::clean_up_path(mc.mAmbientTex);
+					addTexUsage(path, mc.mAmbientTexBorderHandlingMode, &mgd.mAmbientTexIndex);
+					if (aLoadTexturesInSrgb) {
+						srgbTextures.insert(path);
 					}
+				}
 
-					mgd.mEmissiveTexIndex = -1;
-					if (mc.mEmissiveTex.empty()) {
-						whiteTexUsages.push_back(&mgd.mEmissiveTexIndex);
-					}
-					else {
-						addTexUsage(avk::clean_up_path(mc.mEmissiveTex), mc.mEmissiveTexBorderHandlingMode, &mgd.mEmissiveTexIndex);
-					}
+				mgd.mEmissiveTexIndex = -1;
+				if (mc.mEmissiveTex.empty()) {
+					whiteTexUsages.push_back(&mgd.mEmissiveTexIndex);
+				}
+				else {
+					addTexUsage(avk::clean_up_path(mc.mEmissiveTex), mc.mEmissiveTexBorderHandlingMode, &mgd.mEmissiveTexIndex);
+				}
 
-					mgd.mHeightTexIndex = -1;
-					if (mc.mHeightTex.empty()) {
-						whiteTexUsages.push_back(&mgd.mHeightTexIndex);
-					}
-					else {
-						addTexUsage(avk::clean_up_path(mc.mHeightTex), mc.mHeightTexBorderHandlingMode, &mgd.mHeightTexIndex);
-					}
+				mgd.mHeightTexIndex = -1;
+				if (mc.mHeightTex.empty()) {
+					whiteTexUsages.push_back(&mgd.mHeightTexIndex);
+				}
+				else {
+					addTexUsage(avk::clean_up_path(mc.mHeightTex), mc.mHeightTexBorderHandlingMode, &mgd.mHeightTexIndex);
+				}
 
-					mgd.mNormalsTexIndex = -1;
-					if (mc.mNormalsTex.empty()) {
-						straightUpNormalTexUsages.push_back(&mgd.mNormalsTexIndex);
-					}
-					else {
-						addTexUsage(avk::clean_up_path(mc.mNormalsTex), mc.mNormalsTexBorderHandlingMode, &mgd.mNormalsTexIndex);
-					}
+				mgd.mNormalsTexIndex = -1;
+				if (mc.mNormalsTex.empty()) {
+					straightUpNormalTexUsages.push_back(&mgd.mNormalsTexIndex);
+				}
+				else {
+					auto path = avk::clean_up_path(mc.mNormalsTex);
+					addTexUsage(path, mc.mNormalsTexBorderHandlingMode, &mgd.mNormalsTexIndex);
+					conversion.mNormalMapTextures.insert(path);
+				}
 
-					mgd.mShininessTexIndex = -1;
-					if (mc.mShininessTex.empty()) {
-						whiteTexUsages.push_back(&mgd.mShininessTexIndex);
-					}
-					else {
-						addTexUsage(avk::clean_up_path(mc.mShininessTex), mc.mShininessTexBorderHandlingMode, &mgd.mShininessTexIndex);
-					}
+				mgd.mShininessTexIndex = -1;
+				if (mc.mShininessTex.empty()) {
+					whiteTexUsages.push_back(&mgd.mShininessTexIndex);
+				}
+				else {
+					addTexUsage(avk::clean_up_path(mc.mShininessTex), mc.mShininessTexBorderHandlingMode, &mgd.mShininessTexIndex);
+				}
 
-					mgd.mOpacityTexIndex = -1;
-					if (mc.mOpacityTex.empty()) {
-						whiteTexUsages.push_back(&mgd.mOpacityTexIndex);
-					}
-					else {
-						addTexUsage(avk::clean_up_path(mc.mOpacityTex), mc.mOpacityTexBorderHandlingMode, &mgd.mOpacityTexIndex);
-					}
+				mgd.mOpacityTexIndex = -1;
+				if (mc.mOpacityTex.empty()) {
+					whiteTexUsages.push_back(&mgd.mOpacityTexIndex);
+				}
+				else {
+					addTexUsage(avk::clean_up_path(mc.mOpacityTex), mc.mOpacityTexBorderHandlingMode, &mgd.mOpacityTexIndex);
+				}
 
-					mgd.mDisplacementTexIndex = -1;
-					if (mc.mDisplacementTex.empty()) {
-						whiteTexUsages.push_back(&mgd.mDisplacementTexIndex);
-					}
-					else {
-						addTexUsage(avk::clean_up_path(mc.mDisplacementTex), mc.mDisplacementTexBorderHandlingMode, &mgd.mDisplacementTexIndex);
-					}
+				mgd.mDisplacementTexIndex = -1;
+				if (mc.mDisplacementTex.empty()) {
+					whiteTexUsages.push_back(&mgd.mDisplacementTexIndex);
+				}
+				else {
+					addTexUsage(avk::clean_up_path(mc.mDisplacementTex), mc.mDisplacementTexBorderHandlingMode, &mgd.mDisplacementTexIndex);
+				}
 
-					mgd.mReflectionTexIndex = -1;
-					if (mc.mReflectionTex.empty()) {
-						whiteTexUsages.push_back(&mgd.mReflectionTexIndex);
-					}
-					else {
-						addTexUsage(avk::clean_up_path(mc.mReflectionTex), mc.mReflectionTexBorderHandlingMode, &mgd.mReflectionTexIndex);
-					}
+				mgd.mReflectionTexIndex = -1;
+				if (mc.mReflectionTex.empty()) {
+					whiteTexUsages.push_back(&mgd.mReflectionTexIndex);
+				}
+				else {
+					addTexUsage(avk::clean_up_path(mc.mReflectionTex), mc.mReflectionTexBorderHandlingMode, &mgd.mReflectionTexIndex);
+				}
 
-					mgd.mLightmapTexIndex = -1;
-					if (mc.mLightmapTex.empty()) {
-						whiteTexUsages.push_back(&mgd.mLightmapTexIndex);
-					}
-					else {
-						addTexUsage(avk::clean_up_path(mc.mLightmapTex), mc.mLightmapTexBorderHandlingMode, &mgd.mLightmapTexIndex);
-					}
+				mgd.mLightmapTexIndex = -1;
+				if (mc.mLightmapTex.empty()) {
+					whiteTexUsages.push_back(&mgd.mLightmapTexIndex);
+				}
+				else {
+					addTexUsage(avk::clean_up_path(mc.mLightmapTex), mc.mLightmapTexBorderHandlingMode, &mgd.mLightmapTexIndex);
+				}
 
-					mgd.mExtraTexIndex = -1;
-					if (mc.mExtraTex.empty()) {
-						whiteTexUsages.push_back(&mgd.mExtraTexIndex);
-					}
-					else {
-						auto path = avk::clean_up_path(mc.mExtraTex);
-						addTexUsage(path, mc.mExtraTexBorderHandlingMode, &mgd.mExtraTexIndex);
-						if (aLoadTexturesInSrgb) {
-							srgbTextures.insert(path);
-						}
+				mgd.mExtraTexIndex = -1;
+				if (mc.mExtraTex.empty()) {
+					whiteTexUsages.push_back(&mgd.mExtraTexIndex);
+				}
+				else {
+					auto path = avk::clean_up_path(mc.mExtraTex);
+					addTexUsage(path, mc.mExtraTexBorderHandlingMode, &mgd.mExtraTexIndex);
+					if (aLoadTexturesInSrgb) {
+						srgbTextures.insert(path);
 					}
-
-					mgd.mDiffuseTexOffsetTiling			= mc.mDiffuseTexOffsetTiling;
-					mgd.mSpecularTexOffsetTiling		= mc.mSpecularTexOffsetTiling;
-					mgd.mAmbientTexOffsetTiling			= mc.mAmbientTexOffsetTiling;
-					mgd.mEmissiveTexOffsetTiling		= mc.mEmissiveTexOffsetTiling;
-					mgd.mHeightTexOffsetTiling			= mc.mHeightTexOffsetTiling;
-					mgd.mNormalsTexOffsetTiling			= mc.mNormalsTexOffsetTiling;
-					mgd.mShininessTexOffsetTiling		= mc.mShininessTexOffsetTiling;
-					mgd.mOpacityTexOffsetTiling			= mc.mOpacityTexOffsetTiling;
-					mgd.mDisplacementTexOffsetTiling	= mc.mDisplacementTexOffsetTiling;
-					mgd.mReflectionTexOffsetTiling		= mc.mReflectionTexOffsetTiling;
-					mgd.mLightmapTexOffsetTiling		= mc.mLightmapTexOffsetTiling;
-					mgd.mExtraTexOffsetTiling			= mc.mExtraTexOffsetTiling;
 				}
-				if constexpr (std::is_convertible<T&, material_gpu_data_ext&>::value) {
-					material_gpu_data_ext& ext = static_cast<material_gpu_data_ext&>(newEntry);
-
-					ext.mDiffuseTexUvSet				= mc.mDiffuseTexUvSet;
-					ext.mSpecularTexUvSet				= mc.mSpecularTexUvSet;
-					ext.mAmbientTexUvSet				= mc.mAmbientTexUvSet;
-					ext.mEmissiveTexUvSet				= mc.mEmissiveTexUvSet;
-					ext.mHeightTexUvSet					= mc.mHeightTexUvSet;
-					ext.mNormalsTexUvSet				= mc.mNormalsTexUvSet;
-					ext.mShininessTexUvSet				= mc.mShininessTexUvSet;
-					ext.mOpacityTexUvSet				= mc.mOpacityTexUvSet;
-					ext.mDisplacementTexUvSet			= mc.mDisplacementTexUvSet;
-					ext.mReflectionTexUvSet				= mc.mReflectionTexUvSet;
-					ext.mLightmapTexUvSet				= mc.mLightmapTexUvSet;
-					ext.mExtraTexUvSet					= mc.mExtraTexUvSet;
-
-					ext.mDiffuseTexRotation				= mc.mDiffuseTexRotation;
-					ext.mSpecularTexRotation			= mc.mSpecularTexRotation;
-					ext.mAmbientTexRotation				= mc.mAmbientTexRotation;
-					ext.mEmissiveTexRotation			= mc.mEmissiveTexRotation;
-					ext.mHeightTexRotation				= mc.mHeightTexRotation;
-					ext.mNormalsTexRotation				= mc.mNormalsTexRotation;
-					ext.mShininessTexRotation			= mc.mShininessTexRotation;
-					ext.mOpacityTexRotation				= mc.mOpacityTexRotation;
-					ext.mDisplacementTexRotation		= mc.mDisplacementTexRotation;
-					ext.mReflectionTexRotation			= mc.mReflectionTexRotation;
-					ext.mLightmapTexRotation			= mc.mLightmapTexRotation;
-					ext.mExtraTexRotation				= mc.mExtraTexRotation;
+
+				mgd.mDiffuseTexOffsetTiling			= mc.mDiffuseTexOffsetTiling;
+				mgd.mSpecularTexOffsetTiling		= mc.mSpecularTexOffsetTiling;
+				mgd.mAmbientTexOffsetTiling			= mc.mAmbientTexOffsetTiling;
+				mgd.mEmissiveTexOffsetTiling		= mc.mEmissiveTexOffsetTiling;
+				mgd.mHeightTexOffsetTiling			= mc.mHeightTexOffsetTiling;
+				mgd.mNormalsTexOffsetTiling			= mc.mNormalsTexOffsetTiling;
+				mgd.mShininessTexOffsetTiling		= mc.mShininessTexOffsetTiling;
+				mgd.mOpacityTexOffsetTiling			= mc.mOpacityTexOffsetTiling;
+				mgd.mDisplacementTexOffsetTiling	= mc.mDisplacementTexOffsetTiling;
+				mgd.mReflectionTexOffsetTiling		= mc.mReflectionTexOffsetTiling;
+				mgd.mLightmapTexOffsetTiling		= mc.mLightmapTexOffsetTiling;
+				mgd.mExtraTexOffsetTiling			= mc.mExtraTexOffsetTiling;
+			}
+			if constexpr (std::is_convertible<T&, material_gpu_data_ext&>::value) {
+				material_gpu_data_ext& ext = static_cast<material_gpu_data_ext&>(newEntry);
+
+				ext.mDiffuseTexUvSet				= mc.mDiffuseTexUvSet;
+				ext.mSpecularTexUvSet				= mc.mSpecularTexUvSet;
+				ext.mAmbientTexUvSet				= mc.mAmbientTexUvSet;
+				ext.mEmissiveTexUvSet				= mc.mEmissiveTexUvSet;
+				ext.mHeightTexUvSet					= mc.mHeightTexUvSet;
+				ext.mNormalsTexUvSet				= mc.mNormalsTexUvSet;
+				ext.mShininessTexUvSet				= mc.mShininessTexUvSet;
+				ext.mOpacityTexUvSet				= mc.mOpacityTexUvSet;
+				ext.mDisplacementTexUvSet			= mc.mDisplacementTexUvSet;
+				ext.mReflectionTexUvSet				= mc.mReflectionTexUvSet;
+				ext.mLightmapTexUvSet				= mc.mLightmapTexUvSet;
+				ext.mExtraTexUvSet					= mc.mExtraTexUvSet;
+
+				ext.mDiffuseTexRotation				= mc.mDiffuseTexRotation;
+				ext.mSpecularTexRotation			= mc.mSpecularTexRotation;
+				ext.mAmbientTexRotation				= mc.mAmbientTexRotation;
+				ext.mEmissiveTexRotation			= mc.mEmissiveTexRotation;
+				ext.mHeightTexRotation				= mc.mHeightTexRotation;
+				ext.mNormalsTexRotation				= mc.mNormalsTexRotation;
+				ext.mShininessTexRotation			= mc.mShininessTexRotation;
+				ext.mOpacityTexRotation				= mc.mOpacityTexRotation;
+				ext.mDisplacementTexRotation		= mc.mDisplacementTexRotation;
+				ext.mReflectionTexRotation			= mc.mReflectionTexRotation;
+				ext.mLightmapTexRotation			= mc.mLightmapTexRotation;
+				ext.mExtraTexRotation				= mc.mExtraTexRotation;
+			}
+		}
+
+		return conversion;
+	}
+
+	/**	Write the materials and textures of the given material configs to a cache file in the same layout as
+	 *	convert_for_gpu_usage_cached writes them, but without creating any GPU resources. The cache file can be
+	 *	read by convert_for_gpu_usage_cached, given the same aImageUsage and aTextureFilterMode.
+	 *	The textures are loaded in parallel, see load_image_data_in_parallel.
+	 *	@param	aSerializer					A serializer in serialize mode
+	 *	@param	aMaterialConfigs			The material config in CPU format
+	 *	@param	aLoadTexturesInSrgb			Set to true to load the images in sRGB format if applicable
+	 *	@param	aFlipTextures				Set to true to y-flip images
+	 *	@param	aImageUsage					How the images are going to be used. Can be a combination of different avk::image_usage values
+	 *	@param	aTextureFilterMode			Texture filtering mode for all the textures.
+	 *	@param	aNumThreads					Number of threads which load textures, or 0 to choose one based on the hardware.
+	 *	@param	aTextureCompression			If set, textures are block-compressed on the CPU before they are written, see compress_image_data_for_usage.
+	 *	@return	The materials converted to a GPU-suitable format, as they have been written to the cache file.
+	 */
+	template <typename T>
+	std::vector<T> serialize_for_gpu_usage(
+		avk::serializer& aSerializer,
+		const std::vector<avk::material_config>& aMaterialConfigs,
+		bool aLoadTexturesInSrgb = false,
+		bool aFlipTextures = false,
+		avk::image_usage aImageUsage = avk::image_usage::general_texture,
+		avk::filter_mode aTextureFilterMode = avk::filter_mode::trilinear,
+		unsigned int aNumThreads = 0,
+		std::optional<avk::texture_compression> aTextureCompression = {})
+	{
+		auto conversion = gather_for_gpu_usage<T>(aMaterialConfigs, aLoadTexturesInSrgb);
+
+		size_t numWhiteTexUsages = conversion.mWhiteTextureUsages.empty() ? 0 : 1;
+		size_t numStraightUpNormalTexUsages = conversion.mStraightUpNormalTextureUsages.empty() ? 0 : 1;
+		size_t numTexNamesToBorderHandlingToUsages = conversion.mTextureUsages.size();
+		auto numImageViews = numTexNamesToBorderHandlingToUsages + numWhiteTexUsages + numStraightUpNormalTexUsages;
+
+		aSerializer.archive(numWhiteTexUsages);
+		aSerializer.archive(numStraightUpNormalTexUsages);
+		aSerializer.archive(numImageViews);
+		aSerializer.archive(numTexNamesToBorderHandlingToUsages);
+
+		// Indices of the image samplers which convert_for_gpu_usage_cached will create when reading the cache file:
+		int numImageSamplers = 0;
+
+		if (numWhiteTexUsages > 0) {
+			serialize_1px_texture(aSerializer, { 255, 255, 255, 255 });
+			serialize_sampler(aSerializer, avk::filter_mode::nearest_neighbor, avk::border_handling_mode::repeat);
+			for (auto* img : conversion.mWhiteTextureUsages) {
+				*img = numImageSamplers;
+			}
+			++numImageSamplers;
+		}
+
+		if (numStraightUpNormalTexUsages > 0) {
+			serialize_1px_texture(aSerializer, { 127, 127, 255, 0 });
+			serialize_sampler(aSerializer, avk::filter_mode::nearest_neighbor, avk::border_handling_mode::repeat);
+			for (auto* img : conversion.mStraightUpNormalTextureUsages) {
+				*img = numImageSamplers;
+			}
+			++numImageSamplers;
+		}
+
+		// Load the images in parallel, but write them and their samplers in the order of mTextureUsages:
+		std::vector<typename decltype(conversion.mTextureUsages)::value_type*> textures;
+		std::vector<image_data> images;
+		textures.reserve(numTexNamesToBorderHandlingToUsages);
+		images.reserve(numTexNamesToBorderHandlingToUsages);
+		for (auto& pair : conversion.mTextureUsages) {
+			assert(!pair.first.empty());
+			textures.push_back(&pair);
+			images.push_back(get_image_data(pair.first, true, conversion.mSrgbTextures.contains(pair.first), aFlipTextures, 4));
+		}
+
+		load_image_data_in_parallel(images, [&](size_t aIndex) {
+			// Same as in convert_for_gpu_usage_cached, the key is computed from the compressed data:
+			if (aTextureCompression) {
+				compress_image_data_for_usage(images[aIndex], aImageUsage, *aTextureCompression, conversion.mNormalMapTextures.contains(textures[aIndex]->first), aNumThreads);
+			}
+
+			// The key precedes the image, so that convert_for_gpu_usage_cached can share identical images, see texture_registry:
+			auto key = make_texture_key(images[aIndex], aImageUsage);
+			archive_texture_key(aSerializer, key);
+			serialize_image_data(aSerializer, images[aIndex], aImageUsage);
+			{
+				// Release the image's memory:
+				auto written = std::move(images[aIndex]);
+			}
+
+			auto& bhModesToUsages = textures[aIndex]->second;
+			assert(!bhModesToUsages.empty());
+			auto numDifferentSamplers = static_cast<int>(bhModesToUsages.size());
+			aSerializer.archive(numDifferentSamplers);
+			for (auto& [bhModes, usages] : bhModesToUsages) {
+				serialize_sampler(aSerializer, aTextureFilterMode, bhModes);
+				for (auto* img : usages) {
+					*img = numImageSamplers;
 				}
+				++numImageSamplers;
 			}
+		}, aNumThreads);
+
+		aSerializer.archive(conversion.mMaterials);
+		return std::move(conversion.mMaterials);
+	}
+
+	/**	Convert the given material config into a format that is usable with a GPU buffer for the materials (i.e. properly vec4-aligned),
+	 *	and a set of images and samplers, which are already created on and uploaded to the GPU.
+	 *	The textures are decoded in parallel, while the images, views, and samplers are created on the calling thread in a deterministic order.
+	 *	@param	aMaterialConfigs			The material config in CPU format
+	 *	@param	aLoadTexturesInSrgb			Set to true to load the images in sRGB format if applicable
+	 *	@param	aFlipTextures				Set to true to y-flip images
+	 *	@param	aImageUsage					How this image is going to be used. Can be a combination of different avk::image_usage values
+	 *	@param	aTextureFilterMode			Texture filtering mode for all the textures. Trilinear or anisotropic filtering modes will trigger MIP-maps to be generated.
+	 *	@param	aNumThreads					Number of threads which decode textures, or 0 to choose one based on the hardware, see load_image_data_in_parallel.
+	 *	@param	aTextureRegistry			Registry which shares identical textures across invocations, see texture_registry. Identical textures of one invocation are always shared.
+	 *	@param	aTextureCompression			If set, textures are block-compressed on the CPU before they are uploaded and cached, see compress_image_data_for_usage.
+	 *	@param	aUploadBatcher				If set, the textures are uploaded by the batcher, see create_image_from_image_data_cached. It is flushed before this function returns,
+	 *										hence, the returned commands can be submitted to the batcher's queue.
+	 *	@return	A tuple of three elements:
+	 *			<0>: A collection of structs that contains material data converted to a GPU-suitable format. Image indices refer to the indices of the second tuple element:
+	 *			<1>: A list of image samplers that were loaded from the referenced images in aMaterialConfigs, i.e. these are already actual GPU resources.
+	 *			<2>: Zero, one, or multiple commands that need to be executed to complete the operation. This can include operations like uploading image data, or creating mip maps.
+	 */
+	template <typename T>
+	std::tuple<std::vector<T>, std::vector<avk::image_sampler>, avk::command::action_type_command> convert_for_gpu_usage_cached(
+		const std::vector<avk::material_config>& aMaterialConfigs,
+		bool aLoadTexturesInSrgb,
+		bool aFlipTextures,
+		avk::image_usage aImageUsage,
+		avk::filter_mode aTextureFilterMode,
+		std::optional<std::reference_wrapper<avk::serializer>> aSerializer = {},
+		unsigned int aNumThreads = 0,
+		std::optional<std::reference_wrapper<avk::texture_registry>> aTextureRegistry = {},
+		std::optional<avk::texture_compression> aTextureCompression = {},
+		std::optional<std::reference_wrapper<avk::upload_batcher>> aUploadBatcher = {})
+	{
+		avk::command::action_type_command commandsToReturn{};
+
+		gpu_material_conversion<T> conversion;
+		if (!aSerializer ||
+			(aSerializer && (aSerializer->get().mode() == serializer::mode::serialize))) {
+			conversion = gather_for_gpu_usage<T>(aMaterialConfigs, aLoadTexturesInSrgb);
 		}
+		auto& result = conversion.mMaterials;
+		auto& texNamesToBorderHandlingToUsages = conversion.mTextureUsages;
+		auto& srgbTextures = conversion.mSrgbTextures;
+		auto& whiteTexUsages = conversion.mWhiteTextureUsages;
+		auto& straightUpNormalTexUsages = conversion.mStraightUpNormalTextureUsages;
 
 		size_t numTexUsages = 0;
 		for (const auto& entry : texNamesToBorderHandlingToUsages) {
@@ -1707,11 +2018,50 @@ namespace avk
 		std::vector<avk::image_sampler> imageSamplers;
 		imageSamplers.reserve(numSamplers);
 
+		// Identical textures share one image view within this invocation, and via aTextureRegistry also across invocations:
+		std::unordered_map<avk::texture_key, avk::image_view> sharedImageViews;
+		auto findSharedImageView = [&](const avk::texture_key& bKey) -> std::optional<avk::image_view> {
+			if (auto it = sharedImageViews.find(bKey); sharedImageViews.end() != it) {
+				return it->second;
+			}
+			if (aTextureRegistry) {
+				if (auto imgView = aTextureRegistry->get().acquire(bKey)) {
+					sharedImageViews.emplace(bKey, imgView.value());
+					return imgView;
+				}
+			}
+			return {};
+		};
+		auto shareImageView = [&](const avk::texture_key& bKey, avk::image_view bImageView) -> avk::image_view {
+			if (aTextureRegistry) {
+				bImageView = aTextureRegistry->get().add(bKey, std::move(bImageView));
+			}
+			else {
+				bImageView.enable_shared_ownership();
+			}
+			sharedImageViews.emplace(bKey, bImageView);
+			return bImageView;
+		};
+		auto getOrCreate1pxTexture = [&](std::array<uint8_t, 4> bColor) -> avk::image_view {
+			auto key = make_texture_key(bColor, vk::Format::eR8G8B8A8Unorm, aImageUsage);
+			if (auto imgView = findSharedImageView(key)) {
+				// The data must be written to or read from the cache file nevertheless:
+				if (aSerializer && aSerializer->get().mode() == serializer::mode::serialize) {
+					serialize_1px_texture(aSerializer->get(), bColor);
+				}
+				else if (aSerializer) {
+					skip_1px_texture(aSerializer->get());
+				}
+				return imgView.value();
+			}
+			auto [tex, cmds] = create_1px_texture_cached(bColor, avk::layout::shader_read_only_optimal, vk::Format::eR8G8B8A8Unorm, avk::memory_usage::device, aImageUsage, aSerializer);
+			commandsToReturn.mNestedCommandsAndSyncInstructions.push_back(std::move(cmds));
+			return shareImageView(key, context().create_image_view(std::move(tex)));
+		};
+
 		// Create the white texture and assign its index to all usages
 		if (numWhiteTexUsages > 0) {
-			auto [tex, cmds] = create_1px_texture_cached({ 255, 255, 255, 255 }, avk::layout::shader_read_only_optimal, vk::Format::eR8G8B8A8Unorm, avk::memory_usage::device, aImageUsage, aSerializer);
-			commandsToReturn.mNestedCommandsAndSyncInstructions.push_back(std::move(cmds));
-			auto imgView = context().create_image_view(std::move(tex));
+			auto imgView = getOrCreate1pxTexture({ 255, 255, 255, 255 });
 			avk::sampler smplr;
 			if (aSerializer)
 			{
@@ -1735,9 +2085,7 @@ namespace avk
 
 		// Create the normal texture, containing a normal pointing straight up, and assign to all usages
 		if (numStraightUpNormalTexUsages > 0) {
-			auto [tex, cmds] = create_1px_texture_cached({ 127, 127, 255, 0 }, avk::layout::shader_read_only_optimal, vk::Format::eR8G8B8A8Unorm, avk::memory_usage::device, aImageUsage, aSerializer);
-			commandsToReturn.mNestedCommandsAndSyncInstructions.push_back(std::move(cmds));
-			auto imgView = context().create_image_view(std::move(tex));
+			auto imgView = getOrCreate1pxTexture({ 127, 127, 255, 0 });
 			avk::sampler smplr;
 			if (aSerializer)
 			{
@@ -1762,16 +2110,52 @@ namespace avk
 		// Load all the images from file, and assign them to all usages
 		if (!aSerializer ||
 			(aSerializer && (aSerializer->get().mode() == serializer::mode::serialize))) {
+			// Decode the images in parallel, but create them, their views, and their samplers in the order of texNamesToBorderHandlingToUsages:
+			std::vector<typename decltype(conversion.mTextureUsages)::value_type*> textures;
+			std::vector<image_data> images;
+			textures.reserve(numTexNamesToBorderHandlingToUsages);
+			images.reserve(numTexNamesToBorderHandlingToUsages);
 			for (auto& pair : texNamesToBorderHandlingToUsages) {
 				assert(!pair.first.empty());
 
 				bool potentiallySrgb = srgbTextures.contains(pair.first);
+				textures.push_back(&pair);
+				images.push_back(get_image_data(pair.first, true, potentiallySrgb, aFlipTextures, 4));
+			}
+
+			load_image_data_in_parallel(images, [&](size_t aIndex) {
+				auto& pair = *textures[aIndex];
+
+				// Compress before computing the key, so that identical textures are only shared if they have been compressed to the same format:
+				if (aTextureCompression) {
+					compress_image_data_for_usage(images[aIndex], aImageUsage, *aTextureCompression, conversion.mNormalMapTextures.contains(pair.first), aNumThreads);
+				}
 
-				// create_image_from_file_cached takes the serializer as an optional,
-				// therefore the call is safe with and without one
-				auto [tex, cmds] = create_image_from_file_cached(pair.first, true, potentiallySrgb, aFlipTextures, 4, avk::layout::shader_read_only_optimal, avk::memory_usage::device, aImageUsage, aSerializer);
-				commandsToReturn.mNestedCommandsAndSyncInstructions.push_back(std::move(cmds));
-				auto imgView = context().create_image_view(std::move(tex));
+				// The key precedes the image in the cache file, so that identical images can be shared when reading it:
+				auto key = make_texture_key(images[aIndex], aImageUsage);
+				if (aSerializer) {
+					archive_texture_key(aSerializer->get(), key);
+				}
+
+				avk::image_view imgView;
+				if (auto sharedImgView = findSharedImageView(key)) {
+					imgView = std::move(sharedImgView.value());
+					// An identical image exists already, but the data must be written to the cache file nevertheless:
+					if (aSerializer) {
+						serialize_image_data(aSerializer->get(), images[aIndex], aImageUsage);
+					}
+				}
+				else {
+					// create_image_from_image_data_cached takes the serializer as an optional,
+					// therefore the call is safe with and without one
+					auto [tex, cmds] = create_image_from_image_data_cached(images[aIndex], avk::layout::shader_read_only_optimal, avk::memory_usage::device, aImageUsage, aSerializer, aUploadBatcher);
+					commandsToReturn.mNestedCommandsAndSyncInstructions.push_back(std::move(cmds));
+					imgView = shareImageView(key, context().create_image_view(std::move(tex)));
+				}
+				{
+					// Release the image's memory, its data has been copied to a staging buffer:
+					auto uploaded = std::move(images[aIndex]);
+				}
 				assert(!pair.second.empty());
 
 				// It is now possible that an image can be referenced from different samplers, which adds support for different
@@ -1810,7 +2194,7 @@ namespace avk
 						*img = index;
 					}
 				}
-			}
+			}, aNumThreads);
 		}
 		else {
 			// We sure have the serializer here
@@ -1821,10 +2205,21 @@ namespace avk
 				const bool potentiallySrgbDontCare = false;
 				const std::string pathDontCare = "";
 
-				// Read an image from cache
-				auto [tex, cmds] = create_image_from_file_cached(pathDontCare, true, potentiallySrgbDontCare, aFlipTextures, 4, avk::layout::shader_read_only_optimal, avk::memory_usage::device, aImageUsage, aSerializer);
-				commandsToReturn.mNestedCommandsAndSyncInstructions.push_back(std::move(cmds));
-				auto imgView = context().create_image_view(std::move(tex));
+				// Read the key, and the image from cache unless an identical one exists already
+				avk::texture_key key;
+				archive_texture_key(aSerializer->get(), key);
+				key.mImageUsage = aImageUsage;
+
+				avk::image_view imgView;
+				if (auto sharedImgView = findSharedImageView(key)) {
+					imgView = std::move(sharedImgView.value());
+					skip_image_data(aSerializer->get());
+				}
+				else {
+					auto [tex, cmds] = create_image_from_file_cached(pathDontCare, true, potentiallySrgbDontCare, aFlipTextures, 4, avk::layout::shader_read_only_optimal, avk::memory_usage::device, aImageUsage, aSerializer, aUploadBatcher);
+					commandsToReturn.mNestedCommandsAndSyncInstructions.push_back(std::move(cmds));
+					imgView = shareImageView(key, context().create_image_view(std::move(tex)));
+				}
 
 				// Read the number of samplers from cache
 				int numDifferentSamplers;
@@ -1856,10 +2251,66 @@ namespace avk
 			aSerializer->get().archive(result);
 		}
 
+		// Submit the remaining copies, s.t. the returned commands, e.g., mip map blits, are executed after them:
+		if (aUploadBatcher) {
+			aUploadBatcher->get().flush();
+		}
+
 		// Hand over ownership to the caller
 		return std::make_tuple(std::move(result), std::move(imageSamplers), std::move(commandsToReturn));
 	}
 
+	/**	Specialization of convert_for_gpu_usage_cached for material_gpu_data_compact, which is also used by all other overloads of
+	 *	convert_for_gpu_usage_cached and convert_for_gpu_usage: the materials are converted to material_gpu_data, which is written to and
+	 *	read from the cache file, i.e., the cache file has the same layout as for material_gpu_data, and compacted afterwards, see
+	 *	compact_material_gpu_data. The texture slots which have been set in the material configs are stored after the materials.
+	 */
+	template <>
+	inline std::tuple<std::vector<material_gpu_data_compact>, std::vector<avk::image_sampler>, avk::command::action_type_command> convert_for_gpu_usage_cached<material_gpu_data_compact>(
+		const std::vector<avk::material_config>& aMaterialConfigs,
+		bool aLoadTexturesInSrgb,
+		bool aFlipTextures,
+		avk::image_usage aImageUsage,
+		avk::filter_mode aTextureFilterMode,
+		std::optional<std::reference_wrapper<avk::serializer>> aSerializer,
+		unsigned int aNumThreads,
+		std::optional<std::reference_wrapper<avk::texture_registry>> aTextureRegistry,
+		std::optional<avk::texture_compression> aTextureCompression,
+		std::optional<std::reference_wrapper<avk::upload_batcher>> aUploadBatcher)
+	{
+		auto [materials, imageSamplers, commands] = convert_for_gpu_usage_cached<material_gpu_data>(
+			aMaterialConfigs,
+			aLoadTexturesInSrgb,
+			aFlipTextures,
+			aImageUsage,
+			aTextureFilterMode,
+			aSerializer,
+			aNumThreads,
+			aTextureRegistry,
+			aTextureCompression,
+			aUploadBatcher);
+
+		// The texture slots which have been set can not be told from material_gpu_data, since all of them have valid texture
+		// indices, hence they are stored after the materials, s.t. materials read from a cache file are compacted identically:
+		std::vector<uint32_t> presentTextures;
+		if (!aSerializer || aSerializer->get().mode() == serializer::mode::serialize) {
+			presentTextures.reserve(aMaterialConfigs.size());
+			for (const auto& mc : aMaterialConfigs) {
+				presentTextures.push_back(present_texture_slots(mc));
+			}
+		}
+		if (aSerializer) {
+			aSerializer->get().archive(presentTextures);
+		}
+
+		std::vector<material_gpu_data_compact> result;
+		result.reserve(materials.size());
+		for (size_t i = 0; i < materials.size(); ++i) {
+			result.push_back(compact_material_gpu_data(materials[i], presentTextures[i]));
+		}
+		return std::make_tuple(std::move(result), std::move(imageSamplers), std::move(commands));
+	}
+
 	
 	/**	Convert the given material config into a format that is usable with a GPU buffer for the materials (i.e. properly vec4-aligned),
 	 *	and a set of images and samplers, which are already created on and uploaded to the GPU.
@@ -1869,6 +2320,11 @@ namespace avk
 	 *	@param	aFlipTextures				Set to true to y-flip images			
 	 *	@param	aImageUsage					How this image is going to be used. Can be a combination of different avk::image_usage values
 	 *	@param	aTextureFilterMode			Texture filtering mode for all the textures. Trilinear or anisotropic filtering modes will trigger MIP-maps to be generated.
+	 *	@param	aNumThreads					Number of threads which decode textures, or 0 to choose one based on the hardware, see load_image_data_in_parallel.
+	 *	@param	aTextureRegistry			Registry which shares identical textures across invocations, see texture_registry. Identical textures of one invocation are always shared.
+	 *	@param	aTextureCompression			If set, textures are block-compressed on the CPU before they are uploaded and cached, see compress_image_data_for_usage.
+	 *	@param	aUploadBatcher				If set, the textures are uploaded by the batcher, see create_image_from_image_data_cached. It is flushed before this function returns,
+	 *										hence, the returned commands can be submitted to the batcher's queue.
 	 *	@return	A tuple of three elements:
 	 *			<0>: A collection of structs that contains material data converted to a GPU-suitable format. Image indices refer to the indices of the second tuple element:
 	 *			<1>: A list of image samplers that were loaded from the referenced images in aMaterialConfigs, i.e. these are already actual GPU resources.
@@ -1881,7 +2337,11 @@ namespace avk
 		bool aLoadTexturesInSrgb = false,
 		bool aFlipTextures = false,
 		avk::image_usage aImageUsage = avk::image_usage::general_texture,
-		avk::filter_mode aTextureFilterMode = avk::filter_mode::trilinear)
+		avk::filter_mode aTextureFilterMode = avk::filter_mode::trilinear,
+		unsigned int aNumThreads = 0,
+		std::optional<std::reference_wrapper<avk::texture_registry>> aTextureRegistry = {},
+		std::optional<avk::texture_compression> aTextureCompression = {},
+		std::optional<std::reference_wrapper<avk::upload_batcher>> aUploadBatcher = {})
 	{
 		return convert_for_gpu_usage_cached<T>(
 			aMaterialConfigs,
@@ -1889,7 +2349,11 @@ namespace avk
 			aFlipTextures,
 			aImageUsage,
 			aTextureFilterMode,
-			aSerializer);
+			aSerializer,
+			aNumThreads,
+			aTextureRegistry,
+			aTextureCompression,
+			aUploadBatcher);
 	}
 
 	/**	Takes a vector of avk::material_config elements and converts it into a format that is usable
@@ -1926,6 +2390,7 @@ namespace avk
 	 *	@param	aImageUsage				Image usage for all the textures that are loaded.
 	 *	@param	aTextureFilterMode		Texture filter mode for all the textures that are loaded.
 	 *	@param	aBorderHandlingMode		Border handling mode for all the textures that are loaded.
+	 *	@param	aTextureRegistry		Registry which shares identical textures with other models, see texture_registry.
 	 *	@return	A tuple of three elements:
 	 *			<0>: A collection of structs that contains material data converted to a GPU-suitable format. Image indices refer to the indices of the second tuple element:
 	 *			<1>: A list of image samplers that were loaded from the referenced images in aMaterialConfigs, i.e. these are already actual GPU resources.
@@ -1937,13 +2402,214 @@ namespace avk
 		bool aLoadTexturesInSrgb = false,
 		bool aFlipTextures = false,
 		avk::image_usage aImageUsage = avk::image_usage::general_texture,
-		avk::filter_mode aTextureFilterMode = avk::filter_mode::trilinear)
+		avk::filter_mode aTextureFilterMode = avk::filter_mode::trilinear,
+		std::optional<std::reference_wrapper<avk::texture_registry>> aTextureRegistry = {})
 	{
 		return convert_for_gpu_usage_cached<T>(
 			aMaterialConfigs,
 			aLoadTexturesInSrgb,
 			aFlipTextures,
 			aImageUsage,
-			aTextureFilterMode);
+			aTextureFilterMode,
+			{},
+			0,
+			aTextureRegistry);
+	}
+
+	/**	Convert the given material config into a format that is usable with a GPU buffer for the materials, like convert_for_gpu_usage,
+	 *	but with textures which are packed into as few images as possible, see pack_textures: small textures are packed into atlases,
+	 *	and textures with the same format, size, and number of levels into texture arrays. The texture indices of the materials refer to
+	 *	the returned image samplers, or, if they are encoded with make_texture_array_index, to the returned texture arrays. The offset and
+	 *	tiling of textures in atlases are changed s.t. they address the texture's region of the atlas.
+	 *	@param	aMaterialConfigs			The material config in CPU format
+	 *	@param	aLoadTexturesInSrgb			Set to true to load the images in sRGB format if applicable
+	 *	@param	aFlipTextures				Set to true to y-flip images
+	 *	@param	aImageUsage					How this image is going to be used. Can be a combination of different avk::image_usage values
+	 *	@param	aTextureFilterMode			Texture filtering mode for all the textures. Trilinear or anisotropic filtering modes will trigger MIP-maps to be generated.
+	 *	@param	aPacking					Which textures to pack
+	 *	@param	aNumThreads					Number of threads which decode textures, or 0 to choose one based on the hardware, see load_image_data_in_parallel.
+	 *	@param	aUploadBatcher				If set, the textures are uploaded by the batcher. It is flushed before this function returns,
+	 *										hence, the returned commands can be submitted to the batcher's queue.
+	 *	@return	A tuple of four elements:
+	 *			<0>: A collection of structs that contains material data converted to a GPU-suitable format.
+	 *			<1>: The image samplers of atlases and of textures which have not been packed, to be bound as sampler2D array.
+	 *			<2>: The image samplers of texture arrays, to be bound as sampler2DArray array, see cTextureArrayIndexBit.
+	 *			<3>: Zero, one, or multiple commands that need to be executed to complete the operation.
+	 */
+	template <typename T>
+	std::tuple<std::vector<T>, std::vector<avk::image_sampler>, std::vector<avk::image_sampler>, avk::command::action_type_command> convert_for_gpu_usage_packed(
+		const std::vector<avk::material_config>& aMaterialConfigs,
+		bool aLoadTexturesInSrgb = false,
+		bool aFlipTextures = false,
+		avk::image_usage aImageUsage = avk::image_usage::general_texture,
+		avk::filter_mode aTextureFilterMode = avk::filter_mode::trilinear,
+		texture_packing aPacking = {},
+		unsigned int aNumThreads = 0,
+		std::optional<std::reference_wrapper<avk::upload_batcher>> aUploadBatcher = {})
+	{
+		static_assert(std::is_convertible<T&, material_gpu_data&>::value, "The texture indices and offsets of T must be those of material_gpu_data");
+
+		avk::command::action_type_command commandsToReturn{};
+		auto conversion = gather_for_gpu_usage<T>(aMaterialConfigs, aLoadTexturesInSrgb);
+
+		// The offset and tiling of each texture index member, which are changed for textures in atlases:
+		static constexpr std::array<std::tuple<int32_t material_gpu_data::*, glm::vec4 material_gpu_data::*>, 12> cTextureMembers = { {
+			{ &material_gpu_data::mDiffuseTexIndex,			&material_gpu_data::mDiffuseTexOffsetTiling },
+			{ &material_gpu_data::mSpecularTexIndex,		&material_gpu_data::mSpecularTexOffsetTiling },
+			{ &material_gpu_data::mAmbientTexIndex,			&material_gpu_data::mAmbientTexOffsetTiling },
+			{ &material_gpu_data::mEmissiveTexIndex,		&material_gpu_data::mEmissiveTexOffsetTiling },
+			{ &material_gpu_data::mHeightTexIndex,			&material_gpu_data::mHeightTexOffsetTiling },
+			{ &material_gpu_data::mNormalsTexIndex,			&material_gpu_data::mNormalsTexOffsetTiling },
+			{ &material_gpu_data::mShininessTexIndex,		&material_gpu_data::mShininessTexOffsetTiling },
+			{ &material_gpu_data::mOpacityTexIndex,			&material_gpu_data::mOpacityTexOffsetTiling },
+			{ &material_gpu_data::mDisplacementTexIndex,	&material_gpu_data::mDisplacementTexOffsetTiling },
+			{ &material_gpu_data::mReflectionTexIndex,		&material_gpu_data::mReflectionTexOffsetTiling },
+			{ &material_gpu_data::mLightmapTexIndex,		&material_gpu_data::mLightmapTexOffsetTiling },
+			{ &material_gpu_data::mExtraTexIndex,			&material_gpu_data::mExtraTexOffsetTiling }
+		} };
+		std::unordered_map<const int*, glm::vec4*> offsetTilings;
+		for (auto& entry : conversion.mMaterials) {
+			material_gpu_data& mgd = static_cast<material_gpu_data&>(entry);
+			for (const auto& [index, offsetTiling] : cTextureMembers) {
+				offsetTilings.emplace(&(mgd.*index), &(mgd.*offsetTiling));
+			}
+		}
+
+		// The 1x1 px textures are not packed, s.t. they keep the indices which convert_for_gpu_usage assigns to them:
+		std::vector<avk::image_sampler> imageSamplers;
+		std::vector<avk::image_sampler> arrayImageSamplers;
+		auto add1pxTexture = [&](std::array<uint8_t, 4> bColor, const std::vector<int*>& bUsages) {
+			if (bUsages.empty()) {
+				return;
+			}
+			auto [tex, cmds] = create_1px_texture(bColor, avk::layout::shader_read_only_optimal, vk::Format::eR8G8B8A8Unorm, avk::memory_usage::device, aImageUsage);
+			commandsToReturn.mNestedCommandsAndSyncInstructions.push_back(std::move(cmds));
+			imageSamplers.push_back(context().create_image_sampler(
+				context().create_image_view(std::move(tex)),
+				context().create_sampler(avk::filter_mode::nearest_neighbor, avk::border_handling_mode::repeat)
+			));
+			for (auto* img : bUsages) {
+				*img = static_cast<int>(imageSamplers.size() - 1);
+			}
+		};
+		add1pxTexture({ 255, 255, 255, 255 }, conversion.mWhiteTextureUsages);
+		add1pxTexture({ 127, 127, 255, 0 }, conversion.mStraightUpNormalTextureUsages);
+
+		std::vector<typename decltype(conversion.mTextureUsages)::value_type*> textures;
+		std::vector<image_data> images;
+		std::vector<std::vector<packable_texture_usage>> usages;
+		for (auto& pair : conversion.mTextureUsages) {
+			textures.push_back(&pair);
+			images.push_back(get_image_data(pair.first, true, conversion.mSrgbTextures.contains(pair.first), aFlipTextures, 4));
+			auto& textureUsages = usages.emplace_back();
+			for (auto& [bhModes, ints] : pair.second) {
+				const bool withinUnitSquare = std::all_of(ints.begin(), ints.end(), [&](const int* bUsage) {
+					const auto& ot = *offsetTilings.at(bUsage);
+					return ot.x >= 0.0f && ot.y >= 0.0f && ot.z >= 0.0f && ot.w >= 0.0f && ot.x + ot.z <= 1.0f && ot.y + ot.w <= 1.0f;
+				});
+				textureUsages.push_back(packable_texture_usage{ bhModes, withinUnitSquare });
+			}
+		}
+
+		auto placements = pack_textures(images, usages, aImageUsage, aTextureFilterMode, aPacking, imageSamplers, arrayImageSamplers, commandsToReturn, aNumThreads, aUploadBatcher);
+
+		// Assign the indices, and map the texture coordinates of textures in atlases into their regions, i.e., uv * tiling + offset is scaled and offset:
+		for (size_t i = 0; i < textures.size(); ++i) {
+			auto& textureUsages = textures[i]->second;
+			for (size_t u = 0; u < textureUsages.size(); ++u) {
+				const auto& placed = placements[i][u];
+				for (auto* img : std::get<std::vector<int*>>(textureUsages[u])) {
+					*img = placed.mIndex;
+					auto& ot = *offsetTilings.at(img);
+					ot = glm::vec4{ glm::vec2{ ot.x, ot.y } * placed.mScale + placed.mOffset, glm::vec2{ ot.z, ot.w } * placed.mScale };
+				}
+			}
+		}
+
+		// Submit the remaining copies, s.t. the returned commands, e.g., mip map blits, are executed after them:
+		if (aUploadBatcher) {
+			aUploadBatcher->get().flush();
+		}
+
+		return std::make_tuple(std::move(conversion.mMaterials), std::move(imageSamplers), std::move(arrayImageSamplers), std::move(commandsToReturn));
+	}
+
+	/**	Convert the given material config into a format that is usable with a GPU buffer for the materials, like convert_for_gpu_usage,
+	 *	but with textures which are streamed by the given texture_streamer instead of being fully resident: only their mip tails are
+	 *	uploaded by this function, and finer levels are streamed in when they are requested, see texture_streamer.
+	 *	@param	aTextureStreamer			The streamer which the textures are added to. The texture indices of the materials refer to its image_samplers().
+	 *	@param	aMaterialConfigs			The material config in CPU format
+	 *	@param	aLoadTexturesInSrgb			Set to true to load the images in sRGB format if applicable
+	 *	@param	aFlipTextures				Set to true to y-flip images
+	 *	@param	aImageUsage					How this image is going to be used. Can be a combination of different avk::image_usage values
+	 *	@param	aTextureFilterMode			Texture filtering mode for all the textures. Trilinear or anisotropic filtering modes will trigger MIP-maps to be generated.
+	 *	@param	aTextureCompression			If set, textures are block-compressed on the CPU before they are streamed, see compress_image_data_for_usage.
+	 *	@return	A tuple of two elements:
+	 *			<0>: A collection of structs that contains material data converted to a GPU-suitable format. Image indices refer to aTextureStreamer.image_samplers().
+	 *			<1>: Commands that need to be executed to upload the 1x1 px replacement textures, if any.
+	 */
+	template <typename T>
+	std::tuple<std::vector<T>, avk::command::action_type_command> convert_for_gpu_usage_streamed(
+		avk::texture_streamer& aTextureStreamer,
+		const std::vector<avk::material_config>& aMaterialConfigs,
+		bool aLoadTexturesInSrgb = false,
+		bool aFlipTextures = false,
+		avk::image_usage aImageUsage = avk::image_usage::general_texture,
+		avk::filter_mode aTextureFilterMode = avk::filter_mode::trilinear,
+		std::optional<avk::texture_compression> aTextureCompression = {})
+	{
+		avk::command::action_type_command commandsToReturn{};
+		auto conversion = gather_for_gpu_usage<T>(aMaterialConfigs, aLoadTexturesInSrgb);
+
+		// The 1x1 px textures are tiny, hence, they are always resident:
+		auto add1pxTexture = [&](std::array<uint8_t, 4> bColor, const std::vector<int*>& bUsages) {
+			if (bUsages.empty()) {
+				return;
+			}
+			auto [tex, cmds] = create_1px_texture(bColor, avk::layout::shader_read_only_optimal, vk::Format::eR8G8B8A8Unorm, avk::memory_usage::device, aImageUsage);
+			commandsToReturn.mNestedCommandsAndSyncInstructions.push_back(std::move(cmds));
+			auto index = static_cast<int>(aTextureStreamer.add_resident_image_sampler(context().create_image_sampler(
+				context().create_image_view(std::move(tex)),
+				context().create_sampler(avk::filter_mode::nearest_neighbor, avk::border_handling_mode::repeat)
+			)));
+			for (auto* img : bUsages) {
+				*img = index;
+			}
+		};
+		add1pxTexture({ 255, 255, 255, 255 }, conversion.mWhiteTextureUsages);
+		add1pxTexture({ 127, 127, 255, 0 }, conversion.mStraightUpNormalTextureUsages);
+
+		for (auto& [path, bhModesAndUsages] : conversion.mTextureUsages) {
+			const bool potentiallySrgb = conversion.mSrgbTextures.contains(path);
+			const bool isNormalMap = conversion.mNormalMapTextures.contains(path);
+
+			// The levels which are stored in the streamer's cache are replaced if the file or the settings change:
+			std::error_code ec;
+			size_t key = 0;
+			avk::hash_combine(key, std::filesystem::file_size(path, ec), std::filesystem::last_write_time(path, ec).time_since_epoch().count(),
+				potentiallySrgb, aFlipTextures, aTextureCompression.has_value(), static_cast<int>(aImageUsage));
+			if (aTextureCompression) {
+				// Every setting selects different block formats:
+				avk::hash_combine(key, aTextureCompression->mPreferBc7, aTextureCompression->mNormalMapsToBc5, aTextureCompression->mCompressHdr, isNormalMap);
+			}
+
+			auto texture = aTextureStreamer.add_texture(path, key, [=]() {
+				auto imageData = get_image_data(path, true, potentiallySrgb, aFlipTextures, 4);
+				if (aTextureCompression) {
+					compress_image_data_for_usage(imageData, aImageUsage, *aTextureCompression, isNormalMap);
+				}
+				return imageData;
+			}, aImageUsage);
+
+			// There can be different border handling types specified for the textures, which share the streamed image:
+			for (auto& [bhModes, usages] : bhModesAndUsages) {
+				auto index = static_cast<int>(aTextureStreamer.add_sampler(texture, context().create_sampler(aTextureFilterMode, bhModes)));
+				for (auto* img : usages) {
+					*img = index;
+				}
+			}
+		}
+
+		return std::make_tuple(std::move(conversion.mMaterials), std::move(commandsToReturn));
 	}
 }
@@ -0,0 +1,40 @@
+#pragma once
+
+namespace avk
+{
+	/**	A read-only view of a whole file, mapped into the address space of the process.
+	 *
+	 *	The file's content is paged in by the operating system on first access,
+	 *	i.e., no data is copied into user-space buffers when the file is read.
+	 *	The mapping is released when the memory_mapped_file is destroyed; all
+	 *	pointers obtained via data() become invalid at that point.
+	 */
+	class memory_mapped_file
+	{
+	public:
+		/**	Maps the file at the given path for reading.
+		 *	@param	aPath	Path to an existing file
+		 *	Throws an avk::runtime_error if the file can not be opened or mapped.
+		 */
+		memory_mapped_file(const std::filesystem::path& aPath);
+
+		memory_mapped_file() = delete;
+		memory_mapped_file(memory_mapped_file&& aOther) noexcept;
+		memory_mapped_file(const memory_mapped_file&) = delete;
+		memory_mapped_file& operator=(memory_mapped_file&& aOther) noexcept;
+		memory_mapped_file& operator=(const memory_mapped_file&) = delete;
+		~memory_mapped_file();
+
+		/** Returns a pointer to the beginning of the mapped file, or nullptr if the file is empty. */
+		const std::byte* data() const { return static_cast<const std::byte*>(mData); }
+
+		/** Returns the size of the mapped file in bytes. */
+		size_t size() const { return mSize; }
+
+	private:
+		void unmap();
+
+		void* mData = nullptr;
+		size_t mSize = 0;
+	};
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+namespace avk
+{
+	/** How the channels of the pixels of an image are encoded, see mip_map_pixel_layout */
+	enum struct mip_map_channel_encoding
+	{
+		/** 8 bit per channel, linear values in [0, 1] */
+		unorm8,
+		/** 8 bit per channel, sRGB-encoded values in [0, 1]; filtered in linear space */
+		srgb8,
+		/** 32 bit float per channel, linear values */
+		float32
+	};
+
+	/** The pixel layout of image data, as far as it is relevant for generating mip maps on the CPU */
+	struct mip_map_pixel_layout
+	{
+		mip_map_channel_encoding mEncoding = mip_map_channel_encoding::unorm8;
+		/** Number of channels per pixel, 1 to 4 */
+		uint32_t mNumChannels = 4;
+		/** True if the last channel is a linear alpha channel, although the others are sRGB-encoded */
+		bool mLinearAlpha = false;
+	};
+
+	/**	Determines the pixel layout of image data with the given format.
+	 *	@param	aFormat			The format of the image data
+	 *	@param	aBytesPerPixel	The actual number of bytes per pixel of the image data. Formats with 16 bit floats are only
+	 *							supported if the data has been converted to 32 bit floats, e.g., with half_to_float.
+	 *	@return	The pixel layout, or {} if mip maps can not be generated for the format on the CPU, e.g., for
+	 *			block-compressed formats
+	 */
+	extern std::optional<mip_map_pixel_layout> mip_map_pixel_layout_for(vk::Format aFormat, size_t aBytesPerPixel);
+
+	/**	Returns the number of levels of a full mip map chain of an image of the given size,
+	 *	i.e., including level 0 and a last level of 1x1 px.
+	 */
+	extern uint32_t number_of_mip_levels(uint32_t aWidth, uint32_t aHeight);
+
+	/**	Computes the next mip map level of the given image data with a 2x2 box filter. For sRGB-encoded
+	 *	data, the filter is applied to linear values. If the width or height of the source is odd and
+	 *	greater than 1, its last column or row does not contribute to the target level.
+	 *	@param	aLayout			The pixel layout of aSource and aTarget
+	 *	@param	aSource			The pixels of the source level, tightly packed
+	 *	@param	aWidth			The width of the source level
+	 *	@param	aHeight			The height of the source level
+	 *	@param	aTarget			The pixels of the target level, i.e., max(aWidth / 2, 1) x max(aHeight / 2, 1) pixels
+	 *	@param	aNumThreads		Number of threads which compute rows of the target level, or 0 to choose one based on the hardware
+	 */
+	extern void downsample_mip_level(const mip_map_pixel_layout& aLayout, const std::byte* aSource, uint32_t aWidth, uint32_t aHeight, std::byte* aTarget, unsigned int aNumThreads = 0);
+
+	/**	Computes all mip map levels below level 0, down to 1x1 px, see downsample_mip_level.
+	 *	@param	aLayout			The pixel layout of aLevel0
+	 *	@param	aLevel0			The pixels of level 0, tightly packed
+	 *	@param	aWidth			The width of level 0
+	 *	@param	aHeight			The height of level 0
+	 *	@param	aNumThreads		Number of threads which compute rows of the levels, or 0 to choose one based on the hardware
+	 *	@return	The pixels of levels 1 to number_of_mip_levels(aWidth, aHeight) - 1
+	 */
+	extern std::vector<std::vector<std::byte>> generate_mip_levels(const mip_map_pixel_layout& aLayout, const std::byte* aLevel0, uint32_t aWidth, uint32_t aHeight, unsigned int aNumThreads = 0);
+}
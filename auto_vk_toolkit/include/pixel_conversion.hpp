@@ -0,0 +1,41 @@
+#pragma once
+
+namespace avk
+{
+	/*	Conversions of the pixels of image data, which are tightly packed, i.e., rows are not padded.
+	 *	The rows are distributed among aNumThreads threads, or among as many threads as the hardware supports if it is 0;
+	 *	small images are converted on the calling thread only. Where the compiler targets SSE2, SSSE3, or F16C, the
+	 *	conversions use them, otherwise they fall back to scalar code which gives the same results.
+	 */
+
+	/** Expands 8 bit RGB pixels to RGBA pixels with an alpha of 255; aTarget must not overlap aSource */
+	extern void expand_rgb_to_rgba(const uint8_t* aSource, uint8_t* aTarget, uint32_t aWidth, uint32_t aHeight, unsigned int aNumThreads = 0);
+
+	/** Expands 32 bit float RGB pixels to RGBA pixels with an alpha of 1; aTarget must not overlap aSource */
+	extern void expand_rgb_to_rgba(const float* aSource, float* aTarget, uint32_t aWidth, uint32_t aHeight, unsigned int aNumThreads = 0);
+
+	/** Flips the rows of an image vertically, in place
+	 *  @param	aRowSize	The size of a row, in bytes
+	 */
+	extern void flip_vertically(std::byte* aPixels, size_t aRowSize, uint32_t aHeight, unsigned int aNumThreads = 0);
+
+	/** Converts sRGB-encoded 8 bit values to linear 32 bit floats in [0, 1]
+	 *  @param	aNumChannels	The number of channels per pixel
+	 *  @param	aLinearAlpha	If true, the last channel is an alpha channel, which is linear already and only normalized
+	 */
+	extern void srgb_to_linear(const uint8_t* aSource, float* aTarget, uint32_t aWidth, uint32_t aHeight, uint32_t aNumChannels, bool aLinearAlpha, unsigned int aNumThreads = 0);
+
+	/** Converts 32 bit floats to 16 bit floats, rounding to nearest even; values beyond the range of 16 bit floats become infinite */
+	extern void float_to_half(const float* aSource, uint16_t* aTarget, uint32_t aWidth, uint32_t aHeight, uint32_t aNumChannels, unsigned int aNumThreads = 0);
+
+	/** Converts 16 bit floats to 32 bit floats */
+	extern void half_to_float(const uint16_t* aSource, float* aTarget, uint32_t aWidth, uint32_t aHeight, uint32_t aNumChannels, unsigned int aNumThreads = 0);
+
+	/** Multiplies the color channels of 8 bit RGBA pixels with their alpha, in place
+	 *  @param	aSrgb	If true, the color channels are sRGB-encoded, and they are multiplied in linear space
+	 */
+	extern void premultiply_alpha(uint8_t* aPixels, uint32_t aWidth, uint32_t aHeight, bool aSrgb, unsigned int aNumThreads = 0);
+
+	/** Multiplies the color channels of 32 bit float RGBA pixels with their alpha, in place */
+	extern void premultiply_alpha(float* aPixels, uint32_t aWidth, uint32_t aHeight, unsigned int aNumThreads = 0);
+}
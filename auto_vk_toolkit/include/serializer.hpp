@@ -2,9 +2,14 @@
 #include "auto_vk_toolkit.hpp"
 
 #include "animation.hpp"
+#include "block_compression.hpp"
+#include "cache_dependencies.hpp"
+#include "cache_file_checksums.hpp"
 #include "lightsource_gpu_data.hpp"
 #include "material_gpu_data.hpp"
+#include "memory_mapped_file.hpp"
 #include "orca_scene.hpp"
+#include "write_behind_streambuf.hpp"
 
 /** cereal binary archive */
 #include "cereal/cereal.hpp"
@@ -47,7 +52,7 @@
  *  invalidate old cache files. An exception will be thrown if the cache file's version and the framework's serializer
  *  versions do not match.
  */
-#define SERIALIZER_CACHE_FILE_VERSION 0x00000001
+#define SERIALIZER_CACHE_FILE_VERSION 0x00000009
 
 namespace avk {
 
@@ -62,6 +67,241 @@ namespace avk {
 		return std::filesystem::exists(aPath);
 	}
 
+	/** @brief Checks if a cache file has been written with the current SERIALIZER_CACHE_FILE_VERSION
+	 *
+	 *  @param[in] aPath The path to a cached file
+	 *
+	 *  @param[out] True if the cache file exists and starts with the current version, false otherwise
+	 */
+	static inline bool does_cache_file_have_current_version(const std::string_view aPath)
+	{
+		// Block-compressed cache files store the version in the header of the compressed stream:
+		if (auto compressedVersion = block_compressed_file_version(std::filesystem::path(aPath)); compressedVersion.has_value()) {
+			return SERIALIZER_CACHE_FILE_VERSION == compressedVersion.value();
+		}
+		std::ifstream stream(std::string(aPath), std::ios::binary);
+		std::uint32_t version = 0;
+		stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+		return stream && SERIALIZER_CACHE_FILE_VERSION == version;
+	}
+
+	/** @brief Checks if a cache file has been written completely
+	 *
+	 *  Cache files end with checksums of their content, which are only written after all of the
+	 *  content has been written. Whether the content matches its checksums is verified during
+	 *  deserialization.
+	 *
+	 *  @param[in] aPath The path to a cached file
+	 *
+	 *  @param[out] True if the cache file ends with valid checksums of the current SERIALIZER_CACHE_FILE_VERSION, false otherwise
+	 */
+	static inline bool is_cache_file_complete(const std::string_view aPath)
+	{
+		return read_cache_file_checksums(std::filesystem::path(aPath), SERIALIZER_CACHE_FILE_VERSION).has_value();
+	}
+
+	/** @brief mapped_binary_input_archive
+	 *
+	 *  A cereal input archive which loads data saved using cereal::BinaryOutputArchive
+	 *  directly from a contiguous block of memory, e.g., a memory mapped cache file.
+	 *  In contrast to cereal::BinaryInputArchive, no stream buffers are involved: loading
+	 *  a value is a single memcpy from the source memory into the value. If a checksum_verifier
+	 *  is given, memory is only loaded after it has been verified.
+	 */
+	class mapped_binary_input_archive : public cereal::InputArchive<mapped_binary_input_archive, cereal::AllowEmptyClassElision>
+	{
+	public:
+		/** @brief Construct, loading from the memory range [aBegin, aEnd)
+		 *
+		 *  @param[in] aBegin Pointer to the first byte to load
+		 *  @param[in] aEnd Pointer one past the last byte to load
+		 *  @param[in] aVerifier Verifier of the memory range, or nullptr if it does not need to be verified
+		 */
+		mapped_binary_input_archive(const std::byte* aBegin, const std::byte* aEnd, const checksum_verifier* aVerifier = nullptr) :
+			cereal::InputArchive<mapped_binary_input_archive, cereal::AllowEmptyClassElision>(this),
+			mCursor(aBegin),
+			mEnd(aEnd),
+			mVerifier(aVerifier)
+		{}
+
+		/** @brief Reads aSize bytes from the source memory into aData
+		 */
+		void loadBinary(void* const aData, std::streamsize aSize)
+		{
+			std::memcpy(aData, consume(static_cast<size_t>(aSize)), static_cast<size_t>(aSize));
+		}
+
+		/** @brief Skips aSize bytes of the source memory and returns a pointer to the first of them
+		 */
+		const std::byte* consume(size_t aSize)
+		{
+			if (aSize > remaining()) {
+				throw cereal::Exception("Failed to read " + std::to_string(aSize) + " bytes from memory mapped file! Only " + std::to_string(remaining()) + " bytes left");
+			}
+			if (nullptr != mVerifier) {
+				mVerifier->verify(mCursor + aSize);
+			}
+			auto* result = mCursor;
+			mCursor += aSize;
+			return result;
+		}
+
+		/** @brief Returns a pointer to the next byte to be loaded
+		 */
+		const std::byte* cursor() const { return mCursor; }
+
+		/** @brief Returns the number of bytes that have not been loaded yet
+		 */
+		size_t remaining() const { return static_cast<size_t>(mEnd - mCursor); }
+
+	private:
+		const std::byte* mCursor;
+		const std::byte* mEnd;
+		const checksum_verifier* mVerifier;
+	};
+
+	/** Loading for arithmetic types from memory */
+	template<class T> inline
+	std::enable_if_t<std::is_arithmetic_v<T>, void>
+	CEREAL_LOAD_FUNCTION_NAME(mapped_binary_input_archive& aArchive, T& aValue)
+	{
+		aArchive.loadBinary(std::addressof(aValue), sizeof(aValue));
+	}
+
+	/** Loading of name-value pairs, which are stored without their names in binary archives */
+	template<class T> inline
+	void CEREAL_SERIALIZE_FUNCTION_NAME(mapped_binary_input_archive& aArchive, cereal::NameValuePair<T>& aValue)
+	{
+		aArchive(aValue.value);
+	}
+
+	/** Loading of size tags */
+	template<class T> inline
+	void CEREAL_SERIALIZE_FUNCTION_NAME(mapped_binary_input_archive& aArchive, cereal::SizeTag<T>& aValue)
+	{
+		aArchive(aValue.size);
+	}
+
+	/** Loading of binary data from memory */
+	template<class T> inline
+	void CEREAL_LOAD_FUNCTION_NAME(mapped_binary_input_archive& aArchive, cereal::BinaryData<T>& aValue)
+	{
+		aArchive.loadBinary(aValue.data, static_cast<std::streamsize>(aValue.size));
+	}
+}
+
+// Register the archive for polymorphic support and tie it to the binary output archive, whose data it loads
+CEREAL_REGISTER_ARCHIVE(avk::mapped_binary_input_archive)
+namespace cereal { namespace traits { namespace detail {
+	template <> struct get_output_from_input<avk::mapped_binary_input_archive>
+	{ using type = cereal::BinaryOutputArchive; };
+} } }
+
+namespace avk {
+
+	/** @brief Determines whether contiguous containers of Type are archived as a single block of memory
+	 *
+	 *  By default, this is the case for all trivially copyable, non-arithmetic types, such as glm::vec3,
+	 *  avk::material_gpu_data or avk::meshlet_gpu_data, whose members cereal would otherwise archive one
+	 *  by one for every element. (Containers of arithmetic types are archived as a single block by cereal.)
+	 *  Specialize it as std::false_type for trivially copyable types whose memory must not be stored as
+	 *  it is, e.g., types containing pointers.
+	 */
+	template<typename Type>
+	struct is_bulk_serializable : std::bool_constant<
+		std::is_trivially_copyable_v<Type> && !std::is_arithmetic_v<Type> && !std::is_pointer_v<Type> && !std::is_member_pointer_v<Type>
+	> {};
+
+	template<typename Type>
+	concept bulk_serializable = is_bulk_serializable<Type>::value;
+
+	/** Loading of vectors of bulk_serializable elements from memory, as a single block */
+	template<bulk_serializable T, class A> inline
+	void CEREAL_LOAD_FUNCTION_NAME(mapped_binary_input_archive& aArchive, std::vector<T, A>& aValue)
+	{
+		cereal::size_type size;
+		aArchive(cereal::make_size_tag(size));
+		if (size > aArchive.remaining() / sizeof(T)) {
+			throw cereal::Exception(std::format("The cache file does not contain {} elements of size {} at the current position.", size, sizeof(T)));
+		}
+		aValue.resize(static_cast<size_t>(size));
+		aArchive(cereal::binary_data(aValue.data(), static_cast<size_t>(size) * sizeof(T)));
+	}
+
+	/** Loading of arrays of bulk_serializable elements from memory, as a single block */
+	template<bulk_serializable T, size_t N> inline
+	void CEREAL_LOAD_FUNCTION_NAME(mapped_binary_input_archive& aArchive, std::array<T, N>& aValue)
+	{
+		aArchive(cereal::binary_data(aValue.data(), sizeof(aValue)));
+	}
+}
+
+// Overloads for cereal's binary archives, which are more specialized than cereal's element-wise
+// overloads for std::vector and std::array, and therefore take precedence. They must be declared in
+// the archives' namespace to be found via argument-dependent lookup.
+namespace cereal {
+
+	/** Saving of vectors of bulk_serializable elements as a single block */
+	template<avk::bulk_serializable T, class A> inline
+	void CEREAL_SAVE_FUNCTION_NAME(BinaryOutputArchive& aArchive, const std::vector<T, A>& aValue)
+	{
+		aArchive(make_size_tag(static_cast<size_type>(aValue.size())));
+		aArchive(binary_data(aValue.data(), aValue.size() * sizeof(T)));
+	}
+
+	/** Loading of vectors of bulk_serializable elements as a single block */
+	template<avk::bulk_serializable T, class A> inline
+	void CEREAL_LOAD_FUNCTION_NAME(BinaryInputArchive& aArchive, std::vector<T, A>& aValue)
+	{
+		size_type size;
+		aArchive(make_size_tag(size));
+		aValue.resize(static_cast<size_t>(size));
+		aArchive(binary_data(aValue.data(), static_cast<size_t>(size) * sizeof(T)));
+	}
+
+	/** Saving of arrays of bulk_serializable elements as a single block */
+	template<avk::bulk_serializable T, size_t N> inline
+	void CEREAL_SAVE_FUNCTION_NAME(BinaryOutputArchive& aArchive, const std::array<T, N>& aValue)
+	{
+		aArchive(binary_data(aValue.data(), sizeof(aValue)));
+	}
+
+	/** Loading of arrays of bulk_serializable elements as a single block */
+	template<avk::bulk_serializable T, size_t N> inline
+	void CEREAL_LOAD_FUNCTION_NAME(BinaryInputArchive& aArchive, std::array<T, N>& aValue)
+	{
+		aArchive(binary_data(aValue.data(), sizeof(aValue)));
+	}
+}
+
+namespace avk {
+
+	/** @brief Options for constructing an avk::serializer
+	 */
+	struct serializer_options
+	{
+		/** Only relevant for deserialization: If true, the cache file is memory mapped and data is
+		 *  loaded directly from the mapped memory instead of through an input stream. If mapping
+		 *  the file fails, the serializer falls back to reading through an input stream. */
+		bool mMemoryMapped = true;
+		/** Only relevant for serialization: If true, the cache file is written as a stream of
+		 *  independently LZ4-compressed blocks. During deserialization, compressed cache files
+		 *  are detected automatically and decompressed by worker threads ahead of the reader. */
+		bool mCompressed = false;
+		/** Only relevant for serialization with mCompressed: Number of uncompressed bytes per block */
+		size_t mCompressionBlockSize = size_t{ 1 } << 20;
+		/** Only relevant for serialization: If true, archived data is copied into a bounded queue of
+		 *  buffers and written to the cache file (and compressed) by a background thread, so that
+		 *  serialization does not block on file writes. flush() waits until all data has been written. */
+		bool mWriteBehind = true;
+		/** Only relevant for serialization with mWriteBehind: Number of bytes per queued buffer */
+		size_t mWriteBehindBufferSize = size_t{ 4 } << 20;
+		/** Only relevant for serialization with mWriteBehind: Maximum number of queued buffers */
+		size_t mWriteBehindMaxQueuedBuffers = 16;
+		/** Only relevant for serialization: Number of bytes of the cache file covered by each checksum */
+		size_t mChecksumBlockSize = size_t{ 256 } << 10;
+	};
+
 	/** @brief serializer
 	 *  
 	 *  This type serializes/deserializes objects to/from binary files using the cereal
@@ -79,18 +319,32 @@ namespace avk {
 		};
 
 		/** @brief Construct a serializer with serializing or deserializing capabilities
+		 *
+		 *  In serialization mode, the data is written to a temporary file next to the cache file,
+		 *  which replaces the cache file when the serializer is destroyed. In deserialization mode,
+		 *  the cache file's content is verified against its checksums while it is deserialized.
+		 *  A cache_file_corrupted_error is thrown if it is incomplete or does not match.
 		 *
 		 *  @param[in] aCacheFilePath The path to the cache file
 		 *  @param[in] aMode serializer::mode::serialize for serialization
 		 *					 serializer::mode::deserialize for deserialization
+		 *  @param[in] aOptions Memory mapping and compression options, see serializer_options
 		 */
-		serializer(std::string_view aCacheFilePath, serializer::mode aMode) :
-			mArchive(aMode == serializer::mode::serialize ?
-				std::variant<deserialize, serialize>{ serializer::serialize(aCacheFilePath) } :
-				std::variant<deserialize, serialize>{ serializer::deserialize(aCacheFilePath) })
+		serializer(std::string_view aCacheFilePath, serializer::mode aMode, serializer_options aOptions = {}) :
+			mArchive(create_archive(aCacheFilePath, aMode, aOptions)),
+			mCacheFilePath(aCacheFilePath),
+			mUncaughtExceptions(std::uncaught_exceptions())
 		{
 			std::uint32_t version = SERIALIZER_CACHE_FILE_VERSION;
-			archive(version);
+			try {
+				archive(version);
+			}
+			catch (const cache_file_corrupted_error&) {
+				// The destructor is not invoked if the constructor throws:
+				std::visit([](auto& aArchive) { aArchive.close(); }, mArchive);
+				remove_corrupted_cache_file(mCacheFilePath);
+				throw;
+			}
 			// If the mode is `deserialize`, version was overwritten by `archive` from the cache file and may be different
 			if (version != SERIALIZER_CACHE_FILE_VERSION)
 			{
@@ -99,24 +353,75 @@ namespace avk {
 		}
 
 		/** @brief Construct a serializer with serializing or deserializing capabilities
-		 *  If the cache file from aCacheFilePath does not exists, the serializer is initialized
-		 *  in serialization mode and creates the file for writing, else the serializer is
-		 *  initialised in deserialization mode and reads from the file.
+		 *  If the cache file from aCacheFilePath does not exists, if it has been written by a
+		 *  different SERIALIZER_CACHE_FILE_VERSION, or if it is incomplete, the serializer is
+		 *  initialized in serialization mode and (re)creates the file for writing, else the
+		 *  serializer is initialised in deserialization mode and reads from the file.
 		 *
 		 *  @param[in] aCacheFilePath The path to the cache file
 		 */
 		serializer(std::string_view aCacheFilePath) :
-			serializer(aCacheFilePath, does_cache_file_exist(aCacheFilePath) ?
-				serializer::mode::deserialize :
-				serializer::mode::serialize)
+			serializer(aCacheFilePath, select_mode_for_cache_file(aCacheFilePath))
 		{ }
 
+		/** @brief Construct a serializer which regenerates the cache file whenever its inputs change
+		 *
+		 *  The serializer is initialized in deserialization mode if the cache file exists, is complete,
+		 *  and has been generated from the given dependencies, i.e., from the same settings and from files
+		 *  which have not changed since then (see avk::is_cache_up_to_date). Otherwise, it is
+		 *  initialized in serialization mode and records the dependencies next to the cache file
+		 *  when it is destroyed, i.e., after the cache file has been written completely. Further
+		 *  input files which are only known during serialization, such as the textures of a model,
+		 *  can be added via add_file_dependency.
+		 *
+		 *  @param[in] aCacheFilePath The path to the cache file
+		 *  @param[in] aDependencies The files and settings the cache file's content is generated from
+		 *  @param[in] aOptions Memory mapping and compression options, see serializer_options
+		 */
+		serializer(std::string_view aCacheFilePath, cache_dependencies aDependencies, serializer_options aOptions = {}) :
+			serializer(aCacheFilePath, select_mode_for_dependencies(aCacheFilePath, aDependencies), aOptions)
+		{
+			if (mode() == mode::serialize) {
+				mDependencies = std::make_unique<cache_dependencies>(std::move(aDependencies));
+			}
+		}
+
 		serializer() = delete;
 		serializer(serializer&&) noexcept = default;
 		serializer(const serializer&) = delete;
 		serializer& operator=(serializer&&) noexcept = default;
 		serializer& operator=(const serializer&) = delete;
-		~serializer() = default;
+
+		/** @brief Completes the cache file in serialization mode, or removes it if it has turned out to be corrupted
+		 *
+		 *  In serialization mode, the temporary file replaces the cache file, and the cache file's dependencies
+		 *  are recorded if the serializer has been constructed with dependencies. If the serializer is destroyed
+		 *  during stack unwinding, the written data is incomplete and the temporary file is removed instead.
+		 *  In deserialization mode, the cache file and its dependency record are removed if its content does
+		 *  not match its checksums, so that it is regenerated the next time.
+		 */
+		~serializer()
+		{
+			try {
+				if (mode() == mode::serialize) {
+					if (std::uncaught_exceptions() > mUncaughtExceptions) {
+						return;
+					}
+					std::get<serialize>(mArchive).commit();
+					if (mDependencies) {
+						write_cache_dependency_record(mCacheFilePath, *mDependencies);
+					}
+				}
+				else if (std::visit([](const auto& aArchive) { return aArchive.is_corrupted(); }, mArchive)) {
+					// Close the file first, so that it can be removed on all platforms:
+					std::visit([](auto& aArchive) { aArchive.close(); }, mArchive);
+					remove_corrupted_cache_file(mCacheFilePath);
+				}
+			}
+			catch (const std::exception& e) {
+				LOG_ERROR(std::format("Unable to complete cache file '{}': {}", mCacheFilePath, e.what()));
+			}
+		}
 
 		/** @brief Returns the mode of the serializer
 		 *
@@ -127,6 +432,32 @@ namespace avk {
 			return std::holds_alternative<serialize>(mArchive) ? mode::serialize : mode::deserialize;
 		}
 
+		/** @brief Returns true if the serializer deserializes directly from a memory mapped cache file
+		 */
+		bool is_memory_mapped() const
+		{
+			return std::holds_alternative<deserialize_mapped>(mArchive);
+		}
+
+		/** @brief Returns true if the cache file is written or read as block-compressed stream
+		 */
+		bool is_compressed() const
+		{
+			return std::visit([](const auto& aArchive) { return aArchive.is_compressed(); }, mArchive);
+		}
+
+		/** @brief Returns the compression ratio and the codec throughput of a block-compressed cache file
+		 *
+		 *  During serialization, the statistics cover all blocks which have been written so far,
+		 *  during deserialization, all blocks which have been decompressed so far.
+		 *
+		 *  @param[out] The statistics, or {} if the cache file is not block-compressed
+		 */
+		std::optional<block_compression_statistics> compression_statistics() const
+		{
+			return std::visit([](const auto& aArchive) { return aArchive.compression_statistics(); }, mArchive);
+		}
+
 		template<typename Type>
 		using BinaryData = cereal::BinaryData<Type>;
 
@@ -160,12 +491,7 @@ namespace avk {
 		template<typename Type>
 		inline void archive(Type&& aValue)
 		{
-			if (mode() == mode::serialize) {
-				std::get<serialize>(mArchive)(std::forward<Type>(aValue));
-			}
-			else {
-				std::get<deserialize>(mArchive)(std::forward<Type>(aValue));
-			}
+			std::visit([&aValue](auto& aArchive) { aArchive(std::forward<Type>(aValue)); }, mArchive);
 		}
 
 		/** @brief Serializes/Deserializes raw memory
@@ -173,7 +499,8 @@ namespace avk {
 		 *  This function serializes a block of memory of a specific size if the serializer
 		 *  was initialized in serialization mode and deserializes the same size of memory
 		 *  from file to the location of the pointer passed to this function if the
-		 *  serializer was initialized in deserialization mode.
+		 *  serializer was initialized in deserialization mode. If the cache file is memory
+		 *  mapped, the data is copied once, straight from the mapped file to aValue.
 		 *
 		 *  @param[in] aValue A pointer to the block of memory to serialize or to fill from file
 		 *  @param[in] aSize The total size of the data in memory
@@ -181,12 +508,7 @@ namespace avk {
 		template<typename Type>
 		inline void archive_memory(Type&& aValue, size_t aSize)
 		{
-			if (mode() == mode::serialize) {
-				std::get<serialize>(mArchive)(binary_data(aValue, aSize));
-			}
-			else {
-				std::get<deserialize>(mArchive)(binary_data(aValue, aSize));
-			}
+			std::visit([&aValue, aSize](auto& aArchive) { aArchive(binary_data(aValue, aSize)); }, mArchive);
 		}
 
 		/** @brief Serializes/Deserializes a avk::buffer
@@ -195,7 +517,8 @@ namespace avk {
 		 *  was initialized in serialization mode and deserializes the buffer content from file
 		 *  to the buffer of the internal memory_handle if the serializer was initialized in
 		 *  deserialization mode. The passed avk::buffer is internally mapped and unmapped for
-		 *  this operations.
+		 *  this operations. If the cache file is memory mapped, the buffer content is copied
+		 *  straight from the mapped file into the buffer's (e.g. staging) memory.
 		 *
 		 *  @param[in] aValue A pointer to the block of memory to serialize or to fill from file
 		 */
@@ -209,11 +532,77 @@ namespace avk {
 			archive_memory(mapping.get(), size);
 		}
 
+		/** @brief Serializes/Deserializes a vector of trivially copyable elements and returns a view of them
+		 *
+		 *  During serialization, the number of elements and the raw memory of the elements are
+		 *  written to file, the latter at an offset which is a multiple of alignof(Type), and a
+		 *  view of aValue is returned. During deserialization from a memory
+		 *  mapped cache file, aValue is left untouched and the returned view points directly into
+		 *  the mapped file, i.e., no data is copied at all. It remains valid as long as the serializer
+		 *  exists. If the elements in the file are not suitably aligned for Type, or if the cache file
+		 *  is not memory mapped, the elements are copied once into aValue and a view of aValue is returned.
+		 *
+		 *  Data written with archive_view must be read with archive_view; the format differs from
+		 *  archive(std::vector<Type>&) for non-arithmetic element types.
+		 *
+		 *  @param[in] aValue The elements to serialize, or storage for the deserialized elements if required
+		 *  @return A view of the serialized or deserialized elements
+		 */
+		template<typename Type> requires std::is_trivially_copyable_v<Type>
+		std::span<const Type> archive_view(std::vector<Type>& aValue)
+		{
+			std::uint64_t count = aValue.size();
+			archive(count);
+			// Pad, so that the elements are suitably aligned in the file and, hence, also in the mapped memory:
+			std::array<std::byte, alignof(Type)> padding{};
+			archive_memory(padding.data(), (alignof(Type) - position() % alignof(Type)) % alignof(Type));
+			if (is_memory_mapped()) {
+				auto& mapped = std::get<deserialize_mapped>(mArchive);
+				if (count > mapped.remaining() / sizeof(Type)) {
+					throw avk::runtime_error(std::format("The cache file does not contain {} elements of size {} at the current position.", count, sizeof(Type)));
+				}
+				const auto* data = mapped.consume(static_cast<size_t>(count) * sizeof(Type));
+				if (reinterpret_cast<std::uintptr_t>(data) % alignof(Type) == 0) {
+					return std::span<const Type>(reinterpret_cast<const Type*>(data), static_cast<size_t>(count));
+				}
+				aValue.resize(static_cast<size_t>(count));
+				std::memcpy(aValue.data(), data, static_cast<size_t>(count) * sizeof(Type));
+				return std::span<const Type>(aValue);
+			}
+			if (mode() == mode::deserialize) {
+				aValue.resize(static_cast<size_t>(count));
+			}
+			archive_memory(aValue.data(), static_cast<size_t>(count) * sizeof(Type));
+			return std::span<const Type>(aValue);
+		}
+
+		/** @brief Adds an input file of the cache file, which is only known during serialization
+		 *
+		 *  Only has an effect if the serializer has been constructed with cache_dependencies and is
+		 *  in serialization mode. The *_cached functions add the files they load data from.
+		 *
+		 *  @param[in] aPath The path to the input file
+		 */
+		void add_file_dependency(std::string aPath)
+		{
+			if (mDependencies) {
+				mDependencies->add_file(std::move(aPath));
+			}
+		}
+
+		/** @brief Returns the current offset in bytes from the beginning of the cache file
+		 */
+		size_t position()
+		{
+			return std::visit([](auto& aArchive) { return aArchive.position(); }, mArchive);
+		}
+
 		/** @brief Flush the underlying output stream
 		 *
 		 *  This function can be used to explicitely flush the underlying outputstream during
-		 *  serialization and requests all data to be written. During deserialization, this
-		 *  function does nothing
+		 *  serialization and requests all data to be written to the temporary file. The cache
+		 *  file itself is replaced when the serializer is destroyed. During deserialization,
+		 *  this function does nothing
 		 */
 		void flush()
 		{
@@ -227,10 +616,21 @@ namespace avk {
 		/** @brief serialize
 		 *
 		 *  This type represents an output archive to save data in binary form to a file.
+		 *  The data is written to a temporary file, followed by its checksums, which replaces
+		 *  the cache file in commit(). If it is destroyed before, the temporary file is removed.
 		 */
 		class serialize {
-			std::ofstream mOfstream;
-			cereal::BinaryOutputArchive mArchive;
+			std::string mCacheFilePath;
+			std::string mTemporaryFilePath;
+			std::unique_ptr<std::ofstream> mOfstream;
+			/** Computes the checksums of all data; sits between mStream, mCompressor, or mWriteBehind and mOfstream */
+			std::unique_ptr<checksumming_streambuf> mChecksums;
+			/** Only set if the cache file is block-compressed; sits between mStream and mChecksums */
+			std::unique_ptr<block_compressing_streambuf> mCompressor;
+			/** Only set in write-behind mode; sits between mStream and mCompressor or mChecksums, respectively */
+			std::unique_ptr<write_behind_streambuf> mWriteBehind;
+			std::unique_ptr<std::ostream> mStream;
+			std::unique_ptr<cereal::BinaryOutputArchive> mArchive;
 
 		public:
 			serialize() = delete;
@@ -238,22 +638,52 @@ namespace avk {
 			/** @brief Construct, outputting a binary file to the provided path
 			 *
 			 *  @param[in] aCacheFilePath The filename including the full path where to save the cached file
+			 *  @param[in] aOptions If aOptions.mCompressed is set, the file is written block-compressed,
+			 *					   if aOptions.mWriteBehind is set, it is written by a background thread
 			 */
-			serialize(const std::string_view aCacheFilePath) :
-				mOfstream(aCacheFilePath.data(), std::ios::binary),
-				mArchive(mOfstream)
-			{}
-
-			/* Construct from other serialize */
-			serialize(serialize&& aOther) noexcept :
-				mOfstream(std::move(aOther.mOfstream)),
-				mArchive(mOfstream)
-			{}
+			serialize(const std::string_view aCacheFilePath, const serializer_options& aOptions) :
+				mCacheFilePath(aCacheFilePath),
+				mTemporaryFilePath(std::string(aCacheFilePath) + ".tmp"),
+				mOfstream(std::make_unique<std::ofstream>(mTemporaryFilePath, std::ios::binary | std::ios::trunc))
+			{
+				if (!*mOfstream) {
+					throw avk::runtime_error(std::format("Unable to open '{}' for writing.", mTemporaryFilePath));
+				}
+				mChecksums = std::make_unique<checksumming_streambuf>(*mOfstream->rdbuf(), aOptions.mChecksumBlockSize);
+				std::streambuf* sink = mChecksums.get();
+				if (aOptions.mCompressed) {
+					mCompressor = std::make_unique<block_compressing_streambuf>(*sink, SERIALIZER_CACHE_FILE_VERSION, aOptions.mCompressionBlockSize);
+					sink = mCompressor.get();
+				}
+				if (aOptions.mWriteBehind) {
+					mWriteBehind = std::make_unique<write_behind_streambuf>(*sink, aOptions.mWriteBehindBufferSize, aOptions.mWriteBehindMaxQueuedBuffers);
+					sink = mWriteBehind.get();
+				}
+				mStream = std::make_unique<std::ostream>(sink);
+				mArchive = std::make_unique<cereal::BinaryOutputArchive>(*mStream);
+			}
 
+			serialize(serialize&&) noexcept = default;
 			serialize(const serialize&) = delete;
-			serialize& operator=(serialize&&) noexcept = default;
+			/* Swaps with other serialize, so that the previous state is torn down in order by the destructor of aOther */
+			serialize& operator=(serialize&& aOther) noexcept
+			{
+				std::swap(mCacheFilePath, aOther.mCacheFilePath);
+				std::swap(mTemporaryFilePath, aOther.mTemporaryFilePath);
+				std::swap(mOfstream, aOther.mOfstream);
+				std::swap(mChecksums, aOther.mChecksums);
+				std::swap(mCompressor, aOther.mCompressor);
+				std::swap(mWriteBehind, aOther.mWriteBehind);
+				std::swap(mStream, aOther.mStream);
+				std::swap(mArchive, aOther.mArchive);
+				return *this;
+			}
 			serialize& operator=(const serialize&) = delete;
-			~serialize() = default;
+
+			~serialize()
+			{
+				close();
+			}
 
 			/** @brief Serializes an Object
 			 *
@@ -264,28 +694,114 @@ namespace avk {
 			template<typename Type>
 			void operator()(Type&& aValue)
 			{
-				mArchive(std::forward<Type>(aValue));
+				(*mArchive)(std::forward<Type>(aValue));
 			}
 
 			/** @brief Flush the underlying output stream
 			 *
 			 *  This function can be used to explicitely flush the underlying outputstream
-			 *  and requests all data to be written.
+			 *  and requests all data to be written. In write-behind mode, it blocks until the
+			 *  background thread has written all data. If the file is block-compressed, the
+			 *  current, possibly incomplete, block is compressed and written.
+			 *  Throws an avk::runtime_error if writing has failed.
 			 */
 			void flush()
 			{
-				mOfstream.flush();
+				mStream->flush();
+				mOfstream->flush();
+				if (!*mStream || !*mOfstream) {
+					throw avk::runtime_error("Failed to write the cache file.");
+				}
+			}
+
+			/** @brief Writes all remaining data and the checksums, and replaces the cache file with the temporary file
+			 *
+			 *  Does nothing if it has been invoked before. Throws an avk::runtime_error if writing has failed.
+			 */
+			void commit()
+			{
+				if (!mOfstream) {
+					return;
+				}
+				flush();
+				if (mCompressor) {
+					const auto& statistics = mCompressor->statistics();
+					LOG_DEBUG(std::format("Compressed cache file: {} bytes in {} blocks, ratio {:.2f}, {:.1f} MB/s per thread",
+						statistics.mUncompressedBytes, statistics.mBlocks, statistics.compression_ratio(), statistics.throughput() / 1e6));
+				}
+				// All data has been passed on to mChecksums => the checksums are the last part of the file:
+				mChecksums->finish(SERIALIZER_CACHE_FILE_VERSION);
+				mArchive.reset();
+				mStream.reset();
+				mWriteBehind.reset();
+				mCompressor.reset();
+				mChecksums.reset();
+				mOfstream->close();
+				if (!*mOfstream) {
+					throw avk::runtime_error(std::format("Failed to write '{}'.", mTemporaryFilePath));
+				}
+				mOfstream.reset();
+				std::filesystem::rename(mTemporaryFilePath, mCacheFilePath);
+			}
+
+			/** @brief Closes and removes the temporary file without replacing the cache file, unless commit() has been invoked before
+			 */
+			void close()
+			{
+				if (!mOfstream) {
+					return;
+				}
+				mArchive.reset();
+				mStream.reset();
+				mWriteBehind.reset();
+				mCompressor.reset();
+				mChecksums.reset();
+				mOfstream.reset();
+				std::error_code errorCode;
+				std::filesystem::remove(mTemporaryFilePath, errorCode);
+			}
+
+			/** @brief Returns the number of (uncompressed) bytes written so far
+			 */
+			size_t position()
+			{
+				return static_cast<size_t>(mStream->tellp());
+			}
+
+			bool is_compressed() const
+			{
+				return static_cast<bool>(mCompressor);
+			}
+
+			bool is_corrupted() const
+			{
+				return false;
+			}
+
+			std::optional<block_compression_statistics> compression_statistics() const
+			{
+				if (!mCompressor) {
+					return {};
+				}
+				if (mWriteBehind) {
+					// The compressor is used by the background thread while it writes:
+					mWriteBehind->wait_until_written();
+				}
+				return mCompressor->statistics();
 			}
 		};
 
 		/** @brief deserialize
 		 *
 		 *  This type represents an input archive to retrieve data in binary form from a file.
+		 *  Every block of the file is verified against its checksum when it is read.
 		 */
 		class deserialize
 		{
-			std::ifstream mIfstream;
-			cereal::BinaryInputArchive mArchive;
+			std::unique_ptr<std::ifstream> mIfstream;
+			std::unique_ptr<verifying_streambuf> mVerifier;
+			std::unique_ptr<std::istream> mStream;
+			std::unique_ptr<cereal::BinaryInputArchive> mArchive;
 
 		public:
 			deserialize() = delete;
@@ -293,18 +809,19 @@ namespace avk {
 			/** @brief Construct, reading a binary file from the provided file
 			 *
 			 *  @param[in] aCacheFilePath The filename including the full path to the binary cached file
+			 *  @param[in] aChecksums The checksums of the cache file
 			 */
-			deserialize(const std::string_view aCacheFilePath) :
-				mIfstream(aCacheFilePath.data(), std::ios::binary),
-				mArchive(mIfstream)
-			{}
-
-			/* Construct from other deserialize */
-			deserialize(deserialize&& aOther) noexcept :
-				mIfstream(std::move(aOther.mIfstream)),
-				mArchive(mIfstream)
-			{}
+			deserialize(const std::string_view aCacheFilePath, cache_file_checksums aChecksums) :
+				mIfstream(std::make_unique<std::ifstream>(std::string(aCacheFilePath), std::ios::binary)),
+				mVerifier(std::make_unique<verifying_streambuf>(*mIfstream->rdbuf(), std::move(aChecksums))),
+				mStream(std::make_unique<std::istream>(mVerifier.get())),
+				mArchive(std::make_unique<cereal::BinaryInputArchive>(*mStream))
+			{
+				// Let checksum mismatches reach the caller:
+				mStream->exceptions(std::ios::badbit);
+			}
 
+			deserialize(deserialize&&) noexcept = default;
 			deserialize(const deserialize&) = delete;
 			deserialize& operator=(deserialize&&) noexcept = default;
 			deserialize& operator=(const deserialize&) = delete;
@@ -318,13 +835,388 @@ namespace avk {
 			 */
 			template<typename Type>
 			void operator()(Type&& aValue)
+			{
+				(*mArchive)(std::forward<Type>(aValue));
+			}
+
+			/** @brief Closes the file
+			 */
+			void close()
+			{
+				mArchive.reset();
+				mStream.reset();
+				mVerifier.reset();
+				mIfstream.reset();
+			}
+
+			/** @brief Returns the number of bytes read so far
+			 */
+			size_t position()
+			{
+				return static_cast<size_t>(mStream->tellg());
+			}
+
+			bool is_compressed() const
+			{
+				return false;
+			}
+
+			bool is_corrupted() const
+			{
+				return mVerifier && mVerifier->has_failed();
+			}
+
+			std::optional<block_compression_statistics> compression_statistics() const
+			{
+				return {};
+			}
+		};
+
+		/** @brief deserialize_mapped
+		 *
+		 *  This type represents an input archive to retrieve data in binary form from a memory mapped file.
+		 *  The file is verified against its checksums by a background thread, ahead of the archive.
+		 */
+		class deserialize_mapped
+		{
+			avk::memory_mapped_file mFile;
+			std::unique_ptr<checksum_verifier> mVerifier;
+			mapped_binary_input_archive mArchive;
+
+		public:
+			deserialize_mapped() = delete;
+
+			/** @brief Construct, memory mapping the provided file for reading
+			 *
+			 *  @param[in] aCacheFilePath The filename including the full path to the binary cached file
+			 *  @param[in] aChecksums The checksums of the cache file
+			 */
+			deserialize_mapped(const std::string_view aCacheFilePath, cache_file_checksums aChecksums) :
+				mFile(std::filesystem::path(aCacheFilePath)),
+				mVerifier(std::make_unique<checksum_verifier>(std::span<const std::byte>(mFile.data(), mFile.size()), aChecksums)),
+				mArchive(mFile.data(), mFile.data() + std::min<size_t>(mFile.size(), static_cast<size_t>(aChecksums.mPayloadSize)), mVerifier.get())
+			{}
+
+			/* Construct from other deserialize_mapped; the mapping, and hence the current position, stay valid */
+			deserialize_mapped(deserialize_mapped&& aOther) noexcept :
+				mFile(std::move(aOther.mFile)),
+				mVerifier(std::move(aOther.mVerifier)),
+				mArchive(aOther.mArchive.cursor(), aOther.mArchive.cursor() + aOther.mArchive.remaining(), mVerifier.get())
+			{}
+
+			deserialize_mapped(const deserialize_mapped&) = delete;
+			deserialize_mapped& operator=(deserialize_mapped&&) noexcept = default;
+			deserialize_mapped& operator=(const deserialize_mapped&) = delete;
+			~deserialize_mapped() = default;
+
+			/** @brief Deserializes an Object
+			 *
+			 *  This function deserializes the object from the mapped file.
+			 *
+			 *  @param[in] aValue The object to fill from file
+			 */
+			template<typename Type>
+			void operator()(Type&& aValue)
 			{
 				mArchive(std::forward<Type>(aValue));
 			}
+
+			/** @brief Skips aSize bytes of the mapped file and returns a pointer to the first of them
+			 */
+			const std::byte* consume(size_t aSize)
+			{
+				return mArchive.consume(aSize);
+			}
+
+			/** @brief Returns the number of bytes that have not been deserialized yet
+			 */
+			size_t remaining() const
+			{
+				return mArchive.remaining();
+			}
+
+			/** @brief Stops the verification and unmaps the file
+			 */
+			void close()
+			{
+				mVerifier.reset();
+				auto file = std::move(mFile);
+			}
+
+			/** @brief Returns the number of bytes deserialized so far
+			 */
+			size_t position()
+			{
+				return static_cast<size_t>(mArchive.cursor() - mFile.data());
+			}
+
+			bool is_compressed() const
+			{
+				return false;
+			}
+
+			bool is_corrupted() const
+			{
+				return mVerifier && mVerifier->has_failed();
+			}
+
+			std::optional<block_compression_statistics> compression_statistics() const
+			{
+				return {};
+			}
 		};
 
-		std::variant<deserialize, serialize> mArchive;
+		/** @brief deserialize_compressed
+		 *
+		 *  This type represents an input archive to retrieve data in binary form from a memory mapped,
+		 *  block-compressed file. The blocks are decompressed by worker threads ahead of the archive,
+		 *  after they have been verified against the file's checksums by a background thread.
+		 */
+		class deserialize_compressed
+		{
+			avk::memory_mapped_file mFile;
+			std::unique_ptr<checksum_verifier> mVerifier;
+			std::unique_ptr<block_decompressing_streambuf> mDecompressor;
+			std::unique_ptr<std::istream> mStream;
+			std::unique_ptr<cereal::BinaryInputArchive> mArchive;
+
+		public:
+			deserialize_compressed() = delete;
+
+			/** @brief Construct, memory mapping the provided block-compressed file for reading
+			 *
+			 *  @param[in] aCacheFilePath The filename including the full path to the binary cached file
+			 *  @param[in] aChecksums The checksums of the cache file
+			 */
+			deserialize_compressed(const std::string_view aCacheFilePath, cache_file_checksums aChecksums) :
+				mFile(std::filesystem::path(aCacheFilePath))
+			{
+				const auto payload = std::span<const std::byte>(mFile.data(), std::min<size_t>(mFile.size(), static_cast<size_t>(aChecksums.mPayloadSize)));
+				mVerifier = std::make_unique<checksum_verifier>(payload, std::move(aChecksums));
+				try {
+					mDecompressor = std::make_unique<block_decompressing_streambuf>(payload, 0, [verifier = mVerifier.get()](std::span<const std::byte> aBlock) {
+						verifier->verify(aBlock.data() + aBlock.size());
+					});
+				}
+				catch (const avk::runtime_error&) {
+					// The block headers have been read before they have been verified => report corrupted ones as such:
+					mVerifier->verify(payload.data() + payload.size());
+					throw;
+				}
+				mStream = std::make_unique<std::istream>(mDecompressor.get());
+				mArchive = std::make_unique<cereal::BinaryInputArchive>(*mStream);
+				// Let decompression errors of the worker threads reach the caller:
+				mStream->exceptions(std::ios::badbit);
+			}
+
+			deserialize_compressed(deserialize_compressed&&) noexcept = default;
+			deserialize_compressed(const deserialize_compressed&) = delete;
+			/* Swaps with other deserialize_compressed, so that the workers are stopped before the previous file is unmapped */
+			deserialize_compressed& operator=(deserialize_compressed&& aOther) noexcept
+			{
+				std::swap(mFile, aOther.mFile);
+				std::swap(mVerifier, aOther.mVerifier);
+				std::swap(mDecompressor, aOther.mDecompressor);
+				std::swap(mStream, aOther.mStream);
+				std::swap(mArchive, aOther.mArchive);
+				return *this;
+			}
+			deserialize_compressed& operator=(const deserialize_compressed&) = delete;
+
+			~deserialize_compressed()
+			{
+				if (!mDecompressor) {
+					return;
+				}
+				const auto statistics = mDecompressor->statistics();
+				LOG_DEBUG(std::format("Decompressed cache file: {} bytes in {} blocks, ratio {:.2f}, {:.1f} MB/s per thread",
+					statistics.mUncompressedBytes, statistics.mBlocks, statistics.compression_ratio(), statistics.throughput() / 1e6));
+			}
+
+			/** @brief Deserializes an Object
+			 *
+			 *  This function deserializes the object from the decompressed stream.
+			 *
+			 *  @param[in] aValue The object to fill from file
+			 */
+			template<typename Type>
+			void operator()(Type&& aValue)
+			{
+				(*mArchive)(std::forward<Type>(aValue));
+			}
+
+			/** @brief Stops the workers and the verification and unmaps the file
+			 */
+			void close()
+			{
+				mArchive.reset();
+				mStream.reset();
+				mDecompressor.reset();
+				mVerifier.reset();
+				auto file = std::move(mFile);
+			}
+
+			/** @brief Returns the number of (uncompressed) bytes read so far
+			 */
+			size_t position()
+			{
+				return static_cast<size_t>(mStream->tellg());
+			}
+
+			bool is_compressed() const
+			{
+				return true;
+			}
+
+			bool is_corrupted() const
+			{
+				return mVerifier && mVerifier->has_failed();
+			}
+
+			std::optional<block_compression_statistics> compression_statistics() const
+			{
+				return mDecompressor->statistics();
+			}
+		};
+
+		using archive_variant = std::variant<deserialize, serialize, deserialize_mapped, deserialize_compressed>;
+
+		/** @brief Creates the archive for the given mode, see the constructor of serializer
+		 */
+		static archive_variant create_archive(std::string_view aCacheFilePath, enum mode aMode, const serializer_options& aOptions)
+		{
+			if (aMode == serializer::mode::serialize) {
+				return archive_variant{ serializer::serialize(aCacheFilePath, aOptions) };
+			}
+			auto checksums = read_cache_file_checksums(std::filesystem::path(aCacheFilePath), SERIALIZER_CACHE_FILE_VERSION);
+			if (!checksums.has_value()) {
+				if (!does_cache_file_have_current_version(aCacheFilePath)) {
+					throw std::runtime_error("Versions of serializer and cache file do not match. Please delete the existing cache file and let it be recreated!");
+				}
+				throw cache_file_corrupted_error(std::format("Cache file '{}' is incomplete. Please delete it and let it be recreated!", aCacheFilePath));
+			}
+			try {
+				if (is_block_compressed_file(std::filesystem::path(aCacheFilePath))) {
+					// Compressed blocks are always decompressed from the mapped file:
+					return archive_variant{ serializer::deserialize_compressed(aCacheFilePath, std::move(checksums.value())) };
+				}
+				if (aOptions.mMemoryMapped) {
+					try {
+						return archive_variant{ serializer::deserialize_mapped(aCacheFilePath, checksums.value()) };
+					}
+					catch (const avk::runtime_error& e) {
+						LOG_WARNING(std::format("Falling back to stream-based deserialization: {}", e.what()));
+					}
+				}
+				return archive_variant{ serializer::deserialize(aCacheFilePath, std::move(checksums.value())) };
+			}
+			catch (const cache_file_corrupted_error&) {
+				remove_corrupted_cache_file(std::string(aCacheFilePath));
+				throw;
+			}
+		}
+
+		/** @brief Removes a corrupted cache file and its dependency record, so that it is regenerated the next time
+		 */
+		static void remove_corrupted_cache_file(const std::string& aCacheFilePath)
+		{
+			LOG_WARNING(std::format("Cache file '{}' is corrupted. It has been removed and will be regenerated.", aCacheFilePath));
+			remove_cache_dependency_record(aCacheFilePath);
+			std::error_code errorCode;
+			std::filesystem::remove(aCacheFilePath, errorCode);
+		}
+
+		/** @brief Determines the mode for a cache file without dependencies, see the constructor of serializer
+		 */
+		static enum mode select_mode_for_cache_file(std::string_view aCacheFilePath)
+		{
+			if (!does_cache_file_have_current_version(aCacheFilePath)) {
+				return mode::serialize;
+			}
+			if (!is_cache_file_complete(aCacheFilePath)) {
+				LOG_WARNING(std::format("Cache file '{}' is incomplete and will be regenerated.", aCacheFilePath));
+				return mode::serialize;
+			}
+			return mode::deserialize;
+		}
+
+		/** @brief Determines the mode for the given dependencies, see the constructor of serializer
+		 */
+		static enum mode select_mode_for_dependencies(std::string_view aCacheFilePath, const cache_dependencies& aDependencies)
+		{
+			if (is_cache_up_to_date(aCacheFilePath, aDependencies)) {
+				if (is_cache_file_complete(aCacheFilePath)) {
+					return mode::deserialize;
+				}
+				LOG_WARNING(std::format("Cache file '{}' is incomplete and will be regenerated.", aCacheFilePath));
+			}
+			// Remove the record before the cache file is overwritten, so that an incompletely written cache file is never considered up to date:
+			remove_cache_dependency_record(aCacheFilePath);
+			return mode::serialize;
+		}
+
+		archive_variant mArchive;
+		std::string mCacheFilePath;
+		std::unique_ptr<cache_dependencies> mDependencies;
+		/** Number of uncaught exceptions when the serializer has been constructed */
+		int mUncaughtExceptions = 0;
 	};
+
+	/** @brief Invokes a function with a serializer for a cache file, regenerating the cache file if it turns out to be corrupted
+	 *
+	 *  Constructs a serializer from aCacheFilePath and aDependencies (see the corresponding constructor
+	 *  of serializer) and invokes aFunction with it. If a cache_file_corrupted_error is thrown while
+	 *  the cache file is deserialized, the serializer removes the cache file, and aFunction is invoked
+	 *  once more with a serializer in serialization mode, which regenerates the cache file. Therefore,
+	 *  aFunction must not have any effects which remain when it throws.
+	 *
+	 *  @param[in] aCacheFilePath The path to the cache file
+	 *  @param[in] aDependencies The files and settings the cache file's content is generated from
+	 *  @param[in] aFunction Function which takes a serializer& and (de)serializes the cache file's content
+	 *  @param[in] aOptions Memory mapping and compression options, see serializer_options
+	 *  @return The result of aFunction
+	 *
+	 *  @example
+	 *		auto [positionsBuffer, indicesBuffer, commands] = avk::with_serializer(pathToModel + ".cache", avk::cache_dependencies{}.add_file(pathToModel),
+	 *			[&](avk::serializer& aSerializer) { return avk::create_vertex_and_index_buffers_cached(aSerializer, modelAndMeshes); });
+	 */
+	template<typename F>
+	auto with_serializer(std::string_view aCacheFilePath, const cache_dependencies& aDependencies, F&& aFunction, serializer_options aOptions = {})
+	{
+		try {
+			auto s = serializer(aCacheFilePath, aDependencies, aOptions);
+			return aFunction(s);
+		}
+		catch (const cache_file_corrupted_error& e) {
+			LOG_WARNING(std::format("Regenerating cache file '{}': {}", aCacheFilePath, e.what()));
+		}
+		auto s = serializer(aCacheFilePath, aDependencies, aOptions);
+		return aFunction(s);
+	}
+
+	/** @brief Invokes a function with a serializer for a cache file without dependencies, regenerating the cache file if it turns out to be corrupted
+	 *
+	 *  Like the overload with dependencies, but constructs the serializer from aCacheFilePath only (see the
+	 *  corresponding constructor of serializer), i.e., the cache file is only regenerated if it does not
+	 *  exist, has been written by a different SERIALIZER_CACHE_FILE_VERSION, is incomplete, or is corrupted.
+	 *
+	 *  @param[in] aCacheFilePath The path to the cache file
+	 *  @param[in] aFunction Function which takes a serializer& and (de)serializes the cache file's content
+	 *  @return The result of aFunction
+	 */
+	template<typename F>
+	auto with_serializer(std::string_view aCacheFilePath, F&& aFunction)
+	{
+		try {
+			auto s = serializer(aCacheFilePath);
+			return aFunction(s);
+		}
+		catch (const cache_file_corrupted_error& e) {
+			LOG_WARNING(std::format("Regenerating cache file '{}': {}", aCacheFilePath, e.what()));
+		}
+		auto s = serializer(aCacheFilePath);
+		return aFunction(s);
+	}
 }
 
 /** @brief Custom Serialization Functions
@@ -542,6 +1434,42 @@ namespace avk {
 		);
 	}
 
+	template<typename Archive>
+	void serialize(Archive& aArchive, avk::compressed_vec3_key& aValue)
+	{
+		aArchive(
+			aValue.mTime,
+			aValue.mValue
+		);
+	}
+
+	template<typename Archive>
+	void serialize(Archive& aArchive, avk::compressed_rotation_key& aValue)
+	{
+		aArchive(
+			aValue.mTime,
+			aValue.mValue
+		);
+	}
+
+	template<typename Archive>
+	void serialize(Archive& aArchive, avk::compressed_vec3_keys& aValue)
+	{
+		aArchive(
+			aValue.mRangeMin,
+			aValue.mRangeExtent,
+			aValue.mKeys
+		);
+	}
+
+	template<typename Archive>
+	void serialize(Archive& aArchive, avk::compressed_rotation_keys& aValue)
+	{
+		aArchive(
+			aValue.mKeys
+		);
+	}
+
 	template<typename Archive>
 	void serialize(Archive& aArchive, avk::mesh_bone_info& aValue)
 	{
@@ -567,11 +1495,16 @@ namespace avk {
 	void serialize(Archive& aArchive, avk::animated_node& aValue)
 	{
 		aArchive(
+			aValue.mNodeName,
 			aValue.mPositionKeys,
 			aValue.mRotationKeys,
 			aValue.mScalingKeys,
 			aValue.mSameRotationAndPositionKeyTimes,
 			aValue.mSameScalingAndPositionKeyTimes,
+			aValue.mHasCompressedKeys,
+			aValue.mCompressedPositionKeys,
+			aValue.mCompressedRotationKeys,
+			aValue.mCompressedScalingKeys,
 			aValue.mLocalTransform,
 			aValue.mGlobalTransform,
 			aValue.mAnimatedParentIndex,
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "mip_map_generation.hpp"
+
+namespace avk
+{
+	/** Block-compressed formats which image data can be encoded to on the CPU, see compress_blocks */
+	enum struct texture_block_format
+	{
+		/** RGB, 4 bit per pixel; for opaque color textures */
+		bc1,
+		/** RGBA, 8 bit per pixel; for color textures with alpha */
+		bc3,
+		/** R, 4 bit per pixel; for single-channel textures */
+		bc4,
+		/** RG, 8 bit per pixel; for two-channel textures and normal maps */
+		bc5,
+		/** Unsigned HDR RGB, 8 bit per pixel; encoded with a single partition */
+		bc6h,
+		/** RGBA, 8 bit per pixel; encoded with a single partition only (mode 6), which is fast, but still better than BC1 and BC3 */
+		bc7
+	};
+
+	/** Settings for block-compressing textures on the CPU, see choose_texture_block_format and compress_image_data_for_usage */
+	struct texture_compression
+	{
+		/** Encode 8 bit color textures to BC7 rather than to BC1 (if opaque) or BC3 (if translucent) */
+		bool mPreferBc7 = false;
+		/** Encode normal maps to BC5, which stores their x and y components only. Shaders which sample them
+		 *  must reconstruct the z component, i.e., z = sqrt(1 - x*x - y*y) after mapping x and y to [-1, 1].
+		 *  If false, normal maps are encoded like color textures.
+		 */
+		bool mNormalMapsToBc5 = false;
+		/** Encode HDR textures to BC6H, which clamps negative values to zero */
+		bool mCompressHdr = true;
+	};
+
+	/**	Chooses the block-compressed format for image data with the given format.
+	 *	@param	aFormat					The format of the image data
+	 *	@param	aBytesPerPixel			The actual number of bytes per pixel of the image data, see mip_map_pixel_layout_for
+	 *	@param	aHasTranslucentPixels	True if any pixel has an alpha value less than 1
+	 *	@param	aSettings				Which formats to prefer
+	 *	@param	aIsNormalMap			True if the image data is a normal map
+	 *	@return	The block-compressed format, or {} if the image data can not be encoded on the CPU, e.g., because it is block-compressed already
+	 */
+	extern std::optional<texture_block_format> choose_texture_block_format(vk::Format aFormat, size_t aBytesPerPixel, bool aHasTranslucentPixels, const texture_compression& aSettings, bool aIsNormalMap = false);
+
+	/**	Returns the Vulkan format of image data which has been encoded to the given block-compressed format.
+	 *	@param	aBlockFormat	The block-compressed format
+	 *	@param	aSrgb			True if the source data is sRGB-encoded; only BC1, BC3, and BC7 have sRGB variants
+	 */
+	extern vk::Format vulkan_format_of(texture_block_format aBlockFormat, bool aSrgb);
+
+	/**	Returns the size of a level of the given extent, in bytes, if it is encoded to the given block-compressed format.
+	 *	Levels whose width or height is not a multiple of 4 are padded to complete blocks.
+	 */
+	extern size_t compressed_size(texture_block_format aBlockFormat, uint32_t aWidth, uint32_t aHeight);
+
+	/**	Returns true if any pixel of the given image data has an alpha value less than 1, i.e., less than 255 for 8 bit data.
+	 *	Always returns false for pixels without an alpha channel, i.e., with less than four channels.
+	 */
+	extern bool has_translucent_pixels(const mip_map_pixel_layout& aLayout, const std::byte* aPixels, uint32_t aWidth, uint32_t aHeight);
+
+	/** A level of one face of image data which shall be encoded by compress_blocks */
+	struct texture_compression_surface
+	{
+		/** The pixels, tightly packed */
+		const std::byte* mPixels = nullptr;
+		uint32_t mWidth = 0;
+		uint32_t mHeight = 0;
+		/** Target memory of compressed_size(aBlockFormat, mWidth, mHeight) bytes */
+		std::byte* mBlocks = nullptr;
+	};
+
+	/**	Encodes the given surfaces, e.g., all levels and faces of image data, to a block-compressed format.
+	 *	All blocks of all surfaces are distributed among the threads, so that small levels do not stall them.
+	 *	@param	aBlockFormat	The block-compressed format, as returned by choose_texture_block_format for the pixel layout
+	 *	@param	aLayout			The pixel layout of all surfaces
+	 *	@param	aSurfaces		The surfaces
+	 *	@param	aNumThreads		Number of threads which encode blocks, or 0 to choose one based on the hardware
+	 */
+	extern void compress_blocks(texture_block_format aBlockFormat, const mip_map_pixel_layout& aLayout, const std::vector<texture_compression_surface>& aSurfaces, unsigned int aNumThreads = 0);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "image_data.hpp"
+#include "upload_batcher.hpp"
+
+namespace avk
+{
+	/** Settings for packing material textures into fewer images, see pack_textures and convert_for_gpu_usage_packed */
+	struct texture_packing
+	{
+		/** Textures with the same format, size, and number of levels are packed into 2D texture arrays if there are
+		 *  at least this many of them; 0 disables texture arrays */
+		uint32_t mMinArrayLayers = 2;
+		/** The maximum number of layers of a texture array; every device supports at least 256 */
+		uint32_t mMaxArrayLayers = 256;
+		/** Uncompressed textures whose width and height do not exceed this are packed into atlases; 0 disables atlases.
+		 *  Only textures which are clamped to edge, and whose offset and tiling keep texture coordinates in [0, 1] are
+		 *  packed, since neighboring textures would be sampled otherwise. Hence, it must also be disabled if meshes
+		 *  have texture coordinates outside of [0, 1] which rely on being clamped. Atlases have no mipmaps.
+		 */
+		uint32_t mMaxAtlasTextureExtent = 16;
+		/** The width and height of atlases */
+		uint32_t mAtlasExtent = 512;
+	};
+
+	/** Texture indices which refer to a layer of a texture array have this bit set. Their bits 16 to 29 contain the layer,
+	 *  and their bits 0 to 15 the index of the image sampler of the texture array. They can be sampled in shaders like follows:
+	 *
+	 *	layout(set = 0, binding = 0) uniform sampler2D textures[];
+	 *	layout(set = 0, binding = 1) uniform sampler2DArray textureArrays[];
+	 *
+	 *	vec4 sampleMaterialTexture(int texIndex, vec2 uv)
+	 *	{
+	 *		if ((texIndex & (1 << 30)) != 0) {
+	 *			return texture(textureArrays[nonuniformEXT(texIndex & 0xFFFF)], vec3(uv, float((texIndex >> 16) & 0x3FFF)));
+	 *		}
+	 *		return texture(textures[nonuniformEXT(texIndex)], uv);
+	 *	}
+	 */
+	static constexpr int32_t cTextureArrayIndexBit = 1 << 30;
+
+	/** Returns the texture index of the given layer of the texture array with the given image sampler, see cTextureArrayIndexBit */
+	static constexpr int32_t make_texture_array_index(uint32_t aArrayImageSamplerIndex, uint32_t aLayer)
+	{
+		return cTextureArrayIndexBit | static_cast<int32_t>((aLayer & 0x3FFFu) << 16) | static_cast<int32_t>(aArrayImageSamplerIndex & 0xFFFFu);
+	}
+
+	/** How a texture is sampled by a group of materials, which share the same sampler */
+	struct packable_texture_usage
+	{
+		std::array<avk::border_handling_mode, 2> mBorderHandlingModes;
+		/** True if the offset and tiling of all materials keep texture coordinates in [0, 1] */
+		bool mWithinUnitSquare = false;
+	};
+
+	/** Where a packed texture has been placed */
+	struct packed_texture
+	{
+		/** The index of the image sampler, which is encoded with make_texture_array_index if it refers to a texture array */
+		int32_t mIndex = -1;
+		/** Texture coordinates must be scaled by this and offset by mOffset to address the texture in an atlas */
+		glm::vec2 mScale = glm::vec2{ 1.0f };
+		glm::vec2 mOffset = glm::vec2{ 0.0f };
+	};
+
+	/**	Loads the given textures in parallel, and creates as few images as possible for them: textures which are small enough are
+	 *	packed into atlases, textures with the same format, size, and number of levels into texture arrays, and all others are
+	 *	created as individual images. Mipmaps are generated on the CPU if aImageUsage is mip-mapped.
+	 *	@param	aImageData					The textures, which need not have been loaded
+	 *	@param	aUsages						For each texture, how it is sampled; every usage gets its own sampler
+	 *	@param	aImageUsage					How the images are going to be used
+	 *	@param	aTextureFilterMode			Texture filtering mode for all the samplers
+	 *	@param	aPacking					Which textures to pack
+	 *	@param	aImageSamplers				The image samplers of atlases and individual images are appended to this
+	 *	@param	aArrayImageSamplers			The image samplers of texture arrays are appended to this
+	 *	@param	aCommands					Commands which upload the images are appended to this
+	 *	@param	aNumThreads					Number of threads which load textures, or 0 to choose one based on the hardware, see load_image_data_in_parallel
+	 *	@param	aUploadBatcher				If set, the images are uploaded by the batcher instead of by aCommands; it is not flushed
+	 *	@return	For each texture, and each of its usages, where it has been placed
+	 */
+	extern std::vector<std::vector<packed_texture>> pack_textures(
+		std::vector<image_data>& aImageData,
+		const std::vector<std::vector<packable_texture_usage>>& aUsages,
+		avk::image_usage aImageUsage,
+		avk::filter_mode aTextureFilterMode,
+		const texture_packing& aPacking,
+		std::vector<avk::image_sampler>& aImageSamplers,
+		std::vector<avk::image_sampler>& aArrayImageSamplers,
+		avk::command::action_type_command& aCommands,
+		unsigned int aNumThreads = 0,
+		std::optional<std::reference_wrapper<avk::upload_batcher>> aUploadBatcher = {});
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "image_data.hpp"
+
+namespace avk
+{
+	/**	Identifies a texture by its content, i.e., by its pixel data, format, and dimensions,
+	 *	regardless of the file it has been loaded from. See texture_registry.
+	 */
+	struct texture_key
+	{
+		/** content_hash of the pixel data of all levels and faces */
+		std::uint64_t mContentHash = 0;
+		vk::Format mFormat = vk::Format::eUndefined;
+		std::uint32_t mWidth = 0;
+		std::uint32_t mHeight = 0;
+		std::uint32_t mFaces = 0;
+		std::uint32_t mLevels = 0;
+		/** The usage the image is created with; identical pixel data with a different usage is a different texture */
+		avk::image_usage mImageUsage = avk::image_usage::general_texture;
+
+		bool operator==(const texture_key&) const = default;
+	};
+}
+
+namespace std // Inject hash for `avk::texture_key` into std::
+{
+	template<> struct hash<avk::texture_key>
+	{
+		std::size_t operator()(avk::texture_key const& o) const noexcept
+		{
+			// The content hash is a good hash already; the other members only distinguish rare collisions:
+			std::size_t h = static_cast<std::size_t>(o.mContentHash);
+			avk::hash_combine(h, static_cast<int>(o.mFormat), o.mWidth, o.mHeight, o.mFaces, o.mLevels, static_cast<int>(o.mImageUsage));
+			return h;
+		}
+	};
+}
+
+namespace avk
+{
+	/**	Computes the key of the given image data by hashing its pixel data.
+	 *	@param	aImageData		Loaded image data
+	 *	@param	aImageUsage		The usage the image is going to be created with
+	 */
+	extern texture_key make_texture_key(const image_data& aImageData, avk::image_usage aImageUsage);
+
+	/**	Computes the key of a 1x1 px texture, as created by create_1px_texture_cached.
+	 *	@param	aColor			The color of the single pixel
+	 *	@param	aFormat			The format the image is created with
+	 *	@param	aImageUsage		The usage the image is going to be created with
+	 */
+	extern texture_key make_texture_key(std::array<uint8_t, 4> aColor, vk::Format aFormat, avk::image_usage aImageUsage);
+
+	/** @brief texture_registry
+	 *
+	 *  Shares a single image and image view among all identical textures, i.e., textures with the same texture_key,
+	 *  even if they have been loaded from different files or for different models. Every registered texture has a
+	 *  reference count: acquire() and add() increment it, release() decrements it, and a texture is removed from
+	 *  the registry when its count drops to zero. The image itself is destroyed as soon as no image sampler refers
+	 *  to it anymore.
+	 *
+	 *  convert_for_gpu_usage_cached acquires every distinct texture once per invocation, hence, the textures of its
+	 *  result can be released with release(const std::vector<avk::image_sampler>&) when they are no longer needed.
+	 *  All member functions are thread-safe.
+	 */
+	class texture_registry
+	{
+	public:
+		texture_registry() = default;
+		texture_registry(const texture_registry&) = delete;
+		texture_registry& operator=(const texture_registry&) = delete;
+		~texture_registry() = default;
+
+		/** @brief Returns the image view of an identical texture, if one has been registered, and increments its reference count
+		 *  @param[in] aKey The key of the texture
+		 *  @return A shared image view, or {} if no identical texture has been registered
+		 */
+		std::optional<avk::image_view> acquire(const texture_key& aKey);
+
+		/** @brief Registers a texture with a reference count of 1
+		 *  Shared ownership is enabled for the image view. If an identical texture has been registered meanwhile,
+		 *  e.g., by another thread, that one is acquired and returned instead.
+		 *  @param[in] aKey The key of the texture
+		 *  @param[in] aImageView The image view of the texture
+		 *  @return A shared image view of the registered texture
+		 */
+		avk::image_view add(const texture_key& aKey, avk::image_view aImageView);
+
+		/** @brief Decrements the reference count of a texture and removes it from the registry when it drops to zero
+		 *  @param[in] aKey The key of the texture
+		 *  @return True if the texture has been removed from the registry
+		 */
+		bool release(const texture_key& aKey);
+
+		/** @brief Releases every registered texture which is referenced by the given image samplers once,
+		 *  regardless of how many of the image samplers refer to it. Image samplers whose image view has not
+		 *  been registered are ignored.
+		 *  @param[in] aImageSamplers Image samplers, e.g., as returned by convert_for_gpu_usage_cached
+		 *  @return The number of textures which have been removed from the registry
+		 */
+		size_t release(const std::vector<avk::image_sampler>& aImageSamplers);
+
+		/** @brief Returns the reference count of a texture, or 0 if it has not been registered */
+		std::uint32_t reference_count(const texture_key& aKey) const;
+
+		/** @brief Returns the number of registered textures */
+		size_t size() const;
+
+		/** @brief Removes all textures from the registry, regardless of their reference counts */
+		void clear();
+
+	private:
+		struct entry
+		{
+			avk::image_view mImageView;
+			std::uint32_t mReferenceCount = 0;
+		};
+
+		bool release_locked(const texture_key& aKey);
+
+		std::unordered_map<texture_key, entry> mTextures;
+		std::unordered_map<VkImageView, texture_key> mKeysOfImageViews;
+		mutable std::mutex mMutex;
+	};
+}
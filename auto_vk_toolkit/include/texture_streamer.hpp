@@ -0,0 +1,210 @@
+#pragma once
+
+#include "image_data.hpp"
+#include "chunked_cache.hpp"
+#include "upload_batcher.hpp"
+
+namespace avk
+{
+	/** @brief texture_streamer
+	 *
+	 *  Keeps only those mipmap levels of textures resident which are needed, instead of all of them. When a texture is added,
+	 *  only its mip tail is uploaded, i.e., the levels which are not larger than the tail extent. Finer levels are requested
+	 *  per frame, either with a level which has been estimated on the CPU, e.g., from the screen size of the objects which
+	 *  use the texture, or with the levels which the shaders have written into a feedback buffer. Requested levels are loaded
+	 *  asynchronously by worker threads, from a chunked_cache if one is given, or from the texture's source otherwise.
+	 *
+	 *  When levels have been loaded, update() creates a new image containing all resident levels: the levels which were resident
+	 *  before are copied on the GPU, only the new ones are uploaded through an upload_batcher. If the resident levels of all
+	 *  textures would exceed the memory budget, the finest levels of the least recently used textures are evicted first.
+	 *  The image samplers of a texture are replaced whenever its image is replaced; the previous ones are kept alive for the
+	 *  frames in flight of the main window. Hence, descriptors must be built from image_samplers() whenever update() returns true.
+	 *
+	 *  Batches are submitted to the queue which is passed to the constructor. It must be the queue which renders with the
+	 *  textures, since the layout of the previous image is changed temporarily while its levels are copied. The member
+	 *  functions are not thread-safe.
+	 *
+	 *  @example
+	 *		avk::texture_streamer streamer(queue, size_t{ 512 } << 20);
+	 *		auto index = streamer.add_texture("albedo.png", 0, [] { return avk::get_image_data("albedo.png", true, true, true, 4); });
+	 *		streamer.add_sampler(index, avk::context().create_sampler(avk::filter_mode::trilinear, avk::border_handling_mode::repeat));
+	 *		// Every frame:
+	 *		streamer.request_screen_size(index, projectedSizeInPixels);
+	 *		if (streamer.update()) { ... bind streamer.image_samplers() ... }
+	 */
+	class texture_streamer
+	{
+	public:
+		/** Returns the image data of a texture; it is invoked on the calling thread for add_texture, and on worker threads afterwards */
+		using image_data_loader = std::function<image_data()>;
+
+		/** @brief Creates the streamer and its worker threads
+		 *  @param[in] aQueue The queue which uploads are submitted to, see upload_batcher; it must also render with the textures
+		 *  @param[in] aMemoryBudget The maximum size of the resident levels of all textures, in bytes; mip tails are always resident
+		 *  @param[in] aMipTailExtent Levels whose width and height do not exceed this are uploaded when a texture is added, and never evicted
+		 *  @param[in] aNumThreads The number of threads which load levels, or 0 to choose one based on the hardware
+		 *  @param[in] aCache If set, the levels of all textures are stored in and streamed from this cache, s.t. sources are only decoded once.
+		 *             It must outlive the streamer, and while the streamer exists, it must only be saved via save_cache(), since the
+		 *             worker threads read from it concurrently. Levels which are read from it are copied, s.t. they remain valid when it is saved.
+		 */
+		explicit texture_streamer(avk::queue& aQueue, size_t aMemoryBudget, uint32_t aMipTailExtent = 128, unsigned int aNumThreads = 0, std::optional<std::reference_wrapper<avk::chunked_cache>> aCache = {});
+		texture_streamer(const texture_streamer&) = delete;
+		texture_streamer& operator=(const texture_streamer&) = delete;
+		/** @brief Stops the worker threads and waits until all uploads have completed */
+		~texture_streamer();
+
+		/** @brief Adds a texture and uploads its mip tail
+		 *  If a cache has been passed to the constructor and it contains the texture's levels, only the mip tail is read from it.
+		 *  Otherwise, aLoader is invoked, mipmaps are generated on the CPU if aImageUsage is mip-mapped, and all levels are stored in the cache.
+		 *  @param[in] aName A unique name of the texture, e.g., its path; it names its entries in the cache
+		 *  @param[in] aKey The key of the texture's cache entries, e.g., a hash of its source; entries with a different key are replaced
+		 *  @param[in] aLoader Returns the texture's image data, which need not have been loaded
+		 *  @param[in] aImageUsage The usage of the texture's images; they must be 2D images
+		 *  @return The index of the texture
+		 */
+		size_t add_texture(std::string aName, std::uint64_t aKey, image_data_loader aLoader, avk::image_usage aImageUsage = avk::image_usage::general_texture);
+
+		/** @brief Adds an image sampler for the given texture, whose image is replaced whenever the texture's resident levels change
+		 *  @return The index of the image sampler in image_samplers()
+		 */
+		size_t add_sampler(size_t aTexture, avk::sampler aSampler);
+
+		/** @brief Adds an image sampler whose image is not streamed, e.g., of a 1x1 px texture
+		 *  @return The index of the image sampler in image_samplers()
+		 */
+		size_t add_resident_image_sampler(avk::image_sampler aImageSampler);
+
+		/** @brief Requests the given level of the texture which the image sampler at the given index refers to, for the current frame
+		 *  The finest level which is requested for a texture between two invocations of update() is streamed in.
+		 */
+		void request_level(size_t aImageSamplerIndex, uint32_t aLevel);
+
+		/** @brief Requests the level which is needed if the texture of the given image sampler covers the given number of pixels on screen
+		 *  @param[in] aImageSamplerIndex The index of the image sampler in image_samplers()
+		 *  @param[in] aSizeInPixels The size of the texture's [0, 1] texture coordinate range on screen, e.g., a CPU estimate from the
+		 *             projected bounding sphere of the objects which use it, multiplied with their texture coordinate scale
+		 */
+		void request_screen_size(size_t aImageSamplerIndex, float aSizeInPixels);
+
+		/** @brief Requests the levels which have been written into a GPU feedback buffer
+		 *  The bound images only contain the levels from resident_level() on, hence, shaders can only determine levels relative to it.
+		 *  They must write the unclamped LOD, which is negative if finer levels than the resident ones are needed, since the level which
+		 *  is actually sampled is clamped to the resident ones.
+		 *  @param[in] aFinestLevels One entry per image sampler, i.e., per element of image_samplers(): the finest level which the shaders
+		 *             need, relative to the texture's resident level, or std::numeric_limits<int32_t>::max() if it has not been sampled.
+		 *             Shaders can fill such a buffer with atomicMin(feedback[texIndex], int(floor(textureQueryLod(tex, uv).y))), after it
+		 *             has been reset to all 0x7FFFFFFF. It must be applied before update() replaces the images it has been written with.
+		 */
+		void apply_feedback(std::span<const int32_t> aFinestLevels);
+
+		/** @brief Streams in requested levels which have been loaded, evicts levels if the budget is exceeded, and loads requested levels
+		 *  Invoke this once per frame, before the image samplers are bound. The requests of the current frame are reset afterwards.
+		 *  @return true if any image sampler has been replaced, i.e., if descriptors must be updated
+		 */
+		bool update();
+
+		/** @brief Saves the cache which has been passed to the constructor, if any, while no worker thread reads from it
+		 *  Use this instead of chunked_cache::save() while the streamer exists. Throws like chunked_cache::save().
+		 */
+		void save_cache();
+
+		/** @brief The image samplers of all textures, in the order of add_sampler and add_resident_image_sampler */
+		const std::vector<avk::image_sampler>& image_samplers() const { return mImageSamplers; }
+
+		/** @brief The number of mipmap levels of the given texture */
+		uint32_t levels(size_t aTexture) const { return static_cast<uint32_t>(mTextures[aTexture].mLevelSizes.size()); }
+
+		/** @brief The finest level of the given texture which is resident */
+		uint32_t resident_level(size_t aTexture) const { return mTextures[aTexture].mResidentLevel; }
+
+		/** @brief The size of the resident levels of all textures, in bytes */
+		size_t resident_size() const { return mResidentSize; }
+
+	private:
+		/** The levels of a texture which are loaded by a worker thread */
+		struct load_job
+		{
+			size_t mTexture;
+			std::string mName;
+			std::uint64_t mKey;
+			image_data_loader mLoader;
+			avk::image_usage mImageUsage;
+			uint32_t mFaces;
+			uint32_t mFirstLevel;
+			uint32_t mEndLevel;
+		};
+
+		/** The data of the levels of a load_job; it points into mImageData or into mCacheData */
+		struct loaded_levels
+		{
+			size_t mTexture = 0;
+			uint32_t mFirstLevel = 0;
+			/** Levels -> faces -> data */
+			std::vector<std::vector<std::span<const std::byte>>> mData;
+			std::optional<image_data> mImageData;
+			/** The levels which have been read from the cache; they are copied, since the cache's data is invalidated when it is saved */
+			std::vector<std::vector<std::byte>> mCacheData;
+			bool mFailed = false;
+		};
+
+		struct streamed_texture
+		{
+			std::string mName;
+			std::uint64_t mKey = 0;
+			image_data_loader mLoader;
+			avk::image_usage mImageUsage = avk::image_usage::general_texture;
+			vk::Format mFormat = vk::Format::eUndefined;
+			uint32_t mWidth = 0;
+			uint32_t mHeight = 0;
+			uint32_t mFaces = 1;
+			/** The size of all faces of each level */
+			std::vector<size_t> mLevelSizes;
+			/** The first level of the mip tail, which is always resident */
+			uint32_t mTailLevel = 0;
+			uint32_t mResidentLevel = 0;
+			/** The finest level which has been requested since the last update(); mTailLevel if none has been requested */
+			uint32_t mRequestedLevel = 0;
+			bool mLoading = false;
+			/** Set if loading has failed, in which case no further levels are requested */
+			bool mFailed = false;
+			uint64_t mLastUsedFrame = 0;
+			avk::image_view mImageView;
+			/** Indices into mImageSamplers, and their samplers */
+			std::vector<size_t> mImageSamplerIndices;
+			std::vector<avk::sampler> mSamplers;
+		};
+
+		/** Loads the given levels from the cache, or from the job's loader if the cache does not contain all of them */
+		loaded_levels load_levels(const load_job& aJob) const;
+		/** Replaces the image of the given texture by one containing the levels from aFirstLevel on, which are copied from
+		 *  the previous image if they are resident, or uploaded from aLoaded otherwise */
+		void make_resident(streamed_texture& aTexture, uint32_t aFirstLevel, const loaded_levels* aLoaded);
+		/** Evicts levels of the least recently used textures until aSize more bytes fit into the budget; returns false if they do not */
+		bool make_room(size_t aSize, const streamed_texture& aExcluded);
+		size_t size_of_levels(const streamed_texture& aTexture, uint32_t aFirstLevel, uint32_t aEndLevel) const;
+		void worker();
+
+		avk::upload_batcher mUploadBatcher;
+		size_t mMemoryBudget;
+		uint32_t mMipTailExtent;
+		std::optional<std::reference_wrapper<avk::chunked_cache>> mCache;
+		/** Held shared by worker threads while they read from mCache, and exclusively by save_cache() */
+		mutable std::shared_mutex mCacheMutex;
+
+		std::vector<streamed_texture> mTextures;
+		std::vector<avk::image_sampler> mImageSamplers;
+		/** The texture of each image sampler, or {} if it is resident */
+		std::vector<std::optional<size_t>> mImageSamplerTextures;
+		size_t mResidentSize = 0;
+		uint64_t mFrame = 1;
+		/** Set if any image sampler has been replaced since the last update() */
+		bool mReplaced = false;
+
+		std::vector<std::thread> mWorkers;
+		std::mutex mMutex;
+		std::condition_variable mJobsAvailable;
+		std::deque<load_job> mJobs;
+		std::vector<loaded_levels> mLoaded;
+		bool mStopping = false;
+	};
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "context_vulkan.hpp"
+
+namespace avk
+{
+	/** Offsets of staged data are multiples of this, which satisfies the alignment of all block-compressed formats, and of vkCmdCopyBuffer */
+	static constexpr size_t cMinStagingAlignment = 16;
+
+	/** @brief upload_batcher
+	 *
+	 *  Uploads image and buffer data through a single, persistently mapped staging buffer, instead of one staging buffer per
+	 *  level and face. The staging buffer is used as a ring of segments: staging memory is sub-allocated from the current
+	 *  segment, and the copies into it are recorded into a batch. When the segment is full, or when flush() is called, the
+	 *  batch is submitted as a single command buffer, and the next segment is used. Before a segment is reused, the fence of
+	 *  its last batch is waited on, i.e., the CPU is throttled if it produces data faster than the GPU copies it.
+	 *  Data which does not fit into a segment is uploaded through a dedicated staging buffer within the current batch.
+	 *
+	 *  All resources which data is copied to must stay alive until their batch has completed, e.g., until wait_idle() returns.
+	 *  Commands which depend on the uploaded data must be submitted to the same queue after flush(), or after wait_idle()
+	 *  to any queue. The member functions are not thread-safe.
+	 */
+	class upload_batcher
+	{
+	public:
+		/** @brief Creates the staging buffer
+		 *  @param[in] aQueue The queue which the batches are submitted to; it must support transfer operations
+		 *  @param[in] aRingSize The size of the staging buffer, in bytes
+		 *  @param[in] aNumSegments The number of segments, i.e., of batches which can be in flight at the same time
+		 */
+		explicit upload_batcher(avk::queue& aQueue, size_t aRingSize = size_t{ 64 } << 20, uint32_t aNumSegments = 4);
+		upload_batcher(const upload_batcher&) = delete;
+		upload_batcher& operator=(const upload_batcher&) = delete;
+		/** @brief Submits the current batch and waits until all batches have completed */
+		~upload_batcher();
+
+		/** @brief Begins uploading data to an image
+		 *  All levels and layers of the image are transitioned into avk::layout::transfer_dst; their previous contents are discarded.
+		 *  @param[in] aImage The image, which must have a color format
+		 */
+		void begin_image(avk::image_t& aImage);
+
+		/** @brief Sub-allocates staging memory for one level of one layer of the image which has been begun last, and records the copy
+		 *  @param[in] aLayer The array layer, or cube map face, of the image
+		 *  @param[in] aLevel The mip map level of the image
+		 *  @param[in] aSize The size of the data, in bytes
+		 *  @return Staging memory of aSize bytes which the data must be written to before any other member function is called
+		 */
+		std::byte* stage_image_region(uint32_t aLayer, uint32_t aLevel, size_t aSize);
+
+		/** @brief Ends uploading data to the image which has been begun last
+		 *  @param[in] aFinalLayout The layout which all levels and layers of the image are transitioned into
+		 */
+		void end_image(avk::layout::image_layout aFinalLayout);
+
+		/** @brief Uploads data to a buffer
+		 *  @param[in] aData The data
+		 *  @param[in] aSize The size of the data, in bytes
+		 *  @param[in] aDstBuffer The buffer, which must have been created with vk::BufferUsageFlagBits::eTransferDst
+		 *  @param[in] aDstOffset The offset in aDstBuffer which the data is copied to
+		 */
+		void upload_buffer(const void* aData, size_t aSize, avk::buffer_t& aDstBuffer, size_t aDstOffset = 0);
+
+		/** @brief Records commands into the current batch, after all commands which have been recorded or staged before
+		 *  @param[in] aCommands Commands which must be executed together with the staged copies, e.g., copies from other resources
+		 */
+		void record(avk::recorded_commands_t aCommands);
+
+		/** @brief Submits the current batch, if it contains any copies, and continues with the next segment */
+		void flush();
+
+		/** @brief Submits the current batch and waits until all batches have completed */
+		void wait_idle();
+
+		/** @brief Returns the size of a segment, i.e., the maximum size of data which is staged in the staging buffer */
+		size_t segment_size() const { return mSegmentSize; }
+
+	private:
+		using ring_mapping = decltype(std::declval<avk::buffer_t&>().map_memory(avk::mapping_access::write));
+
+		/** A staging buffer for data which does not fit into a segment, which is kept alive by the fence of its batch */
+		struct dedicated_staging_buffer
+		{
+			avk::buffer mBuffer;
+			std::unique_ptr<ring_mapping> mMapping;
+		};
+
+		/** Returns the offset of aSize bytes in the staging buffer, or {} if they do not fit into a segment */
+		std::optional<size_t> allocate(size_t aSize, size_t aAlignment);
+		/** Records the copies to the current image which have been staged since the last call */
+		void record_image_copies();
+
+		avk::queue* mQueue;
+		size_t mSegmentSize;
+		uint32_t mNumSegments;
+		avk::buffer mRing;
+		std::unique_ptr<ring_mapping> mRingMapping;
+		std::byte* mRingData = nullptr;
+
+		uint32_t mCurrentSegment = 0;
+		size_t mSegmentOffset = 0;
+		/** The fence of the last batch of each segment */
+		std::vector<std::optional<avk::fence>> mSegmentFences;
+
+		std::vector<avk::recorded_commands_t> mPendingCommands;
+		std::vector<dedicated_staging_buffer> mPendingDedicatedBuffers;
+
+		avk::image_t* mCurrentImage = nullptr;
+		std::vector<vk::BufferImageCopy> mCurrentImageCopies;
+	};
+}
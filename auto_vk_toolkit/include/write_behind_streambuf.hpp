@@ -0,0 +1,63 @@
+#pragma once
+
+namespace avk
+{
+	/** @brief write_behind_streambuf
+	 *
+	 *  An output stream buffer which copies written data into buffers of fixed size and hands full
+	 *  buffers over to a background thread, which writes them to a sink. Writing to this stream
+	 *  buffer therefore only costs a memcpy, unless the queue of buffers is full, in which case the
+	 *  writer waits until the background thread has caught up. sync() waits until all data has been
+	 *  written to the sink and then syncs the sink. The destructor writes all remaining data and
+	 *  joins the background thread.
+	 */
+	class write_behind_streambuf : public std::streambuf
+	{
+	public:
+		/** @brief Construct, writing to aSink in the background
+		 *
+		 *  @param[in] aSink The stream buffer the data is written to; must outlive this instance and must not be accessed while it exists
+		 *  @param[in] aBufferSize Number of bytes per buffer
+		 *  @param[in] aMaxQueuedBuffers Maximum number of full buffers waiting to be written, which bounds the memory usage
+		 */
+		write_behind_streambuf(std::streambuf& aSink, size_t aBufferSize, size_t aMaxQueuedBuffers);
+		write_behind_streambuf(const write_behind_streambuf&) = delete;
+		write_behind_streambuf& operator=(const write_behind_streambuf&) = delete;
+		~write_behind_streambuf() override;
+
+		/** @brief Blocks until the background thread has written all queued buffers
+		 *  Data which has been written after the last full buffer remains in this stream buffer until sync() is invoked.
+		 */
+		void wait_until_written() const;
+
+		/** @brief Returns true if writing to the sink has failed */
+		bool has_failed() const;
+
+	protected:
+		int_type overflow(int_type aChar) override;
+		int sync() override;
+		pos_type seekoff(off_type aOffset, std::ios_base::seekdir aDirection, std::ios_base::openmode aMode) override;
+
+	private:
+		/** Moves the put area into the queue, waiting if the queue is full, and starts a new put area */
+		void enqueue_buffer();
+
+		void writer();
+
+		std::streambuf& mSink;
+		size_t mBufferSize;
+		size_t mMaxQueuedBuffers;
+		std::vector<char> mBuffer;
+		/** Number of bytes which have been moved into the queue */
+		std::uint64_t mBytesEnqueued = 0;
+		std::deque<std::vector<char>> mQueue;
+		/** Buffers which have been written, for reuse */
+		std::vector<std::vector<char>> mFreeBuffers;
+		bool mWriting = false;
+		bool mFailed = false;
+		bool mStop = false;
+		mutable std::mutex mMutex;
+		mutable std::condition_variable mCondition;
+		std::thread mWriter;
+	};
+}
@@ -1,16 +1,130 @@
 #include <glm/gtx/quaternion.hpp>
+#include <glm/gtx/component_wise.hpp>
 
 #include "animation.hpp"
 #include "transform.hpp"
 
 namespace avk
 {
+	/**	Helper function for animation::compress which determines the keys that must be kept in order to reproduce
+	 *	all keys of aKeys within aMaxError by interpolating between the kept keys. Greedily extends the interpolation
+	 *	span, starting from the last kept key, for as long as all the keys in between can be reproduced.
+	 *	@return	Indices of the keys to keep, sorted in ascending order. Contains at least the first key.
+	 */
+	template <typename K, typename I, typename E>
+	static std::vector<size_t> select_keys_within_error(const std::vector<K>& aKeys, I aInterpolate, E aError, float aMaxError)
+	{
+		std::vector<size_t> result;
+		if (aKeys.empty()) {
+			return result;
+		}
+		result.push_back(0);
+		const auto n = aKeys.size();
+
+		// Constant key collections can be reduced to a single key:
+		if (std::all_of(std::begin(aKeys), std::end(aKeys), [&](const K& aKey) { return aError(aKeys[0].mValue, aKey.mValue) <= aMaxError; })) {
+			return result;
+		}
+
+		size_t anchor = 0;
+		for (size_t candidate = 2; candidate < n; ++candidate) {
+			const double spanTicks = aKeys[candidate].mTime - aKeys[anchor].mTime;
+			bool canSkip = spanTicks > 0.0;
+			for (size_t i = anchor + 1; canSkip && i < candidate; ++i) {
+				const auto f = static_cast<float>((aKeys[i].mTime - aKeys[anchor].mTime) / spanTicks);
+				canSkip = aError(aInterpolate(aKeys[anchor].mValue, aKeys[candidate].mValue, f), aKeys[i].mValue) <= aMaxError;
+			}
+			if (!canSkip) {
+				// The key before the candidate can not be skipped => keep it and continue from there:
+				anchor = candidate - 1;
+				result.push_back(anchor);
+			}
+		}
+		result.push_back(n - 1);
+		return result;
+	}
+
+	/**	Helper function for animation::compress which range-quantizes the selected keys to 16 bits per component.
+	 */
+	template <typename K>
+	static compressed_vec3_keys compress_vec3_keys(const std::vector<K>& aKeys, const std::vector<size_t>& aIndicesToKeep)
+	{
+		compressed_vec3_keys result;
+		result.mRangeMin = glm::vec3{ std::numeric_limits<float>::max() };
+		glm::vec3 rangeMax{ std::numeric_limits<float>::lowest() };
+		for (auto i : aIndicesToKeep) {
+			result.mRangeMin = glm::min(result.mRangeMin, aKeys[i].mValue);
+			rangeMax = glm::max(rangeMax, aKeys[i].mValue);
+		}
+		result.mRangeExtent = rangeMax - result.mRangeMin;
+
+		result.mKeys.reserve(aIndicesToKeep.size());
+		for (auto i : aIndicesToKeep) {
+			auto& key = result.mKeys.emplace_back();
+			key.mTime = static_cast<float>(aKeys[i].mTime);
+			for (glm::length_t c = 0; c < 3; ++c) {
+				const float normalized = result.mRangeExtent[c] > 0.0f ? (aKeys[i].mValue[c] - result.mRangeMin[c]) / result.mRangeExtent[c] : 0.0f;
+				key.mValue[c] = static_cast<uint16_t>(glm::round(glm::clamp(normalized, 0.0f, 1.0f) * 65535.0f));
+			}
+		}
+		return result;
+	}
+
+	/**	Helper function for animation::compress which quantizes the selected rotation keys with the smallest three method.
+	 */
+	static compressed_rotation_keys compress_rotation_keys(const std::vector<rotation_key>& aKeys, const std::vector<size_t>& aIndicesToKeep)
+	{
+		constexpr float cSqrt2 = 1.41421356237309505f;
+		compressed_rotation_keys result;
+		result.mKeys.reserve(aIndicesToKeep.size());
+		for (auto i : aIndicesToKeep) {
+			const auto q = glm::normalize(aKeys[i].mValue);
+			float xyzw[4] = { q.x, q.y, q.z, q.w };
+			int largest = 0;
+			for (int c = 1; c < 4; ++c) {
+				if (glm::abs(xyzw[c]) > glm::abs(xyzw[largest])) {
+					largest = c;
+				}
+			}
+			// q and -q represent the same rotation => make the largest component positive, s.t. it can be restored from the other three:
+			const float sign = xyzw[largest] < 0.0f ? -1.0f : 1.0f;
+
+			auto& key = result.mKeys.emplace_back();
+			key.mTime = static_cast<float>(aKeys[i].mTime);
+			for (int c = 0, j = 0; c < 4; ++c) {
+				if (c == largest) {
+					continue;
+				}
+				const float normalized = glm::clamp(sign * xyzw[c] * cSqrt2 * 0.5f + 0.5f, 0.0f, 1.0f); // [-1/sqrt(2)..1/sqrt(2)] -> [0..1]
+				key.mValue[j++] = static_cast<uint16_t>(glm::round(normalized * 32767.0f));
+			}
+			key.mValue[0] |= static_cast<uint16_t>((largest & 0x1) << 15);
+			key.mValue[1] |= static_cast<uint16_t>((largest >> 1) << 15);
+		}
+		return result;
+	}
+
+	/**	Helper function for sampling compressed keys: Returns the translation, rotation, and scale of the node's local transform
+	 *	if any of its compressed key collections is empty, which are used for the channels without keys; identity values otherwise.
+	 */
+	static std::tuple<glm::vec3, glm::quat, glm::vec3> compressed_keys_fallback_transforms(const animated_node& aNode)
+	{
+		if (aNode.mCompressedPositionKeys.mKeys.empty() || aNode.mCompressedRotationKeys.mKeys.empty() || aNode.mCompressedScalingKeys.mKeys.empty()) {
+			return transforms_from_matrix(aNode.mLocalTransform);
+		}
+		return std::make_tuple(glm::vec3{ 0.0f }, glm::quat{ 1.0f, 0.0f, 0.0f, 0.0f }, glm::vec3{ 1.0f });
+	}
+
 	glm::vec3 animation::compute_node_local_translation(const animated_node& aNode, double aTimeInTicks) const
 	{
 		glm::vec3 localTranslation;
 
+		if (aNode.mHasCompressedKeys && !aNode.mCompressedPositionKeys.mKeys.empty()) {
+			auto [t1, t2, tf] = find_and_decode_compressed_keys(aNode.mCompressedPositionKeys, aTimeInTicks);
+			localTranslation = glm::lerp(t1, t2, tf);
+		}
 		// The localTransform can only be different than the identity if there are animation keys.
-		if (aNode.mPositionKeys.size() > 0) { 
+		else if (aNode.mPositionKeys.size() > 0) { 
 			auto [tpos1, tpos2] = find_positions_in_keys(aNode.mPositionKeys, aTimeInTicks);
 			auto tf = get_interpolation_factor(aNode.mPositionKeys[tpos1], aNode.mPositionKeys[tpos2], aTimeInTicks);
 			localTranslation = glm::lerp(aNode.mPositionKeys[tpos1].mValue, aNode.mPositionKeys[tpos2].mValue, tf);
@@ -28,8 +142,12 @@ namespace avk
 	{
 		glm::quat localRotation;
 
+		if (aNode.mHasCompressedKeys && !aNode.mCompressedRotationKeys.mKeys.empty()) {
+			auto [r1, r2, rf] = find_and_decode_compressed_keys(aNode.mCompressedRotationKeys, aTimeInTicks);
+			localRotation = glm::normalize(glm::slerp(r1, r2, rf));
+		}
 		// The localTransform can only be different than the identity if there are animation keys.
-		if (aNode.mRotationKeys.size() > 0) {
+		else if (aNode.mRotationKeys.size() > 0) {
 			auto [rpos1, rpos2] = find_positions_in_keys(aNode.mRotationKeys, aTimeInTicks);
 			auto rf = get_interpolation_factor(aNode.mRotationKeys[rpos1], aNode.mRotationKeys[rpos2], aTimeInTicks);
 			localRotation = glm::slerp(aNode.mRotationKeys[rpos1].mValue, aNode.mRotationKeys[rpos2].mValue, rf);	// use slerp, not lerp or mix (those lead to jerks)
@@ -48,8 +166,12 @@ namespace avk
 	{
 		glm::vec3 localScale;
 
+		if (aNode.mHasCompressedKeys && !aNode.mCompressedScalingKeys.mKeys.empty()) {
+			auto [s1, s2, sf] = find_and_decode_compressed_keys(aNode.mCompressedScalingKeys, aTimeInTicks);
+			localScale = glm::lerp(s1, s2, sf);
+		}
 		// The localTransform can only be different than the identity if there are animation keys.
-		if (aNode.mScalingKeys.size() > 0) {
+		else if (aNode.mScalingKeys.size() > 0) {
 			auto [spos1, spos2] = find_positions_in_keys(aNode.mScalingKeys, aTimeInTicks);
 			auto sf = get_interpolation_factor(aNode.mScalingKeys[spos1], aNode.mScalingKeys[spos2], aTimeInTicks);
 			localScale = glm::lerp(aNode.mScalingKeys[spos1].mValue, aNode.mScalingKeys[spos2].mValue, sf);
@@ -63,9 +185,26 @@ namespace avk
 		return localScale;
 	}
 	
-	glm::mat4 animation::compute_node_local_transform(const animated_node& aNode, double aTimeInTicks) const
+	std::tuple<glm::vec3, glm::quat, glm::vec3> animation::compute_node_local_translation_rotation_scale(const animated_node& aNode, double aTimeInTicks) const
 	{
-		glm::mat4 localTransform;
+		if (aNode.mHasCompressedKeys) {
+			// Sample the compressed keys in place, i.e. only the keys which are actually needed are decoded.
+			// Channels without keys keep the values of the node's local transform:
+			auto [translation, rotation, scaling] = compressed_keys_fallback_transforms(aNode);
+			if (!aNode.mCompressedPositionKeys.mKeys.empty()) {
+				auto [t1, t2, tf] = find_and_decode_compressed_keys(aNode.mCompressedPositionKeys, aTimeInTicks);
+				translation = glm::lerp(t1, t2, tf);
+			}
+			if (!aNode.mCompressedRotationKeys.mKeys.empty()) {
+				auto [r1, r2, rf] = find_and_decode_compressed_keys(aNode.mCompressedRotationKeys, aTimeInTicks);
+				rotation = glm::normalize(glm::slerp(r1, r2, rf));
+			}
+			if (!aNode.mCompressedScalingKeys.mKeys.empty()) {
+				auto [s1, s2, sf] = find_and_decode_compressed_keys(aNode.mCompressedScalingKeys, aTimeInTicks);
+				scaling = glm::lerp(s1, s2, sf);
+			}
+			return std::make_tuple(translation, rotation, scaling);
+		}
 
 		// The localTransform can only be different than the identity if there are animation keys.
 		if (aNode.mPositionKeys.size() + aNode.mRotationKeys.size() + aNode.mScalingKeys.size() > 0) {
@@ -91,6 +230,19 @@ namespace avk
 			auto sf = get_interpolation_factor(aNode.mScalingKeys[spos1], aNode.mScalingKeys[spos2], aTimeInTicks);
 			auto scaling = glm::lerp(aNode.mScalingKeys[spos1].mValue, aNode.mScalingKeys[spos2].mValue, sf);
 
+			return std::make_tuple(translation, rotation, scaling);
+		}
+
+		return transforms_from_matrix(aNode.mLocalTransform);
+	}
+
+	glm::mat4 animation::compute_node_local_transform(const animated_node& aNode, double aTimeInTicks) const
+	{
+		glm::mat4 localTransform;
+
+		// The localTransform can only be different than the identity if there are animation keys.
+		if (aNode.mHasCompressedKeys || aNode.mPositionKeys.size() + aNode.mRotationKeys.size() + aNode.mScalingKeys.size() > 0) {
+			auto [translation, rotation, scaling] = compute_node_local_translation_rotation_scale(aNode, aTimeInTicks);
 			localTransform = matrix_from_transforms(translation, rotation, scaling);
 		}
 		else {
@@ -104,8 +256,12 @@ namespace avk
 	{
 		glm::vec3 inverseLocalTranslation;
 
+		if (aNode.mHasCompressedKeys && !aNode.mCompressedPositionKeys.mKeys.empty()) {
+			auto [t1, t2, tf] = find_and_decode_compressed_keys(aNode.mCompressedPositionKeys, aTimeInTicks);
+			inverseLocalTranslation = glm::lerp(-t1, -t2, tf);
+		}
 		// The localTransform can only be different than the identity if there are animation keys.
-		if (aNode.mPositionKeys.size() > 0) {
+		else if (aNode.mPositionKeys.size() > 0) {
 			auto [tpos1, tpos2] = find_positions_in_keys(aNode.mPositionKeys, aTimeInTicks);
 			auto tf = get_interpolation_factor(aNode.mPositionKeys[tpos1], aNode.mPositionKeys[tpos2], aTimeInTicks);
 			inverseLocalTranslation = glm::lerp(-aNode.mPositionKeys[tpos1].mValue, -aNode.mPositionKeys[tpos2].mValue, tf);
@@ -123,8 +279,12 @@ namespace avk
 	{
 		glm::quat localRotation;
 
+		if (aNode.mHasCompressedKeys && !aNode.mCompressedRotationKeys.mKeys.empty()) {
+			auto [r1, r2, rf] = find_and_decode_compressed_keys(aNode.mCompressedRotationKeys, aTimeInTicks);
+			localRotation = glm::normalize(glm::slerp(glm::inverse(r1), glm::inverse(r2), rf));
+		}
 		// The localTransform can only be different than the identity if there are animation keys.
-		if (aNode.mRotationKeys.size() > 0) {
+		else if (aNode.mRotationKeys.size() > 0) {
 			auto [rpos1, rpos2] = find_positions_in_keys(aNode.mRotationKeys, aTimeInTicks);
 			auto rf = get_interpolation_factor(aNode.mRotationKeys[rpos1], aNode.mRotationKeys[rpos2], aTimeInTicks);
 			localRotation = glm::slerp(glm::inverse(aNode.mRotationKeys[rpos1].mValue), glm::inverse(aNode.mRotationKeys[rpos2].mValue), rf);	// use slerp, not lerp or mix (those lead to jerks)
@@ -143,8 +303,12 @@ namespace avk
 	{
 		glm::vec3 localScale;
 
+		if (aNode.mHasCompressedKeys && !aNode.mCompressedScalingKeys.mKeys.empty()) {
+			auto [s1, s2, sf] = find_and_decode_compressed_keys(aNode.mCompressedScalingKeys, aTimeInTicks);
+			localScale = glm::lerp(1.0f / s1, 1.0f / s2, sf);
+		}
 		// The localTransform can only be different than the identity if there are animation keys.
-		if (aNode.mScalingKeys.size() > 0) {
+		else if (aNode.mScalingKeys.size() > 0) {
 			auto [spos1, spos2] = find_positions_in_keys(aNode.mScalingKeys, aTimeInTicks);
 			auto sf = get_interpolation_factor(aNode.mScalingKeys[spos1], aNode.mScalingKeys[spos2], aTimeInTicks);
 			localScale = glm::lerp(1.0f / aNode.mScalingKeys[spos1].mValue, 1.0f / aNode.mScalingKeys[spos2].mValue, sf);
@@ -162,8 +326,31 @@ namespace avk
 	{
 		glm::mat4 inverseLocalTransform;
 
+		if (aNode.mHasCompressedKeys) {
+			// Channels without keys keep the (inverted) values of the node's local transform:
+			auto [translation, rotation, scaling] = compressed_keys_fallback_transforms(aNode);
+			translation = -translation;
+			rotation = glm::inverse(rotation);
+			scaling = 1.0f / scaling;
+			if (!aNode.mCompressedPositionKeys.mKeys.empty()) {
+				auto [t1, t2, tf] = find_and_decode_compressed_keys(aNode.mCompressedPositionKeys, aTimeInTicks);
+				translation = glm::lerp(-t1, -t2, tf);
+			}
+			if (!aNode.mCompressedRotationKeys.mKeys.empty()) {
+				auto [r1, r2, rf] = find_and_decode_compressed_keys(aNode.mCompressedRotationKeys, aTimeInTicks);
+				rotation = glm::normalize(glm::slerp(glm::inverse(r1), glm::inverse(r2), rf));
+			}
+			if (!aNode.mCompressedScalingKeys.mKeys.empty()) {
+				auto [s1, s2, sf] = find_and_decode_compressed_keys(aNode.mCompressedScalingKeys, aTimeInTicks);
+				scaling = glm::lerp(1.0f / s1, 1.0f / s2, sf);
+			}
+			inverseLocalTransform = // compute S^-1 * R^-1 * T^-1
+				glm::mat4{ glm::vec4{scaling.x, 0.f, 0.f, 0.f}, glm::vec4{0.f, scaling.y, 0.f, 0.f}, glm::vec4{0.f, 0.f, scaling.z, 0.f}, glm::vec4{0.f, 0.f, 0.f, 1.f} } *
+				glm::toMat4(rotation) *
+				glm::mat4{ glm::vec4{0.0f}, glm::vec4{0.0f}, glm::vec4{0.0f}, glm::vec4{translation, 1.0f} };
+		}
 		// The localTransform can only be different than the identity if there are animation keys.
-		if (aNode.mPositionKeys.size() + aNode.mRotationKeys.size() + aNode.mScalingKeys.size() > 0) {
+		else if (aNode.mPositionKeys.size() + aNode.mRotationKeys.size() + aNode.mScalingKeys.size() > 0) {
 			// Translation/position:
 			auto [tpos1, tpos2] = find_positions_in_keys(aNode.mPositionKeys, aTimeInTicks);
 			auto tf = get_interpolation_factor(aNode.mPositionKeys[tpos1], aNode.mPositionKeys[tpos2], aTimeInTicks);
@@ -268,12 +455,104 @@ namespace avk
 		}
 	}
 
+	/**	Helper function for the animate_into_* overloads with compact target formats: Computes each bone matrix
+	 *	in the given target space, converts it via aConvert, and writes the result to aTargetIndex(aInfo).
+	 */
+	template <typename T, typename C, typename I>
+	static void animate_into_converted_targets(animation& aAnimation, const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, C aConvert, I aTargetFor)
+	{
+		switch (aTargetSpace) {
+		case bone_matrices_space::mesh_space:
+			aAnimation.animate(aClip, aTime, [&aConvert, &aTargetFor](mesh_bone_info aInfo, const glm::mat4& aInverseMeshRootMatrix, const glm::mat4& aTransformMatrix, const glm::mat4& aInverseBindPoseMatrix) {
+				if (T* target = aTargetFor(aInfo)) {
+					*target = aConvert(aInverseMeshRootMatrix * aTransformMatrix * aInverseBindPoseMatrix);
+				}
+			});
+			break;
+		case bone_matrices_space::model_space:
+			aAnimation.animate(aClip, aTime, [&aConvert, &aTargetFor](mesh_bone_info aInfo, const glm::mat4& aInverseMeshRootMatrix, const glm::mat4& aTransformMatrix, const glm::mat4& aInverseBindPoseMatrix) {
+				if (T* target = aTargetFor(aInfo)) {
+					*target = aConvert(aTransformMatrix * aInverseBindPoseMatrix);
+				}
+			});
+			break;
+		default:
+			throw avk::runtime_error("Unknown target space value.");
+		}
+	}
+
+	/** Returns a callback which determines the target location in a single target buffer. */
+	template <typename T>
+	static auto single_target_buffer_location(T* aTargetMemory)
+	{
+		return [aTargetMemory](const mesh_bone_info& aInfo) -> T* {
+			return aTargetMemory + aInfo.mGlobalBoneIndexOffset + aInfo.mMeshLocalBoneIndex;
+		};
+	}
+
+	/** Returns a callback which determines the target location in strided memory per mesh, or nullptr if it exceeds the given maximums. */
+	template <typename T>
+	static auto strided_target_per_mesh_location(T* aTargetMemory, size_t aMeshStride, std::optional<size_t> aMatricesStride, std::optional<size_t> aMaxMeshes, std::optional<size_t> aMaxBonesPerMesh)
+	{
+		return [target = reinterpret_cast<uint8_t*>(aTargetMemory), meshStride = aMeshStride, matStride = aMatricesStride.value_or(sizeof(T)), maxMeshes = aMaxMeshes.value_or(std::numeric_limits<size_t>::max()), maxBones = aMaxBonesPerMesh.value_or(std::numeric_limits<size_t>::max())]
+			(const mesh_bone_info& aInfo) -> T* {
+				if (aInfo.mMeshAnimationIndex < maxMeshes && aInfo.mMeshLocalBoneIndex < maxBones) {
+					return reinterpret_cast<T*>(target + aInfo.mMeshAnimationIndex * meshStride + aInfo.mMeshLocalBoneIndex * matStride);
+				}
+				return nullptr;
+			};
+	}
+
+	void animation::animate_into_single_target_buffer(const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, glm::mat3x4* aTargetMemory)
+	{
+		animate_into_converted_targets<glm::mat3x4>(*this, aClip, aTime, aTargetSpace, &to_affine_bone_matrix, single_target_buffer_location(aTargetMemory));
+	}
+
+	void animation::animate_into_single_target_buffer(const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, bone_dual_quaternion* aTargetMemory)
+	{
+		animate_into_converted_targets<bone_dual_quaternion>(*this, aClip, aTime, aTargetSpace, &bone_dual_quaternion::from_matrix, single_target_buffer_location(aTargetMemory));
+	}
+
+	void animation::animate_into_strided_target_per_mesh(const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, glm::mat3x4* aTargetMemory, size_t aMeshStride, std::optional<size_t> aMatricesStride, std::optional<size_t> aMaxMeshes, std::optional<size_t> aMaxBonesPerMesh)
+	{
+		animate_into_converted_targets<glm::mat3x4>(*this, aClip, aTime, aTargetSpace, &to_affine_bone_matrix, strided_target_per_mesh_location(aTargetMemory, aMeshStride, aMatricesStride, aMaxMeshes, aMaxBonesPerMesh));
+	}
+
+	void animation::animate_into_strided_target_per_mesh(const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, bone_dual_quaternion* aTargetMemory, size_t aMeshStride, std::optional<size_t> aMatricesStride, std::optional<size_t> aMaxMeshes, std::optional<size_t> aMaxBonesPerMesh)
+	{
+		animate_into_converted_targets<bone_dual_quaternion>(*this, aClip, aTime, aTargetSpace, &bone_dual_quaternion::from_matrix, strided_target_per_mesh_location(aTargetMemory, aMeshStride, aMatricesStride, aMaxMeshes, aMaxBonesPerMesh));
+	}
+
 	std::vector<double> animation::animation_key_times_for_clip_in_ticks(const animation_clip_data& aClip) const
 	{
 		const double cMachineEpsilon = 2.3e-16;
 		
 		std::set<double> mUniqueKeys;
+
+		// Same procedure as for the full-precision keys below, but for compressed keys (see animation::compress):
+		auto addCompressedKeyTimes = [&](const auto& aKeys) {
+			for (size_t i = 1; i < aKeys.size(); ++i) {
+				const double time = aKeys[i].mTime;
+				if (time >= aClip.mStartTicks - cMachineEpsilon && time <= aClip.mEndTicks + cMachineEpsilon) {
+					if (time - aClip.mStartTicks > cMachineEpsilon) {
+						mUniqueKeys.insert(aKeys[i - 1].mTime);
+					}
+					mUniqueKeys.insert(time);
+					if (i + 1 < aKeys.size() && aClip.mEndTicks - time > cMachineEpsilon) {
+						mUniqueKeys.insert(aKeys[i + 1].mTime);
+					}
+				}
+			}
+		};
+
 		for (auto& anode : mAnimationData) {
+			if (anode.mHasCompressedKeys) {
+				addCompressedKeyTimes(anode.mCompressedPositionKeys.mKeys);
+				addCompressedKeyTimes(anode.mCompressedRotationKeys.mKeys);
+				addCompressedKeyTimes(anode.mCompressedScalingKeys.mKeys);
+				continue;
+			}
+
 			// POSITION KEYS:
 			for (size_t i = 1; i < anode.mPositionKeys.size(); ++i) {
 				if (anode.mPositionKeys[i].mTime >= aClip.mStartTicks - cMachineEpsilon && anode.mPositionKeys[i].mTime <= aClip.mEndTicks + cMachineEpsilon) {
@@ -327,6 +606,61 @@ namespace avk
 		return result;
 	}
 
+	void animation::compress(const animation_compression_config& aConfig)
+	{
+		size_t sizeBefore = 0;
+		size_t sizeAfter = 0;
+		for (auto& anode : mAnimationData) {
+			if (anode.mHasCompressedKeys || anode.mPositionKeys.size() + anode.mRotationKeys.size() + anode.mScalingKeys.size() == 0) {
+				continue;
+			}
+			sizeBefore += anode.mPositionKeys.size() * sizeof(position_key) + anode.mRotationKeys.size() * sizeof(rotation_key) + anode.mScalingKeys.size() * sizeof(scaling_key);
+
+			const auto distanceVec3 = [](const glm::vec3& a, const glm::vec3& b) { return glm::length(a - b); };
+			const auto maxDifferenceVec3 = [](const glm::vec3& a, const glm::vec3& b) { return glm::compMax(glm::abs(a - b)); };
+			const auto angleQuat = [](const glm::quat& a, const glm::quat& b) { return 2.0f * glm::acos(glm::min(1.0f, glm::abs(glm::dot(a, b)))); };
+			const auto lerpVec3 = [](const glm::vec3& a, const glm::vec3& b, float f) { return glm::lerp(a, b, f); };
+			const auto slerpQuat = [](const glm::quat& a, const glm::quat& b, float f) { return glm::normalize(glm::slerp(a, b, f)); };
+
+			anode.mCompressedPositionKeys = compress_vec3_keys(anode.mPositionKeys, select_keys_within_error(anode.mPositionKeys, lerpVec3, distanceVec3, aConfig.mMaxTranslationError));
+			anode.mCompressedRotationKeys = compress_rotation_keys(anode.mRotationKeys, select_keys_within_error(anode.mRotationKeys, slerpQuat, angleQuat, aConfig.mMaxRotationError));
+			anode.mCompressedScalingKeys  = compress_vec3_keys(anode.mScalingKeys, select_keys_within_error(anode.mScalingKeys, lerpVec3, maxDifferenceVec3, aConfig.mMaxScalingError));
+			anode.mHasCompressedKeys = true;
+
+			// Release the full-precision keys:
+			anode.mPositionKeys = {};
+			anode.mRotationKeys = {};
+			anode.mScalingKeys = {};
+
+			// The key reduction works per collection, i.e. the key times are (most likely) not the same anymore:
+			anode.mSameRotationAndPositionKeyTimes = false;
+			anode.mSameScalingAndPositionKeyTimes = false;
+
+			sizeAfter += anode.mCompressedPositionKeys.mKeys.size() * sizeof(compressed_vec3_key) + anode.mCompressedRotationKeys.mKeys.size() * sizeof(compressed_rotation_key) + anode.mCompressedScalingKeys.mKeys.size() * sizeof(compressed_vec3_key);
+		}
+		LOG_DEBUG(std::format("Compressed the keys of animation[{}] from {} bytes to {} bytes.", mAnimationIndex, sizeBefore, sizeAfter));
+	}
+
+	bool animation::is_compressed() const
+	{
+		return std::any_of(std::begin(mAnimationData), std::end(mAnimationData), [](const animated_node& aNode) { return aNode.mHasCompressedKeys; });
+	}
+
+	void animation::set_skipped_leaf_levels(uint32_t aSkippedLeafLevels)
+	{
+		if (mNodeHeights.size() != mAnimationData.size()) {
+			mNodeHeights.assign(mAnimationData.size(), 0u);
+			// Animated parents are always stored before their children => iterate backwards to propagate the heights upwards:
+			for (size_t i = mAnimationData.size(); i > 0; --i) {
+				const auto& parent = mAnimationData[i - 1].mAnimatedParentIndex;
+				if (parent.has_value()) {
+					mNodeHeights[parent.value()] = std::max(mNodeHeights[parent.value()], mNodeHeights[i - 1] + 1u);
+				}
+			}
+		}
+		mSkippedLeafLevels = aSkippedLeafLevels;
+	}
+
 	size_t animation::number_of_animated_nodes() const
 	{
 		return mAnimationData.size();
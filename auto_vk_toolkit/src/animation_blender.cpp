@@ -0,0 +1,221 @@
+#include "animation_blender.hpp"
+#include "transform.hpp"
+
+namespace avk
+{
+	animation_blender::animation_blender(const animation& aSkeleton, size_t aMaxStackDepth)
+		: mSkeleton{ &aSkeleton }
+		, mNumNodes{ aSkeleton.number_of_animated_nodes() }
+		, mMaxStackDepth{ aMaxStackDepth }
+	{
+		if (0 == mMaxStackDepth) {
+			throw avk::logic_error("The maximum stack depth of an animation_blender must be at least 1.");
+		}
+
+		mRestPose.reserve(mNumNodes);
+		for (size_t i = 0; i < mNumNodes; ++i) {
+			auto [translation, rotation, scale] = transforms_from_matrix(aSkeleton.get_animated_node_at(i).get().mLocalTransform);
+			mRestPose.push_back(node_local_trs{ translation, rotation, scale });
+		}
+		mPoseArena.resize(mNumNodes * mMaxStackDepth);
+		mGlobalTransforms.resize(mNumNodes, glm::mat4{ 1.0f });
+	}
+
+	size_t animation_blender::add_animation(const animation& aAnimation)
+	{
+		std::unordered_map<std::string_view, size_t> nodeIndicesByName;
+		const auto n = aAnimation.number_of_animated_nodes();
+		for (size_t i = 0; i < n; ++i) {
+			nodeIndicesByName.emplace(aAnimation.get_animated_node_at(i).get().mNodeName, i);
+		}
+
+		auto& mapping = mNodeMappings.emplace_back(mNumNodes, int64_t{ -1 });
+		for (size_t i = 0; i < mNumNodes; ++i) {
+			auto it = nodeIndicesByName.find(mSkeleton->get_animated_node_at(i).get().mNodeName);
+			if (std::end(nodeIndicesByName) != it) {
+				mapping[i] = static_cast<int64_t>(it->second);
+			}
+		}
+
+		mAnimations.push_back(&aAnimation);
+		return mAnimations.size() - 1;
+	}
+
+	size_t animation_blender::add_mask(std::vector<float> aWeightPerNode)
+	{
+		if (aWeightPerNode.size() != mNumNodes) {
+			throw avk::logic_error(std::format("A mask must contain exactly one weight per animated node, i.e. {} weights, but {} have been passed.", mNumNodes, aWeightPerNode.size()));
+		}
+		mMasks.insert(std::end(mMasks), std::begin(aWeightPerNode), std::end(aWeightPerNode));
+		return mMasks.size() / mNumNodes - 1;
+	}
+
+	size_t animation_blender::add_mask_for_subtree(size_t aRootNodeIndex, float aWeightInside, float aWeightOutside)
+	{
+		assert(aRootNodeIndex < mNumNodes);
+		std::vector<bool> insideSubtree(mNumNodes, false);
+		insideSubtree[aRootNodeIndex] = true;
+		// Animated parents are always stored before their children => one pass is sufficient:
+		for (size_t i = aRootNodeIndex + 1; i < mNumNodes; ++i) {
+			auto parent = mSkeleton->get_animated_parent_index_of(i);
+			insideSubtree[i] = parent.has_value() && insideSubtree[parent.value()];
+		}
+
+		std::vector<float> weights(mNumNodes);
+		for (size_t i = 0; i < mNumNodes; ++i) {
+			weights[i] = insideSubtree[i] ? aWeightInside : aWeightOutside;
+		}
+		return add_mask(std::move(weights));
+	}
+
+	std::optional<size_t> animation_blender::find_node_index(std::string_view aNodeName) const
+	{
+		for (size_t i = 0; i < mNumNodes; ++i) {
+			if (mSkeleton->get_animated_node_at(i).get().mNodeName == aNodeName) {
+				return i;
+			}
+		}
+		return {};
+	}
+
+	node_local_trs* animation_blender::push_pose()
+	{
+		if (mStackSize >= mMaxStackDepth) {
+			throw avk::logic_error(std::format("The animation_blender's pose stack is full. It has been created with a maximum stack depth of {}.", mMaxStackDepth));
+		}
+		return pose_at(mStackSize++);
+	}
+
+	void animation_blender::push_clip(size_t aAnimationIndex, const animation_clip_data& aClip, double aTime)
+	{
+		assert(aAnimationIndex < mAnimations.size());
+		if (aClip.mTicksPerSecond == 0.0) {
+			throw avk::runtime_error("animation_clip_data::mTicksPerSecond may not be 0.0 => set a different value!");
+		}
+
+		const auto& ani = *mAnimations[aAnimationIndex];
+		const auto& mapping = mNodeMappings[aAnimationIndex];
+		const double timeInTicks = aTime * aClip.mTicksPerSecond;
+
+		auto* pose = push_pose();
+		for (size_t i = 0; i < mNumNodes; ++i) {
+			if (mapping[i] < 0) {
+				pose[i] = mRestPose[i];
+				continue;
+			}
+			const auto& anode = ani.get_animated_node_at(static_cast<size_t>(mapping[i])).get();
+			if (!anode.mHasCompressedKeys && anode.mPositionKeys.size() + anode.mRotationKeys.size() + anode.mScalingKeys.size() == 0) {
+				// Not animated => no need to decompose its local transform again
+				pose[i] = mRestPose[i];
+				continue;
+			}
+			std::tie(pose[i].mTranslation, pose[i].mRotation, pose[i].mScale) = ani.compute_node_local_translation_rotation_scale(anode, timeInTicks);
+		}
+	}
+
+	void animation_blender::push_rest_pose()
+	{
+		auto* pose = push_pose();
+		std::copy(std::begin(mRestPose), std::end(mRestPose), pose);
+	}
+
+	void animation_blender::blend(float aWeight, std::optional<size_t> aMask)
+	{
+		if (mStackSize < 2) {
+			throw avk::logic_error("animation_blender::blend requires two poses on the stack.");
+		}
+		assert(!aMask.has_value() || (aMask.value() + 1) * mNumNodes <= mMasks.size());
+
+		auto* a = pose_at(mStackSize - 2);
+		const auto* b = pose_at(mStackSize - 1);
+		const float* mask = aMask.has_value() ? mMasks.data() + aMask.value() * mNumNodes : nullptr;
+		for (size_t i = 0; i < mNumNodes; ++i) {
+			const float w = nullptr == mask ? aWeight : aWeight * mask[i];
+			a[i].mTranslation = glm::lerp(a[i].mTranslation, b[i].mTranslation, w);
+			a[i].mRotation    = glm::normalize(glm::slerp(a[i].mRotation, b[i].mRotation, w));
+			a[i].mScale       = glm::lerp(a[i].mScale, b[i].mScale, w);
+		}
+		--mStackSize;
+	}
+
+	void animation_blender::add(float aWeight, std::optional<size_t> aMask)
+	{
+		if (mStackSize < 3) {
+			throw avk::logic_error("animation_blender::add requires three poses on the stack: base, additive, and reference.");
+		}
+		assert(!aMask.has_value() || (aMask.value() + 1) * mNumNodes <= mMasks.size());
+
+		auto* base = pose_at(mStackSize - 3);
+		const auto* additive = pose_at(mStackSize - 2);
+		const auto* reference = pose_at(mStackSize - 1);
+		const float* mask = aMask.has_value() ? mMasks.data() + aMask.value() * mNumNodes : nullptr;
+		const glm::quat identity{ 1.0f, 0.0f, 0.0f, 0.0f };
+		for (size_t i = 0; i < mNumNodes; ++i) {
+			const float w = nullptr == mask ? aWeight : aWeight * mask[i];
+			base[i].mTranslation += (additive[i].mTranslation - reference[i].mTranslation) * w;
+			const auto deltaRotation = glm::inverse(reference[i].mRotation) * additive[i].mRotation;
+			base[i].mRotation = glm::normalize(base[i].mRotation * glm::slerp(identity, deltaRotation, w));
+			base[i].mScale *= glm::lerp(glm::vec3{ 1.0f }, additive[i].mScale / reference[i].mScale, w);
+		}
+		mStackSize -= 2;
+	}
+
+	void animation_blender::compute_global_transforms()
+	{
+		if (0 == mStackSize) {
+			throw avk::logic_error("There is no pose on the animation_blender's stack which could be applied.");
+		}
+
+		// Compose each node exactly once, from the final blended local transform:
+		const auto* pose = pose_at(mStackSize - 1);
+		for (size_t i = 0; i < mNumNodes; ++i) {
+			const auto& anode = mSkeleton->get_animated_node_at(i).get();
+			const auto localTransform = matrix_from_transforms(pose[i].mTranslation, pose[i].mRotation, pose[i].mScale);
+			if (anode.mAnimatedParentIndex.has_value()) {
+				mGlobalTransforms[i] = mGlobalTransforms[anode.mAnimatedParentIndex.value()] * anode.mParentTransform * localTransform;
+			}
+			else {
+				mGlobalTransforms[i] = anode.mParentTransform * localTransform;
+			}
+		}
+		mStackSize = 0;
+	}
+
+	void animation_blender::apply_into_single_target_buffer(bone_matrices_space aTargetSpace, glm::mat4* aTargetMemory)
+	{
+		switch (aTargetSpace) {
+		case bone_matrices_space::mesh_space:
+			apply([aTargetMemory](mesh_bone_info aInfo, const glm::mat4& aInverseMeshRootMatrix, const glm::mat4& aTransformMatrix, const glm::mat4& aInverseBindPoseMatrix) {
+				aTargetMemory[aInfo.mGlobalBoneIndexOffset + aInfo.mMeshLocalBoneIndex] = aInverseMeshRootMatrix * aTransformMatrix * aInverseBindPoseMatrix;
+			});
+			break;
+		case bone_matrices_space::model_space:
+			apply([aTargetMemory](mesh_bone_info aInfo, const glm::mat4& aInverseMeshRootMatrix, const glm::mat4& aTransformMatrix, const glm::mat4& aInverseBindPoseMatrix) {
+				aTargetMemory[aInfo.mGlobalBoneIndexOffset + aInfo.mMeshLocalBoneIndex] = aTransformMatrix * aInverseBindPoseMatrix;
+			});
+			break;
+		default:
+			throw avk::runtime_error("Unknown target space value.");
+		}
+	}
+
+	void animation_blender::apply_into_strided_target_per_mesh(bone_matrices_space aTargetSpace, glm::mat4* aTargetMemory, size_t aMeshStride, std::optional<size_t> aMatricesStride)
+	{
+		auto* target = reinterpret_cast<uint8_t*>(aTargetMemory);
+		const auto matStride = aMatricesStride.value_or(sizeof(glm::mat4));
+		switch (aTargetSpace) {
+		case bone_matrices_space::mesh_space:
+			apply([target, aMeshStride, matStride](mesh_bone_info aInfo, const glm::mat4& aInverseMeshRootMatrix, const glm::mat4& aTransformMatrix, const glm::mat4& aInverseBindPoseMatrix) {
+				*reinterpret_cast<glm::mat4*>(target + aInfo.mMeshAnimationIndex * aMeshStride + aInfo.mMeshLocalBoneIndex * matStride) = aInverseMeshRootMatrix * aTransformMatrix * aInverseBindPoseMatrix;
+			});
+			break;
+		case bone_matrices_space::model_space:
+			apply([target, aMeshStride, matStride](mesh_bone_info aInfo, const glm::mat4& aInverseMeshRootMatrix, const glm::mat4& aTransformMatrix, const glm::mat4& aInverseBindPoseMatrix) {
+				*reinterpret_cast<glm::mat4*>(target + aInfo.mMeshAnimationIndex * aMeshStride + aInfo.mMeshLocalBoneIndex * matStride) = aTransformMatrix * aInverseBindPoseMatrix;
+			});
+			break;
+		default:
+			throw avk::runtime_error("Unknown target space value.");
+		}
+	}
+}
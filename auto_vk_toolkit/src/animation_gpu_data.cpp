@@ -0,0 +1,84 @@
+#include "animation_gpu_data.hpp"
+
+namespace avk
+{
+	animation_gpu_data convert_for_gpu_usage(const animation& aAnimation, bone_matrices_space aTargetSpace)
+	{
+		if (bone_matrices_space::mesh_space != aTargetSpace && bone_matrices_space::model_space != aTargetSpace) {
+			throw avk::runtime_error("Unknown target space value.");
+		}
+
+		animation_gpu_data result;
+		const auto n = aAnimation.number_of_animated_nodes();
+		result.mNodes.reserve(n);
+
+		auto appendKey = [&result](double bTime, const glm::vec4& bValue) {
+			result.mKeyTimes.push_back(static_cast<float>(bTime));
+			result.mKeyValues.push_back(bValue);
+		};
+		auto currentKeyOffset = [&result]() {
+			return static_cast<uint32_t>(result.mKeyTimes.size());
+		};
+
+		for (size_t i = 0; i < n; ++i) {
+			const auto& anode = aAnimation.get_animated_node_at(i).get();
+			auto& gnode = result.mNodes.emplace_back();
+			gnode.mParentTransform = anode.mParentTransform;
+			gnode.mLocalTransform = anode.mLocalTransform;
+			gnode.mAnimatedParentIndex = anode.mAnimatedParentIndex.has_value() ? static_cast<int32_t>(anode.mAnimatedParentIndex.value()) : -1;
+			gnode.mPadding = 0;
+
+			if (anode.mHasCompressedKeys) {
+				// Decode the keys, the compute shader samples plain keys only:
+				gnode.mPositionKeysOffset = currentKeyOffset();
+				for (size_t k = 0; k < anode.mCompressedPositionKeys.mKeys.size(); ++k) {
+					appendKey(anode.mCompressedPositionKeys.mKeys[k].mTime, glm::vec4{ anode.mCompressedPositionKeys.value_at(k), 0.0f });
+				}
+				gnode.mRotationKeysOffset = currentKeyOffset();
+				for (size_t k = 0; k < anode.mCompressedRotationKeys.mKeys.size(); ++k) {
+					const auto q = anode.mCompressedRotationKeys.value_at(k);
+					appendKey(anode.mCompressedRotationKeys.mKeys[k].mTime, glm::vec4{ q.x, q.y, q.z, q.w });
+				}
+				gnode.mScalingKeysOffset = currentKeyOffset();
+				for (size_t k = 0; k < anode.mCompressedScalingKeys.mKeys.size(); ++k) {
+					appendKey(anode.mCompressedScalingKeys.mKeys[k].mTime, glm::vec4{ anode.mCompressedScalingKeys.value_at(k), 0.0f });
+				}
+				gnode.mPositionKeysCount = static_cast<uint32_t>(anode.mCompressedPositionKeys.mKeys.size());
+				gnode.mRotationKeysCount = static_cast<uint32_t>(anode.mCompressedRotationKeys.mKeys.size());
+				gnode.mScalingKeysCount  = static_cast<uint32_t>(anode.mCompressedScalingKeys.mKeys.size());
+			}
+			else {
+				gnode.mPositionKeysOffset = currentKeyOffset();
+				for (const auto& key : anode.mPositionKeys) {
+					appendKey(key.mTime, glm::vec4{ key.mValue, 0.0f });
+				}
+				gnode.mRotationKeysOffset = currentKeyOffset();
+				for (const auto& key : anode.mRotationKeys) {
+					appendKey(key.mTime, glm::vec4{ key.mValue.x, key.mValue.y, key.mValue.z, key.mValue.w });
+				}
+				gnode.mScalingKeysOffset = currentKeyOffset();
+				for (const auto& key : anode.mScalingKeys) {
+					appendKey(key.mTime, glm::vec4{ key.mValue, 0.0f });
+				}
+				gnode.mPositionKeysCount = static_cast<uint32_t>(anode.mPositionKeys.size());
+				gnode.mRotationKeysCount = static_cast<uint32_t>(anode.mRotationKeys.size());
+				gnode.mScalingKeysCount  = static_cast<uint32_t>(anode.mScalingKeys.size());
+			}
+
+			for (const auto& target : anode.mBoneMeshTargets) {
+				auto& gtarget = result.mBoneTargets.emplace_back();
+				gtarget.mTargetSpaceMatrix = bone_matrices_space::mesh_space == aTargetSpace ? target.mInverseMeshRootMatrix : glm::mat4{ 1.0f };
+				gtarget.mInverseBindPoseMatrix = target.mInverseBindPoseMatrix;
+				gtarget.mAnimatedNodeIndex = static_cast<uint32_t>(i);
+				gtarget.mTargetIndex = static_cast<uint32_t>(target.mMeshBoneInfo.mGlobalBoneIndexOffset + target.mMeshBoneInfo.mMeshLocalBoneIndex);
+				gtarget.mPadding[0] = gtarget.mPadding[1] = 0;
+				result.mNumBoneMatrices = std::max(result.mNumBoneMatrices, gtarget.mTargetIndex + 1);
+			}
+		}
+
+		LOG_DEBUG(std::format("Converted animation for GPU usage: {} nodes, {} keys, {} bone targets, {} bone matrices per instance.",
+			result.mNodes.size(), result.mKeyTimes.size(), result.mBoneTargets.size(), result.mNumBoneMatrices));
+
+		return result;
+	}
+}
@@ -0,0 +1,71 @@
+#include "animation_update_scheduler.hpp"
+
+namespace avk
+{
+	animation_update_scheduler::animation_update_scheduler(std::vector<animation_lod_level> aLevels)
+		: mLevels{ std::move(aLevels) }
+	{
+		if (mLevels.empty()) {
+			throw avk::logic_error("An animation_update_scheduler requires at least one LOD level.");
+		}
+		for (size_t i = 0; i < mLevels.size(); ++i) {
+			if (0 == mLevels[i].mUpdateInterval) {
+				throw avk::logic_error(std::format("The update interval of LOD level {} must be at least 1.", i));
+			}
+			if (i > 0 && mLevels[i].mMaxDistance < mLevels[i - 1].mMaxDistance) {
+				throw avk::logic_error("The LOD levels passed to animation_update_scheduler must be sorted by mMaxDistance in ascending order.");
+			}
+		}
+	}
+
+	size_t animation_update_scheduler::add_instance()
+	{
+		mLastUpdateFrames.emplace_back();
+		return mLastUpdateFrames.size() - 1;
+	}
+
+	void animation_update_scheduler::begin_frame()
+	{
+		++mCurrentFrame;
+		mUpdatesInCurrentFrame = 0;
+	}
+
+	std::optional<std::reference_wrapper<const animation_lod_level>> animation_update_scheduler::level_if_due(size_t aInstanceId, float aDistance)
+	{
+		assert(aInstanceId < mLastUpdateFrames.size());
+
+		auto it = std::find_if(std::begin(mLevels), std::end(mLevels), [aDistance](const animation_lod_level& aLevel) {
+			return aDistance <= aLevel.mMaxDistance;
+		});
+		const auto& level = std::end(mLevels) == it ? mLevels.back() : *it;
+
+		auto& lastUpdate = mLastUpdateFrames[aInstanceId];
+		if (lastUpdate.has_value()) {
+			if (lastUpdate.value() == mCurrentFrame) {
+				return std::cref(level); // Already updated in this frame => it's fine to be updated again
+			}
+			// The instance id serves as phase, so that throttled instances are evenly distributed across frames:
+			if (mCurrentFrame % level.mUpdateInterval != aInstanceId % level.mUpdateInterval) {
+				return {};
+			}
+		}
+
+		lastUpdate = mCurrentFrame;
+		++mUpdatesInCurrentFrame;
+		return std::cref(level);
+	}
+
+	bool animation_update_scheduler::animate_into_single_target_buffer(size_t aInstanceId, float aDistance, animation& aAnimation, const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, glm::mat4* aTargetMemory)
+	{
+		return update(aInstanceId, aDistance, aAnimation, [&]() {
+			aAnimation.animate_into_single_target_buffer(aClip, aTime, aTargetSpace, aTargetMemory);
+		});
+	}
+
+	bool animation_update_scheduler::animate_into_strided_target_per_mesh(size_t aInstanceId, float aDistance, animation& aAnimation, const animation_clip_data& aClip, double aTime, bone_matrices_space aTargetSpace, glm::mat4* aTargetMemory, size_t aMeshStride, std::optional<size_t> aMatricesStride, std::optional<size_t> aMaxMeshes, std::optional<size_t> aMaxBonesPerMesh)
+	{
+		return update(aInstanceId, aDistance, aAnimation, [&]() {
+			aAnimation.animate_into_strided_target_per_mesh(aClip, aTime, aTargetSpace, aTargetMemory, aMeshStride, aMatricesStride, aMaxMeshes, aMaxBonesPerMesh);
+		});
+	}
+}
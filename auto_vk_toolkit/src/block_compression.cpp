@@ -0,0 +1,458 @@
+#include "block_compression.hpp"
+
+namespace avk
+{
+	namespace
+	{
+		/** "AVKZ" in little endian byte order */
+		constexpr std::uint32_t cBlockCompressedMagic = 0x5A4B5641u;
+
+		/** Set in a block header's compressed size if the block is stored uncompressed */
+		constexpr std::uint32_t cStoredUncompressedFlag = 0x80000000u;
+
+		struct block_compressed_stream_header
+		{
+			std::uint32_t mMagic;
+			std::uint32_t mVersion;
+			std::uint32_t mBlockSize;
+			std::uint32_t mReserved;
+		};
+
+		struct block_header
+		{
+			/** Size of the block's data in the stream; cStoredUncompressedFlag is set if it is stored uncompressed */
+			std::uint32_t mCompressedSize;
+			std::uint32_t mUncompressedSize;
+		};
+
+		// Parameters of the LZ4 block format:
+		constexpr size_t cMinMatch = 4;
+		constexpr size_t cLastLiterals = 5;  // The last 5 bytes are always literals
+		constexpr size_t cMatchFindLimit = 12; // The last match must start at least 12 bytes before the end
+		constexpr size_t cMaxOffset = 65535;
+		constexpr int cHashLog = 16;
+
+		inline std::uint32_t read_u32(const std::uint8_t* aPtr)
+		{
+			std::uint32_t value;
+			std::memcpy(&value, aPtr, sizeof(value));
+			return value;
+		}
+
+		inline std::uint32_t hash_sequence(std::uint32_t aSequence)
+		{
+			return (aSequence * 2654435761u) >> (32 - cHashLog);
+		}
+
+		/** Writes a length >= 15 in the LZ4 encoding of additional length bytes */
+		inline std::uint8_t* write_length(std::uint8_t* aOutput, size_t aLength)
+		{
+			for (; aLength >= 255; aLength -= 255) {
+				*aOutput++ = 255;
+			}
+			*aOutput++ = static_cast<std::uint8_t>(aLength);
+			return aOutput;
+		}
+
+		/** Reads additional length bytes; returns false if the input ends prematurely */
+		inline bool read_length(const std::uint8_t*& aInput, const std::uint8_t* aInputEnd, size_t& aLength)
+		{
+			std::uint8_t value;
+			do {
+				if (aInput >= aInputEnd) {
+					return false;
+				}
+				value = *aInput++;
+				aLength += value;
+			} while (255 == value);
+			return true;
+		}
+
+		std::uint8_t* write_sequence(std::uint8_t* aOutput, const std::uint8_t* aLiterals, size_t aLiteralsLength, std::optional<std::tuple<size_t, size_t>> aOffsetAndMatchLength)
+		{
+			auto* token = aOutput++;
+			*token = static_cast<std::uint8_t>(std::min<size_t>(aLiteralsLength, 15) << 4);
+			if (aLiteralsLength >= 15) {
+				aOutput = write_length(aOutput, aLiteralsLength - 15);
+			}
+			std::memcpy(aOutput, aLiterals, aLiteralsLength);
+			aOutput += aLiteralsLength;
+
+			if (aOffsetAndMatchLength.has_value()) {
+				auto [offset, matchLength] = aOffsetAndMatchLength.value();
+				*aOutput++ = static_cast<std::uint8_t>(offset & 0xFF);
+				*aOutput++ = static_cast<std::uint8_t>(offset >> 8);
+				const auto encodedMatchLength = matchLength - cMinMatch;
+				*token |= static_cast<std::uint8_t>(std::min<size_t>(encodedMatchLength, 15));
+				if (encodedMatchLength >= 15) {
+					aOutput = write_length(aOutput, encodedMatchLength - 15);
+				}
+			}
+			return aOutput;
+		}
+
+		void write_to_sink(std::streambuf& aSink, const void* aData, size_t aSize)
+		{
+			if (aSink.sputn(static_cast<const char*>(aData), static_cast<std::streamsize>(aSize)) != static_cast<std::streamsize>(aSize)) {
+				throw avk::runtime_error(std::format("Failed to write {} bytes of compressed data.", aSize));
+			}
+		}
+	}
+
+	size_t lz4_compress_bound(size_t aInputSize)
+	{
+		return aInputSize + aInputSize / 255 + 16;
+	}
+
+	size_t lz4_compress_block(std::span<const std::byte> aInput, std::byte* aOutput)
+	{
+		const auto* input = reinterpret_cast<const std::uint8_t*>(aInput.data());
+		const auto inputSize = aInput.size();
+		auto* output = reinterpret_cast<std::uint8_t*>(aOutput);
+		auto* op = output;
+
+		size_t anchor = 0;
+		if (inputSize > cMatchFindLimit) {
+			// Positions of the most recent occurrences of 4-byte sequences, indexed by their hash:
+			std::vector<std::uint32_t> hashTable(size_t{ 1 } << cHashLog, 0u);
+			const size_t matchFindLimit = inputSize - cMatchFindLimit;
+			const size_t matchLimit = inputSize - cLastLiterals;
+
+			size_t ip = 0;
+			while (ip < matchFindLimit) {
+				const auto sequence = read_u32(input + ip);
+				auto& entry = hashTable[hash_sequence(sequence)];
+				const size_t candidate = entry;
+				entry = static_cast<std::uint32_t>(ip);
+
+				if (candidate >= ip || ip - candidate > cMaxOffset || read_u32(input + candidate) != sequence) {
+					// No match => skip ahead faster, the longer no match has been found:
+					ip += 1 + ((ip - anchor) >> 6);
+					continue;
+				}
+
+				auto matchLength = cMinMatch;
+				while (ip + matchLength < matchLimit && input[candidate + matchLength] == input[ip + matchLength]) {
+					++matchLength;
+				}
+				op = write_sequence(op, input + anchor, ip - anchor, std::make_tuple(ip - candidate, matchLength));
+				ip += matchLength;
+				anchor = ip;
+			}
+		}
+
+		// The remaining bytes are stored as literals:
+		op = write_sequence(op, input + anchor, inputSize - anchor, {});
+		return static_cast<size_t>(op - output);
+	}
+
+	bool lz4_decompress_block(std::span<const std::byte> aInput, std::span<std::byte> aOutput)
+	{
+		const auto* ip = reinterpret_cast<const std::uint8_t*>(aInput.data());
+		const auto* const inputEnd = ip + aInput.size();
+		auto* const outputBegin = reinterpret_cast<std::uint8_t*>(aOutput.data());
+		auto* op = outputBegin;
+		auto* const outputEnd = op + aOutput.size();
+
+		while (ip < inputEnd) {
+			const auto token = *ip++;
+
+			size_t literalsLength = token >> 4;
+			if (15 == literalsLength && !read_length(ip, inputEnd, literalsLength)) {
+				return false;
+			}
+			if (literalsLength > static_cast<size_t>(inputEnd - ip) || literalsLength > static_cast<size_t>(outputEnd - op)) {
+				return false;
+			}
+			std::memcpy(op, ip, literalsLength);
+			ip += literalsLength;
+			op += literalsLength;
+
+			if (ip == inputEnd) {
+				break; // The last sequence consists of literals only
+			}
+
+			if (inputEnd - ip < 2) {
+				return false;
+			}
+			const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+			ip += 2;
+			if (0 == offset || offset > static_cast<size_t>(op - outputBegin)) {
+				return false;
+			}
+
+			size_t matchLength = token & 0x0F;
+			if (15 == matchLength && !read_length(ip, inputEnd, matchLength)) {
+				return false;
+			}
+			matchLength += cMinMatch;
+			if (matchLength > static_cast<size_t>(outputEnd - op)) {
+				return false;
+			}
+
+			const auto* match = op - offset;
+			if (offset >= matchLength) {
+				std::memcpy(op, match, matchLength);
+				op += matchLength;
+			}
+			else {
+				// Overlapping copy, e.g., a repeated pattern => must be copied front to back
+				for (size_t i = 0; i < matchLength; ++i) {
+					*op++ = *match++;
+				}
+			}
+		}
+
+		return op == outputEnd;
+	}
+
+	std::optional<std::uint32_t> block_compressed_file_version(const std::filesystem::path& aPath)
+	{
+		std::ifstream stream(aPath, std::ios::binary);
+		block_compressed_stream_header header;
+		if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) || cBlockCompressedMagic != header.mMagic) {
+			return {};
+		}
+		return header.mVersion;
+	}
+
+	bool is_block_compressed_file(const std::filesystem::path& aPath)
+	{
+		return block_compressed_file_version(aPath).has_value();
+	}
+
+	block_compressing_streambuf::block_compressing_streambuf(std::streambuf& aSink, std::uint32_t aVersion, size_t aBlockSize)
+		: mSink{ aSink }
+		, mBlock(std::clamp<size_t>(aBlockSize, 4096, cStoredUncompressedFlag - 1))
+		, mCompressed(lz4_compress_bound(mBlock.size()))
+	{
+		const block_compressed_stream_header header{ cBlockCompressedMagic, aVersion, static_cast<std::uint32_t>(mBlock.size()), 0 };
+		write_to_sink(mSink, &header, sizeof(header));
+		mStatistics.mCompressedBytes += sizeof(header);
+		setp(mBlock.data(), mBlock.data() + mBlock.size());
+	}
+
+	block_compressing_streambuf::~block_compressing_streambuf()
+	{
+		try {
+			write_block();
+		}
+		catch (const std::exception& e) {
+			LOG_ERROR(std::format("Failed to write the last block of a compressed stream: {}", e.what()));
+		}
+	}
+
+	void block_compressing_streambuf::write_block()
+	{
+		const auto size = static_cast<size_t>(pptr() - pbase());
+		if (0 == size) {
+			return;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		const auto compressedSize = lz4_compress_block(std::as_bytes(std::span<const char>(pbase(), size)), mCompressed.data());
+		mStatistics.mCodecSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		block_header header{ static_cast<std::uint32_t>(compressedSize), static_cast<std::uint32_t>(size) };
+		const void* data = mCompressed.data();
+		if (compressedSize >= size) {
+			// Incompressible, e.g., already compressed texture data => store it as is
+			header.mCompressedSize = static_cast<std::uint32_t>(size) | cStoredUncompressedFlag;
+			data = pbase();
+		}
+		write_to_sink(mSink, &header, sizeof(header));
+		write_to_sink(mSink, data, header.mCompressedSize & ~cStoredUncompressedFlag);
+
+		mStatistics.mUncompressedBytes += size;
+		mStatistics.mCompressedBytes += sizeof(header) + (header.mCompressedSize & ~cStoredUncompressedFlag);
+		++mStatistics.mBlocks;
+		setp(mBlock.data(), mBlock.data() + mBlock.size());
+	}
+
+	block_compressing_streambuf::int_type block_compressing_streambuf::overflow(int_type aChar)
+	{
+		write_block();
+		if (!traits_type::eq_int_type(aChar, traits_type::eof())) {
+			*pptr() = traits_type::to_char_type(aChar);
+			pbump(1);
+		}
+		return traits_type::not_eof(aChar);
+	}
+
+	int block_compressing_streambuf::sync()
+	{
+		write_block();
+		return mSink.pubsync();
+	}
+
+	block_compressing_streambuf::pos_type block_compressing_streambuf::seekoff(off_type aOffset, std::ios_base::seekdir aDirection, std::ios_base::openmode aMode)
+	{
+		// Only reporting the current (uncompressed) position is supported:
+		if (0 != aOffset || std::ios_base::cur != aDirection || !(aMode & std::ios_base::out)) {
+			return pos_type(off_type(-1));
+		}
+		return pos_type(static_cast<off_type>(mStatistics.mUncompressedBytes + static_cast<std::uint64_t>(pptr() - pbase())));
+	}
+
+	block_decompressing_streambuf::block_decompressing_streambuf(std::span<const std::byte> aSource, unsigned int aNumWorkers, std::function<void(std::span<const std::byte>)> aVerifyBlock)
+		: mVerifyBlock{ std::move(aVerifyBlock) }
+	{
+		block_compressed_stream_header header;
+		if (aSource.size() < sizeof(header)) {
+			throw avk::runtime_error("The data is too small to be a block-compressed stream.");
+		}
+		std::memcpy(&header, aSource.data(), sizeof(header));
+		if (cBlockCompressedMagic != header.mMagic) {
+			throw avk::runtime_error("The data is not a block-compressed stream.");
+		}
+
+		// Gather all blocks up front, so that the workers can decompress them in any order:
+		size_t offset = sizeof(header);
+		std::uint64_t uncompressedOffset = 0;
+		while (offset < aSource.size()) {
+			block_header blockHeader;
+			if (aSource.size() - offset < sizeof(blockHeader)) {
+				throw avk::runtime_error("Block-compressed stream ends with a truncated block header.");
+			}
+			std::memcpy(&blockHeader, aSource.data() + offset, sizeof(blockHeader));
+			offset += sizeof(blockHeader);
+
+			const auto storedUncompressed = 0 != (blockHeader.mCompressedSize & cStoredUncompressedFlag);
+			const auto dataSize = static_cast<size_t>(blockHeader.mCompressedSize & ~cStoredUncompressedFlag);
+			if (aSource.size() - offset < dataSize || blockHeader.mUncompressedSize > header.mBlockSize
+				|| (storedUncompressed && dataSize != blockHeader.mUncompressedSize)) {
+				throw avk::runtime_error("Block-compressed stream contains an invalid or truncated block.");
+			}
+			mBlocks.push_back(block_info{ aSource.subspan(offset, dataSize), uncompressedOffset, blockHeader.mUncompressedSize, storedUncompressed });
+			offset += dataSize;
+			uncompressedOffset += blockHeader.mUncompressedSize;
+		}
+
+		if (0 == aNumWorkers) {
+			aNumWorkers = std::clamp(std::thread::hardware_concurrency(), 2u, 9u) - 1u;
+		}
+		aNumWorkers = static_cast<unsigned int>(std::min<size_t>(aNumWorkers, std::max<size_t>(mBlocks.size(), 1)));
+		// Two slots per worker, so that workers can keep decompressing while the reader processes a block:
+		mSlots.resize(2 * static_cast<size_t>(aNumWorkers));
+		mSlotBlockIndices.resize(mSlots.size(), -1);
+		mStatistics.mCompressedBytes = aSource.size();
+		for (unsigned int i = 0; i < aNumWorkers; ++i) {
+			mWorkers.emplace_back([this]() { worker(); });
+		}
+		setg(nullptr, nullptr, nullptr);
+	}
+
+	block_decompressing_streambuf::~block_decompressing_streambuf()
+	{
+		{
+			std::scoped_lock lock(mMutex);
+			mStop = true;
+		}
+		mCondition.notify_all();
+		for (auto& worker : mWorkers) {
+			worker.join();
+		}
+	}
+
+	block_compression_statistics block_decompressing_streambuf::statistics() const
+	{
+		std::scoped_lock lock(mMutex);
+		return mStatistics;
+	}
+
+	void block_decompressing_streambuf::worker()
+	{
+		while (true) {
+			size_t blockIndex;
+			{
+				std::unique_lock lock(mMutex);
+				// Only decompress up to mSlots.size() blocks ahead of the reader, because their slots are still in use otherwise:
+				mCondition.wait(lock, [this]() {
+					return mStop || mError || mNextBlockToDecompress >= mBlocks.size()
+						|| static_cast<std::int64_t>(mNextBlockToDecompress) < std::max<std::int64_t>(mCurrentBlock, 0) + static_cast<std::int64_t>(mSlots.size());
+				});
+				if (mStop || mError || mNextBlockToDecompress >= mBlocks.size()) {
+					return;
+				}
+				blockIndex = mNextBlockToDecompress++;
+			}
+
+			const auto& block = mBlocks[blockIndex];
+			auto& slot = mSlots[blockIndex % mSlots.size()];
+			slot.resize(block.mUncompressedSize);
+
+			const auto start = std::chrono::steady_clock::now();
+			std::exception_ptr error;
+			try {
+				if (mVerifyBlock) {
+					mVerifyBlock(block.mData);
+				}
+				if (block.mStoredUncompressed) {
+					std::memcpy(slot.data(), block.mData.data(), block.mData.size());
+				}
+				else if (!lz4_decompress_block(block.mData, std::as_writable_bytes(std::span<char>(slot)))) {
+					throw avk::runtime_error(std::format("Block {} of a block-compressed stream is corrupted.", blockIndex));
+				}
+			}
+			catch (...) {
+				error = std::current_exception();
+			}
+			const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			{
+				std::scoped_lock lock(mMutex);
+				if (error && !mError) {
+					mError = error;
+				}
+				mSlotBlockIndices[blockIndex % mSlots.size()] = static_cast<std::int64_t>(blockIndex);
+				mStatistics.mUncompressedBytes += block.mUncompressedSize;
+				mStatistics.mCodecSeconds += seconds;
+				++mStatistics.mBlocks;
+			}
+			mCondition.notify_all();
+		}
+	}
+
+	block_decompressing_streambuf::int_type block_decompressing_streambuf::underflow()
+	{
+		if (gptr() < egptr()) {
+			return traits_type::to_int_type(*gptr());
+		}
+
+		std::unique_lock lock(mMutex);
+		const auto nextBlock = mCurrentBlock + 1;
+		if (nextBlock >= static_cast<std::int64_t>(mBlocks.size())) {
+			return traits_type::eof();
+		}
+		// Moving on releases the slot of the current block:
+		mCurrentBlock = nextBlock;
+		mCondition.notify_all();
+
+		auto& slotBlockIndex = mSlotBlockIndices[nextBlock % mSlots.size()];
+		mCondition.wait(lock, [&]() { return mError || slotBlockIndex == nextBlock; });
+		if (mError) {
+			std::rethrow_exception(mError);
+		}
+
+		auto& slot = mSlots[nextBlock % mSlots.size()];
+		setg(slot.data(), slot.data(), slot.data() + slot.size());
+		if (slot.empty()) {
+			lock.unlock();
+			return underflow();
+		}
+		return traits_type::to_int_type(*gptr());
+	}
+
+	block_decompressing_streambuf::pos_type block_decompressing_streambuf::seekoff(off_type aOffset, std::ios_base::seekdir aDirection, std::ios_base::openmode aMode)
+	{
+		// Only reporting the current (uncompressed) position is supported:
+		if (0 != aOffset || std::ios_base::cur != aDirection || !(aMode & std::ios_base::in)) {
+			return pos_type(off_type(-1));
+		}
+		if (mCurrentBlock < 0) {
+			return pos_type(off_type(0));
+		}
+		const auto& block = mBlocks[static_cast<size_t>(mCurrentBlock)];
+		return pos_type(static_cast<off_type>(block.mUncompressedOffset + static_cast<std::uint64_t>(gptr() - eback())));
+	}
+}
@@ -0,0 +1,191 @@
+#include "cache_dependencies.hpp"
+#include "content_hash.hpp"
+#include "serializer.hpp"
+
+namespace avk
+{
+	template<typename Archive>
+	void serialize(Archive& aArchive, cache_file_dependency& aValue)
+	{
+		aArchive(
+			aValue.mPath,
+			aValue.mSize,
+			aValue.mLastWriteTime,
+			aValue.mContentHash
+		);
+	}
+
+	template<typename Archive>
+	void serialize(Archive& aArchive, cache_setting_dependency& aValue)
+	{
+		aArchive(
+			aValue.mName,
+			aValue.mValue
+		);
+	}
+
+	namespace
+	{
+		/** The content of a dependency record file */
+		struct cache_dependency_record
+		{
+			std::uint32_t mVersion = SERIALIZER_CACHE_FILE_VERSION;
+			/** The cache file's state when the record has been written, to detect cache files which have been written without a record */
+			std::uint64_t mCacheFileSize = 0;
+			std::int64_t mCacheFileLastWriteTime = 0;
+			std::vector<cache_file_dependency> mFiles;
+			std::vector<cache_setting_dependency> mSettings;
+		};
+
+		template<typename Archive>
+		void serialize(Archive& aArchive, cache_dependency_record& aValue)
+		{
+			aArchive(
+				aValue.mVersion,
+				aValue.mCacheFileSize,
+				aValue.mCacheFileLastWriteTime,
+				aValue.mFiles,
+				aValue.mSettings
+			);
+		}
+
+		std::int64_t last_write_time_ticks(const std::string& aPath, std::error_code& aErrorCode)
+		{
+			return static_cast<std::int64_t>(std::filesystem::last_write_time(aPath, aErrorCode).time_since_epoch().count());
+		}
+	}
+
+	cache_file_dependency cache_file_dependency::from_file(const std::string& aPath)
+	{
+		std::error_code errorCode;
+		auto size = std::filesystem::file_size(aPath, errorCode);
+		auto lastWriteTime = last_write_time_ticks(aPath, errorCode);
+		if (errorCode) {
+			throw avk::runtime_error(std::format("Unable to query the state of cache dependency '{}': {}", aPath, errorCode.message()));
+		}
+		return cache_file_dependency{ aPath, static_cast<std::uint64_t>(size), lastWriteTime, file_content_hash(aPath) };
+	}
+
+	bool cache_file_dependency::is_up_to_date() const
+	{
+		std::error_code errorCode;
+		auto size = std::filesystem::file_size(mPath, errorCode);
+		if (errorCode || static_cast<std::uint64_t>(size) != mSize) {
+			return false;
+		}
+		auto lastWriteTime = last_write_time_ticks(mPath, errorCode);
+		if (errorCode) {
+			return false;
+		}
+		if (lastWriteTime == mLastWriteTime) {
+			return true;
+		}
+		try {
+			return file_content_hash(mPath) == mContentHash;
+		}
+		catch (const avk::runtime_error&) {
+			return false;
+		}
+	}
+
+	cache_dependencies& cache_dependencies::add_file(std::string aPath)
+	{
+		if (std::find(std::begin(mFiles), std::end(mFiles), aPath) == std::end(mFiles)) {
+			mFiles.push_back(std::move(aPath));
+		}
+		return *this;
+	}
+
+	std::string cache_dependency_record_path(std::string_view aCacheFilePath)
+	{
+		return std::string(aCacheFilePath) + ".deps";
+	}
+
+	bool is_cache_up_to_date(std::string_view aCacheFilePath, const cache_dependencies& aDependencies)
+	{
+		const auto cacheFilePath = std::string(aCacheFilePath);
+		const auto recordPath = cache_dependency_record_path(aCacheFilePath);
+		if (!does_cache_file_exist(cacheFilePath) || !does_cache_file_exist(recordPath)) {
+			return false;
+		}
+
+		cache_dependency_record record;
+		try {
+			std::ifstream stream(recordPath, std::ios::binary);
+			cereal::BinaryInputArchive archive(stream);
+			archive(record);
+		}
+		catch (const cereal::Exception&) {
+			LOG_WARNING(std::format("The dependency record of cache file '{}' is invalid.", cacheFilePath));
+			return false;
+		}
+
+		if (SERIALIZER_CACHE_FILE_VERSION != record.mVersion) {
+			LOG_INFO(std::format("Cache file '{}' has been written by a different serializer version.", cacheFilePath));
+			return false;
+		}
+
+		std::error_code errorCode;
+		auto cacheFileSize = std::filesystem::file_size(cacheFilePath, errorCode);
+		auto cacheFileLastWriteTime = last_write_time_ticks(cacheFilePath, errorCode);
+		if (errorCode || static_cast<std::uint64_t>(cacheFileSize) != record.mCacheFileSize || cacheFileLastWriteTime != record.mCacheFileLastWriteTime) {
+			LOG_INFO(std::format("Cache file '{}' has been modified after its dependencies have been recorded.", cacheFilePath));
+			return false;
+		}
+
+		if (aDependencies.settings() != record.mSettings) {
+			LOG_INFO(std::format("The settings of cache file '{}' have changed.", cacheFilePath));
+			return false;
+		}
+
+		for (const auto& path : aDependencies.files()) {
+			auto it = std::find_if(std::begin(record.mFiles), std::end(record.mFiles), [&path](const cache_file_dependency& aFile) { return aFile.mPath == path; });
+			if (std::end(record.mFiles) == it) {
+				LOG_INFO(std::format("Cache file '{}' has not been generated from '{}'.", cacheFilePath, path));
+				return false;
+			}
+		}
+
+		for (const auto& file : record.mFiles) {
+			if (!file.is_up_to_date()) {
+				LOG_INFO(std::format("Cache file '{}' is stale because '{}' has changed.", cacheFilePath, file.mPath));
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void write_cache_dependency_record(std::string_view aCacheFilePath, const cache_dependencies& aDependencies)
+	{
+		const auto cacheFilePath = std::string(aCacheFilePath);
+		const auto recordPath = cache_dependency_record_path(aCacheFilePath);
+
+		cache_dependency_record record;
+		std::error_code errorCode;
+		record.mCacheFileSize = static_cast<std::uint64_t>(std::filesystem::file_size(cacheFilePath, errorCode));
+		record.mCacheFileLastWriteTime = last_write_time_ticks(cacheFilePath, errorCode);
+		if (errorCode) {
+			throw avk::runtime_error(std::format("Unable to query the state of cache file '{}': {}", cacheFilePath, errorCode.message()));
+		}
+		for (const auto& path : aDependencies.files()) {
+			record.mFiles.push_back(cache_file_dependency::from_file(path));
+		}
+		record.mSettings = aDependencies.settings();
+
+		std::ofstream stream(recordPath, std::ios::binary | std::ios::trunc);
+		{
+			cereal::BinaryOutputArchive archive(stream);
+			archive(record);
+		}
+		stream.close();
+		if (!stream) {
+			throw avk::runtime_error(std::format("Unable to write the dependency record '{}'.", recordPath));
+		}
+	}
+
+	void remove_cache_dependency_record(std::string_view aCacheFilePath)
+	{
+		std::error_code errorCode;
+		std::filesystem::remove(cache_dependency_record_path(aCacheFilePath), errorCode);
+	}
+}
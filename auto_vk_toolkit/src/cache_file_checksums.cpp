@@ -0,0 +1,260 @@
+#include "cache_file_checksums.hpp"
+#include "content_hash.hpp"
+
+namespace avk
+{
+	namespace
+	{
+		/** "AVKS" in little endian byte order */
+		constexpr std::uint32_t cCacheFileChecksumsMagic = 0x534B5641u;
+
+		/** Stored at the very end of the file, after the checksums */
+		struct cache_file_checksums_footer
+		{
+			std::uint64_t mPayloadSize;
+			std::uint64_t mBlockSize;
+			/** content_hash of the checksums, see checksums_checksum */
+			std::uint64_t mChecksumsChecksum;
+			std::uint32_t mVersion;
+			std::uint32_t mMagic;
+		};
+
+		/** Computes the checksum of the checksums, which also covers the payload size and the block size */
+		std::uint64_t checksums_checksum(std::uint64_t aPayloadSize, std::uint64_t aBlockSize, const std::vector<std::uint64_t>& aBlockChecksums)
+		{
+			const std::array<std::uint64_t, 2> sizes{ aPayloadSize, aBlockSize };
+			return content_hash(aBlockChecksums.data(), aBlockChecksums.size() * sizeof(std::uint64_t), content_hash(sizes.data(), sizeof(sizes)));
+		}
+
+		/** Validates the footer against the size of the file; returns the number of blocks if it is valid */
+		std::optional<std::uint64_t> validate_footer(const cache_file_checksums_footer& aFooter, std::uint64_t aFileSize, std::uint32_t aVersion)
+		{
+			if (cCacheFileChecksumsMagic != aFooter.mMagic || aVersion != aFooter.mVersion || 0 == aFooter.mBlockSize) {
+				return {};
+			}
+			const auto numBlocks = (aFooter.mPayloadSize + aFooter.mBlockSize - 1) / aFooter.mBlockSize;
+			if (aFooter.mPayloadSize > aFileSize || numBlocks > (aFileSize - aFooter.mPayloadSize) / sizeof(std::uint64_t)
+				|| aFooter.mPayloadSize + numBlocks * sizeof(std::uint64_t) + sizeof(cache_file_checksums_footer) != aFileSize) {
+				return {};
+			}
+			return numBlocks;
+		}
+
+		std::optional<cache_file_checksums> make_checksums(const cache_file_checksums_footer& aFooter, std::vector<std::uint64_t> aBlockChecksums)
+		{
+			if (checksums_checksum(aFooter.mPayloadSize, aFooter.mBlockSize, aBlockChecksums) != aFooter.mChecksumsChecksum) {
+				return {};
+			}
+			return cache_file_checksums{ aFooter.mPayloadSize, aFooter.mBlockSize, std::move(aBlockChecksums) };
+		}
+
+		void write_to_sink(std::streambuf& aSink, const void* aData, size_t aSize)
+		{
+			if (aSink.sputn(static_cast<const char*>(aData), static_cast<std::streamsize>(aSize)) != static_cast<std::streamsize>(aSize)) {
+				throw avk::runtime_error(std::format("Failed to write {} bytes to the cache file.", aSize));
+			}
+		}
+	}
+
+	std::optional<cache_file_checksums> read_cache_file_checksums(std::span<const std::byte> aFile, std::uint32_t aVersion)
+	{
+		cache_file_checksums_footer footer;
+		if (aFile.size() < sizeof(footer)) {
+			return {};
+		}
+		std::memcpy(&footer, aFile.data() + aFile.size() - sizeof(footer), sizeof(footer));
+		const auto numBlocks = validate_footer(footer, aFile.size(), aVersion);
+		if (!numBlocks.has_value()) {
+			return {};
+		}
+		std::vector<std::uint64_t> blockChecksums(static_cast<size_t>(numBlocks.value()));
+		std::memcpy(blockChecksums.data(), aFile.data() + footer.mPayloadSize, blockChecksums.size() * sizeof(std::uint64_t));
+		return make_checksums(footer, std::move(blockChecksums));
+	}
+
+	std::optional<cache_file_checksums> read_cache_file_checksums(const std::filesystem::path& aPath, std::uint32_t aVersion)
+	{
+		std::error_code errorCode;
+		const auto fileSize = static_cast<std::uint64_t>(std::filesystem::file_size(aPath, errorCode));
+		cache_file_checksums_footer footer;
+		if (errorCode || fileSize < sizeof(footer)) {
+			return {};
+		}
+		std::ifstream stream(aPath, std::ios::binary);
+		stream.seekg(static_cast<std::streamoff>(fileSize - sizeof(footer)));
+		if (!stream.read(reinterpret_cast<char*>(&footer), sizeof(footer))) {
+			return {};
+		}
+		const auto numBlocks = validate_footer(footer, fileSize, aVersion);
+		if (!numBlocks.has_value()) {
+			return {};
+		}
+		std::vector<std::uint64_t> blockChecksums(static_cast<size_t>(numBlocks.value()));
+		stream.seekg(static_cast<std::streamoff>(footer.mPayloadSize));
+		if (!stream.read(reinterpret_cast<char*>(blockChecksums.data()), static_cast<std::streamsize>(blockChecksums.size() * sizeof(std::uint64_t)))) {
+			return {};
+		}
+		return make_checksums(footer, std::move(blockChecksums));
+	}
+
+	checksumming_streambuf::checksumming_streambuf(std::streambuf& aSink, size_t aBlockSize)
+		: mSink{ aSink }
+		, mBlock(std::max<size_t>(aBlockSize, 4096))
+	{
+		setp(mBlock.data(), mBlock.data() + mBlock.size());
+	}
+
+	void checksumming_streambuf::write_block()
+	{
+		const auto size = static_cast<size_t>(pptr() - pbase());
+		if (0 == size) {
+			return;
+		}
+		mChecksums.push_back(content_hash(pbase(), size, mChecksums.size()));
+		write_to_sink(mSink, pbase(), size);
+		mPayloadSize += size;
+		setp(mBlock.data(), mBlock.data() + mBlock.size());
+	}
+
+	void checksumming_streambuf::finish(std::uint32_t aVersion)
+	{
+		write_block();
+		write_to_sink(mSink, mChecksums.data(), mChecksums.size() * sizeof(std::uint64_t));
+		const cache_file_checksums_footer footer{ mPayloadSize, mBlock.size(), checksums_checksum(mPayloadSize, mBlock.size(), mChecksums), aVersion, cCacheFileChecksumsMagic };
+		write_to_sink(mSink, &footer, sizeof(footer));
+		if (0 != mSink.pubsync()) {
+			throw avk::runtime_error("Failed to write the checksums of the cache file.");
+		}
+	}
+
+	checksumming_streambuf::int_type checksumming_streambuf::overflow(int_type aChar)
+	{
+		write_block();
+		if (!traits_type::eq_int_type(aChar, traits_type::eof())) {
+			*pptr() = traits_type::to_char_type(aChar);
+			pbump(1);
+		}
+		return traits_type::not_eof(aChar);
+	}
+
+	int checksumming_streambuf::sync()
+	{
+		// An incomplete block stays in the put area, because every checksum covers a whole block:
+		return mSink.pubsync();
+	}
+
+	checksumming_streambuf::pos_type checksumming_streambuf::seekoff(off_type aOffset, std::ios_base::seekdir aDirection, std::ios_base::openmode aMode)
+	{
+		// Only reporting the current position is supported:
+		if (0 != aOffset || std::ios_base::cur != aDirection || !(aMode & std::ios_base::out)) {
+			return pos_type(off_type(-1));
+		}
+		return pos_type(static_cast<off_type>(mPayloadSize + static_cast<std::uint64_t>(pptr() - pbase())));
+	}
+
+	checksum_verifier::checksum_verifier(std::span<const std::byte> aPayload, cache_file_checksums aChecksums)
+		: mPayload{ aPayload.first(std::min<size_t>(aPayload.size(), static_cast<size_t>(aChecksums.mPayloadSize))) }
+		, mChecksums{ std::move(aChecksums) }
+	{
+		mWorker = std::thread([this]() { worker(); });
+	}
+
+	checksum_verifier::~checksum_verifier()
+	{
+		{
+			std::scoped_lock lock(mMutex);
+			mStop = true;
+		}
+		mCondition.notify_all();
+		mWorker.join();
+	}
+
+	bool checksum_verifier::has_failed() const
+	{
+		std::scoped_lock lock(mMutex);
+		return mFailedBlock.has_value();
+	}
+
+	void checksum_verifier::wait_until_verified(size_t aEnd) const
+	{
+		std::unique_lock lock(mMutex);
+		mCondition.wait(lock, [&]() { return mStop || mFailedBlock.has_value() || aEnd <= mVerifiedBytes.load(); });
+		if (aEnd <= mVerifiedBytes.load()) {
+			return;
+		}
+		if (mFailedBlock.has_value()) {
+			const auto begin = mFailedBlock.value() * mChecksums.mBlockSize;
+			throw cache_file_corrupted_error(std::format("The cache file is corrupted: bytes {} to {} do not match their checksum.", begin, std::min(begin + mChecksums.mBlockSize, mChecksums.mPayloadSize)));
+		}
+		throw avk::runtime_error("The verification of the cache file has been stopped.");
+	}
+
+	void checksum_verifier::worker()
+	{
+		const auto blockSize = static_cast<size_t>(mChecksums.mBlockSize);
+		for (size_t i = 0; i < mChecksums.mBlockChecksums.size(); ++i) {
+			const auto begin = i * blockSize;
+			const auto size = std::min(blockSize, mPayload.size() - std::min(begin, mPayload.size()));
+			const bool valid = size == std::min<std::uint64_t>(blockSize, mChecksums.mPayloadSize - begin)
+				&& content_hash(mPayload.data() + begin, size, i) == mChecksums.mBlockChecksums[i];
+
+			{
+				std::scoped_lock lock(mMutex);
+				if (!valid) {
+					mFailedBlock = i;
+				}
+				else {
+					mVerifiedBytes.store(begin + size, std::memory_order_release);
+				}
+				if (!valid || mStop) {
+					mCondition.notify_all();
+					return;
+				}
+			}
+			mCondition.notify_all();
+		}
+	}
+
+	verifying_streambuf::verifying_streambuf(std::streambuf& aSource, cache_file_checksums aChecksums)
+		: mSource{ aSource }
+		, mChecksums{ std::move(aChecksums) }
+		, mBlock(static_cast<size_t>(mChecksums.mBlockSize))
+	{
+		setg(nullptr, nullptr, nullptr);
+	}
+
+	verifying_streambuf::int_type verifying_streambuf::underflow()
+	{
+		if (gptr() < egptr()) {
+			return traits_type::to_int_type(*gptr());
+		}
+
+		const auto nextBlock = static_cast<size_t>(mCurrentBlock + 1);
+		if (nextBlock >= mChecksums.mBlockChecksums.size()) {
+			return traits_type::eof();
+		}
+		const auto begin = nextBlock * mChecksums.mBlockSize;
+		const auto size = static_cast<size_t>(std::min(mChecksums.mBlockSize, mChecksums.mPayloadSize - begin));
+		const auto bytesRead = mSource.sgetn(mBlock.data(), static_cast<std::streamsize>(size));
+		if (bytesRead != static_cast<std::streamsize>(size) || content_hash(mBlock.data(), size, nextBlock) != mChecksums.mBlockChecksums[nextBlock]) {
+			mFailed = true;
+			throw cache_file_corrupted_error(std::format("The cache file is corrupted: bytes {} to {} do not match their checksum.", begin, begin + size));
+		}
+
+		mCurrentBlock = static_cast<std::int64_t>(nextBlock);
+		setg(mBlock.data(), mBlock.data(), mBlock.data() + size);
+		return traits_type::to_int_type(*gptr());
+	}
+
+	verifying_streambuf::pos_type verifying_streambuf::seekoff(off_type aOffset, std::ios_base::seekdir aDirection, std::ios_base::openmode aMode)
+	{
+		// Only reporting the current position is supported:
+		if (0 != aOffset || std::ios_base::cur != aDirection || !(aMode & std::ios_base::in)) {
+			return pos_type(off_type(-1));
+		}
+		if (mCurrentBlock < 0) {
+			return pos_type(off_type(0));
+		}
+		return pos_type(static_cast<off_type>(static_cast<std::uint64_t>(mCurrentBlock) * mChecksums.mBlockSize + static_cast<std::uint64_t>(gptr() - eback())));
+	}
+}
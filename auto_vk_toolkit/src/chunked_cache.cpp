@@ -0,0 +1,260 @@
+#include "chunked_cache.hpp"
+
+namespace avk
+{
+	namespace
+	{
+		/** "AVKC" in little endian byte order */
+		constexpr std::uint32_t cChunkedCacheMagic = 0x434B5641u;
+
+		/** Entries' data is aligned to this many bytes within the file */
+		constexpr std::uint64_t cChunkedCacheAlignment = 16;
+
+		struct chunked_cache_header
+		{
+			std::uint32_t mMagic;
+			std::uint32_t mVersion;
+		};
+
+		/** Stored at the very end of the file, so that the table of contents can be written after all entries */
+		struct chunked_cache_footer
+		{
+			std::uint64_t mTableOfContentsOffset;
+			std::uint64_t mTableOfContentsSize;
+			std::uint64_t mTableOfContentsChecksum;
+			std::uint32_t mVersion;
+			std::uint32_t mMagic;
+		};
+	}
+
+	chunked_cache::chunked_cache(std::string_view aCacheFilePath)
+		: mPath{ aCacheFilePath }
+	{
+		if (!does_cache_file_exist(mPath)) {
+			return;
+		}
+		try {
+			mFile.emplace(std::filesystem::path(mPath));
+		}
+		catch (const avk::runtime_error& e) {
+			LOG_WARNING(std::format("Unable to open chunked cache file, starting with an empty cache: {}", e.what()));
+			return;
+		}
+		if (!read_table_of_contents()) {
+			LOG_WARNING(std::format("The chunked cache file '{}' is invalid or of a different version. Starting with an empty cache.", mPath));
+			mEntries.clear();
+			mFile.reset();
+		}
+	}
+
+	chunked_cache::~chunked_cache()
+	{
+		if (!has_unsaved_changes()) {
+			return;
+		}
+		try {
+			save();
+		}
+		catch (const std::exception& e) {
+			LOG_ERROR(std::format("Unable to save chunked cache file '{}': {}", mPath, e.what()));
+		}
+	}
+
+	bool chunked_cache::read_table_of_contents()
+	{
+		const auto* fileBegin = mFile->data();
+		const auto fileSize = mFile->size();
+		if (fileSize < sizeof(chunked_cache_header) + sizeof(chunked_cache_footer)) {
+			return false;
+		}
+
+		chunked_cache_header header;
+		std::memcpy(&header, fileBegin, sizeof(header));
+		chunked_cache_footer footer;
+		std::memcpy(&footer, fileBegin + fileSize - sizeof(footer), sizeof(footer));
+		if (cChunkedCacheMagic != header.mMagic || cChunkedCacheMagic != footer.mMagic
+			|| SERIALIZER_CACHE_FILE_VERSION != header.mVersion || SERIALIZER_CACHE_FILE_VERSION != footer.mVersion) {
+			return false;
+		}
+
+		const auto tocEnd = static_cast<std::uint64_t>(fileSize - sizeof(footer));
+		if (footer.mTableOfContentsOffset > tocEnd || footer.mTableOfContentsSize != tocEnd - footer.mTableOfContentsOffset) {
+			return false;
+		}
+		const auto* tocBegin = fileBegin + footer.mTableOfContentsOffset;
+		if (content_hash(tocBegin, static_cast<size_t>(footer.mTableOfContentsSize)) != footer.mTableOfContentsChecksum) {
+			return false;
+		}
+
+		std::vector<chunked_cache_entry> tableOfContents;
+		try {
+			mapped_binary_input_archive archive(tocBegin, tocBegin + footer.mTableOfContentsSize);
+			archive(tableOfContents);
+		}
+		catch (const cereal::Exception&) {
+			return false;
+		}
+
+		for (auto& entry : tableOfContents) {
+			if (entry.mOffset < sizeof(chunked_cache_header) || entry.mOffset > footer.mTableOfContentsOffset || entry.mSize > footer.mTableOfContentsOffset - entry.mOffset) {
+				return false;
+			}
+			auto name = entry.mName;
+			mEntries.insert_or_assign(std::move(name), entry_state{ std::move(entry), {}, false });
+		}
+		return true;
+	}
+
+	std::optional<chunked_cache_entry> chunked_cache::find(std::string_view aName) const
+	{
+		std::scoped_lock lock(mMutex);
+		auto it = mEntries.find(aName);
+		if (std::end(mEntries) == it) {
+			return {};
+		}
+		return it->second.mEntry;
+	}
+
+	bool chunked_cache::contains(std::string_view aName, std::uint64_t aKey) const
+	{
+		auto entry = find(aName);
+		return entry.has_value() && entry->mKey == aKey;
+	}
+
+	std::vector<chunked_cache_entry> chunked_cache::entries() const
+	{
+		std::scoped_lock lock(mMutex);
+		std::vector<chunked_cache_entry> result;
+		result.reserve(mEntries.size());
+		for (const auto& [name, state] : mEntries) {
+			result.push_back(state.mEntry);
+		}
+		return result;
+	}
+
+	std::optional<std::span<const std::byte>> chunked_cache::load_data(std::string_view aName, std::uint64_t aKey) const
+	{
+		std::span<const std::byte> data;
+		std::uint64_t checksum;
+		{
+			std::scoped_lock lock(mMutex);
+			auto it = mEntries.find(aName);
+			if (std::end(mEntries) == it || it->second.mEntry.mKey != aKey) {
+				return {};
+			}
+			const auto& state = it->second;
+			if (state.mUnsaved) {
+				// Has been computed in this run => no need to verify
+				return std::span<const std::byte>(state.mUnsavedData);
+			}
+			data = std::span<const std::byte>(mFile->data() + state.mEntry.mOffset, static_cast<size_t>(state.mEntry.mSize));
+			checksum = state.mEntry.mChecksum;
+		}
+
+		// Verify outside of the lock, so that multiple threads can load entries in parallel:
+		if (content_hash(data) != checksum) {
+			LOG_WARNING(std::format("Entry '{}' of chunked cache file '{}' is corrupted and has to be regenerated.", aName, mPath));
+			return {};
+		}
+		return data;
+	}
+
+	void chunked_cache::store_data(std::string_view aName, std::uint64_t aKey, std::vector<std::byte> aData)
+	{
+		auto entry = chunked_cache_entry{ std::string(aName), aKey, 0, aData.size(), content_hash(aData) };
+		std::scoped_lock lock(mMutex);
+		mEntries.insert_or_assign(std::string(aName), entry_state{ std::move(entry), std::move(aData), true });
+		mUnsavedChanges = true;
+	}
+
+	void chunked_cache::remove(std::string_view aName)
+	{
+		std::scoped_lock lock(mMutex);
+		auto it = mEntries.find(aName);
+		if (std::end(mEntries) != it) {
+			mEntries.erase(it);
+			mUnsavedChanges = true;
+		}
+	}
+
+	bool chunked_cache::has_unsaved_changes() const
+	{
+		std::scoped_lock lock(mMutex);
+		return mUnsavedChanges;
+	}
+
+	void chunked_cache::save()
+	{
+		std::scoped_lock lock(mMutex);
+
+		const auto tempPath = mPath + ".tmp";
+		std::vector<chunked_cache_entry> tableOfContents;
+		tableOfContents.reserve(mEntries.size());
+		{
+			std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+			if (!stream) {
+				throw avk::runtime_error(std::format("Unable to open '{}' for writing.", tempPath));
+			}
+
+			const chunked_cache_header header{ cChunkedCacheMagic, SERIALIZER_CACHE_FILE_VERSION };
+			stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			std::uint64_t offset = sizeof(header);
+
+			const std::array<char, cChunkedCacheAlignment> padding{};
+			for (const auto& [name, state] : mEntries) {
+				const auto paddingSize = (cChunkedCacheAlignment - offset % cChunkedCacheAlignment) % cChunkedCacheAlignment;
+				stream.write(padding.data(), static_cast<std::streamsize>(paddingSize));
+				offset += paddingSize;
+
+				const auto* data = state.mUnsaved ? state.mUnsavedData.data() : mFile->data() + state.mEntry.mOffset;
+				stream.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(state.mEntry.mSize));
+
+				auto& entry = tableOfContents.emplace_back(state.mEntry);
+				entry.mOffset = offset;
+				offset += entry.mSize;
+			}
+
+			std::vector<std::byte> tocData;
+			{
+				byte_vector_streambuf buffer(tocData);
+				std::ostream tocStream(&buffer);
+				cereal::BinaryOutputArchive archive(tocStream);
+				archive(tableOfContents);
+			}
+			stream.write(reinterpret_cast<const char*>(tocData.data()), static_cast<std::streamsize>(tocData.size()));
+
+			const chunked_cache_footer footer{ offset, tocData.size(), content_hash(tocData), SERIALIZER_CACHE_FILE_VERSION, cChunkedCacheMagic };
+			stream.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+
+			stream.close();
+			if (!stream) {
+				throw avk::runtime_error(std::format("Failed to write chunked cache file '{}'.", tempPath));
+			}
+		}
+
+		// The previous file must not be mapped anymore when it is replaced:
+		const bool wasMapped = mFile.has_value();
+		mFile.reset();
+		try {
+			std::filesystem::rename(tempPath, mPath);
+		}
+		catch (const std::filesystem::filesystem_error& e) {
+			// Keep the previous file mapped, so that the entries which have not been modified remain readable:
+			if (wasMapped) {
+				mFile.emplace(std::filesystem::path(mPath));
+			}
+			std::error_code errorCode;
+			std::filesystem::remove(tempPath, errorCode);
+			throw avk::runtime_error(std::format("Unable to replace chunked cache file '{}' with '{}': {}", mPath, tempPath, e.what()));
+		}
+		mFile.emplace(std::filesystem::path(mPath));
+
+		for (auto& entry : tableOfContents) {
+			auto& state = mEntries.at(entry.mName);
+			state.mEntry = std::move(entry);
+			state.mUnsavedData = {};
+			state.mUnsaved = false;
+		}
+		mUnsavedChanges = false;
+	}
+}
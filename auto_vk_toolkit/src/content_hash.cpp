@@ -0,0 +1,113 @@
+#include "content_hash.hpp"
+#include "memory_mapped_file.hpp"
+
+namespace avk
+{
+	namespace
+	{
+		constexpr uint64_t cPrime1 = 0x9E3779B185EBCA87ull;
+		constexpr uint64_t cPrime2 = 0xC2B2AE3D27D4EB4Full;
+		constexpr uint64_t cPrime3 = 0x165667B19E3779F9ull;
+		constexpr uint64_t cPrime4 = 0x85EBCA77C2B2AE63ull;
+		constexpr uint64_t cPrime5 = 0x27D4EB2F165667C5ull;
+
+		inline uint64_t rotate_left(uint64_t aValue, int aBits)
+		{
+			return (aValue << aBits) | (aValue >> (64 - aBits));
+		}
+
+		inline uint64_t read_u64(const uint8_t* aPtr)
+		{
+			uint64_t value;
+			std::memcpy(&value, aPtr, sizeof(value));
+			return value;
+		}
+
+		inline uint32_t read_u32(const uint8_t* aPtr)
+		{
+			uint32_t value;
+			std::memcpy(&value, aPtr, sizeof(value));
+			return value;
+		}
+
+		inline uint64_t accumulate(uint64_t aAccumulator, uint64_t aInput)
+		{
+			aAccumulator += aInput * cPrime2;
+			aAccumulator = rotate_left(aAccumulator, 31);
+			return aAccumulator * cPrime1;
+		}
+
+		inline uint64_t merge_accumulator(uint64_t aHash, uint64_t aAccumulator)
+		{
+			aHash ^= accumulate(0, aAccumulator);
+			return aHash * cPrime1 + cPrime4;
+		}
+	}
+
+	uint64_t content_hash(const void* aData, size_t aSize, uint64_t aSeed)
+	{
+		const auto* p = static_cast<const uint8_t*>(aData);
+		const auto* const end = p + aSize;
+		uint64_t hash;
+
+		if (aSize >= 32) {
+			// Four independent lanes, so that the CPU can process them in parallel:
+			uint64_t v1 = aSeed + cPrime1 + cPrime2;
+			uint64_t v2 = aSeed + cPrime2;
+			uint64_t v3 = aSeed;
+			uint64_t v4 = aSeed - cPrime1;
+			const auto* const limit = end - 32;
+			do {
+				v1 = accumulate(v1, read_u64(p));
+				v2 = accumulate(v2, read_u64(p + 8));
+				v3 = accumulate(v3, read_u64(p + 16));
+				v4 = accumulate(v4, read_u64(p + 24));
+				p += 32;
+			} while (p <= limit);
+
+			hash = rotate_left(v1, 1) + rotate_left(v2, 7) + rotate_left(v3, 12) + rotate_left(v4, 18);
+			hash = merge_accumulator(hash, v1);
+			hash = merge_accumulator(hash, v2);
+			hash = merge_accumulator(hash, v3);
+			hash = merge_accumulator(hash, v4);
+		}
+		else {
+			hash = aSeed + cPrime5;
+		}
+
+		hash += static_cast<uint64_t>(aSize);
+
+		for (; p + 8 <= end; p += 8) {
+			hash ^= accumulate(0, read_u64(p));
+			hash = rotate_left(hash, 27) * cPrime1 + cPrime4;
+		}
+		if (p + 4 <= end) {
+			hash ^= static_cast<uint64_t>(read_u32(p)) * cPrime1;
+			hash = rotate_left(hash, 23) * cPrime2 + cPrime3;
+			p += 4;
+		}
+		for (; p < end; ++p) {
+			hash ^= static_cast<uint64_t>(*p) * cPrime5;
+			hash = rotate_left(hash, 11) * cPrime1;
+		}
+
+		// Final avalanche:
+		hash ^= hash >> 33;
+		hash *= cPrime2;
+		hash ^= hash >> 29;
+		hash *= cPrime3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	uint64_t content_hash(std::span<const std::byte> aData, uint64_t aSeed)
+	{
+		return content_hash(aData.data(), aData.size(), aSeed);
+	}
+
+	uint64_t file_content_hash(const std::filesystem::path& aPath, uint64_t aSeed)
+	{
+		const memory_mapped_file file(aPath);
+		return content_hash(file.data(), file.size(), aSeed);
+	}
+}
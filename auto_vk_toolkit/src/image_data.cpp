@@ -1,6 +1,12 @@
 
 #include "image_data.hpp"
 #include "vk_convenience_functions.hpp"
+#include "mip_map_generation.hpp"
+#include "texture_compression.hpp"
+#include "ktx2.hpp"
+#include "mapped_texture_file.hpp"
+#include "pixel_conversion.hpp"
+#include <cstdlib>
 
 namespace avk
 {	
@@ -111,7 +117,222 @@ namespace avk
 		std::vector<std::unique_ptr<image_data_implementor>> image_data_implementors;
 	};
 
+	/** Implementation of image_data_implementor interface for KTX2 files, see ktx2_file
+	* Level data without supercompression is not copied, i.e., get_data points into the memory-mapped file. Supercompressed level data
+	* and Basis Universal payloads are transcoded with the transcoder which has been set by set_ktx2_transcoder, with one level per thread.
+	* Uncompressed levels are copied and flipped in place if they must be flipped; block-compressed levels are not flipped, but a warning is logged.
+	*/
+	class image_data_ktx2 : public image_data_implementor
+	{
+	public:
+		explicit image_data_ktx2(const std::string& aPath, const bool aLoadHdrIfPossible = false, const bool aLoadSrgbIfApplicable = false, const bool aFlip = false, const int aPreferredNumberOfTextureComponents = 4)
+			: image_data_implementor(aPath, aLoadHdrIfPossible, aLoadSrgbIfApplicable, aFlip, aPreferredNumberOfTextureComponents)
+		{
+		}
+
+		void load()
+		{
+			// Leave the image data empty for other files, s.t. the next image loading library is tried:
+			if (mFile || !ktx2_file::has_ktx2_identifier(path()))
+			{
+				return;
+			}
+
+			auto file = std::make_unique<ktx2_file>(path());
+			mFormat = file->format();
+			if (file->requires_transcoding())
+			{
+				transcode(*file);
+			}
+			mFile = std::move(file);
+
+			if (mFlip)
+			{
+				if (can_flip())
+				{
+					flip();
+				}
+				else
+				{
+					LOG_WARNING(std::format("The KTX2 file '{}' can not be flipped, since its format {} is block-compressed. It is loaded as it is stored.", path(), vk::to_string(mFormat)));
+				}
+			}
+		}
+
+		vk::Format get_format() const
+		{
+			return mFormat;
+		}
+
+		vk::ImageType target() const
+		{
+			return mFile->target();
+		}
+
+		extent_type extent(const uint32_t level = 0) const
+		{
+			return mFile->extent(level);
+		}
+
+		void* get_data(const uint32_t layer, const uint32_t face, const uint32_t level)
+		{
+			const size_t offset = (size_t{ layer } * faces() + face) * size(level);
+			if (!mTranscodedLevels.empty())
+			{
+				return mTranscodedLevels[level].data() + offset;
+			}
+			// The mapping is read-only, which is fine since the raw data must not be written to:
+			return const_cast<std::byte*>(mFile->level(level).mData) + offset;
+		}
+
+		size_t size() const
+		{
+			size_t total = 0;
+			for (uint32_t level = 0; level < levels(); ++level)
+			{
+				total += size_of_level(level);
+			}
+			return total;
+		}
+
+		size_t size(const uint32_t level) const
+		{
+			return size_of_level(level) / (size_t{ layers() } * faces());
+		}
+
+		bool empty() const
+		{
+			return !mFile;
+		}
+
+		uint32_t levels() const
+		{
+			return mFile->levels();
+		}
+
+		uint32_t layers() const
+		{
+			return mFile->layers();
+		}
+
+		uint32_t faces() const
+		{
+			return mFile->faces();
+		}
+
+		bool is_hdr() const
+		{
+			return mFile->is_hdr();
+		}
+
+		bool can_flip() const
+		{
+			// Rows of blocks can not be swapped without flipping the blocks themselves
+			return mFile && !avk::is_block_compressed_format(mFormat);
+		}
+
+	private:
+		/** Flips all levels in place by swapping their rows; levels which are used directly from the file are copied first, since the mapping is read-only */
+		void flip()
+		{
+			assert(can_flip());
+			if (mTranscodedLevels.empty())
+			{
+				mTranscodedLevels.resize(levels());
+				for (uint32_t level = 0; level < levels(); ++level)
+				{
+					const auto& levelData = mFile->level(level);
+					mTranscodedLevels[level].assign(levelData.mData, levelData.mData + levelData.mSize);
+				}
+			}
+
+			for (uint32_t level = 0; level < levels(); ++level)
+			{
+				const auto levelExtent = extent(level);
+				const auto sliceSize = size(level) / levelExtent.depth;
+				for (uint32_t layer = 0; layer < layers(); ++layer)
+				{
+					for (uint32_t face = 0; face < faces(); ++face)
+					{
+						auto* data = static_cast<std::byte*>(get_data(layer, face, level));
+						for (uint32_t slice = 0; slice < levelExtent.depth; ++slice)
+						{
+							flip_vertically(data + slice * sliceSize, sliceSize / levelExtent.height, levelExtent.height);
+						}
+					}
+				}
+			}
+		}
+
+		/** The size of all layers and faces of the given level */
+		size_t size_of_level(const uint32_t aLevel) const
+		{
+			return mTranscodedLevels.empty() ? mFile->level(aLevel).mSize : mTranscodedLevels[aLevel].size();
+		}
+
+		void transcode(const ktx2_file& aFile)
+		{
+			const auto& transcoder = get_ktx2_transcoder();
+			if (!transcoder)
+			{
+				throw avk::runtime_error(std::format("The KTX2 file '{}' requires transcoding, but no transcoder has been set with set_ktx2_transcoder", path()));
+			}
+
+			mFormat = ktx2_transcode_target_format(aFile);
+			const auto numLevels = aFile.levels();
+			mTranscodedLevels.resize(numLevels);
+			for (uint32_t level = 0; level < numLevels; ++level)
+			{
+				mTranscodedLevels[level].resize(ktx2_transcoded_level_size(aFile, level, mFormat));
+			}
+
+			// Levels are independent of each other; they are pulled by the threads starting with the largest one:
+			std::atomic<uint32_t> nextLevel{ 0 };
+			std::atomic<bool> failed{ false };
+			auto transcodeLevels = [&]() {
+				for (uint32_t level = nextLevel++; level < numLevels && !failed; level = nextLevel++)
+				{
+					try
+					{
+						if (!transcoder(aFile, level, mFormat, mTranscodedLevels[level].data()))
+						{
+							failed = true;
+						}
+					}
+					catch (...)
+					{
+						failed = true;
+					}
+				}
+			};
+			const auto numThreads = std::min(numLevels, std::max(std::thread::hardware_concurrency(), 1u));
+			std::vector<std::thread> threads;
+			for (uint32_t i = 1; i < numThreads; ++i)
+			{
+				threads.emplace_back(transcodeLevels);
+			}
+			transcodeLevels();
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			if (failed)
+			{
+				throw avk::runtime_error(std::format("Could not transcode the KTX2 file '{}' to {}", path(), vk::to_string(mFormat)));
+			}
+		}
+
+		std::unique_ptr<ktx2_file> mFile;
+		vk::Format mFormat = vk::Format::eUndefined;
+		/** The transcoded or flipped data of all layers and faces, per level; empty if the level data is used directly from the file */
+		std::vector<std::vector<std::byte>> mTranscodedLevels;
+	};
+
 	/** Implementation of image_data_implementor interface for loading image files with the GLI image library
+	* DDS and KTX files whose format and layout are supported by mapped_texture_file are not loaded with gli, but memory-mapped,
+	* s.t. get_data points into the mapping and the image data is paged in when it is copied, e.g., into a staging buffer. They
+	* are only loaded with gli if they must be flipped, since that requires a copy of the image data.
 	*/
 	class image_data_gli : public image_data_implementor
 	{
@@ -123,8 +344,29 @@ namespace avk
 
 		void load()
 		{
+			const auto container = mapped_texture_file::identify(path());
+			if (texture_container::unknown == container)
+			{
+				// Leave the image data empty, without gli reading the whole file, s.t. the next image loading library is tried
+				return;
+			}
+			if (texture_container::kmg != container)
+			{
+				auto file = mapped_texture_file::load(path());
+				if (file && (!mFlip || !can_flip_format(file->format())))
+				{
+					mMappedFile = std::move(file);
+					return;
+				}
+			}
+
 			gliTex = gli::load(path());
 
+			if (!gliTex.empty() && 4 == mPreferredNumberOfTextureComponents)
+			{
+				expand_rgb();
+			}
+
 			if (!gliTex.empty() && mFlip)
 			{
 				flip();
@@ -134,11 +376,19 @@ namespace avk
 		vk::Format get_format() const
 		{
 			// TODO: what if mLoadHdrIfPossible == false but file has a HDR format? Likewise, mLoadSrgbIfApplicable is not considered here.
+			if (mMappedFile)
+			{
+				return mMappedFile->format();
+			}
 			return map_format_gli_to_vk(gliTex.format());
 		};
 
 		vk::ImageType target() const
 		{
+			if (mMappedFile)
+			{
+				return vk::ImageType::e2D;
+			}
 			switch (gliTex.target())
 			{
 			case gli::TARGET_1D:
@@ -158,6 +408,10 @@ namespace avk
 
 		extent_type extent(const uint32_t level = 0) const
 		{
+			if (mMappedFile)
+			{
+				return mMappedFile->extent(level);
+			}
 			auto e = gliTex.extent(level);
 
 			return vk::Extent3D(e[0], e[1], e[2]);
@@ -165,36 +419,46 @@ namespace avk
 
 		void* get_data(const uint32_t layer, const uint32_t face, const uint32_t level)
 		{
+			if (mMappedFile)
+			{
+				// The mapping is read-only, which is fine since the raw data must not be written to:
+				return const_cast<std::byte*>(mMappedFile->data(layer, face, level));
+			}
 			return gliTex.data(layer, face, level);
 		};
 
 		size_t size() const
 		{
-			return gliTex.size();
+			return mMappedFile ? mMappedFile->size() : gliTex.size();
 		}
 
 		size_t size(const uint32_t level) const
 		{
-			return gliTex.size(level);
+			return mMappedFile ? mMappedFile->size(level) : gliTex.size(level);
 		}
 
 		uint32_t levels() const
 		{
-			return static_cast<uint32_t>(gliTex.levels());
+			return mMappedFile ? mMappedFile->levels() : static_cast<uint32_t>(gliTex.levels());
 		};
 
 		uint32_t layers() const
 		{
-			return static_cast<uint32_t>(gliTex.layers());
+			return mMappedFile ? mMappedFile->layers() : static_cast<uint32_t>(gliTex.layers());
 		};
 
 		uint32_t faces() const
 		{
-			return static_cast<uint32_t>(gliTex.faces());
+			return mMappedFile ? mMappedFile->faces() : static_cast<uint32_t>(gliTex.faces());
 		};
 
 		bool can_flip() const
 		{
+			if (mMappedFile)
+			{
+				// Mapped files are 2D textures, 2D texture arrays, or cube maps
+				return can_flip_format(mMappedFile->format());
+			}
 			switch (gliTex.target())
 			{
 			case gli::TARGET_2D:
@@ -209,18 +473,90 @@ namespace avk
 
 		bool empty() const
 		{
-			return gliTex.empty();
+			return !mMappedFile && gliTex.empty();
 		};
 
+		bool is_hdr() const
+		{
+			return mMappedFile && mMappedFile->is_hdr();
+		}
+
 	protected:
 		void flip()
 		{
 			assert(can_flip());
 
-			gliTex = gli::flip(gliTex);
+			if (gli::is_compressed(gliTex.format()))
+			{
+				gliTex = gli::flip(gliTex);
+				return;
+			}
+
+			// Uncompressed images are flipped in place instead of being copied by gli::flip
+			for (size_t layer = 0; layer < gliTex.layers(); ++layer)
+			{
+				for (size_t face = 0; face < gliTex.faces(); ++face)
+				{
+					for (size_t level = 0; level < gliTex.levels(); ++level)
+					{
+						const auto height = static_cast<uint32_t>(gliTex.extent(level).y);
+						flip_vertically(static_cast<std::byte*>(gliTex.data(layer, face, level)), gliTex.size(level) / height, height);
+					}
+				}
+			}
 		};
 
 	private:
+		/** Expands 8 bit RGB images to RGBA, since three-component formats are hardly supported by GPUs */
+		void expand_rgb()
+		{
+			gli::format rgbaFormat;
+			switch (gliTex.format())
+			{
+			case gli::format::FORMAT_RGB8_UNORM_PACK8:
+				rgbaFormat = gli::format::FORMAT_RGBA8_UNORM_PACK8;
+				break;
+			case gli::format::FORMAT_RGB8_SRGB_PACK8:
+				rgbaFormat = gli::format::FORMAT_RGBA8_SRGB_PACK8;
+				break;
+			default:
+				return;
+			}
+
+			gli::texture rgba(gliTex.target(), rgbaFormat, gliTex.extent(), gliTex.layers(), gliTex.faces(), gliTex.levels());
+			for (size_t layer = 0; layer < gliTex.layers(); ++layer)
+			{
+				for (size_t face = 0; face < gliTex.faces(); ++face)
+				{
+					for (size_t level = 0; level < gliTex.levels(); ++level)
+					{
+						const auto extent = gliTex.extent(level);
+						expand_rgb_to_rgba(static_cast<const uint8_t*>(gliTex.data(layer, face, level)), static_cast<uint8_t*>(rgba.data(layer, face, level)), static_cast<uint32_t>(extent.x), static_cast<uint32_t>(extent.y * extent.z));
+					}
+				}
+			}
+			gliTex = std::move(rgba);
+		}
+
+		/** Returns true if gli::flip supports the given format, i.e., if it is uncompressed or S3TC-compressed */
+		static bool can_flip_format(const vk::Format aFormat)
+		{
+			switch (aFormat)
+			{
+			case vk::Format::eBc1RgbUnormBlock:
+			case vk::Format::eBc1RgbSrgbBlock:
+			case vk::Format::eBc1RgbaUnormBlock:
+			case vk::Format::eBc1RgbaSrgbBlock:
+			case vk::Format::eBc2UnormBlock:
+			case vk::Format::eBc2SrgbBlock:
+			case vk::Format::eBc3UnormBlock:
+			case vk::Format::eBc3SrgbBlock:
+				return true;
+			default:
+				return !avk::is_block_compressed_format(aFormat);
+			}
+		}
+
 		/** Map GLI image format enum to Vulkan image format enum
 		* @param aGliFmt	a valid GLI format value
 		* @return the Vulkan image format enum value that corresponds to the input parameter
@@ -275,6 +611,9 @@ namespace avk
 			case gli::format::FORMAT_RGBA8_UNORM_PACK8:
 				imFmt = vk::Format::eR8G8B8A8Unorm;
 				break;
+			case gli::format::FORMAT_RGBA8_SRGB_PACK8:
+				imFmt = vk::Format::eR8G8B8A8Srgb;
+				break;
 			default:
 				imFmt = vk::Format::eUndefined;
 			}
@@ -283,6 +622,8 @@ namespace avk
 		}
 
 		gli::texture gliTex;
+		/** The DDS or KTX file whose image data is used in place; gliTex is empty if it is set */
+		std::unique_ptr<mapped_texture_file> mMappedFile;
 	};
 
 	/** Implementation of image_data_implementor interface for loading image files with the stbi image library
@@ -300,22 +641,29 @@ namespace avk
 
 		void load()
 		{
-			stbi_set_flip_vertically_on_load(mFlip);
+			// The image is flipped afterwards by flip_vertically, which swaps rows on multiple threads. The setting is thread-local,
+			// so that images can be loaded concurrently:
+			stbi_set_flip_vertically_on_load_thread(false);
 
 			int w = 0, h = 0;
 
 			mLoadHdrIfPossible = mLoadHdrIfPossible && stbi_is_hdr(path().c_str());
 
+			// RGB files are loaded with three channels, and expanded to RGBA by expand_rgb_to_rgba instead of pixel by pixel by stb_image:
+			int channelsInFile = 0;
+			const bool expandRgb = 4 == mPreferredNumberOfTextureComponents && stbi_info(path().c_str(), &w, &h, &channelsInFile) && 3 == channelsInFile;
+			const int channelsToLoad = expandRgb ? STBI_rgb : map_to_stbi_channels(mPreferredNumberOfTextureComponents);
+
 			// TODO: load 16 bit per channel files?
 			if (mLoadHdrIfPossible)
 			{
-				void* data = stbi_loadf(path().c_str(), &w, &h, &mChannelsInFile, map_to_stbi_channels(mPreferredNumberOfTextureComponents));
+				void* data = stbi_loadf(path().c_str(), &w, &h, &mChannelsInFile, channelsToLoad);
 				mData = std::unique_ptr<void, decltype(&deleter)>(data, &deleter);
 				sizeofPixelPerChannel = sizeof(float);
 			}
 			else
 			{
-				void* data = stbi_load(path().c_str(), &w, &h, &mChannelsInFile, map_to_stbi_channels(mPreferredNumberOfTextureComponents));
+				void* data = stbi_load(path().c_str(), &w, &h, &mChannelsInFile, channelsToLoad);
 				mData = std::unique_ptr<void, decltype(&deleter)>(data, &deleter);
 				sizeofPixelPerChannel = sizeof(stbi_uc);
 			}
@@ -328,6 +676,36 @@ namespace avk
 			assert(mData != nullptr);
 
 			mExtent = vk::Extent3D(w, h, 1);
+			const auto width = static_cast<uint32_t>(w);
+			const auto height = static_cast<uint32_t>(h);
+
+			if (expandRgb)
+			{
+				auto rgba = allocate(size());
+				if (mLoadHdrIfPossible)
+				{
+					expand_rgb_to_rgba(static_cast<const float*>(mData.get()), static_cast<float*>(rgba.get()), width, height);
+				}
+				else
+				{
+					expand_rgb_to_rgba(static_cast<const type_8bit*>(mData.get()), static_cast<type_8bit*>(rgba.get()), width, height);
+				}
+				mData = std::move(rgba);
+			}
+
+			// HDR formats have 16 bit floats, hence, stb_image's 32 bit floats are converted:
+			if (mLoadHdrIfPossible)
+			{
+				sizeofPixelPerChannel = sizeof(uint16_t);
+				auto halfs = allocate(size());
+				float_to_half(static_cast<const float*>(mData.get()), static_cast<uint16_t*>(halfs.get()), width, height, static_cast<uint32_t>(mPreferredNumberOfTextureComponents));
+				mData = std::move(halfs);
+			}
+
+			if (mFlip)
+			{
+				flip_vertically(static_cast<std::byte*>(mData.get()), size() / height, height);
+			}
 
 			mFormat = select_format(mPreferredNumberOfTextureComponents, mLoadHdrIfPossible, mLoadSrgbIfApplicable);
 		};
@@ -475,6 +853,20 @@ namespace avk
 			stbi_image_free(data);
 		};
 
+		// Image data which has been converted after loading is allocated with malloc() as well
+		static void free_deleter(void* data) {
+			std::free(data);
+		};
+
+		static std::unique_ptr<void, decltype(&deleter)> allocate(size_t aSize)
+		{
+			void* data = std::malloc(aSize);
+			if (nullptr == data) {
+				throw std::bad_alloc();
+			}
+			return std::unique_ptr<void, decltype(&deleter)>(data, &free_deleter);
+		}
+
 		vk::Extent3D mExtent;
 		int mChannelsInFile;
 		size_t sizeofPixelPerChannel;
@@ -483,12 +875,387 @@ namespace avk
 		std::unique_ptr<void, decltype(&deleter)> mData;
 	};
 
+	/** Implementation of image_data_implementor interface that adds mipmap levels which have been generated on the CPU to loaded image data
+	*/
+	class image_data_mip_chain : public image_data_implementor
+	{
+	public:
+		/** @param aLevel0	the loaded image data, which provides level 0
+		* @param aLevels	the pixels of levels 1 to n-1, indexed by [level - 1][face]
+		*/
+		explicit image_data_mip_chain(std::unique_ptr<image_data_implementor> aLevel0, std::vector<std::vector<std::vector<std::byte>>> aLevels)
+			: image_data_implementor(aLevel0->paths(), aLevel0->is_hdr()), mLevel0(std::move(aLevel0)), mLevels(std::move(aLevels))
+		{
+			assert(!mLevel0->empty());
+		}
+
+		void load()
+		{
+			// level 0 has been loaded already, all other levels have been generated from it
+		}
+
+		vk::Format get_format() const
+		{
+			return mLevel0->get_format();
+		}
+
+		vk::ImageType target() const
+		{
+			return mLevel0->target();
+		}
+
+		extent_type extent(const uint32_t level = 0) const
+		{
+			const auto extent0 = mLevel0->extent();
+			return 0 == level ? extent0 : extent_type(std::max(extent0.width >> level, 1u), std::max(extent0.height >> level, 1u), 1u);
+		}
+
+		void* get_data(const uint32_t layer, const uint32_t face, const uint32_t level)
+		{
+			return 0 == level ? mLevel0->get_data(layer, face, 0) : mLevels[level - 1][face].data();
+		}
+
+		size_t size() const
+		{
+			size_t total = mLevel0->size(0) * mLevel0->faces();
+			for (const auto& faces : mLevels)
+			{
+				for (const auto& face : faces)
+				{
+					total += face.size();
+				}
+			}
+			return total;
+		}
+
+		size_t size(const uint32_t level) const
+		{
+			return 0 == level ? mLevel0->size(0) : mLevels[level - 1][0].size();
+		}
+
+		bool empty() const
+		{
+			return mLevel0->empty();
+		}
+
+		uint32_t levels() const
+		{
+			return static_cast<uint32_t>(mLevels.size()) + 1;
+		}
+
+		uint32_t faces() const
+		{
+			return mLevel0->faces();
+		}
+
+		bool can_flip() const
+		{
+			return mLevel0->can_flip();
+		}
+
+		bool is_hdr() const
+		{
+			return mLevel0->is_hdr();
+		}
+
+	private:
+		std::unique_ptr<image_data_implementor> mLevel0;
+		std::vector<std::vector<std::vector<std::byte>>> mLevels;
+	};
+
+	/** Implementation of image_data_implementor interface that holds image data which has been converted on the CPU, e.g., block-compressed
+	*/
+	class image_data_converted : public image_data_implementor
+	{
+	public:
+		/** @param aSource	the image data before the conversion, which provides the paths, extents, and number of faces
+		* @param aFormat	the format after the conversion, e.g., a block-compressed one
+		* @param aLevels	the converted data of all levels, indexed by [level][face]
+		*/
+		explicit image_data_converted(const image_data_implementor& aSource, vk::Format aFormat, std::vector<std::vector<std::vector<std::byte>>> aLevels)
+			: image_data_implementor(aSource.paths(), aSource.is_hdr()), mFormat(aFormat), mFaces(aSource.faces()), mIsHdr(aSource.is_hdr()), mLevels(std::move(aLevels))
+		{
+			for (uint32_t level = 0; level < static_cast<uint32_t>(mLevels.size()); ++level)
+			{
+				mExtents.push_back(aSource.extent(level));
+			}
+		}
+
+		void load()
+		{
+			// the data has been converted from loaded image data already
+		}
+
+		vk::Format get_format() const
+		{
+			return mFormat;
+		}
+
+		vk::ImageType target() const
+		{
+			return vk::ImageType::e2D;
+		}
+
+		extent_type extent(const uint32_t level = 0) const
+		{
+			return mExtents[level];
+		}
+
+		void* get_data(const uint32_t layer, const uint32_t face, const uint32_t level)
+		{
+			return mLevels[level][face].data();
+		}
+
+		size_t size() const
+		{
+			size_t total = 0;
+			for (const auto& faces : mLevels)
+			{
+				for (const auto& face : faces)
+				{
+					total += face.size();
+				}
+			}
+			return total;
+		}
+
+		size_t size(const uint32_t level) const
+		{
+			return mLevels[level][0].size();
+		}
+
+		bool empty() const
+		{
+			return mLevels.empty();
+		}
+
+		uint32_t levels() const
+		{
+			return static_cast<uint32_t>(mLevels.size());
+		}
+
+		uint32_t faces() const
+		{
+			return mFaces;
+		}
+
+		bool is_hdr() const
+		{
+			return mIsHdr;
+		}
+
+	private:
+		vk::Format mFormat;
+		uint32_t mFaces;
+		bool mIsHdr;
+		std::vector<extent_type> mExtents;
+		std::vector<std::vector<std::vector<std::byte>>> mLevels;
+	};
+
+	namespace
+	{
+		/** Returns true if image data of the given format contains 16 bit floats, which are converted to 32 bit floats
+		 *  for generating mipmaps or compressing them, since mip_map_pixel_layout_for only supports the latter */
+		bool contains_half_floats(vk::Format aFormat, size_t aBytesPerPixel)
+		{
+			const auto layout = mip_map_pixel_layout_for(aFormat, aBytesPerPixel * 2);
+			return layout && mip_map_channel_encoding::float32 == layout->mEncoding;
+		}
+
+		/** Converts the given 16 bit floats to 32 bit floats */
+		std::vector<float> to_floats(const void* aHalfs, uint32_t aWidth, uint32_t aHeight, uint32_t aNumChannels, unsigned int aNumThreads)
+		{
+			std::vector<float> floats(size_t{ aWidth } * aHeight * aNumChannels);
+			half_to_float(static_cast<const uint16_t*>(aHalfs), floats.data(), aWidth, aHeight, aNumChannels, aNumThreads);
+			return floats;
+		}
+	}
+
+	bool image_data::generate_mip_maps(unsigned int aNumThreads)
+	{
+		assert(!empty());
+
+		if (levels() > 1 || layers() != 1 || target() != vk::ImageType::e2D)
+		{
+			return false;
+		}
+
+		const auto extent0 = extent();
+		const auto numLevels = number_of_mip_levels(extent0.width, extent0.height);
+		const size_t numPixels = size_t{ extent0.width } * extent0.height;
+		if (numLevels < 2 || 0 == numPixels || size(0) % numPixels != 0)
+		{
+			return false;
+		}
+
+		const auto bytesPerPixel = size(0) / numPixels;
+		const bool halfFloats = contains_half_floats(get_format(), bytesPerPixel);
+		const auto layout = mip_map_pixel_layout_for(get_format(), halfFloats ? bytesPerPixel * 2 : bytesPerPixel);
+		if (!layout)
+		{
+			return false;
+		}
+
+		std::vector<std::vector<std::vector<std::byte>>> generatedLevels(numLevels - 1);
+		for (uint32_t face = 0; face < faces(); ++face)
+		{
+			std::vector<std::vector<std::byte>> levelsOfFace;
+			if (halfFloats)
+			{
+				const auto floats = to_floats(get_data(0, face, 0), extent0.width, extent0.height, layout->mNumChannels, aNumThreads);
+				levelsOfFace = generate_mip_levels(*layout, reinterpret_cast<const std::byte*>(floats.data()), extent0.width, extent0.height, aNumThreads);
+				for (size_t level = 0; level < levelsOfFace.size(); ++level)
+				{
+					const auto width = std::max(extent0.width >> (level + 1), 1u);
+					const auto height = std::max(extent0.height >> (level + 1), 1u);
+					std::vector<std::byte> halfs(levelsOfFace[level].size() / 2);
+					float_to_half(reinterpret_cast<const float*>(levelsOfFace[level].data()), reinterpret_cast<uint16_t*>(halfs.data()), width, height, layout->mNumChannels, aNumThreads);
+					levelsOfFace[level] = std::move(halfs);
+				}
+			}
+			else
+			{
+				levelsOfFace = generate_mip_levels(*layout, static_cast<const std::byte*>(get_data(0, face, 0)), extent0.width, extent0.height, aNumThreads);
+			}
+			for (size_t level = 0; level < levelsOfFace.size(); ++level)
+			{
+				generatedLevels[level].push_back(std::move(levelsOfFace[level]));
+			}
+		}
+
+		pimpl = std::make_unique<image_data_mip_chain>(std::move(pimpl), std::move(generatedLevels));
+		return true;
+	}
+
+	bool image_data::compress(const texture_compression& aSettings, bool aIsNormalMap, unsigned int aNumThreads)
+	{
+		assert(!empty());
+
+		if (layers() != 1 || target() != vk::ImageType::e2D)
+		{
+			return false;
+		}
+
+		const auto extent0 = extent();
+		const size_t numPixels = size_t{ extent0.width } * extent0.height;
+		if (0 == numPixels || size(0) % numPixels != 0)
+		{
+			return false;
+		}
+		const bool halfFloats = contains_half_floats(get_format(), size(0) / numPixels);
+		const auto bytesPerPixel = halfFloats ? size(0) / numPixels * 2 : size(0) / numPixels;
+		const auto layout = mip_map_pixel_layout_for(get_format(), bytesPerPixel);
+		if (!layout)
+		{
+			return false;
+		}
+
+		// Half floats only matter for choosing BC6H, i.e., they are not translucent
+		bool hasTranslucentPixels = false;
+		for (uint32_t face = 0; face < faces() && !hasTranslucentPixels && !halfFloats; ++face)
+		{
+			hasTranslucentPixels = has_translucent_pixels(*layout, static_cast<const std::byte*>(get_data(0, face, 0)), extent0.width, extent0.height);
+		}
+		const auto blockFormat = choose_texture_block_format(get_format(), bytesPerPixel, hasTranslucentPixels, aSettings, aIsNormalMap);
+		if (!blockFormat)
+		{
+			return false;
+		}
+
+		// Encode all levels and faces at once, so that the threads are busy even for small levels:
+		const auto numLevels = std::max(levels(), 1u);
+		std::vector<std::vector<std::vector<std::byte>>> compressedLevels(numLevels);
+		std::vector<texture_compression_surface> surfaces;
+		std::vector<std::vector<float>> floatSurfaces;
+		for (uint32_t level = 0; level < numLevels; ++level)
+		{
+			const auto levelExtent = extent(level);
+			compressedLevels[level].reserve(faces());
+			for (uint32_t face = 0; face < faces(); ++face)
+			{
+				auto& blocks = compressedLevels[level].emplace_back(compressed_size(*blockFormat, levelExtent.width, levelExtent.height));
+				auto* pixels = static_cast<const std::byte*>(get_data(0, face, level));
+				if (halfFloats)
+				{
+					pixels = reinterpret_cast<const std::byte*>(floatSurfaces.emplace_back(to_floats(pixels, levelExtent.width, levelExtent.height, layout->mNumChannels, aNumThreads)).data());
+				}
+				surfaces.push_back(texture_compression_surface{ pixels, levelExtent.width, levelExtent.height, blocks.data() });
+			}
+		}
+		compress_blocks(*blockFormat, *layout, surfaces, aNumThreads);
+
+		const bool isSrgb = mip_map_channel_encoding::srgb8 == layout->mEncoding;
+		pimpl = std::make_unique<image_data_converted>(*pimpl, vulkan_format_of(*blockFormat, isSrgb), std::move(compressedLevels));
+		return true;
+	}
+
+	bool image_data::premultiply_alpha(unsigned int aNumThreads)
+	{
+		assert(!empty());
+
+		if (layers() != 1 || target() != vk::ImageType::e2D)
+		{
+			return false;
+		}
+
+		const auto extent0 = extent();
+		const size_t numPixels = size_t{ extent0.width } * extent0.height;
+		if (0 == numPixels || size(0) % numPixels != 0)
+		{
+			return false;
+		}
+		const bool halfFloats = contains_half_floats(get_format(), size(0) / numPixels);
+		const auto layout = mip_map_pixel_layout_for(get_format(), halfFloats ? size(0) / numPixels * 2 : size(0) / numPixels);
+		if (!layout || 4 != layout->mNumChannels)
+		{
+			return false;
+		}
+
+		// The data is copied, since memory-mapped image data must not be written to:
+		const auto numLevels = std::max(levels(), 1u);
+		std::vector<std::vector<std::vector<std::byte>>> premultipliedLevels(numLevels);
+		for (uint32_t level = 0; level < numLevels; ++level)
+		{
+			const auto levelExtent = extent(level);
+			premultipliedLevels[level].reserve(faces());
+			for (uint32_t face = 0; face < faces(); ++face)
+			{
+				const auto* pixels = static_cast<const std::byte*>(get_data(0, face, level));
+				auto& premultiplied = premultipliedLevels[level].emplace_back(pixels, pixels + size(level));
+				if (halfFloats)
+				{
+					auto floats = to_floats(pixels, levelExtent.width, levelExtent.height, 4, aNumThreads);
+					avk::premultiply_alpha(floats.data(), levelExtent.width, levelExtent.height, aNumThreads);
+					float_to_half(floats.data(), reinterpret_cast<uint16_t*>(premultiplied.data()), levelExtent.width, levelExtent.height, 4, aNumThreads);
+				}
+				else if (mip_map_channel_encoding::float32 == layout->mEncoding)
+				{
+					avk::premultiply_alpha(reinterpret_cast<float*>(premultiplied.data()), levelExtent.width, levelExtent.height, aNumThreads);
+				}
+				else
+				{
+					avk::premultiply_alpha(reinterpret_cast<uint8_t*>(premultiplied.data()), levelExtent.width, levelExtent.height, mip_map_channel_encoding::srgb8 == layout->mEncoding, aNumThreads);
+				}
+			}
+		}
+
+		pimpl = std::make_unique<image_data_converted>(*pimpl, get_format(), std::move(premultipliedLevels));
+		return true;
+	}
+
 	std::unique_ptr<image_data_implementor> image_data_interface::load_image_data_from_file(const std::string& aPath, const bool aLoadHdrIfPossible, const bool aLoadSrgbIfApplicable, const bool aFlip, const int aPreferredNumberOfTextureComponents)
 	{
-		// try loading with GLI
-		std::unique_ptr<image_data_implementor> retval(new image_data_gli(aPath, aLoadHdrIfPossible, aLoadSrgbIfApplicable, aFlip, aPreferredNumberOfTextureComponents));
+		// try loading as KTX2, which GLI does not support
+		std::unique_ptr<image_data_implementor> retval(new image_data_ktx2(aPath, aLoadHdrIfPossible, aLoadSrgbIfApplicable, aFlip, aPreferredNumberOfTextureComponents));
 		retval->load();
 
+		// try loading with GLI
+		if (retval->empty())
+		{
+			retval = std::unique_ptr<image_data_implementor>(new image_data_gli(aPath, aLoadHdrIfPossible, aLoadSrgbIfApplicable, aFlip, aPreferredNumberOfTextureComponents));
+			retval->load();
+		}
+
 		// try loading with stb
 		if (retval->empty())
 		{
@@ -0,0 +1,265 @@
+#include "ktx2.hpp"
+#include "context_vulkan.hpp"
+#include <cstring>
+
+namespace avk
+{
+	namespace
+	{
+		constexpr std::array<uint8_t, 12> cKtx2Identifier = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+		/** Size of the identifier, the header, and the index, i.e., the offset of the level index */
+		constexpr size_t cKtx2LevelIndexOffset = 80;
+		constexpr size_t cKtx2LevelIndexEntrySize = 24;
+
+		// Values of the basic data format descriptor block, see the Khronos Data Format Specification:
+		constexpr uint8_t cDfdModelEtc1s = 163;
+		constexpr uint8_t cDfdModelUastc = 166;
+		constexpr uint8_t cDfdTransferSrgb = 2;
+		constexpr uint8_t cDfdChannelEtc1sRrr = 3;
+		constexpr uint8_t cDfdChannelEtc1sGgg = 4;
+		constexpr uint8_t cDfdChannelEtc1sAaa = 15;
+		constexpr uint8_t cDfdChannelUastcRgba = 3;
+		constexpr uint8_t cDfdChannelUastcRrr = 4;
+		constexpr uint8_t cDfdChannelUastcRrrg = 5;
+		constexpr uint8_t cDfdChannelUastcRg = 6;
+		constexpr size_t cDfdSamplesOffset = 24;
+		constexpr size_t cDfdSampleSize = 16;
+
+		template <typename T>
+		T read_little_endian(const std::byte* aData)
+		{
+			// KTX2 files are little-endian, like all platforms supported by Vulkan
+			T value;
+			std::memcpy(&value, aData, sizeof(T));
+			return value;
+		}
+
+		bool is_within(size_t aOffset, size_t aLength, size_t aFileSize)
+		{
+			return aOffset <= aFileSize && aLength <= aFileSize - aOffset;
+		}
+
+		ktx2_transcoder sKtx2Transcoder;
+	}
+
+	ktx2_file::ktx2_file(const std::filesystem::path& aPath)
+		: mFile(aPath)
+	{
+		const auto* data = mFile.data();
+		const auto fileSize = mFile.size();
+		if (fileSize < cKtx2LevelIndexOffset || 0 != std::memcmp(data, cKtx2Identifier.data(), cKtx2Identifier.size()))
+		{
+			throw avk::runtime_error(std::format("'{}' is not a KTX2 file", aPath.string()));
+		}
+
+		mFormat           = static_cast<vk::Format>(read_little_endian<uint32_t>(data + 12));
+		mWidth            = read_little_endian<uint32_t>(data + 20);
+		mHeight           = read_little_endian<uint32_t>(data + 24);
+		mDepth            = read_little_endian<uint32_t>(data + 28);
+		mLayers           = std::max(read_little_endian<uint32_t>(data + 32), 1u);
+		mFaces            = read_little_endian<uint32_t>(data + 36);
+		// A level count of 0 requests mipmaps to be generated; the file stores level 0 only
+		const auto numLevels = std::max(read_little_endian<uint32_t>(data + 40), 1u);
+		mSupercompression = static_cast<ktx2_supercompression>(read_little_endian<uint32_t>(data + 44));
+		const auto dfdOffset = read_little_endian<uint32_t>(data + 48);
+		const auto dfdLength = read_little_endian<uint32_t>(data + 52);
+		const auto sgdOffset = read_little_endian<uint64_t>(data + 64);
+		const auto sgdLength = read_little_endian<uint64_t>(data + 72);
+
+		if (0 == mWidth || (1 != mFaces && 6 != mFaces) || numLevels > 32 || mSupercompression > ktx2_supercompression::zlib)
+		{
+			throw avk::runtime_error(std::format("The KTX2 file '{}' has an invalid or unsupported header", aPath.string()));
+		}
+		if (!is_within(cKtx2LevelIndexOffset, size_t{ numLevels } * cKtx2LevelIndexEntrySize, fileSize) || !is_within(sgdOffset, sgdLength, fileSize))
+		{
+			throw avk::runtime_error(std::format("The KTX2 file '{}' is truncated", aPath.string()));
+		}
+
+		mLevels.reserve(numLevels);
+		for (uint32_t level = 0; level < numLevels; ++level)
+		{
+			const auto* entry = data + cKtx2LevelIndexOffset + level * cKtx2LevelIndexEntrySize;
+			const auto offset = read_little_endian<uint64_t>(entry);
+			const auto length = read_little_endian<uint64_t>(entry + 8);
+			if (!is_within(offset, length, fileSize))
+			{
+				throw avk::runtime_error(std::format("Level {} of the KTX2 file '{}' exceeds the file", level, aPath.string()));
+			}
+			mLevels.push_back(ktx2_level{ data + offset, static_cast<size_t>(length), static_cast<size_t>(read_little_endian<uint64_t>(entry + 16)) });
+		}
+		mGlobalData = std::span<const std::byte>(data + sgdOffset, static_cast<size_t>(sgdLength));
+
+		// The basic descriptor block follows the total size of the data format descriptor:
+		if (dfdLength >= 4 + cDfdSamplesOffset && is_within(dfdOffset, dfdLength, fileSize))
+		{
+			const auto* block = data + dfdOffset + 4;
+			const auto colorModel = static_cast<uint8_t>(block[8]);
+			const auto blockSize = std::min<size_t>(read_little_endian<uint16_t>(block + 6), dfdLength - 4);
+			const auto numSamples = blockSize > cDfdSamplesOffset ? (blockSize - cDfdSamplesOffset) / cDfdSampleSize : 0;
+			auto channelId = [block](size_t aSample) { return static_cast<uint8_t>(static_cast<uint8_t>(block[cDfdSamplesOffset + aSample * cDfdSampleSize + 3]) & 0x0F); };
+
+			mIsSrgb = cDfdTransferSrgb == static_cast<uint8_t>(block[10]);
+			if (cDfdModelEtc1s == colorModel && numSamples > 0)
+			{
+				mColorModel = ktx2_color_model::etc1s;
+				const auto first = channelId(0);
+				const bool hasSecondSlice = numSamples > 1;
+				mChannels = cDfdChannelEtc1sRrr == first
+					? (hasSecondSlice && cDfdChannelEtc1sGgg == channelId(1) ? 2 : 1)
+					: (hasSecondSlice && cDfdChannelEtc1sAaa == channelId(1) ? 4 : 3);
+			}
+			else if (cDfdModelUastc == colorModel && numSamples > 0)
+			{
+				mColorModel = ktx2_color_model::uastc;
+				switch (channelId(0))
+				{
+				case cDfdChannelUastcRrr:
+					mChannels = 1;
+					break;
+				case cDfdChannelUastcRg:
+					mChannels = 2;
+					break;
+				case cDfdChannelUastcRgba:
+				case cDfdChannelUastcRrrg: // luminance and alpha are transcoded like RGBA
+					mChannels = 4;
+					break;
+				default:
+					mChannels = 3;
+				}
+			}
+		}
+
+		if (ktx2_color_model::vulkan_format == mColorModel && vk::Format::eUndefined == mFormat)
+		{
+			throw avk::runtime_error(std::format("The KTX2 file '{}' has neither a Vulkan format nor a Basis Universal payload", aPath.string()));
+		}
+	}
+
+	bool ktx2_file::has_ktx2_identifier(const std::filesystem::path& aPath)
+	{
+		std::ifstream stream(aPath, std::ios::binary);
+		std::array<char, cKtx2Identifier.size()> identifier{};
+		if (!stream.read(identifier.data(), identifier.size()))
+		{
+			return false;
+		}
+		return 0 == std::memcmp(identifier.data(), cKtx2Identifier.data(), cKtx2Identifier.size());
+	}
+
+	vk::ImageType ktx2_file::target() const
+	{
+		if (mDepth > 0)
+		{
+			return vk::ImageType::e3D;
+		}
+		return mHeight > 0 ? vk::ImageType::e2D : vk::ImageType::e1D;
+	}
+
+	vk::Extent3D ktx2_file::extent(uint32_t aLevel) const
+	{
+		return vk::Extent3D(std::max(mWidth >> aLevel, 1u), std::max(mHeight >> aLevel, 1u), std::max(mDepth >> aLevel, 1u));
+	}
+
+	bool ktx2_file::is_hdr() const
+	{
+		switch (mFormat)
+		{
+		case vk::Format::eR16Sfloat:
+		case vk::Format::eR16G16Sfloat:
+		case vk::Format::eR16G16B16Sfloat:
+		case vk::Format::eR16G16B16A16Sfloat:
+		case vk::Format::eR32Sfloat:
+		case vk::Format::eR32G32Sfloat:
+		case vk::Format::eR32G32B32Sfloat:
+		case vk::Format::eR32G32B32A32Sfloat:
+		case vk::Format::eB10G11R11UfloatPack32:
+		case vk::Format::eE5B9G9R9UfloatPack32:
+		case vk::Format::eBc6HUfloatBlock:
+		case vk::Format::eBc6HSfloatBlock:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	void set_ktx2_transcoder(ktx2_transcoder aTranscoder)
+	{
+		sKtx2Transcoder = std::move(aTranscoder);
+	}
+
+	const ktx2_transcoder& get_ktx2_transcoder()
+	{
+		return sKtx2Transcoder;
+	}
+
+	vk::Format ktx2_transcode_target_format(const ktx2_file& aFile)
+	{
+		if (ktx2_color_model::vulkan_format == aFile.color_model())
+		{
+			return aFile.format();
+		}
+
+		const bool srgb = aFile.is_srgb();
+		const auto uncompressed = srgb ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+		std::vector<vk::Format> candidates;
+		if (1 == aFile.channels())
+		{
+			candidates.push_back(vk::Format::eBc4UnormBlock);
+		}
+		else if (2 == aFile.channels())
+		{
+			candidates.push_back(vk::Format::eBc5UnormBlock);
+		}
+		candidates.push_back(srgb ? vk::Format::eBc7SrgbBlock : vk::Format::eBc7UnormBlock);
+		if (4 == aFile.channels())
+		{
+			candidates.push_back(srgb ? vk::Format::eBc3SrgbBlock : vk::Format::eBc3UnormBlock);
+		}
+		else
+		{
+			candidates.push_back(srgb ? vk::Format::eBc1RgbSrgbBlock : vk::Format::eBc1RgbUnormBlock);
+		}
+
+		if (context().state() < context_state::fully_initialized) {
+			return candidates[0];
+		}
+
+		for (auto candidate : candidates) {
+			auto formatProps = context().physical_device().getFormatProperties(candidate);
+			if (formatProps.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImage) {
+				return candidate;
+			}
+		}
+		return uncompressed;
+	}
+
+	size_t ktx2_transcoded_level_size(const ktx2_file& aFile, uint32_t aLevel, vk::Format aTargetFormat)
+	{
+		if (ktx2_color_model::vulkan_format == aFile.color_model())
+		{
+			return aFile.level(aLevel).mUncompressedSize;
+		}
+
+		const auto levelExtent = aFile.extent(aLevel);
+		const size_t numImages = size_t{ aFile.layers() } * aFile.faces() * levelExtent.depth;
+		const size_t numBlocks = size_t{ (levelExtent.width + 3) / 4 } * ((levelExtent.height + 3) / 4);
+		switch (aTargetFormat)
+		{
+		case vk::Format::eBc1RgbUnormBlock:
+		case vk::Format::eBc1RgbSrgbBlock:
+		case vk::Format::eBc4UnormBlock:
+			return numImages * numBlocks * 8;
+		case vk::Format::eBc3UnormBlock:
+		case vk::Format::eBc3SrgbBlock:
+		case vk::Format::eBc5UnormBlock:
+		case vk::Format::eBc7UnormBlock:
+		case vk::Format::eBc7SrgbBlock:
+			return numImages * numBlocks * 16;
+		case vk::Format::eR8G8B8A8Unorm:
+		case vk::Format::eR8G8B8A8Srgb:
+			return numImages * levelExtent.width * levelExtent.height * 4;
+		default:
+			throw avk::runtime_error(std::format("KTX2 data can not be transcoded to {}", vk::to_string(aTargetFormat)));
+		}
+	}
+}
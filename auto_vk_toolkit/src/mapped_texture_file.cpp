@@ -0,0 +1,453 @@
+#include "mapped_texture_file.hpp"
+#include <cstring>
+
+namespace avk
+{
+	namespace
+	{
+		constexpr uint32_t four_cc(char a, char b, char c, char d)
+		{
+			return uint32_t{ static_cast<uint8_t>(a) } | (uint32_t{ static_cast<uint8_t>(b) } << 8) | (uint32_t{ static_cast<uint8_t>(c) } << 16) | (uint32_t{ static_cast<uint8_t>(d) } << 24);
+		}
+
+		constexpr std::array<uint8_t, 4> cDdsIdentifier = { 0x44, 0x44, 0x53, 0x20 };
+		constexpr std::array<uint8_t, 12> cKtxIdentifier = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+		constexpr std::array<uint8_t, 13> cKmgIdentifier = { 0xAB, 0x4B, 0x4D, 0x47, 0x20, 0x31, 0x30, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+		// Layout of DDS files, see https://learn.microsoft.com/en-us/windows/win32/direct3ddds/dds-header
+		/** Size of the identifier and the header, i.e., the offset of the data or of the DX10 header */
+		constexpr size_t cDdsDataOffset = 128;
+		constexpr size_t cDdsDx10DataOffset = 148;
+		constexpr uint32_t cDdsFlagMipMapCount = 0x20000;
+		constexpr uint32_t cDdsFlagDepth = 0x800000;
+		constexpr uint32_t cDdsPixelFormatFourCc = 0x4;
+		constexpr uint32_t cDdsPixelFormatRgb = 0x40;
+		constexpr uint32_t cDdsCaps2Cubemap = 0x200;
+		constexpr uint32_t cDdsCaps2AllFaces = 0xFC00;
+		constexpr uint32_t cDdsCaps2Volume = 0x200000;
+		constexpr uint32_t cDx10DimensionTexture2D = 3;
+		constexpr uint32_t cDx10MiscTextureCube = 0x4;
+
+		// Layout of KTX files, see https://registry.khronos.org/KTX/specs/1.0/ktxspec.v1.html
+		constexpr size_t cKtxHeaderSize = 64;
+		constexpr uint32_t cKtxEndiannessNative = 0x04030201;
+
+		/** Larger extents are not supported by any Vulkan implementation, and could overflow the size computations */
+		constexpr uint32_t cMaxExtent = 1u << 16;
+		constexpr uint32_t cMaxLevels = 17;
+
+		template <typename T>
+		T read_little_endian(const std::byte* aData)
+		{
+			// DDS files are little-endian, like all platforms supported by Vulkan; KTX files are checked for their endianness
+			T value;
+			std::memcpy(&value, aData, sizeof(T));
+			return value;
+		}
+
+		bool is_within(size_t aOffset, size_t aLength, size_t aFileSize)
+		{
+			return aOffset <= aFileSize && aLength <= aFileSize - aOffset;
+		}
+
+		template <size_t N>
+		bool starts_with(const std::byte* aData, size_t aSize, const std::array<uint8_t, N>& aIdentifier)
+		{
+			return aSize >= N && 0 == std::memcmp(aData, aIdentifier.data(), N);
+		}
+
+		texture_container identify_data(const std::byte* aData, size_t aSize)
+		{
+			if (starts_with(aData, aSize, cDdsIdentifier)) {
+				return texture_container::dds;
+			}
+			if (starts_with(aData, aSize, cKtxIdentifier)) {
+				return texture_container::ktx;
+			}
+			if (starts_with(aData, aSize, cKmgIdentifier)) {
+				return texture_container::kmg;
+			}
+			return texture_container::unknown;
+		}
+
+		/** The extent of a texel block and its size in bytes; uncompressed formats have blocks of 1x1 texels */
+		struct texel_block
+		{
+			uint32_t mExtent;
+			uint32_t mSize;
+		};
+
+		std::optional<texel_block> texel_block_of(vk::Format aFormat)
+		{
+			switch (aFormat) {
+			case vk::Format::eR8Unorm:
+				return texel_block{ 1, 1 };
+			case vk::Format::eR8G8Unorm:
+			case vk::Format::eR16Sfloat:
+				return texel_block{ 1, 2 };
+			case vk::Format::eR8G8B8A8Unorm:
+			case vk::Format::eR8G8B8A8Srgb:
+			case vk::Format::eB8G8R8A8Unorm:
+			case vk::Format::eB8G8R8A8Srgb:
+			case vk::Format::eR16G16Sfloat:
+			case vk::Format::eR32Sfloat:
+				return texel_block{ 1, 4 };
+			case vk::Format::eR16G16B16A16Unorm:
+			case vk::Format::eR16G16B16A16Sfloat:
+			case vk::Format::eR32G32Sfloat:
+				return texel_block{ 1, 8 };
+			case vk::Format::eR32G32B32A32Sfloat:
+				return texel_block{ 1, 16 };
+			case vk::Format::eBc1RgbUnormBlock:
+			case vk::Format::eBc1RgbSrgbBlock:
+			case vk::Format::eBc1RgbaUnormBlock:
+			case vk::Format::eBc1RgbaSrgbBlock:
+			case vk::Format::eBc4UnormBlock:
+			case vk::Format::eBc4SnormBlock:
+				return texel_block{ 4, 8 };
+			case vk::Format::eBc2UnormBlock:
+			case vk::Format::eBc2SrgbBlock:
+			case vk::Format::eBc3UnormBlock:
+			case vk::Format::eBc3SrgbBlock:
+			case vk::Format::eBc5UnormBlock:
+			case vk::Format::eBc5SnormBlock:
+			case vk::Format::eBc6HUfloatBlock:
+			case vk::Format::eBc6HSfloatBlock:
+			case vk::Format::eBc7UnormBlock:
+			case vk::Format::eBc7SrgbBlock:
+				return texel_block{ 4, 16 };
+			default:
+				return {};
+			}
+		}
+
+		size_t level_size(const texel_block& aBlock, uint32_t aWidth, uint32_t aHeight)
+		{
+			return size_t{ (aWidth + aBlock.mExtent - 1) / aBlock.mExtent } * ((aHeight + aBlock.mExtent - 1) / aBlock.mExtent) * aBlock.mSize;
+		}
+
+		/** Maps a DXGI_FORMAT of the DX10 header to the Vulkan format */
+		vk::Format dxgi_format_to_vk(uint32_t aDxgiFormat)
+		{
+			switch (aDxgiFormat) {
+			case 2:  return vk::Format::eR32G32B32A32Sfloat;
+			case 10: return vk::Format::eR16G16B16A16Sfloat;
+			case 11: return vk::Format::eR16G16B16A16Unorm;
+			case 16: return vk::Format::eR32G32Sfloat;
+			case 28: return vk::Format::eR8G8B8A8Unorm;
+			case 29: return vk::Format::eR8G8B8A8Srgb;
+			case 34: return vk::Format::eR16G16Sfloat;
+			case 41: return vk::Format::eR32Sfloat;
+			case 49: return vk::Format::eR8G8Unorm;
+			case 54: return vk::Format::eR16Sfloat;
+			case 61: return vk::Format::eR8Unorm;
+			case 71: return vk::Format::eBc1RgbaUnormBlock;
+			case 72: return vk::Format::eBc1RgbaSrgbBlock;
+			case 74: return vk::Format::eBc2UnormBlock;
+			case 75: return vk::Format::eBc2SrgbBlock;
+			case 77: return vk::Format::eBc3UnormBlock;
+			case 78: return vk::Format::eBc3SrgbBlock;
+			case 80: return vk::Format::eBc4UnormBlock;
+			case 81: return vk::Format::eBc4SnormBlock;
+			case 83: return vk::Format::eBc5UnormBlock;
+			case 84: return vk::Format::eBc5SnormBlock;
+			case 87: return vk::Format::eB8G8R8A8Unorm;
+			case 91: return vk::Format::eB8G8R8A8Srgb;
+			case 95: return vk::Format::eBc6HUfloatBlock;
+			case 96: return vk::Format::eBc6HSfloatBlock;
+			case 98: return vk::Format::eBc7UnormBlock;
+			case 99: return vk::Format::eBc7SrgbBlock;
+			default: return vk::Format::eUndefined;
+			}
+		}
+
+		/** Maps the FourCC code of a DDS file without DX10 header to the Vulkan format; numeric codes are D3DFORMAT values */
+		vk::Format dds_four_cc_to_vk(uint32_t aFourCc)
+		{
+			switch (aFourCc) {
+			case four_cc('D', 'X', 'T', '1'): return vk::Format::eBc1RgbaUnormBlock;
+			case four_cc('D', 'X', 'T', '3'): return vk::Format::eBc2UnormBlock;
+			case four_cc('D', 'X', 'T', '5'): return vk::Format::eBc3UnormBlock;
+			case four_cc('A', 'T', 'I', '1'):
+			case four_cc('B', 'C', '4', 'U'): return vk::Format::eBc4UnormBlock;
+			case four_cc('B', 'C', '4', 'S'): return vk::Format::eBc4SnormBlock;
+			case four_cc('A', 'T', 'I', '2'):
+			case four_cc('B', 'C', '5', 'U'): return vk::Format::eBc5UnormBlock;
+			case four_cc('B', 'C', '5', 'S'): return vk::Format::eBc5SnormBlock;
+			case 36:  return vk::Format::eR16G16B16A16Unorm;
+			case 111: return vk::Format::eR16Sfloat;
+			case 112: return vk::Format::eR16G16Sfloat;
+			case 113: return vk::Format::eR16G16B16A16Sfloat;
+			case 114: return vk::Format::eR32Sfloat;
+			case 115: return vk::Format::eR32G32Sfloat;
+			case 116: return vk::Format::eR32G32B32A32Sfloat;
+			default:  return vk::Format::eUndefined;
+			}
+		}
+
+		/** Maps the glInternalFormat of a KTX file with compressed data to the Vulkan format */
+		vk::Format ktx_compressed_format_to_vk(uint32_t aGlInternalFormat)
+		{
+			switch (aGlInternalFormat) {
+			case 0x83F0: return vk::Format::eBc1RgbUnormBlock;
+			case 0x83F1: return vk::Format::eBc1RgbaUnormBlock;
+			case 0x83F2: return vk::Format::eBc2UnormBlock;
+			case 0x83F3: return vk::Format::eBc3UnormBlock;
+			case 0x8C4C: return vk::Format::eBc1RgbSrgbBlock;
+			case 0x8C4D: return vk::Format::eBc1RgbaSrgbBlock;
+			case 0x8C4E: return vk::Format::eBc2SrgbBlock;
+			case 0x8C4F: return vk::Format::eBc3SrgbBlock;
+			case 0x8DBB: return vk::Format::eBc4UnormBlock;
+			case 0x8DBC: return vk::Format::eBc4SnormBlock;
+			case 0x8DBD: return vk::Format::eBc5UnormBlock;
+			case 0x8DBE: return vk::Format::eBc5SnormBlock;
+			case 0x8E8C: return vk::Format::eBc7UnormBlock;
+			case 0x8E8D: return vk::Format::eBc7SrgbBlock;
+			case 0x8E8E: return vk::Format::eBc6HSfloatBlock;
+			case 0x8E8F: return vk::Format::eBc6HUfloatBlock;
+			default:     return vk::Format::eUndefined;
+			}
+		}
+
+		/** Maps the glFormat and glType of a KTX file with uncompressed data to the Vulkan format; the order of the channels is given by glFormat */
+		vk::Format ktx_uncompressed_format_to_vk(uint32_t aGlFormat, uint32_t aGlType, uint32_t aGlInternalFormat)
+		{
+			constexpr uint32_t glRed = 0x1903, glRg = 0x8227, glRgba = 0x1908, glBgra = 0x80E1;
+			constexpr uint32_t glUnsignedByte = 0x1401, glUnsignedShort = 0x1403, glFloat = 0x1406, glHalfFloat = 0x140B;
+			constexpr uint32_t glSrgb8Alpha8 = 0x8C43;
+			const bool srgb = glSrgb8Alpha8 == aGlInternalFormat;
+
+			switch (aGlType) {
+			case glUnsignedByte:
+				switch (aGlFormat) {
+				case glRed:  return vk::Format::eR8Unorm;
+				case glRg:   return vk::Format::eR8G8Unorm;
+				case glRgba: return srgb ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+				case glBgra: return srgb ? vk::Format::eB8G8R8A8Srgb : vk::Format::eB8G8R8A8Unorm;
+				default:     return vk::Format::eUndefined;
+				}
+			case glUnsignedShort:
+				return glRgba == aGlFormat ? vk::Format::eR16G16B16A16Unorm : vk::Format::eUndefined;
+			case glHalfFloat:
+				switch (aGlFormat) {
+				case glRed:  return vk::Format::eR16Sfloat;
+				case glRg:   return vk::Format::eR16G16Sfloat;
+				case glRgba: return vk::Format::eR16G16B16A16Sfloat;
+				default:     return vk::Format::eUndefined;
+				}
+			case glFloat:
+				switch (aGlFormat) {
+				case glRed:  return vk::Format::eR32Sfloat;
+				case glRg:   return vk::Format::eR32G32Sfloat;
+				case glRgba: return vk::Format::eR32G32B32A32Sfloat;
+				default:     return vk::Format::eUndefined;
+				}
+			default:
+				return vk::Format::eUndefined;
+			}
+		}
+	}
+
+	mapped_texture_file::mapped_texture_file(memory_mapped_file aFile)
+		: mFile(std::move(aFile))
+	{
+	}
+
+	texture_container mapped_texture_file::identify(const std::filesystem::path& aPath)
+	{
+		std::ifstream stream(aPath, std::ios::binary);
+		std::array<char, cKmgIdentifier.size()> identifier{};
+		stream.read(identifier.data(), identifier.size());
+		return identify_data(reinterpret_cast<const std::byte*>(identifier.data()), static_cast<size_t>(stream.gcount()));
+	}
+
+	std::unique_ptr<mapped_texture_file> mapped_texture_file::load(const std::filesystem::path& aPath)
+	{
+		std::unique_ptr<mapped_texture_file> file;
+		try {
+			file.reset(new mapped_texture_file(memory_mapped_file(aPath)));
+		}
+		catch (const avk::runtime_error&) {
+			return {};
+		}
+
+		bool parsed = false;
+		switch (identify_data(file->mFile.data(), file->mFile.size())) {
+		case texture_container::dds:
+			parsed = file->parse_dds();
+			break;
+		case texture_container::ktx:
+			parsed = file->parse_ktx();
+			break;
+		default:
+			break;
+		}
+		if (!parsed) {
+			return {};
+		}
+		return file;
+	}
+
+	bool mapped_texture_file::parse_dds()
+	{
+		const auto* data = mFile.data();
+		const auto fileSize = mFile.size();
+		if (fileSize < cDdsDataOffset) {
+			return false;
+		}
+
+		const auto flags = read_little_endian<uint32_t>(data + 8);
+		mHeight = read_little_endian<uint32_t>(data + 12);
+		mWidth = read_little_endian<uint32_t>(data + 16);
+		const auto depth = read_little_endian<uint32_t>(data + 24);
+		const auto numLevels = 0 != (flags & cDdsFlagMipMapCount) ? std::max(read_little_endian<uint32_t>(data + 28), 1u) : 1u;
+		const auto pixelFormatFlags = read_little_endian<uint32_t>(data + 80);
+		const auto fourCc = read_little_endian<uint32_t>(data + 84);
+		const auto caps2 = read_little_endian<uint32_t>(data + 112);
+		if (0 != (caps2 & cDdsCaps2Volume) || (0 != (flags & cDdsFlagDepth) && depth > 1)) {
+			return false;
+		}
+
+		size_t dataOffset = cDdsDataOffset;
+		if (0 != (pixelFormatFlags & cDdsPixelFormatFourCc) && four_cc('D', 'X', '1', '0') == fourCc) {
+			if (fileSize < cDdsDx10DataOffset || cDx10DimensionTexture2D != read_little_endian<uint32_t>(data + 132)) {
+				return false;
+			}
+			mFormat = dxgi_format_to_vk(read_little_endian<uint32_t>(data + 128));
+			mFaces = 0 != (read_little_endian<uint32_t>(data + 136) & cDx10MiscTextureCube) ? 6 : 1;
+			mLayers = read_little_endian<uint32_t>(data + 140);
+			dataOffset = cDdsDx10DataOffset;
+		}
+		else {
+			if (0 != (pixelFormatFlags & cDdsPixelFormatFourCc)) {
+				mFormat = dds_four_cc_to_vk(fourCc);
+			}
+			else if (0 != (pixelFormatFlags & cDdsPixelFormatRgb) && 32 == read_little_endian<uint32_t>(data + 88)) {
+				const std::array<uint32_t, 4> masks = { read_little_endian<uint32_t>(data + 92), read_little_endian<uint32_t>(data + 96), read_little_endian<uint32_t>(data + 100), read_little_endian<uint32_t>(data + 104) };
+				if (masks == std::array<uint32_t, 4>{ 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000 }) {
+					mFormat = vk::Format::eR8G8B8A8Unorm;
+				}
+				else if (masks == std::array<uint32_t, 4>{ 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000 }) {
+					mFormat = vk::Format::eB8G8R8A8Unorm;
+				}
+			}
+			if (0 != (caps2 & cDdsCaps2Cubemap)) {
+				// Cube maps with missing faces are left to gli
+				if (cDdsCaps2AllFaces != (caps2 & cDdsCaps2AllFaces)) {
+					return false;
+				}
+				mFaces = 6;
+			}
+		}
+
+		const auto block = texel_block_of(mFormat);
+		if (!block || 0 == mWidth || 0 == mHeight || mWidth > cMaxExtent || mHeight > cMaxExtent || 0 == mLayers || mLayers > cMaxExtent || numLevels > cMaxLevels) {
+			return false;
+		}
+
+		// All levels of a layer and face are stored consecutively, followed by those of the next face and layer:
+		size_t imageStride = 0;
+		mLevels.resize(numLevels);
+		for (uint32_t level = 0; level < numLevels; ++level) {
+			const auto levelExtent = extent(level);
+			mLevels[level].mOffset = dataOffset + imageStride;
+			mLevels[level].mSize = level_size(*block, levelExtent.width, levelExtent.height);
+			imageStride += mLevels[level].mSize;
+		}
+		for (auto& lvl : mLevels) {
+			lvl.mImageStride = imageStride;
+		}
+		return is_within(dataOffset, imageStride * mLayers * mFaces, fileSize);
+	}
+
+	bool mapped_texture_file::parse_ktx()
+	{
+		const auto* data = mFile.data();
+		const auto fileSize = mFile.size();
+		if (fileSize < cKtxHeaderSize || cKtxEndiannessNative != read_little_endian<uint32_t>(data + 12)) {
+			return false;
+		}
+
+		const auto glType = read_little_endian<uint32_t>(data + 16);
+		const auto glFormat = read_little_endian<uint32_t>(data + 24);
+		const auto glInternalFormat = read_little_endian<uint32_t>(data + 28);
+		mWidth = read_little_endian<uint32_t>(data + 36);
+		mHeight = read_little_endian<uint32_t>(data + 40);
+		const auto depth = read_little_endian<uint32_t>(data + 44);
+		const auto numArrayElements = read_little_endian<uint32_t>(data + 48);
+		mFaces = read_little_endian<uint32_t>(data + 52);
+		// A level count of 0 requests mipmaps to be generated; the file stores level 0 only
+		const auto numLevels = std::max(read_little_endian<uint32_t>(data + 56), 1u);
+		const auto keyValueDataSize = read_little_endian<uint32_t>(data + 60);
+		mLayers = std::max(numArrayElements, 1u);
+		mFormat = 0 == glType ? ktx_compressed_format_to_vk(glInternalFormat) : ktx_uncompressed_format_to_vk(glFormat, glType, glInternalFormat);
+
+		const auto block = texel_block_of(mFormat);
+		if (!block || 0 != depth || 0 == mWidth || 0 == mHeight || mWidth > cMaxExtent || mHeight > cMaxExtent || mLayers > cMaxExtent || (1 != mFaces && 6 != mFaces) || numLevels > cMaxLevels) {
+			return false;
+		}
+
+		// Each level is preceded by its imageSize, and stores all faces of a layer, followed by those of the next layer:
+		const size_t numImages = size_t{ mLayers } * mFaces;
+		size_t offset = cKtxHeaderSize + keyValueDataSize;
+		mLevels.resize(numLevels);
+		for (uint32_t level = 0; level < numLevels; ++level) {
+			if (!is_within(offset, sizeof(uint32_t), fileSize)) {
+				return false;
+			}
+			const auto imageSize = read_little_endian<uint32_t>(data + offset);
+			offset += sizeof(uint32_t);
+
+			const auto levelExtent = extent(level);
+			const auto faceSize = level_size(*block, levelExtent.width, levelExtent.height);
+			// imageSize is the size of a single face for cube maps which are not arrays. If it differs from the tightly
+			// packed size, rows are padded; if faces are not multiples of 4 bytes, they are padded => both are left to gli.
+			const size_t expectedImageSize = 6 == mFaces && 0 == numArrayElements ? faceSize : faceSize * numImages;
+			if (imageSize != expectedImageSize || 0 != faceSize % 4 || !is_within(offset, faceSize * numImages, fileSize)) {
+				return false;
+			}
+			mLevels[level].mOffset = offset;
+			mLevels[level].mSize = faceSize;
+			mLevels[level].mImageStride = faceSize;
+			offset += faceSize * numImages;
+		}
+		return true;
+	}
+
+	bool mapped_texture_file::is_hdr() const
+	{
+		switch (mFormat) {
+		case vk::Format::eR16Sfloat:
+		case vk::Format::eR16G16Sfloat:
+		case vk::Format::eR16G16B16A16Sfloat:
+		case vk::Format::eR32Sfloat:
+		case vk::Format::eR32G32Sfloat:
+		case vk::Format::eR32G32B32A32Sfloat:
+		case vk::Format::eBc6HUfloatBlock:
+		case vk::Format::eBc6HSfloatBlock:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	vk::Extent3D mapped_texture_file::extent(uint32_t aLevel) const
+	{
+		return vk::Extent3D(std::max(mWidth >> aLevel, 1u), std::max(mHeight >> aLevel, 1u), 1u);
+	}
+
+	const std::byte* mapped_texture_file::data(uint32_t aLayer, uint32_t aFace, uint32_t aLevel) const
+	{
+		const auto& lvl = mLevels[aLevel];
+		return mFile.data() + lvl.mOffset + (size_t{ aLayer } * mFaces + aFace) * lvl.mImageStride;
+	}
+
+	size_t mapped_texture_file::size() const
+	{
+		size_t total = 0;
+		for (const auto& lvl : mLevels) {
+			total += lvl.mSize;
+		}
+		return total * mLayers * mFaces;
+	}
+}
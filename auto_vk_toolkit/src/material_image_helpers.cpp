@@ -2,9 +2,19 @@
 #include "image_data.hpp"
 #include "material_image_helpers.hpp"
 #include "serializer.hpp"
+#include <cstring>
 
 namespace avk
 {
+	bool generate_mip_maps_for_usage(image_data& aImageData, avk::image_usage aImageUsage)
+	{
+		bool is_mip_mapped = (static_cast<int>(aImageUsage) & static_cast<int>(avk::image_usage::mip_mapped)) > 0;
+		if (is_mip_mapped && aImageData.levels() <= 1) {
+			return aImageData.generate_mip_maps();
+		}
+		return false;
+	}
+
 	std::tuple<avk::image, avk::command::action_type_command> create_cubemap_from_image_data_cached(image_data& aImageData, avk::layout::image_layout aImageLayout, avk::memory_usage aMemoryUsage, avk::image_usage aImageUsage, std::optional<std::reference_wrapper<avk::serializer>> aSerializer)
 	{
 		// image must have flag set to be used for cube map
@@ -29,7 +39,7 @@ namespace avk
 		return create_cubemap_from_image_data_cached(cubemapImageData, aImageLayout, aMemoryUsage, aImageUsage, aSerializer);
 	}
 
-	std::tuple<avk::image, avk::command::action_type_command> create_image_from_image_data_cached(image_data& aImageData, avk::layout::image_layout aImageLayout, avk::memory_usage aMemoryUsage, avk::image_usage aImageUsage, std::optional<std::reference_wrapper<avk::serializer>> aSerializer)
+	std::tuple<avk::image, avk::command::action_type_command> create_image_from_image_data_cached(image_data& aImageData, avk::layout::image_layout aImageLayout, avk::memory_usage aMemoryUsage, avk::image_usage aImageUsage, std::optional<std::reference_wrapper<avk::serializer>> aSerializer, std::optional<std::reference_wrapper<avk::upload_batcher>> aUploadBatcher)
 	{
 		using namespace avk;
 
@@ -46,6 +56,12 @@ namespace avk
 
 			assert(!aImageData.empty());
 
+			if (aSerializer) {
+				for (const auto& path : aImageData.paths()) {
+					aSerializer->get().add_file_dependency(path);
+				}
+			}
+
 			if (aImageData.target() != vk::ImageType::e2D) {
 				throw avk::runtime_error(std::format("The image loaded from '{}' is not intended to be used as 2D image. Can't load it.", aImageData.path()));
 			}
@@ -55,6 +71,12 @@ namespace avk
 				throw avk::runtime_error(std::format("The image loaded from '{}' is not intended to be used as a cube map image.", aImageData.path()));
 			}
 
+			// Mip maps which are generated on the CPU are stored in the cache file, hence, they need not be blitted whenever it is read.
+			// Without a cache file, blitting them on the GPU is faster.
+			if (aSerializer) {
+				generate_mip_maps_for_usage(aImageData, aImageUsage);
+			}
+
 			width = aImageData.extent().width;
 			height = aImageData.extent().height;
 
@@ -125,6 +147,10 @@ namespace avk
 			}
 		};
 
+		if (aUploadBatcher) {
+			aUploadBatcher->get().begin_image(*img);
+		}
+
 		// TODO: Do we have to account for gliTex.base_level() and gliTex.max_level()?
 		for (uint32_t level = 0; level < maxLevels; ++level)
 		{
@@ -157,6 +183,21 @@ namespace avk
 				}
 #endif
 
+				if (aUploadBatcher) {
+					// Stage the data in the batcher's staging buffer; it records the copy into its current batch:
+					auto* staging = aUploadBatcher->get().stage_image_region(face, level, texSize);
+					if (aSerializer && aSerializer->get().mode() == avk::serializer::mode::deserialize) {
+						aSerializer->get().archive_memory(staging, texSize);
+					}
+					else {
+						std::memcpy(staging, texData, texSize);
+						if (aSerializer) {
+							aSerializer->get().archive_memory(texData, texSize);
+						}
+					}
+					continue;
+				}
+
 				auto sb = context().create_buffer(
 					AVK_STAGING_BUFFER_MEMORY_USAGE,
 					vk::BufferUsageFlagBits::eTransferSrc,
@@ -204,6 +245,10 @@ namespace avk
 				actionTypeCommand.handle_lifetime_of(std::move(sb));
 			}
 		}
+
+		if (aUploadBatcher) {
+			aUploadBatcher->get().end_image(aImageLayout);
+		}
 		
 		if (maxLevels == 1 && img->create_info().mipLevels > 1)
 		{
@@ -219,10 +264,211 @@ namespace avk
 		return std::make_tuple(std::move(img), std::move(actionTypeCommand));
 	}
 
-	std::tuple<avk::image, avk::command::action_type_command> create_image_from_file_cached(const std::string& aPath, bool aLoadHdrIfPossible, bool aLoadSrgbIfApplicable, bool aFlip, int aPreferredNumberOfTextureComponents, avk::layout::image_layout aImageLayout, avk::memory_usage aMemoryUsage, avk::image_usage aImageUsage, std::optional<std::reference_wrapper<avk::serializer>> aSerializer)
+	std::tuple<avk::image, avk::command::action_type_command> create_image_from_file_cached(const std::string& aPath, bool aLoadHdrIfPossible, bool aLoadSrgbIfApplicable, bool aFlip, int aPreferredNumberOfTextureComponents, avk::layout::image_layout aImageLayout, avk::memory_usage aMemoryUsage, avk::image_usage aImageUsage, std::optional<std::reference_wrapper<avk::serializer>> aSerializer, std::optional<std::reference_wrapper<avk::upload_batcher>> aUploadBatcher)
 	{
 		auto imageData = get_image_data(aPath, aLoadHdrIfPossible, aLoadSrgbIfApplicable, aFlip, aPreferredNumberOfTextureComponents);
-		return avk::create_image_from_image_data_cached(imageData, aImageLayout, aMemoryUsage, aImageUsage, aSerializer);
+		return avk::create_image_from_image_data_cached(imageData, aImageLayout, aMemoryUsage, aImageUsage, aSerializer, aUploadBatcher);
+	}
+
+	void serialize_image_data(avk::serializer& aSerializer, image_data& aImageData, avk::image_usage aImageUsage)
+	{
+		assert(aSerializer.mode() == avk::serializer::mode::serialize);
+
+		// load the image to memory
+		aImageData.load();
+
+		assert(!aImageData.empty());
+
+		for (const auto& path : aImageData.paths()) {
+			aSerializer.add_file_dependency(path);
+		}
+
+		if (aImageData.target() != vk::ImageType::e2D) {
+			throw avk::runtime_error(std::format("The image loaded from '{}' is not intended to be used as 2D image. Can't load it.", aImageData.path()));
+		}
+
+		bool is_cube_compatible = (static_cast<int>(aImageUsage) & static_cast<int>(avk::image_usage::cube_compatible)) > 0;
+		if (is_cube_compatible && aImageData.faces() != 6) {
+			throw avk::runtime_error(std::format("The image loaded from '{}' is not intended to be used as a cube map image.", aImageData.path()));
+		}
+
+		// Same levels as create_image_from_image_data_cached writes:
+		generate_mip_maps_for_usage(aImageData, aImageUsage);
+
+		// Same layout as in create_image_from_image_data_cached:
+		uint32_t width = aImageData.extent().width;
+		uint32_t height = aImageData.extent().height;
+		vk::Format format = aImageData.get_format();
+		uint32_t numLayers = aImageData.faces();
+		aSerializer.archive(width);
+		aSerializer.archive(height);
+		aSerializer.archive(format);
+		aSerializer.archive(numLayers);
+
+		size_t maxLevels = std::max<size_t>(aImageData.levels(), 1);
+		size_t maxFaces = aImageData.faces();
+		aSerializer.archive(maxLevels);
+		aSerializer.archive(maxFaces);
+
+		for (uint32_t level = 0; level < maxLevels; ++level)
+		{
+			for (uint32_t face = 0; face < maxFaces; ++face)
+			{
+				size_t texSize = aImageData.size(level);
+				avk::image_data::extent_type levelExtent = aImageData.extent(level);
+				aSerializer.archive(texSize);
+				aSerializer.archive(levelExtent);
+				aSerializer.archive_memory(aImageData.get_data(0, face, level), texSize);
+			}
+		}
+	}
+
+	bool compress_image_data_for_usage(image_data& aImageData, avk::image_usage aImageUsage, const texture_compression& aSettings, bool aIsNormalMap, unsigned int aNumThreads)
+	{
+		aImageData.load();
+
+		assert(!aImageData.empty());
+
+		bool is_mip_mapped = (static_cast<int>(aImageUsage) & static_cast<int>(avk::image_usage::mip_mapped)) > 0;
+		if (is_mip_mapped && aImageData.levels() <= 1 && !aImageData.generate_mip_maps(aNumThreads)) {
+			// Only a single level could be uploaded, because mip maps can not be blitted for block-compressed formats:
+			const auto extent = aImageData.extent();
+			if (number_of_mip_levels(extent.width, extent.height) > 1) {
+				return false;
+			}
+		}
+
+		return aImageData.compress(aSettings, aIsNormalMap, aNumThreads);
+	}
+
+	void skip_image_data(avk::serializer& aSerializer)
+	{
+		assert(aSerializer.mode() == avk::serializer::mode::deserialize);
+
+		// Same layout as in create_image_from_image_data_cached:
+		uint32_t width = 0;
+		uint32_t height = 0;
+		vk::Format format = vk::Format::eUndefined;
+		uint32_t numLayers = 0;
+		aSerializer.archive(width);
+		aSerializer.archive(height);
+		aSerializer.archive(format);
+		aSerializer.archive(numLayers);
+
+		size_t maxLevels = 0;
+		size_t maxFaces = 0;
+		aSerializer.archive(maxLevels);
+		aSerializer.archive(maxFaces);
+
+		std::vector<std::byte> skipped;
+		for (size_t level = 0; level < maxLevels; ++level)
+		{
+			for (size_t face = 0; face < maxFaces; ++face)
+			{
+				size_t texSize = 0;
+				avk::image_data::extent_type levelExtent;
+				aSerializer.archive(texSize);
+				aSerializer.archive(levelExtent);
+				skipped.resize(texSize);
+				aSerializer.archive_memory(skipped.data(), texSize);
+			}
+		}
+	}
+
+	void load_image_data_in_parallel(std::vector<image_data>& aImageData, std::function<void(size_t)> aForEachLoadedImage, unsigned int aNumThreads)
+	{
+		const auto numImages = aImageData.size();
+		if (0 == aNumThreads) {
+			aNumThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		aNumThreads = static_cast<unsigned int>(std::min<size_t>(aNumThreads, numImages));
+
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::vector<bool> loaded(numImages, false);
+		std::vector<std::exception_ptr> errors(numImages);
+		size_t nextToLoad = 0;
+		size_t nextProcessed = 0;
+		bool cancel = false;
+
+		// Every worker loads the next image, unless aNumThreads images have been loaded, but not processed yet:
+		auto worker = [&]() {
+			std::unique_lock lock(mutex);
+			while (true) {
+				condition.wait(lock, [&]() { return cancel || nextToLoad >= numImages || nextToLoad < nextProcessed + aNumThreads; });
+				if (cancel || nextToLoad >= numImages) {
+					return;
+				}
+				const auto index = nextToLoad++;
+				lock.unlock();
+
+				try {
+					aImageData[index].load();
+				}
+				catch (...) {
+					errors[index] = std::current_exception();
+				}
+
+				lock.lock();
+				loaded[index] = true;
+				condition.notify_all();
+			}
+		};
+
+		std::vector<std::thread> workers;
+		workers.reserve(aNumThreads);
+		for (unsigned int i = 0; i < aNumThreads; ++i) {
+			workers.emplace_back(worker);
+		}
+		auto joinWorkers = [&](bool aCancel) {
+			{
+				std::scoped_lock lock(mutex);
+				cancel = cancel || aCancel;
+			}
+			condition.notify_all();
+			for (auto& w : workers) {
+				w.join();
+			}
+		};
+
+		try {
+			for (size_t i = 0; i < numImages; ++i) {
+				{
+					std::unique_lock lock(mutex);
+					condition.wait(lock, [&]() { return loaded[i]; });
+				}
+				if (errors[i]) {
+					std::rethrow_exception(errors[i]);
+				}
+
+				aForEachLoadedImage(i);
+
+				{
+					std::scoped_lock lock(mutex);
+					++nextProcessed;
+				}
+				condition.notify_all();
+			}
+		}
+		catch (...) {
+			joinWorkers(true);
+			throw;
+		}
+		joinWorkers(false);
+	}
+
+	void serialize_image_data_in_parallel(avk::serializer& aSerializer, std::vector<image_data>& aImageData, avk::image_usage aImageUsage, std::function<void(size_t)> aAfterEachImage, unsigned int aNumThreads)
+	{
+		load_image_data_in_parallel(aImageData, [&](size_t aIndex) {
+			serialize_image_data(aSerializer, aImageData[aIndex], aImageUsage);
+			{
+				// Release the image's memory:
+				auto written = std::move(aImageData[aIndex]);
+			}
+			if (aAfterEachImage) {
+				aAfterEachImage(aIndex);
+			}
+		}, aNumThreads);
 	}
 
 	std::tuple<std::vector<glm::vec3>, std::vector<uint32_t>> get_vertices_and_indices(const std::vector<std::tuple<const avk::model_t&, std::vector<avk::mesh_index_t>>>& aModelsAndSelectedMeshes)
@@ -555,4 +801,22 @@ namespace avk
 	{
 		return create_sampler_cached(aSerializer, aFilterMode, { aBorderHandlingMode, aBorderHandlingMode, aBorderHandlingMode }, aMipMapMaxLod, std::move(aAlterConfigBeforeCreation));
 		}
-		}
+
+	void serialize_sampler(avk::serializer& aSerializer, avk::filter_mode aFilterMode, std::array<avk::border_handling_mode, 3> aBorderHandlingModes, float aMipMapMaxLod)
+	{
+		// Same layout as in create_sampler_cached:
+		aSerializer.archive(aFilterMode);
+		aSerializer.archive(aBorderHandlingModes);
+		aSerializer.archive(aMipMapMaxLod);
+	}
+
+	void serialize_sampler(avk::serializer& aSerializer, avk::filter_mode aFilterMode, std::array<avk::border_handling_mode, 2> aBorderHandlingModes, float aMipMapMaxLod)
+	{
+		serialize_sampler(aSerializer, aFilterMode, { aBorderHandlingModes[0], aBorderHandlingModes[1], aBorderHandlingModes[1] }, aMipMapMaxLod);
+	}
+
+	void serialize_sampler(avk::serializer& aSerializer, avk::filter_mode aFilterMode, avk::border_handling_mode aBorderHandlingMode, float aMipMapMaxLod)
+	{
+		serialize_sampler(aSerializer, aFilterMode, { aBorderHandlingMode, aBorderHandlingMode, aBorderHandlingMode }, aMipMapMaxLod);
+	}
+}
@@ -0,0 +1,101 @@
+#include "memory_mapped_file.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace avk
+{
+	memory_mapped_file::memory_mapped_file(const std::filesystem::path& aPath)
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileW(aPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (INVALID_HANDLE_VALUE == file) {
+			throw avk::runtime_error(std::format("Unable to open file '{}' for memory mapping (error code {}).", aPath.string(), GetLastError()));
+		}
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize)) {
+			CloseHandle(file);
+			throw avk::runtime_error(std::format("Unable to determine the size of file '{}' (error code {}).", aPath.string(), GetLastError()));
+		}
+		mSize = static_cast<size_t>(fileSize.QuadPart);
+		if (mSize > 0) {
+			HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (nullptr != mapping) {
+				mData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				// The view keeps the mapping object alive => the handles are not needed anymore
+				CloseHandle(mapping);
+			}
+			if (nullptr == mData) {
+				auto errorCode = GetLastError();
+				CloseHandle(file);
+				throw avk::runtime_error(std::format("Unable to memory map file '{}' (error code {}).", aPath.string(), errorCode));
+			}
+		}
+		CloseHandle(file);
+#else
+		int file = open(aPath.c_str(), O_RDONLY);
+		if (-1 == file) {
+			throw avk::runtime_error(std::format("Unable to open file '{}' for memory mapping (errno {}).", aPath.string(), errno));
+		}
+		struct stat fileStat;
+		if (-1 == fstat(file, &fileStat)) {
+			auto errorCode = errno;
+			close(file);
+			throw avk::runtime_error(std::format("Unable to determine the size of file '{}' (errno {}).", aPath.string(), errorCode));
+		}
+		mSize = static_cast<size_t>(fileStat.st_size);
+		if (mSize > 0) {
+			void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+			if (MAP_FAILED == data) {
+				auto errorCode = errno;
+				close(file);
+				throw avk::runtime_error(std::format("Unable to memory map file '{}' (errno {}).", aPath.string(), errorCode));
+			}
+			mData = data;
+			// Cache files are read front to back => let the kernel read ahead aggressively
+			madvise(mData, mSize, MADV_SEQUENTIAL);
+		}
+		// The mapping stays valid after closing the file descriptor
+		close(file);
+#endif
+	}
+
+	memory_mapped_file::memory_mapped_file(memory_mapped_file&& aOther) noexcept
+		: mData{ std::exchange(aOther.mData, nullptr) }
+		, mSize{ std::exchange(aOther.mSize, 0) }
+	{
+	}
+
+	memory_mapped_file& memory_mapped_file::operator=(memory_mapped_file&& aOther) noexcept
+	{
+		if (this != &aOther) {
+			unmap();
+			mData = std::exchange(aOther.mData, nullptr);
+			mSize = std::exchange(aOther.mSize, 0);
+		}
+		return *this;
+	}
+
+	memory_mapped_file::~memory_mapped_file()
+	{
+		unmap();
+	}
+
+	void memory_mapped_file::unmap()
+	{
+		if (nullptr == mData) {
+			return;
+		}
+#ifdef _WIN32
+		UnmapViewOfFile(mData);
+#else
+		munmap(mData, mSize);
+#endif
+		mData = nullptr;
+		mSize = 0;
+	}
+}
@@ -0,0 +1,237 @@
+#include "mip_map_generation.hpp"
+
+namespace avk
+{
+	namespace
+	{
+		/** Levels with fewer target pixels per thread are computed by fewer threads, down to the calling thread only */
+		constexpr size_t cMinPixelsPerThread = size_t{ 1 } << 16;
+
+		/** Number of entries of the table which maps linear values to sRGB-encoded 8 bit values */
+		constexpr uint32_t cLinearToSrgbTableSize = 1u << 16;
+
+		float srgb_to_linear(float aValue)
+		{
+			return aValue <= 0.04045f ? aValue / 12.92f : std::pow((aValue + 0.055f) / 1.055f, 2.4f);
+		}
+
+		float linear_to_srgb(float aValue)
+		{
+			return aValue <= 0.0031308f ? aValue * 12.92f : 1.055f * std::pow(aValue, 1.0f / 2.4f) - 0.055f;
+		}
+
+		/** Lookup tables for converting sRGB-encoded 8 bit values to linear values and back */
+		struct srgb_tables
+		{
+			srgb_tables()
+				: mToLinear{}
+				, mFromLinear(cLinearToSrgbTableSize)
+			{
+				for (uint32_t i = 0; i < 256; ++i) {
+					mToLinear[i] = srgb_to_linear(static_cast<float>(i) / 255.0f);
+				}
+				for (uint32_t i = 0; i < cLinearToSrgbTableSize; ++i) {
+					mFromLinear[i] = static_cast<uint8_t>(std::lround(linear_to_srgb(static_cast<float>(i) / static_cast<float>(cLinearToSrgbTableSize - 1)) * 255.0f));
+				}
+			}
+
+			uint8_t from_linear(float aValue) const
+			{
+				// The average of values in [0, 1] is in [0, 1], hence, no clamping is required:
+				return mFromLinear[static_cast<uint32_t>(aValue * static_cast<float>(cLinearToSrgbTableSize - 1) + 0.5f)];
+			}
+
+			std::array<float, 256> mToLinear;
+			std::vector<uint8_t> mFromLinear;
+		};
+
+		const srgb_tables& get_srgb_tables()
+		{
+			static const srgb_tables sTables;
+			return sTables;
+		}
+
+		/** Sum of two source values: integers for unorm8 data, linear values for sRGB-encoded data */
+		template <mip_map_channel_encoding E>
+		using sum_type = std::conditional_t<mip_map_channel_encoding::unorm8 == E, uint16_t, float>;
+
+		/** Computes the rows [aRowBegin, aRowEnd) of the target level; DX is the offset to the second source column, i.e., 0 for a source width of 1 */
+		template <mip_map_channel_encoding E, uint32_t C, bool LinearAlpha, uint32_t DX>
+		void downsample_rows(const std::byte* aSource, uint32_t aWidth, uint32_t aHeight, std::byte* aTarget, uint32_t aTargetWidth, uint32_t aRowBegin, uint32_t aRowEnd)
+		{
+			using channel_type = std::conditional_t<mip_map_channel_encoding::float32 == E, float, uint8_t>;
+			const auto* source = reinterpret_cast<const channel_type*>(aSource);
+			auto* target = reinterpret_cast<channel_type*>(aTarget);
+			const auto& tables = get_srgb_tables();
+			const size_t sourceStride = size_t{ aWidth } * C;
+
+			// The two source rows are summed first, and then pairs of columns of the sums. Both loops have
+			// constant channel counts and offsets, which allows the compiler to vectorize them:
+			const size_t numSums = size_t{ aTargetWidth } * (1 + DX) * C;
+			std::vector<sum_type<E>> sums(numSums);
+			for (uint32_t y = aRowBegin; y < aRowEnd; ++y) {
+				const auto* row0 = source + std::min(2 * y, aHeight - 1) * sourceStride;
+				const auto* row1 = source + std::min(2 * y + 1, aHeight - 1) * sourceStride;
+				auto* out = target + size_t{ y } * aTargetWidth * C;
+
+				if constexpr (mip_map_channel_encoding::srgb8 == E) {
+					for (size_t i = 0; i < numSums; i += C) {
+						for (uint32_t c = 0; c < C; ++c) {
+							sums[i + c] = LinearAlpha && C - 1 == c
+								? static_cast<float>(row0[i + c]) + static_cast<float>(row1[i + c])
+								: tables.mToLinear[row0[i + c]] + tables.mToLinear[row1[i + c]];
+						}
+					}
+				}
+				else {
+					for (size_t i = 0; i < numSums; ++i) {
+						sums[i] = static_cast<sum_type<E>>(row0[i] + row1[i]);
+					}
+				}
+
+				for (uint32_t x = 0; x < aTargetWidth; ++x) {
+					const auto* s = sums.data() + size_t{ 2 * x } * C;
+					for (uint32_t c = 0; c < C; ++c) {
+						const auto sum = s[c] + s[DX * C + c];
+						if constexpr (mip_map_channel_encoding::float32 == E) {
+							out[size_t{ x } * C + c] = 0.25f * sum;
+						}
+						else if constexpr (mip_map_channel_encoding::unorm8 == E) {
+							out[size_t{ x } * C + c] = static_cast<uint8_t>((sum + 2u) >> 2);
+						}
+						else if (LinearAlpha && C - 1 == c) {
+							// Sums of integers are exact in float:
+							out[size_t{ x } * C + c] = static_cast<uint8_t>((static_cast<uint32_t>(sum) + 2u) >> 2);
+						}
+						else {
+							out[size_t{ x } * C + c] = tables.from_linear(0.25f * sum);
+						}
+					}
+				}
+			}
+		}
+
+		using downsample_rows_function = void(*)(const std::byte*, uint32_t, uint32_t, std::byte*, uint32_t, uint32_t, uint32_t);
+
+		template <mip_map_channel_encoding E, bool LinearAlpha>
+		downsample_rows_function select_downsample_rows(uint32_t aNumChannels, bool aSingleColumn)
+		{
+			switch (aNumChannels) {
+			case 1: return aSingleColumn ? &downsample_rows<E, 1, LinearAlpha, 0> : &downsample_rows<E, 1, LinearAlpha, 1>;
+			case 2: return aSingleColumn ? &downsample_rows<E, 2, LinearAlpha, 0> : &downsample_rows<E, 2, LinearAlpha, 1>;
+			case 3: return aSingleColumn ? &downsample_rows<E, 3, LinearAlpha, 0> : &downsample_rows<E, 3, LinearAlpha, 1>;
+			case 4: return aSingleColumn ? &downsample_rows<E, 4, LinearAlpha, 0> : &downsample_rows<E, 4, LinearAlpha, 1>;
+			default: throw avk::runtime_error(std::format("Can not generate mip maps for pixels with {} channels.", aNumChannels));
+			}
+		}
+
+		downsample_rows_function select_downsample_rows(const mip_map_pixel_layout& aLayout, bool aSingleColumn)
+		{
+			switch (aLayout.mEncoding) {
+			case mip_map_channel_encoding::unorm8:
+				return select_downsample_rows<mip_map_channel_encoding::unorm8, false>(aLayout.mNumChannels, aSingleColumn);
+			case mip_map_channel_encoding::srgb8:
+				return aLayout.mLinearAlpha
+					? select_downsample_rows<mip_map_channel_encoding::srgb8, true>(aLayout.mNumChannels, aSingleColumn)
+					: select_downsample_rows<mip_map_channel_encoding::srgb8, false>(aLayout.mNumChannels, aSingleColumn);
+			case mip_map_channel_encoding::float32:
+			default:
+				return select_downsample_rows<mip_map_channel_encoding::float32, false>(aLayout.mNumChannels, aSingleColumn);
+			}
+		}
+
+		size_t bytes_per_pixel(const mip_map_pixel_layout& aLayout)
+		{
+			return aLayout.mNumChannels * (mip_map_channel_encoding::float32 == aLayout.mEncoding ? sizeof(float) : sizeof(uint8_t));
+		}
+	}
+
+	std::optional<mip_map_pixel_layout> mip_map_pixel_layout_for(vk::Format aFormat, size_t aBytesPerPixel)
+	{
+		mip_map_pixel_layout layout;
+		switch (aFormat) {
+		case vk::Format::eR8Unorm:				layout = { mip_map_channel_encoding::unorm8, 1, false }; break;
+		case vk::Format::eR8G8Unorm:			layout = { mip_map_channel_encoding::unorm8, 2, false }; break;
+		case vk::Format::eR8G8B8Unorm:
+		case vk::Format::eB8G8R8Unorm:			layout = { mip_map_channel_encoding::unorm8, 3, false }; break;
+		case vk::Format::eR8G8B8A8Unorm:
+		case vk::Format::eB8G8R8A8Unorm:		layout = { mip_map_channel_encoding::unorm8, 4, false }; break;
+		case vk::Format::eR8Srgb:				layout = { mip_map_channel_encoding::srgb8, 1, false }; break;
+		case vk::Format::eR8G8Srgb:				layout = { mip_map_channel_encoding::srgb8, 2, false }; break;
+		case vk::Format::eR8G8B8Srgb:
+		case vk::Format::eB8G8R8Srgb:			layout = { mip_map_channel_encoding::srgb8, 3, false }; break;
+		case vk::Format::eR8G8B8A8Srgb:
+		case vk::Format::eB8G8R8A8Srgb:			layout = { mip_map_channel_encoding::srgb8, 4, true }; break;
+		case vk::Format::eR16Sfloat:
+		case vk::Format::eR32Sfloat:			layout = { mip_map_channel_encoding::float32, 1, false }; break;
+		case vk::Format::eR16G16Sfloat:
+		case vk::Format::eR32G32Sfloat:			layout = { mip_map_channel_encoding::float32, 2, false }; break;
+		case vk::Format::eR16G16B16Sfloat:
+		case vk::Format::eR32G32B32Sfloat:		layout = { mip_map_channel_encoding::float32, 3, false }; break;
+		case vk::Format::eR16G16B16A16Sfloat:
+		case vk::Format::eR32G32B32A32Sfloat:	layout = { mip_map_channel_encoding::float32, 4, false }; break;
+		default:
+			return {};
+		}
+
+		// 16 bit floats are only supported if they have been converted to 32 bit floats:
+		if (bytes_per_pixel(layout) != aBytesPerPixel) {
+			return {};
+		}
+		return layout;
+	}
+
+	uint32_t number_of_mip_levels(uint32_t aWidth, uint32_t aHeight)
+	{
+		uint32_t levels = 1;
+		for (auto size = std::max(aWidth, aHeight); size > 1; size >>= 1) {
+			++levels;
+		}
+		return levels;
+	}
+
+	void downsample_mip_level(const mip_map_pixel_layout& aLayout, const std::byte* aSource, uint32_t aWidth, uint32_t aHeight, std::byte* aTarget, unsigned int aNumThreads)
+	{
+		assert(aWidth > 0 && aHeight > 0);
+		const auto targetWidth = std::max(aWidth / 2, 1u);
+		const auto targetHeight = std::max(aHeight / 2, 1u);
+		const auto downsampleRows = select_downsample_rows(aLayout, 1 == aWidth);
+
+		if (0 == aNumThreads) {
+			aNumThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		const auto numPixels = size_t{ targetWidth } * targetHeight;
+		const auto numThreads = static_cast<uint32_t>(std::min<size_t>({ aNumThreads, std::max<size_t>(numPixels / cMinPixelsPerThread, 1), targetHeight }));
+
+		// Split the rows into contiguous ranges, the last one of which is computed on the calling thread:
+		std::vector<std::thread> threads;
+		threads.reserve(numThreads - 1);
+		for (uint32_t t = 0; t + 1 < numThreads; ++t) {
+			threads.emplace_back(downsampleRows, aSource, aWidth, aHeight, aTarget, targetWidth, targetHeight * t / numThreads, targetHeight * (t + 1) / numThreads);
+		}
+		downsampleRows(aSource, aWidth, aHeight, aTarget, targetWidth, targetHeight * (numThreads - 1) / numThreads, targetHeight);
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+	std::vector<std::vector<std::byte>> generate_mip_levels(const mip_map_pixel_layout& aLayout, const std::byte* aLevel0, uint32_t aWidth, uint32_t aHeight, unsigned int aNumThreads)
+	{
+		const auto numLevels = number_of_mip_levels(aWidth, aHeight);
+		std::vector<std::vector<std::byte>> levels;
+		levels.reserve(numLevels - 1);
+
+		const auto* source = aLevel0;
+		for (uint32_t level = 1; level < numLevels; ++level) {
+			const auto targetWidth = std::max(aWidth / 2, 1u);
+			const auto targetHeight = std::max(aHeight / 2, 1u);
+			auto& target = levels.emplace_back(size_t{ targetWidth } * targetHeight * bytes_per_pixel(aLayout));
+			downsample_mip_level(aLayout, source, aWidth, aHeight, target.data(), aNumThreads);
+
+			source = target.data();
+			aWidth = targetWidth;
+			aHeight = targetHeight;
+		}
+		return levels;
+	}
+}
@@ -1179,6 +1179,7 @@ namespace avk
 				anode.mGlobalTransform = anode.mParentTransform;
 			}
 
+			anode.mNodeName = to_string(bNode->mName);
 			anode.mLocalTransform = to_mat4(bNode->mTransformation);
 
 			// See if we have an inverse bind pose matrix for this node:
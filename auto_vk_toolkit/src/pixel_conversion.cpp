@@ -0,0 +1,351 @@
+#include "pixel_conversion.hpp"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AVK_PIXEL_CONVERSION_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#define AVK_PIXEL_CONVERSION_SSSE3 1
+#include <tmmintrin.h>
+#endif
+#if defined(__F16C__) || defined(__AVX2__)
+#define AVK_PIXEL_CONVERSION_F16C 1
+#include <immintrin.h>
+#endif
+
+namespace avk
+{
+	namespace
+	{
+		/** Images with fewer pixels per thread are converted by fewer threads, down to the calling thread only */
+		constexpr size_t cMinPixelsPerThread = size_t{ 1 } << 16;
+
+		/** Number of entries of the table which maps linear values to sRGB-encoded 8 bit values */
+		constexpr uint32_t cLinearToSrgbTableSize = 1u << 16;
+
+		/** Invokes aConvertRows(rowBegin, rowEnd) for contiguous ranges of rows on multiple threads, the last one of which is the calling thread */
+		template <typename F>
+		void for_each_row_range(uint32_t aWidth, uint32_t aHeight, unsigned int aNumThreads, F aConvertRows)
+		{
+			if (0 == aNumThreads) {
+				aNumThreads = std::max(std::thread::hardware_concurrency(), 1u);
+			}
+			const auto numPixels = size_t{ aWidth } * aHeight;
+			const auto numThreads = static_cast<uint32_t>(std::min<size_t>({ aNumThreads, std::max<size_t>(numPixels / cMinPixelsPerThread, 1), std::max(aHeight, 1u) }));
+
+			std::vector<std::thread> threads;
+			threads.reserve(numThreads - 1);
+			for (uint32_t t = 0; t + 1 < numThreads; ++t) {
+				threads.emplace_back(aConvertRows, aHeight * t / numThreads, aHeight * (t + 1) / numThreads);
+			}
+			aConvertRows(aHeight * (numThreads - 1) / numThreads, aHeight);
+			for (auto& thread : threads) {
+				thread.join();
+			}
+		}
+
+		float srgb_to_linear(float aValue)
+		{
+			return aValue <= 0.04045f ? aValue / 12.92f : std::pow((aValue + 0.055f) / 1.055f, 2.4f);
+		}
+
+		float linear_to_srgb(float aValue)
+		{
+			return aValue <= 0.0031308f ? aValue * 12.92f : 1.055f * std::pow(aValue, 1.0f / 2.4f) - 0.055f;
+		}
+
+		/** Lookup tables for converting sRGB-encoded 8 bit values to linear values and back */
+		struct srgb_tables
+		{
+			srgb_tables()
+				: mToLinear{}
+				, mFromLinear(cLinearToSrgbTableSize)
+			{
+				for (uint32_t i = 0; i < 256; ++i) {
+					mToLinear[i] = srgb_to_linear(static_cast<float>(i) / 255.0f);
+				}
+				for (uint32_t i = 0; i < cLinearToSrgbTableSize; ++i) {
+					mFromLinear[i] = static_cast<uint8_t>(std::lround(linear_to_srgb(static_cast<float>(i) / static_cast<float>(cLinearToSrgbTableSize - 1)) * 255.0f));
+				}
+			}
+
+			uint8_t from_linear(float aValue) const
+			{
+				return mFromLinear[static_cast<uint32_t>(aValue * static_cast<float>(cLinearToSrgbTableSize - 1) + 0.5f)];
+			}
+
+			std::array<float, 256> mToLinear;
+			std::vector<uint8_t> mFromLinear;
+		};
+
+		const srgb_tables& get_srgb_tables()
+		{
+			static const srgb_tables sTables;
+			return sTables;
+		}
+
+		uint16_t float_to_half(float aValue)
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &aValue, sizeof(bits));
+			const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+			const auto absBits = bits & 0x7FFFFFFFu;
+
+			if (absBits >= 0x7F800000u) {
+				// Infinity stays infinity, NaN stays a (quiet) NaN:
+				return sign | (absBits > 0x7F800000u ? 0x7E00u : 0x7C00u);
+			}
+			if (absBits >= 0x477FF000u) {
+				// Rounds to a value beyond 65504:
+				return sign | 0x7C00u;
+			}
+			if (absBits < 0x38800000u) {
+				// Subnormal half, or zero; shifting the mantissa with its implicit bit rounds to nearest even:
+				if (absBits < 0x33000000u) {
+					return sign;
+				}
+				const auto exponent = absBits >> 23;
+				const auto mantissa = (absBits & 0x007FFFFFu) | 0x00800000u;
+				const auto shift = 126u - exponent;
+				auto half = mantissa >> shift;
+				const auto remainder = mantissa & ((1u << shift) - 1u);
+				const auto halfway = 1u << (shift - 1u);
+				if (remainder > halfway || (remainder == halfway && (half & 1u))) {
+					++half;
+				}
+				return sign | static_cast<uint16_t>(half);
+			}
+
+			// Normal half; a carry of the rounding into the exponent is correct:
+			auto half = ((absBits - 0x38000000u) >> 13);
+			const auto remainder = absBits & 0x1FFFu;
+			if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+				++half;
+			}
+			return sign | static_cast<uint16_t>(half);
+		}
+
+		float half_to_float(uint16_t aValue)
+		{
+			const uint32_t sign = static_cast<uint32_t>(aValue & 0x8000u) << 16;
+			const uint32_t exponent = (aValue >> 10) & 0x1Fu;
+			uint32_t mantissa = aValue & 0x3FFu;
+			uint32_t bits;
+			if (0 == exponent) {
+				if (0 == mantissa) {
+					bits = sign;
+				}
+				else {
+					// Subnormal half => normalize it:
+					int e = -1;
+					do {
+						++e;
+						mantissa <<= 1;
+					} while (0 == (mantissa & 0x400u));
+					bits = sign | ((112u - e) << 23) | ((mantissa & 0x3FFu) << 13);
+				}
+			}
+			else if (0x1Fu == exponent) {
+				bits = sign | 0x7F800000u | (mantissa << 13);
+			}
+			else {
+				bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+			}
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+	}
+
+	void expand_rgb_to_rgba(const uint8_t* aSource, uint8_t* aTarget, uint32_t aWidth, uint32_t aHeight, unsigned int aNumThreads)
+	{
+		for_each_row_range(aWidth, aHeight, aNumThreads, [=](uint32_t aRowBegin, uint32_t aRowEnd) {
+			const size_t end = size_t{ aRowEnd } * aWidth;
+			size_t i = size_t{ aRowBegin } * aWidth;
+#if AVK_PIXEL_CONVERSION_SSSE3
+			// Four pixels per iteration; 16 bytes are loaded, hence, at least six pixels must be left:
+			const auto shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+			const auto alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+			for (; i + 6 <= end; i += 4) {
+				const auto rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSource + i * 3));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(aTarget + i * 4), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+			}
+#endif
+			for (; i < end; ++i) {
+				aTarget[i * 4 + 0] = aSource[i * 3 + 0];
+				aTarget[i * 4 + 1] = aSource[i * 3 + 1];
+				aTarget[i * 4 + 2] = aSource[i * 3 + 2];
+				aTarget[i * 4 + 3] = 255;
+			}
+		});
+	}
+
+	void expand_rgb_to_rgba(const float* aSource, float* aTarget, uint32_t aWidth, uint32_t aHeight, unsigned int aNumThreads)
+	{
+		for_each_row_range(aWidth, aHeight, aNumThreads, [=](uint32_t aRowBegin, uint32_t aRowEnd) {
+			const size_t end = size_t{ aRowEnd } * aWidth;
+			size_t i = size_t{ aRowBegin } * aWidth;
+#if AVK_PIXEL_CONVERSION_SSE2
+			// Four pixels per iteration, i.e., three loads and four stores:
+			const auto one = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+			const auto mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+			for (; i + 4 <= end; i += 4) {
+				const auto a = _mm_loadu_ps(aSource + i * 3);     // r0 g0 b0 r1
+				const auto b = _mm_loadu_ps(aSource + i * 3 + 4); // g1 b1 r2 g2
+				const auto c = _mm_loadu_ps(aSource + i * 3 + 8); // b2 r3 g3 b3
+				const auto p0 = a;
+				const auto t = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 3, 3));  // r1 r1 g1 b1
+				const auto p1 = _mm_shuffle_ps(t, t, _MM_SHUFFLE(3, 3, 2, 0));  // r1 g1 b1 -
+				const auto p2 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 0, 3, 2));  // r2 g2 b2 -
+				const auto p3 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(0, 3, 2, 1));  // r3 g3 b3 -
+				_mm_storeu_ps(aTarget + i * 4 + 0, _mm_or_ps(_mm_and_ps(p0, mask), one));
+				_mm_storeu_ps(aTarget + i * 4 + 4, _mm_or_ps(_mm_and_ps(p1, mask), one));
+				_mm_storeu_ps(aTarget + i * 4 + 8, _mm_or_ps(_mm_and_ps(p2, mask), one));
+				_mm_storeu_ps(aTarget + i * 4 + 12, _mm_or_ps(_mm_and_ps(p3, mask), one));
+			}
+#endif
+			for (; i < end; ++i) {
+				aTarget[i * 4 + 0] = aSource[i * 3 + 0];
+				aTarget[i * 4 + 1] = aSource[i * 3 + 1];
+				aTarget[i * 4 + 2] = aSource[i * 3 + 2];
+				aTarget[i * 4 + 3] = 1.0f;
+			}
+		});
+	}
+
+	void flip_vertically(std::byte* aPixels, size_t aRowSize, uint32_t aHeight, unsigned int aNumThreads)
+	{
+		// Every thread swaps a range of rows of the upper half with the corresponding rows of the lower half:
+		const auto numPairs = aHeight / 2;
+		const auto pixelsPerRow = static_cast<uint32_t>(std::min<size_t>(aRowSize / 4 + 1, std::numeric_limits<uint32_t>::max()));
+		for_each_row_range(pixelsPerRow, numPairs, aNumThreads, [=](uint32_t aRowBegin, uint32_t aRowEnd) {
+			std::vector<std::byte> row(aRowSize);
+			for (auto y = aRowBegin; y < aRowEnd; ++y) {
+				auto* upper = aPixels + size_t{ y } * aRowSize;
+				auto* lower = aPixels + size_t{ aHeight - 1 - y } * aRowSize;
+				std::memcpy(row.data(), upper, aRowSize);
+				std::memcpy(upper, lower, aRowSize);
+				std::memcpy(lower, row.data(), aRowSize);
+			}
+		});
+	}
+
+	void srgb_to_linear(const uint8_t* aSource, float* aTarget, uint32_t aWidth, uint32_t aHeight, uint32_t aNumChannels, bool aLinearAlpha, unsigned int aNumThreads)
+	{
+		const auto& tables = get_srgb_tables();
+		for_each_row_range(aWidth, aHeight, aNumThreads, [=, &tables](uint32_t aRowBegin, uint32_t aRowEnd) {
+			const size_t end = size_t{ aRowEnd } * aWidth * aNumChannels;
+			for (size_t i = size_t{ aRowBegin } * aWidth * aNumChannels; i < end; i += aNumChannels) {
+				for (uint32_t c = 0; c < aNumChannels; ++c) {
+					aTarget[i + c] = aLinearAlpha && c + 1 == aNumChannels ? static_cast<float>(aSource[i + c]) / 255.0f : tables.mToLinear[aSource[i + c]];
+				}
+			}
+		});
+	}
+
+	void float_to_half(const float* aSource, uint16_t* aTarget, uint32_t aWidth, uint32_t aHeight, uint32_t aNumChannels, unsigned int aNumThreads)
+	{
+		for_each_row_range(aWidth, aHeight, aNumThreads, [=](uint32_t aRowBegin, uint32_t aRowEnd) {
+			const size_t end = size_t{ aRowEnd } * aWidth * aNumChannels;
+			size_t i = size_t{ aRowBegin } * aWidth * aNumChannels;
+#if AVK_PIXEL_CONVERSION_F16C
+			for (; i + 4 <= end; i += 4) {
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(aTarget + i), _mm_cvtps_ph(_mm_loadu_ps(aSource + i), _MM_FROUND_TO_NEAREST_INT));
+			}
+#endif
+			for (; i < end; ++i) {
+				aTarget[i] = float_to_half(aSource[i]);
+			}
+		});
+	}
+
+	void half_to_float(const uint16_t* aSource, float* aTarget, uint32_t aWidth, uint32_t aHeight, uint32_t aNumChannels, unsigned int aNumThreads)
+	{
+		for_each_row_range(aWidth, aHeight, aNumThreads, [=](uint32_t aRowBegin, uint32_t aRowEnd) {
+			const size_t end = size_t{ aRowEnd } * aWidth * aNumChannels;
+			size_t i = size_t{ aRowBegin } * aWidth * aNumChannels;
+#if AVK_PIXEL_CONVERSION_F16C
+			for (; i + 4 <= end; i += 4) {
+				_mm_storeu_ps(aTarget + i, _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(aSource + i))));
+			}
+#endif
+			for (; i < end; ++i) {
+				aTarget[i] = half_to_float(aSource[i]);
+			}
+		});
+	}
+
+	void premultiply_alpha(uint8_t* aPixels, uint32_t aWidth, uint32_t aHeight, bool aSrgb, unsigned int aNumThreads)
+	{
+		if (aSrgb) {
+			const auto& tables = get_srgb_tables();
+			for_each_row_range(aWidth, aHeight, aNumThreads, [=, &tables](uint32_t aRowBegin, uint32_t aRowEnd) {
+				const size_t end = size_t{ aRowEnd } * aWidth * 4;
+				for (size_t i = size_t{ aRowBegin } * aWidth * 4; i < end; i += 4) {
+					const auto alpha = static_cast<float>(aPixels[i + 3]) / 255.0f;
+					for (size_t c = 0; c < 3; ++c) {
+						aPixels[i + c] = tables.from_linear(tables.mToLinear[aPixels[i + c]] * alpha);
+					}
+				}
+			});
+			return;
+		}
+
+		for_each_row_range(aWidth, aHeight, aNumThreads, [=](uint32_t aRowBegin, uint32_t aRowEnd) {
+			const size_t end = size_t{ aRowEnd } * aWidth * 4;
+			size_t i = size_t{ aRowBegin } * aWidth * 4;
+#if AVK_PIXEL_CONVERSION_SSE2
+			// Four pixels per iteration, as 16 bit values; x * a / 255 is rounded exactly like in the scalar code.
+			// The alpha channel is multiplied with 255, which keeps it unchanged:
+			const auto zero = _mm_setzero_si128();
+			const auto alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+			const auto alphaFactor = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+			const auto bias = _mm_set1_epi16(128);
+			auto premultiply = [&](__m128i aTwoPixels) {
+				auto alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(aTwoPixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+				alpha = _mm_or_si128(_mm_andnot_si128(alphaLanes, alpha), alphaFactor);
+				const auto product = _mm_add_epi16(_mm_mullo_epi16(aTwoPixels, alpha), bias);
+				return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+			};
+			for (; i + 16 <= end; i += 16) {
+				const auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aPixels + i));
+				const auto lo = premultiply(_mm_unpacklo_epi8(pixels, zero));
+				const auto hi = premultiply(_mm_unpackhi_epi8(pixels, zero));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(aPixels + i), _mm_packus_epi16(lo, hi));
+			}
+#endif
+			for (; i < end; i += 4) {
+				const uint32_t alpha = aPixels[i + 3];
+				for (size_t c = 0; c < 3; ++c) {
+					const uint32_t product = aPixels[i + c] * alpha + 128;
+					aPixels[i + c] = static_cast<uint8_t>((product + (product >> 8)) >> 8);
+				}
+			}
+		});
+	}
+
+	void premultiply_alpha(float* aPixels, uint32_t aWidth, uint32_t aHeight, unsigned int aNumThreads)
+	{
+		for_each_row_range(aWidth, aHeight, aNumThreads, [=](uint32_t aRowBegin, uint32_t aRowEnd) {
+			const size_t end = size_t{ aRowEnd } * aWidth * 4;
+			size_t i = size_t{ aRowBegin } * aWidth * 4;
+#if AVK_PIXEL_CONVERSION_SSE2
+			const auto alphaLane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+			for (; i + 4 <= end; i += 4) {
+				const auto pixel = _mm_loadu_ps(aPixels + i);
+				const auto alpha = _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 3, 3, 3));
+				const auto product = _mm_mul_ps(pixel, alpha);
+				_mm_storeu_ps(aPixels + i, _mm_or_ps(_mm_andnot_ps(alphaLane, product), _mm_and_ps(alphaLane, pixel)));
+			}
+#endif
+			for (; i < end; i += 4) {
+				aPixels[i + 0] *= aPixels[i + 3];
+				aPixels[i + 1] *= aPixels[i + 3];
+				aPixels[i + 2] *= aPixels[i + 3];
+			}
+		});
+	}
+}
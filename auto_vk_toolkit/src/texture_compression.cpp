@@ -0,0 +1,546 @@
+#include "texture_compression.hpp"
+#include <bit>
+#include <stb_dxt.h>
+
+namespace avk
+{
+	namespace
+	{
+		/** Jobs with fewer blocks are not split further, see compress_blocks */
+		constexpr size_t cMinBlocksPerJob = 256;
+
+		/** Interpolation weights of 4 bit indices, which are used by BC6H and BC7 */
+		constexpr std::array<uint32_t, 16> cWeights4 = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		/** Writes the bits of a 128 bit block, starting with its least significant bit */
+		class block_bit_writer
+		{
+		public:
+			void put(uint32_t aValue, uint32_t aNumBits)
+			{
+				for (uint32_t i = 0; i < aNumBits; ++i, ++mPosition) {
+					if ((aValue >> i) & 1u) {
+						mBits[mPosition >> 6] |= uint64_t{ 1 } << (mPosition & 63);
+					}
+				}
+			}
+
+			void write_to(uint8_t* aTarget) const
+			{
+				assert(128 == mPosition);
+				for (uint32_t i = 0; i < 16; ++i) {
+					aTarget[i] = static_cast<uint8_t>(mBits[i >> 3] >> (8 * (i & 7)));
+				}
+			}
+
+		private:
+			std::array<uint64_t, 2> mBits = {};
+			uint32_t mPosition = 0;
+		};
+
+		/**	Fits a line through the N-dimensional values of 16 pixels and returns its end points, such that the projections
+		 *	of all values onto the line are between them. The direction is the principal axis, found by power iteration.
+		 */
+		template <uint32_t N>
+		std::array<std::array<float, N>, 2> fit_end_points(const std::array<std::array<float, N>, 16>& aValues)
+		{
+			std::array<float, N> mean = {};
+			for (const auto& v : aValues) {
+				for (uint32_t c = 0; c < N; ++c) {
+					mean[c] += v[c] / 16.0f;
+				}
+			}
+
+			std::array<std::array<float, N>, N> covariance = {};
+			for (const auto& v : aValues) {
+				for (uint32_t r = 0; r < N; ++r) {
+					for (uint32_t c = 0; c < N; ++c) {
+						covariance[r][c] += (v[r] - mean[r]) * (v[c] - mean[c]);
+					}
+				}
+			}
+
+			std::array<float, N> axis;
+			axis.fill(1.0f);
+			for (int iteration = 0; iteration < 8; ++iteration) {
+				std::array<float, N> next = {};
+				float length = 0.0f;
+				for (uint32_t r = 0; r < N; ++r) {
+					for (uint32_t c = 0; c < N; ++c) {
+						next[r] += covariance[r][c] * axis[c];
+					}
+					length = std::max(length, std::abs(next[r]));
+				}
+				if (length <= 0.0f) {
+					break; // all values are equal, any axis will do
+				}
+				for (uint32_t c = 0; c < N; ++c) {
+					axis[c] = next[c] / length;
+				}
+			}
+
+			float lengthSquared = 0.0f;
+			for (uint32_t c = 0; c < N; ++c) {
+				lengthSquared += axis[c] * axis[c];
+			}
+			float minT = 0.0f, maxT = 0.0f;
+			for (const auto& v : aValues) {
+				float t = 0.0f;
+				for (uint32_t c = 0; c < N; ++c) {
+					t += (v[c] - mean[c]) * axis[c];
+				}
+				minT = std::min(minT, t / lengthSquared);
+				maxT = std::max(maxT, t / lengthSquared);
+			}
+
+			std::array<std::array<float, N>, 2> endPoints;
+			for (uint32_t c = 0; c < N; ++c) {
+				endPoints[0][c] = mean[c] + minT * axis[c];
+				endPoints[1][c] = mean[c] + maxT * axis[c];
+			}
+			return endPoints;
+		}
+
+		/** Returns the index of the palette entry which is closest to the given value */
+		template <uint32_t N>
+		uint32_t closest_index(const std::array<std::array<float, N>, 16>& aPalette, const std::array<float, N>& aValue, float& aError)
+		{
+			uint32_t best = 0;
+			aError = std::numeric_limits<float>::max();
+			for (uint32_t i = 0; i < 16; ++i) {
+				float error = 0.0f;
+				for (uint32_t c = 0; c < N; ++c) {
+					const auto d = aPalette[i][c] - aValue[c];
+					error += d * d;
+				}
+				if (error < aError) {
+					aError = error;
+					best = i;
+				}
+			}
+			return best;
+		}
+
+		/** Least-squares fit of two end points to the given values and their indices; returns false if all indices are equal */
+		template <uint32_t N>
+		bool refit_end_points(const std::array<std::array<float, N>, 16>& aValues, const std::array<uint32_t, 16>& aIndices, std::array<std::array<float, N>, 2>& aEndPoints)
+		{
+			float a = 0.0f, b = 0.0f, c = 0.0f;
+			std::array<float, N> rhs0 = {}, rhs1 = {};
+			for (uint32_t i = 0; i < 16; ++i) {
+				const auto t = static_cast<float>(cWeights4[aIndices[i]]) / 64.0f;
+				a += (1.0f - t) * (1.0f - t);
+				b += t * (1.0f - t);
+				c += t * t;
+				for (uint32_t ch = 0; ch < N; ++ch) {
+					rhs0[ch] += (1.0f - t) * aValues[i][ch];
+					rhs1[ch] += t * aValues[i][ch];
+				}
+			}
+			const auto determinant = a * c - b * b;
+			if (std::abs(determinant) < 1e-6f) {
+				return false;
+			}
+			for (uint32_t ch = 0; ch < N; ++ch) {
+				aEndPoints[0][ch] = (c * rhs0[ch] - b * rhs1[ch]) / determinant;
+				aEndPoints[1][ch] = (a * rhs1[ch] - b * rhs0[ch]) / determinant;
+			}
+			return true;
+		}
+
+		/** Quantized end points and indices of a single-partition block with 4 bit indices, i.e., BC6H mode 11 or BC7 mode 6 */
+		template <uint32_t N>
+		struct single_partition_block
+		{
+			std::array<std::array<uint32_t, N>, 2> mEndPoints = {};
+			std::array<uint32_t, 2> mPBits = {};
+			std::array<uint32_t, 16> mIndices = {};
+			float mError = std::numeric_limits<float>::max();
+
+			/** Makes sure that the most significant bit of the first index is 0, so that it can be stored with 3 bits */
+			void fix_anchor_index()
+			{
+				if (mIndices[0] & 8u) {
+					std::swap(mEndPoints[0], mEndPoints[1]);
+					std::swap(mPBits[0], mPBits[1]);
+					for (auto& index : mIndices) {
+						index = 15u - index;
+					}
+				}
+			}
+		};
+
+		/**	Encodes the values with a single partition, given functions which quantize end points and which compute the
+		 *	palette of quantized end points. The end points are fitted once more to the resulting indices.
+		 */
+		template <uint32_t N, typename Q, typename P>
+		single_partition_block<N> encode_single_partition(const std::array<std::array<float, N>, 16>& aValues, Q aQuantize, P aPalette)
+		{
+			single_partition_block<N> best;
+			auto endPoints = fit_end_points<N>(aValues);
+			for (int attempt = 0; attempt < 2; ++attempt) {
+				single_partition_block<N> candidate;
+				aQuantize(endPoints, candidate);
+				const auto palette = aPalette(candidate);
+				candidate.mError = 0.0f;
+				for (uint32_t i = 0; i < 16; ++i) {
+					float error;
+					candidate.mIndices[i] = closest_index<N>(palette, aValues[i], error);
+					candidate.mError += error;
+				}
+				if (candidate.mError < best.mError) {
+					best = candidate;
+				}
+				if (0.0f == best.mError || !refit_end_points<N>(aValues, best.mIndices, endPoints)) {
+					break;
+				}
+			}
+			best.fix_anchor_index();
+			return best;
+		}
+
+		/** Converts a float to the bits of an unsigned half float, clamping it to [0, 65504] and rounding to nearest even */
+		uint32_t to_half_ufloat_bits(float aValue)
+		{
+			if (!(aValue > 0.0f)) {
+				return 0; // negative, zero, or NaN
+			}
+			if (aValue >= 65504.0f) {
+				return 0x7BFF;
+			}
+			const auto bits = std::bit_cast<uint32_t>(aValue);
+			const auto exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+			auto mantissa = bits & 0x7FFFFF;
+			uint32_t shift = 13;
+			uint32_t half = 0;
+			if (exponent <= 0) {
+				if (exponent < -10) {
+					return 0;
+				}
+				mantissa |= 0x800000;
+				shift = static_cast<uint32_t>(14 - exponent);
+			}
+			else {
+				half = static_cast<uint32_t>(exponent) << 10;
+			}
+			half |= mantissa >> shift;
+			const auto remainder = mantissa & ((1u << shift) - 1);
+			const auto halfway = 1u << (shift - 1);
+			if (remainder > halfway || (remainder == halfway && (half & 1u))) {
+				++half; // may carry into the exponent, which is correct
+			}
+			return std::min(half, 0x7BFFu);
+		}
+
+		/** Encodes a block to BC6H mode 11, i.e., a single partition with 10 bit end points which are not delta-encoded */
+		void encode_bc6h_block(const std::array<std::array<float, 3>, 16>& aPixels, uint8_t* aTarget)
+		{
+			// BC6H interpolates the bits of half floats, hence, so does the encoder:
+			std::array<std::array<float, 3>, 16> values;
+			for (uint32_t i = 0; i < 16; ++i) {
+				for (uint32_t c = 0; c < 3; ++c) {
+					values[i][c] = static_cast<float>(to_half_ufloat_bits(aPixels[i][c]));
+				}
+			}
+
+			auto unquantize = [](uint32_t aValue) -> uint32_t {
+				return 0 == aValue ? 0 : (1023 == aValue ? 0xFFFF : ((aValue << 16) + 0x8000) >> 10);
+			};
+			auto block = encode_single_partition<3>(values,
+				[](const std::array<std::array<float, 3>, 2>& aEndPoints, single_partition_block<3>& aBlock) {
+					for (uint32_t e = 0; e < 2; ++e) {
+						for (uint32_t c = 0; c < 3; ++c) {
+							// Inverse of the palette computation below for end points, which yields 31 * q + 15:
+							aBlock.mEndPoints[e][c] = static_cast<uint32_t>(std::clamp(std::lround((aEndPoints[e][c] - 15.0f) / 31.0f), 0l, 1023l));
+						}
+					}
+				},
+				[&unquantize](const single_partition_block<3>& aBlock) {
+					std::array<std::array<float, 3>, 16> palette;
+					for (uint32_t i = 0; i < 16; ++i) {
+						for (uint32_t c = 0; c < 3; ++c) {
+							const auto interpolated = ((64 - cWeights4[i]) * unquantize(aBlock.mEndPoints[0][c]) + cWeights4[i] * unquantize(aBlock.mEndPoints[1][c]) + 32) >> 6;
+							palette[i][c] = static_cast<float>((interpolated * 31) >> 6);
+						}
+					}
+					return palette;
+				});
+
+			block_bit_writer writer;
+			writer.put(0x03, 5); // mode 11
+			for (uint32_t e = 0; e < 2; ++e) {
+				for (uint32_t c = 0; c < 3; ++c) {
+					writer.put(block.mEndPoints[e][c], 10);
+				}
+			}
+			writer.put(block.mIndices[0], 3);
+			for (uint32_t i = 1; i < 16; ++i) {
+				writer.put(block.mIndices[i], 4);
+			}
+			writer.write_to(aTarget);
+		}
+
+		/** Encodes a block to BC7 mode 6, i.e., a single partition with 7 bit RGBA end points, a p-bit per end point, and 4 bit indices */
+		void encode_bc7_block(const std::array<std::array<float, 4>, 16>& aPixels, uint8_t* aTarget)
+		{
+			auto block = encode_single_partition<4>(aPixels,
+				[](const std::array<std::array<float, 4>, 2>& aEndPoints, single_partition_block<4>& aBlock) {
+					for (uint32_t e = 0; e < 2; ++e) {
+						// Choose the p-bit, i.e., the shared least significant bit of all channels, with the smaller error:
+						float bestError = std::numeric_limits<float>::max();
+						for (uint32_t p = 0; p < 2; ++p) {
+							std::array<uint32_t, 4> quantized;
+							float error = 0.0f;
+							for (uint32_t c = 0; c < 4; ++c) {
+								const auto value = std::clamp(aEndPoints[e][c], 0.0f, 255.0f);
+								quantized[c] = static_cast<uint32_t>(std::clamp(std::lround((value - static_cast<float>(p)) / 2.0f), 0l, 127l));
+								const auto d = static_cast<float>(quantized[c] << 1 | p) - value;
+								error += d * d;
+							}
+							if (error < bestError) {
+								bestError = error;
+								aBlock.mEndPoints[e] = quantized;
+								aBlock.mPBits[e] = p;
+							}
+						}
+					}
+				},
+				[](const single_partition_block<4>& aBlock) {
+					std::array<std::array<float, 4>, 16> palette;
+					for (uint32_t i = 0; i < 16; ++i) {
+						for (uint32_t c = 0; c < 4; ++c) {
+							const auto e0 = aBlock.mEndPoints[0][c] << 1 | aBlock.mPBits[0];
+							const auto e1 = aBlock.mEndPoints[1][c] << 1 | aBlock.mPBits[1];
+							palette[i][c] = static_cast<float>(((64 - cWeights4[i]) * e0 + cWeights4[i] * e1 + 32) >> 6);
+						}
+					}
+					return palette;
+				});
+
+			block_bit_writer writer;
+			writer.put(1u << 6, 7); // mode 6
+			for (uint32_t c = 0; c < 4; ++c) {
+				writer.put(block.mEndPoints[0][c], 7);
+				writer.put(block.mEndPoints[1][c], 7);
+			}
+			writer.put(block.mPBits[0], 1);
+			writer.put(block.mPBits[1], 1);
+			writer.put(block.mIndices[0], 3);
+			for (uint32_t i = 1; i < 16; ++i) {
+				writer.put(block.mIndices[i], 4);
+			}
+			writer.write_to(aTarget);
+		}
+
+		size_t bytes_per_block(texture_block_format aBlockFormat)
+		{
+			return texture_block_format::bc1 == aBlockFormat || texture_block_format::bc4 == aBlockFormat ? 8 : 16;
+		}
+
+		/**	Returns the pixel of a 4x4 block at the given block coordinates, replicating the last column and row of the surface
+		 *	for blocks which exceed it.
+		 */
+		template <typename C>
+		const C* block_pixel(const texture_compression_surface& aSurface, uint32_t aNumChannels, uint32_t aBlockX, uint32_t aBlockY, uint32_t aIndex)
+		{
+			const auto x = std::min(aBlockX * 4 + aIndex % 4, aSurface.mWidth - 1);
+			const auto y = std::min(aBlockY * 4 + aIndex / 4, aSurface.mHeight - 1);
+			return reinterpret_cast<const C*>(aSurface.mPixels) + (size_t{ y } * aSurface.mWidth + x) * aNumChannels;
+		}
+
+		/** Encodes the block rows [aRowBegin, aRowEnd) of the given surface */
+		void compress_block_rows(texture_block_format aBlockFormat, const mip_map_pixel_layout& aLayout, const texture_compression_surface& aSurface, uint32_t aRowBegin, uint32_t aRowEnd)
+		{
+			const auto numChannels = aLayout.mNumChannels;
+			const auto blocksPerRow = (aSurface.mWidth + 3) / 4;
+			const auto blockSize = bytes_per_block(aBlockFormat);
+
+			for (uint32_t by = aRowBegin; by < aRowEnd; ++by) {
+				for (uint32_t bx = 0; bx < blocksPerRow; ++bx) {
+					auto* target = reinterpret_cast<uint8_t*>(aSurface.mBlocks) + (size_t{ by } * blocksPerRow + bx) * blockSize;
+
+					if (texture_block_format::bc6h == aBlockFormat) {
+						std::array<std::array<float, 3>, 16> pixels;
+						for (uint32_t i = 0; i < 16; ++i) {
+							const auto* p = block_pixel<float>(aSurface, numChannels, bx, by, i);
+							for (uint32_t c = 0; c < 3; ++c) {
+								pixels[i][c] = p[std::min(c, numChannels - 1)];
+							}
+						}
+						encode_bc6h_block(pixels, target);
+						continue;
+					}
+
+					// Missing channels are filled with 0, except for alpha, which is filled with 255:
+					std::array<uint8_t, 64> rgba;
+					for (uint32_t i = 0; i < 16; ++i) {
+						const auto* p = block_pixel<uint8_t>(aSurface, numChannels, bx, by, i);
+						for (uint32_t c = 0; c < 4; ++c) {
+							rgba[i * 4 + c] = c < numChannels ? p[c] : (3 == c ? 255 : 0);
+						}
+					}
+
+					switch (aBlockFormat) {
+					case texture_block_format::bc1:
+					case texture_block_format::bc3:
+						stb_compress_dxt_block(target, rgba.data(), texture_block_format::bc3 == aBlockFormat ? 1 : 0, STB_DXT_HIGHQUAL);
+						break;
+					case texture_block_format::bc4: {
+						std::array<uint8_t, 16> r;
+						for (uint32_t i = 0; i < 16; ++i) {
+							r[i] = rgba[i * 4];
+						}
+						stb_compress_bc4_block(target, r.data());
+						break;
+					}
+					case texture_block_format::bc5: {
+						std::array<uint8_t, 32> rg;
+						for (uint32_t i = 0; i < 16; ++i) {
+							rg[i * 2] = rgba[i * 4];
+							rg[i * 2 + 1] = rgba[i * 4 + 1];
+						}
+						stb_compress_bc5_block(target, rg.data());
+						break;
+					}
+					case texture_block_format::bc7:
+					default: {
+						std::array<std::array<float, 4>, 16> pixels;
+						for (uint32_t i = 0; i < 16; ++i) {
+							for (uint32_t c = 0; c < 4; ++c) {
+								pixels[i][c] = static_cast<float>(rgba[i * 4 + c]);
+							}
+						}
+						encode_bc7_block(pixels, target);
+						break;
+					}
+					}
+				}
+			}
+		}
+	}
+
+	std::optional<texture_block_format> choose_texture_block_format(vk::Format aFormat, size_t aBytesPerPixel, bool aHasTranslucentPixels, const texture_compression& aSettings, bool aIsNormalMap)
+	{
+		const auto layout = mip_map_pixel_layout_for(aFormat, aBytesPerPixel);
+		if (!layout) {
+			return {};
+		}
+
+		switch (aFormat) {
+		case vk::Format::eR8Unorm:
+			return texture_block_format::bc4;
+		case vk::Format::eR8G8Unorm:
+			return texture_block_format::bc5;
+		case vk::Format::eR8G8B8Unorm:
+		case vk::Format::eR8G8B8A8Unorm:
+			if (aIsNormalMap && aSettings.mNormalMapsToBc5) {
+				return texture_block_format::bc5;
+			}
+			[[fallthrough]];
+		case vk::Format::eR8G8B8Srgb:
+		case vk::Format::eR8G8B8A8Srgb:
+			if (aSettings.mPreferBc7) {
+				return texture_block_format::bc7;
+			}
+			return aHasTranslucentPixels ? texture_block_format::bc3 : texture_block_format::bc1;
+		case vk::Format::eR16G16B16Sfloat:
+		case vk::Format::eR16G16B16A16Sfloat:
+		case vk::Format::eR32G32B32Sfloat:
+		case vk::Format::eR32G32B32A32Sfloat:
+			if (aSettings.mCompressHdr) {
+				return texture_block_format::bc6h;
+			}
+			return {};
+		default:
+			// BGR formats, single-channel sRGB formats, and float formats with less than three channels
+			return {};
+		}
+	}
+
+	vk::Format vulkan_format_of(texture_block_format aBlockFormat, bool aSrgb)
+	{
+		switch (aBlockFormat) {
+		case texture_block_format::bc1:  return aSrgb ? vk::Format::eBc1RgbSrgbBlock : vk::Format::eBc1RgbUnormBlock;
+		case texture_block_format::bc3:  return aSrgb ? vk::Format::eBc3SrgbBlock : vk::Format::eBc3UnormBlock;
+		case texture_block_format::bc4:  return vk::Format::eBc4UnormBlock;
+		case texture_block_format::bc5:  return vk::Format::eBc5UnormBlock;
+		case texture_block_format::bc6h: return vk::Format::eBc6HUfloatBlock;
+		case texture_block_format::bc7:
+		default:                         return aSrgb ? vk::Format::eBc7SrgbBlock : vk::Format::eBc7UnormBlock;
+		}
+	}
+
+	size_t compressed_size(texture_block_format aBlockFormat, uint32_t aWidth, uint32_t aHeight)
+	{
+		return size_t{ (aWidth + 3) / 4 } * ((aHeight + 3) / 4) * bytes_per_block(aBlockFormat);
+	}
+
+	bool has_translucent_pixels(const mip_map_pixel_layout& aLayout, const std::byte* aPixels, uint32_t aWidth, uint32_t aHeight)
+	{
+		if (aLayout.mNumChannels < 4) {
+			return false;
+		}
+		const auto numPixels = size_t{ aWidth } * aHeight;
+		if (mip_map_channel_encoding::float32 == aLayout.mEncoding) {
+			const auto* pixels = reinterpret_cast<const float*>(aPixels);
+			for (size_t i = 0; i < numPixels; ++i) {
+				if (pixels[i * 4 + 3] < 1.0f) {
+					return true;
+				}
+			}
+			return false;
+		}
+		const auto* pixels = reinterpret_cast<const uint8_t*>(aPixels);
+		for (size_t i = 0; i < numPixels; ++i) {
+			if (pixels[i * 4 + 3] < 255) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void compress_blocks(texture_block_format aBlockFormat, const mip_map_pixel_layout& aLayout, const std::vector<texture_compression_surface>& aSurfaces, unsigned int aNumThreads)
+	{
+		assert((texture_block_format::bc6h == aBlockFormat) == (mip_map_channel_encoding::float32 == aLayout.mEncoding));
+
+		// Split every surface into jobs of whole block rows:
+		struct job
+		{
+			const texture_compression_surface* mSurface;
+			uint32_t mRowBegin;
+			uint32_t mRowEnd;
+		};
+		std::vector<job> jobs;
+		for (const auto& surface : aSurfaces) {
+			const auto blocksPerRow = size_t{ (surface.mWidth + 3) / 4 };
+			const auto numRows = (surface.mHeight + 3) / 4;
+			const auto rowsPerJob = static_cast<uint32_t>(std::max<size_t>((cMinBlocksPerJob + blocksPerRow - 1) / blocksPerRow, 1));
+			for (uint32_t row = 0; row < numRows; row += rowsPerJob) {
+				jobs.push_back(job{ &surface, row, std::min(row + rowsPerJob, numRows) });
+			}
+		}
+
+		if (0 == aNumThreads) {
+			aNumThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		const auto numThreads = static_cast<unsigned int>(std::min<size_t>(aNumThreads, jobs.size()));
+
+		std::atomic<size_t> nextJob = 0;
+		auto worker = [&]() {
+			for (auto index = nextJob++; index < jobs.size(); index = nextJob++) {
+				compress_block_rows(aBlockFormat, aLayout, *jobs[index].mSurface, jobs[index].mRowBegin, jobs[index].mRowEnd);
+			}
+		};
+
+		// The calling thread is one of the workers:
+		std::vector<std::thread> threads;
+		threads.reserve(numThreads > 0 ? numThreads - 1 : 0);
+		for (unsigned int t = 1; t < numThreads; ++t) {
+			threads.emplace_back(worker);
+		}
+		worker();
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+}
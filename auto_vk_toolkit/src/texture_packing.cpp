@@ -0,0 +1,327 @@
+#include "texture_packing.hpp"
+#include "material_image_helpers.hpp"
+#include <cstring>
+#include <numeric>
+
+namespace avk
+{
+	namespace
+	{
+		/** Texels around each texture in an atlas which repeat its edges, s.t. bilinear filtering does not sample its neighbors */
+		constexpr uint32_t cAtlasGutter = 1;
+
+		/** How a texture is created */
+		enum struct packing_kind
+		{
+			individual,
+			array,
+			atlas
+		};
+
+		/** The data of a level of a layer of an image which is uploaded */
+		struct image_region
+		{
+			uint32_t mLayer;
+			uint32_t mLevel;
+			const std::byte* mData;
+			size_t mSize;
+		};
+
+		/** A texture in an atlas */
+		struct atlas_entry
+		{
+			size_t mTexture;
+			uint32_t mX;
+			uint32_t mY;
+		};
+
+		/** The size of a texel of the given uncompressed image data, or 0 if it is block-compressed or has padded rows */
+		size_t texel_size(image_data& aImageData)
+		{
+			const auto extent = aImageData.extent();
+			const size_t numTexels = size_t{ extent.width } * extent.height;
+			if (avk::is_block_compressed_format(aImageData.get_format()) || 0 == numTexels || aImageData.size(0) % numTexels != 0) {
+				return 0;
+			}
+			return aImageData.size(0) / numTexels;
+		}
+
+		/** Creates an image with the given regions, which are uploaded by the batcher, or by commands which are appended to aCommands */
+		avk::image_view create_image_from_regions(uint32_t aWidth, uint32_t aHeight, vk::Format aFormat, uint32_t aLayers, uint32_t aLevels, size_t aTexelSize, avk::image_usage aImageUsage,
+			const std::vector<image_region>& aRegions, avk::command::action_type_command& aCommands, std::optional<std::reference_wrapper<avk::upload_batcher>> aUploadBatcher)
+		{
+			auto img = context().create_image(aWidth, aHeight, aFormat, aLayers, avk::memory_usage::device, aImageUsage, [&](avk::image_t& image) {
+				image.create_info().mipLevels = aLevels;
+			});
+
+			auto regionOf = [&](const image_region& bRegion, size_t bOffset) {
+				return vk::BufferImageCopy{}
+					.setBufferOffset(bOffset)
+					.setBufferRowLength(0)
+					.setBufferImageHeight(0)
+					.setImageSubresource(vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, bRegion.mLevel, bRegion.mLayer, 1u })
+					.setImageOffset(vk::Offset3D{ 0, 0, 0 })
+					.setImageExtent(vk::Extent3D{ std::max(aWidth >> bRegion.mLevel, 1u), std::max(aHeight >> bRegion.mLevel, 1u), 1u });
+			};
+
+			if (aUploadBatcher) {
+				aUploadBatcher->get().begin_image(*img);
+				for (const auto& region : aRegions) {
+					std::memcpy(aUploadBatcher->get().stage_image_region(region.mLayer, region.mLevel, region.mSize), region.mData, region.mSize);
+				}
+				aUploadBatcher->get().end_image(avk::layout::shader_read_only_optimal);
+			}
+			else {
+				// All regions are staged in one buffer and copied with a single command; offsets must also be multiples of the texel size:
+				const auto alignment = std::lcm(cMinStagingAlignment, std::max<size_t>(aTexelSize, 1));
+				std::vector<vk::BufferImageCopy> copies;
+				std::vector<std::byte> staged;
+				for (const auto& region : aRegions) {
+					const auto offset = (staged.size() + alignment - 1) / alignment * alignment;
+					copies.push_back(regionOf(region, offset));
+					staged.resize(offset + region.mSize);
+					std::memcpy(staged.data() + offset, region.mData, region.mSize);
+				}
+
+				auto sb = context().create_buffer(
+					AVK_STAGING_BUFFER_MEMORY_USAGE,
+					vk::BufferUsageFlagBits::eTransferSrc,
+					avk::generic_buffer_meta::create_from_size(staged.size())
+				);
+				auto nop = sb->fill(staged.data(), 0);
+				assert(!nop.mBeginFun);
+				assert(!nop.mEndFun);
+
+				auto actionTypeCommand = avk::command::action_type_command{
+					{},
+					{
+						std::make_tuple(img->handle(), avk::sync::sync_hint{
+							avk::stage::none     + avk::access::none,
+							avk::stage::transfer + avk::access::transfer_write
+						})
+					}
+				};
+				actionTypeCommand.mNestedCommandsAndSyncInstructions.push_back(
+					avk::sync::image_memory_barrier(*img,
+						avk::stage::none  >> avk::stage::copy,
+						avk::access::none >> avk::access::transfer_write
+					).with_layout_transition(avk::layout::undefined >> avk::layout::transfer_dst)
+				);
+				actionTypeCommand.mNestedCommandsAndSyncInstructions.push_back(
+					avk::command::custom_commands([src = sb->handle(), dst = img->handle(), copies = std::move(copies)](avk::command_buffer_t& cb) {
+						cb.handle().copyBufferToImage(src, dst, vk::ImageLayout::eTransferDstOptimal, copies, cb.root_ptr()->dispatch_loader_core());
+					})
+				);
+				actionTypeCommand.mNestedCommandsAndSyncInstructions.push_back(
+					avk::sync::image_memory_barrier(*img,
+						avk::stage::copy            >> avk::stage::transfer,
+						avk::access::transfer_write >> avk::access::none
+					).with_layout_transition(avk::layout::transfer_dst >> avk::layout::shader_read_only_optimal)
+				);
+				actionTypeCommand.handle_lifetime_of(std::move(sb));
+				actionTypeCommand.infer_sync_hint_from_resource_sync_hints();
+				aCommands.mNestedCommandsAndSyncInstructions.push_back(std::move(actionTypeCommand));
+			}
+
+			auto imgView = context().create_image_view(std::move(img));
+			imgView.enable_shared_ownership();
+			return imgView;
+		}
+
+		/** Copies a texture into an atlas at the given position, and repeats its edges in the gutter around it */
+		void copy_into_atlas(std::byte* aAtlas, uint32_t aAtlasExtent, size_t aTexelSize, const std::byte* aTexels, uint32_t aWidth, uint32_t aHeight, uint32_t aX, uint32_t aY)
+		{
+			const auto paddedWidth = aWidth + 2 * cAtlasGutter;
+			const auto paddedHeight = aHeight + 2 * cAtlasGutter;
+			for (uint32_t y = 0; y < paddedHeight; ++y) {
+				const auto srcY = std::min(std::max(y, cAtlasGutter) - cAtlasGutter, aHeight - 1);
+				auto* dstRow = aAtlas + (size_t{ aY + y } * aAtlasExtent + aX) * aTexelSize;
+				const auto* srcRow = aTexels + size_t{ srcY } * aWidth * aTexelSize;
+				for (uint32_t x = 0; x < paddedWidth; ++x) {
+					const auto srcX = std::min(std::max(x, cAtlasGutter) - cAtlasGutter, aWidth - 1);
+					std::memcpy(dstRow + x * aTexelSize, srcRow + srcX * aTexelSize, aTexelSize);
+				}
+			}
+		}
+	}
+
+	std::vector<std::vector<packed_texture>> pack_textures(
+		std::vector<image_data>& aImageData,
+		const std::vector<std::vector<packable_texture_usage>>& aUsages,
+		avk::image_usage aImageUsage,
+		avk::filter_mode aTextureFilterMode,
+		const texture_packing& aPacking,
+		std::vector<avk::image_sampler>& aImageSamplers,
+		std::vector<avk::image_sampler>& aArrayImageSamplers,
+		avk::command::action_type_command& aCommands,
+		unsigned int aNumThreads,
+		std::optional<std::reference_wrapper<avk::upload_batcher>> aUploadBatcher)
+	{
+		assert(aImageData.size() == aUsages.size());
+		const auto numTextures = aImageData.size();
+		std::vector<std::vector<packed_texture>> result(numTextures);
+		for (size_t i = 0; i < numTextures; ++i) {
+			result[i].resize(aUsages[i].size());
+		}
+
+		load_image_data_in_parallel(aImageData, [&](size_t aIndex) {
+			if (aImageData[aIndex].target() != vk::ImageType::e2D) {
+				throw avk::runtime_error(std::format("The image loaded from '{}' is not intended to be used as 2D image. Can't load it.", aImageData[aIndex].path()));
+			}
+			generate_mip_maps_for_usage(aImageData[aIndex], aImageUsage);
+		}, aNumThreads);
+
+		std::vector<packing_kind> kinds(numTextures, packing_kind::individual);
+		const bool isMipMapped = (static_cast<int>(aImageUsage) & static_cast<int>(avk::image_usage::mip_mapped)) > 0;
+
+		// Pack the small textures into atlases, grouped by format, with a shelf packer:
+		if (aPacking.mMaxAtlasTextureExtent > 0) {
+			std::map<vk::Format, std::vector<size_t>> candidates;
+			for (size_t i = 0; i < numTextures; ++i) {
+				auto& imageData = aImageData[i];
+				const auto extent = imageData.extent();
+				const bool clampedToEdge = std::all_of(aUsages[i].begin(), aUsages[i].end(), [](const packable_texture_usage& u) {
+					return u.mWithinUnitSquare
+						&& u.mBorderHandlingModes[0] == avk::border_handling_mode::clamp_to_edge
+						&& u.mBorderHandlingModes[1] == avk::border_handling_mode::clamp_to_edge;
+				});
+				if (clampedToEdge && imageData.faces() == 1 && texel_size(imageData) > 0
+					&& extent.width <= aPacking.mMaxAtlasTextureExtent && extent.height <= aPacking.mMaxAtlasTextureExtent
+					&& extent.width + 2 * cAtlasGutter <= aPacking.mAtlasExtent && extent.height + 2 * cAtlasGutter <= aPacking.mAtlasExtent) {
+					candidates[imageData.get_format()].push_back(i);
+				}
+			}
+
+			for (auto& [format, textures] : candidates) {
+				// The tallest textures first, s.t. the shelves are filled evenly:
+				std::stable_sort(textures.begin(), textures.end(), [&](size_t a, size_t b) {
+					return aImageData[a].extent().height > aImageData[b].extent().height;
+				});
+
+				std::vector<std::vector<atlas_entry>> atlases(1);
+				uint32_t x = 0, y = 0, shelfHeight = 0;
+				for (auto i : textures) {
+					const auto width = aImageData[i].extent().width + 2 * cAtlasGutter;
+					const auto height = aImageData[i].extent().height + 2 * cAtlasGutter;
+					if (x + width > aPacking.mAtlasExtent) {
+						x = 0;
+						y += shelfHeight;
+						shelfHeight = 0;
+					}
+					if (y + height > aPacking.mAtlasExtent) {
+						atlases.emplace_back();
+						x = y = shelfHeight = 0;
+					}
+					atlases.back().push_back(atlas_entry{ i, x, y });
+					x += width;
+					shelfHeight = std::max(shelfHeight, height);
+				}
+
+				for (const auto& entries : atlases) {
+					// An atlas with a single texture would only waste memory:
+					if (entries.size() < 2) {
+						continue;
+					}
+
+					const auto texelSize = texel_size(aImageData[entries.front().mTexture]);
+					std::vector<std::byte> atlas(size_t{ aPacking.mAtlasExtent } * aPacking.mAtlasExtent * texelSize);
+					for (const auto& entry : entries) {
+						auto& imageData = aImageData[entry.mTexture];
+						copy_into_atlas(atlas.data(), aPacking.mAtlasExtent, texelSize, static_cast<const std::byte*>(imageData.get_data(0, 0, 0)),
+							imageData.extent().width, imageData.extent().height, entry.mX, entry.mY);
+					}
+					auto imgView = create_image_from_regions(aPacking.mAtlasExtent, aPacking.mAtlasExtent, format, 1, 1, texelSize, aImageUsage,
+						{ image_region{ 0, 0, atlas.data(), atlas.size() } }, aCommands, aUploadBatcher);
+
+					// All textures in an atlas are clamped to edge, i.e., they share one sampler:
+					aImageSamplers.push_back(context().create_image_sampler(imgView, context().create_sampler(aTextureFilterMode, avk::border_handling_mode::clamp_to_edge)));
+					const auto index = static_cast<int32_t>(aImageSamplers.size() - 1);
+					const auto atlasExtent = static_cast<float>(aPacking.mAtlasExtent);
+					for (const auto& entry : entries) {
+						kinds[entry.mTexture] = packing_kind::atlas;
+						const auto extent = aImageData[entry.mTexture].extent();
+						for (auto& placed : result[entry.mTexture]) {
+							placed.mIndex = index;
+							placed.mScale = glm::vec2{ static_cast<float>(extent.width), static_cast<float>(extent.height) } / atlasExtent;
+							placed.mOffset = glm::vec2{ static_cast<float>(entry.mX + cAtlasGutter), static_cast<float>(entry.mY + cAtlasGutter) } / atlasExtent;
+						}
+					}
+				}
+			}
+		}
+
+		// Pack textures with the same format, size, and number of levels into texture arrays:
+		if (aPacking.mMinArrayLayers > 0) {
+			std::map<std::tuple<vk::Format, uint32_t, uint32_t, uint32_t>, std::vector<size_t>> groups;
+			for (size_t i = 0; i < numTextures; ++i) {
+				auto& imageData = aImageData[i];
+				const auto extent = imageData.extent();
+				// Mipmaps can not be blitted for texture arrays, hence, they must have been generated on the CPU:
+				const bool hasAllLevels = !isMipMapped || imageData.levels() > 1 || (extent.width == 1 && extent.height == 1);
+				if (packing_kind::individual == kinds[i] && imageData.faces() == 1 && hasAllLevels) {
+					groups[std::make_tuple(imageData.get_format(), extent.width, extent.height, imageData.levels())].push_back(i);
+				}
+			}
+
+			const auto maxLayers = std::clamp(aPacking.mMaxArrayLayers, 2u, 0x4000u);
+			for (const auto& [key, textures] : groups) {
+				if (textures.size() < std::max(aPacking.mMinArrayLayers, 2u)) {
+					continue;
+				}
+				const auto& [format, width, height, levels] = key;
+				const auto texelSize = avk::is_block_compressed_format(format) ? size_t{ 0 } : texel_size(aImageData[textures.front()]);
+
+				// Distribute the textures evenly, s.t. no array has a single layer:
+				const auto numArrays = (textures.size() + maxLayers - 1) / maxLayers;
+				for (size_t a = 0; a < numArrays; ++a) {
+					const auto begin = textures.size() * a / numArrays;
+					const auto end = textures.size() * (a + 1) / numArrays;
+
+					std::vector<image_region> regions;
+					for (auto t = begin; t < end; ++t) {
+						for (uint32_t level = 0; level < levels; ++level) {
+							auto& imageData = aImageData[textures[t]];
+							regions.push_back(image_region{ static_cast<uint32_t>(t - begin), level, static_cast<const std::byte*>(imageData.get_data(0, 0, level)), imageData.size(level) });
+						}
+					}
+					auto imgView = create_image_from_regions(width, height, format, static_cast<uint32_t>(end - begin), levels, texelSize, aImageUsage, regions, aCommands, aUploadBatcher);
+
+					// One image sampler per border handling mode which any of the layers is sampled with:
+					std::vector<std::tuple<std::array<avk::border_handling_mode, 2>, uint32_t>> samplers;
+					for (auto t = begin; t < end; ++t) {
+						for (size_t u = 0; u < aUsages[textures[t]].size(); ++u) {
+							const auto& bhModes = aUsages[textures[t]][u].mBorderHandlingModes;
+							auto it = std::find_if(samplers.begin(), samplers.end(), [&](const auto& s) { return std::get<0>(s) == bhModes; });
+							if (samplers.end() == it) {
+								if (aArrayImageSamplers.size() > 0xFFFF) {
+									throw avk::runtime_error("Too many texture arrays; their indices exceed 16 bits.");
+								}
+								aArrayImageSamplers.push_back(context().create_image_sampler(imgView, context().create_sampler(aTextureFilterMode, bhModes)));
+								it = samplers.insert(samplers.end(), std::make_tuple(bhModes, static_cast<uint32_t>(aArrayImageSamplers.size() - 1)));
+							}
+							result[textures[t]][u].mIndex = make_texture_array_index(std::get<1>(*it), static_cast<uint32_t>(t - begin));
+						}
+						kinds[textures[t]] = packing_kind::array;
+					}
+				}
+			}
+		}
+
+		// All other textures become individual images, like in convert_for_gpu_usage_cached:
+		for (size_t i = 0; i < numTextures; ++i) {
+			if (packing_kind::individual != kinds[i]) {
+				continue;
+			}
+			auto [tex, cmds] = create_image_from_image_data_cached(aImageData[i], avk::layout::shader_read_only_optimal, avk::memory_usage::device, aImageUsage, {}, aUploadBatcher);
+			aCommands.mNestedCommandsAndSyncInstructions.push_back(std::move(cmds));
+			auto imgView = context().create_image_view(std::move(tex));
+			imgView.enable_shared_ownership();
+			for (size_t u = 0; u < aUsages[i].size(); ++u) {
+				aImageSamplers.push_back(context().create_image_sampler(imgView, context().create_sampler(aTextureFilterMode, aUsages[i][u].mBorderHandlingModes)));
+				result[i][u].mIndex = static_cast<int32_t>(aImageSamplers.size() - 1);
+			}
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,116 @@
+#include "texture_registry.hpp"
+#include "content_hash.hpp"
+
+namespace avk
+{
+	texture_key make_texture_key(const image_data& aImageData, avk::image_usage aImageUsage)
+	{
+		assert(!aImageData.empty());
+
+		texture_key key;
+		key.mFormat = aImageData.get_format();
+		key.mWidth = aImageData.extent().width;
+		key.mHeight = aImageData.extent().height;
+		key.mFaces = aImageData.faces();
+		key.mLevels = std::max<std::uint32_t>(aImageData.levels(), 1);
+		key.mImageUsage = aImageUsage;
+
+		// Same levels and faces as serialize_image_data writes:
+		for (std::uint32_t level = 0; level < key.mLevels; ++level) {
+			for (std::uint32_t face = 0; face < key.mFaces; ++face) {
+				key.mContentHash = content_hash(aImageData.get_data(0, face, level), aImageData.size(level), key.mContentHash);
+			}
+		}
+		return key;
+	}
+
+	texture_key make_texture_key(std::array<uint8_t, 4> aColor, vk::Format aFormat, avk::image_usage aImageUsage)
+	{
+		return texture_key{ content_hash(aColor.data(), sizeof(aColor)), aFormat, 1u, 1u, 1u, 1u, aImageUsage };
+	}
+
+	std::optional<avk::image_view> texture_registry::acquire(const texture_key& aKey)
+	{
+		std::scoped_lock lock(mMutex);
+		auto it = mTextures.find(aKey);
+		if (mTextures.end() == it) {
+			return {};
+		}
+		++it->second.mReferenceCount;
+		return it->second.mImageView;
+	}
+
+	avk::image_view texture_registry::add(const texture_key& aKey, avk::image_view aImageView)
+	{
+		std::scoped_lock lock(mMutex);
+		auto [it, inserted] = mTextures.try_emplace(aKey);
+		++it->second.mReferenceCount;
+		if (inserted) {
+			aImageView.enable_shared_ownership();
+			mKeysOfImageViews[static_cast<VkImageView>(aImageView->handle())] = aKey;
+			it->second.mImageView = std::move(aImageView);
+		}
+		return it->second.mImageView;
+	}
+
+	bool texture_registry::release_locked(const texture_key& aKey)
+	{
+		auto it = mTextures.find(aKey);
+		if (mTextures.end() == it) {
+			return false;
+		}
+		assert(it->second.mReferenceCount > 0);
+		if (--it->second.mReferenceCount > 0) {
+			return false;
+		}
+		mKeysOfImageViews.erase(static_cast<VkImageView>(it->second.mImageView->handle()));
+		mTextures.erase(it);
+		return true;
+	}
+
+	bool texture_registry::release(const texture_key& aKey)
+	{
+		std::scoped_lock lock(mMutex);
+		return release_locked(aKey);
+	}
+
+	size_t texture_registry::release(const std::vector<avk::image_sampler>& aImageSamplers)
+	{
+		std::scoped_lock lock(mMutex);
+		std::vector<texture_key> keys;
+		for (const auto& imageSampler : aImageSamplers) {
+			auto it = mKeysOfImageViews.find(static_cast<VkImageView>(imageSampler->get_image_view()->handle()));
+			if (mKeysOfImageViews.end() != it && std::find(keys.begin(), keys.end(), it->second) == keys.end()) {
+				keys.push_back(it->second);
+			}
+		}
+
+		size_t numRemoved = 0;
+		for (const auto& key : keys) {
+			if (release_locked(key)) {
+				++numRemoved;
+			}
+		}
+		return numRemoved;
+	}
+
+	std::uint32_t texture_registry::reference_count(const texture_key& aKey) const
+	{
+		std::scoped_lock lock(mMutex);
+		auto it = mTextures.find(aKey);
+		return mTextures.end() == it ? 0 : it->second.mReferenceCount;
+	}
+
+	size_t texture_registry::size() const
+	{
+		std::scoped_lock lock(mMutex);
+		return mTextures.size();
+	}
+
+	void texture_registry::clear()
+	{
+		std::scoped_lock lock(mMutex);
+		mTextures.clear();
+		mKeysOfImageViews.clear();
+	}
+}
@@ -0,0 +1,427 @@
+#include "texture_streamer.hpp"
+#include "material_image_helpers.hpp"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace avk
+{
+	namespace
+	{
+		std::string header_entry_name(std::string_view aName)
+		{
+			return std::format("{}/header", aName);
+		}
+
+		std::string level_entry_name(std::string_view aName, uint32_t aLevel)
+		{
+			return std::format("{}/level{}", aName, aLevel);
+		}
+
+		/** Loads the image data and generates its mipmaps on the CPU if they are needed, since levels can not be blitted from levels which are not resident */
+		void load_with_mip_maps(image_data& aImageData, avk::image_usage aImageUsage)
+		{
+			aImageData.load();
+			generate_mip_maps_for_usage(aImageData, aImageUsage);
+		}
+
+		/** Returns the data of all faces of the given levels of the image data */
+		std::vector<std::vector<std::span<const std::byte>>> data_of_levels(image_data& aImageData, uint32_t aFirstLevel, uint32_t aEndLevel)
+		{
+			std::vector<std::vector<std::span<const std::byte>>> levels;
+			for (uint32_t level = aFirstLevel; level < aEndLevel; ++level) {
+				auto& faces = levels.emplace_back();
+				for (uint32_t face = 0; face < aImageData.faces(); ++face) {
+					faces.emplace_back(static_cast<const std::byte*>(aImageData.get_data(0, face, level)), aImageData.size(level));
+				}
+			}
+			return levels;
+		}
+	}
+
+	texture_streamer::texture_streamer(avk::queue& aQueue, size_t aMemoryBudget, uint32_t aMipTailExtent, unsigned int aNumThreads, std::optional<std::reference_wrapper<avk::chunked_cache>> aCache)
+		: mUploadBatcher(aQueue)
+		, mMemoryBudget(aMemoryBudget)
+		, mMipTailExtent(std::max(aMipTailExtent, 1u))
+		, mCache(aCache)
+	{
+		if (0 == aNumThreads) {
+			aNumThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		for (unsigned int i = 0; i < aNumThreads; ++i) {
+			mWorkers.emplace_back(&texture_streamer::worker, this);
+		}
+	}
+
+	texture_streamer::~texture_streamer()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStopping = true;
+		}
+		mJobsAvailable.notify_all();
+		for (auto& w : mWorkers) {
+			w.join();
+		}
+		// The images must outlive the batches which copy to and from them:
+		mUploadBatcher.wait_idle();
+	}
+
+	size_t texture_streamer::add_texture(std::string aName, std::uint64_t aKey, image_data_loader aLoader, avk::image_usage aImageUsage)
+	{
+		const auto index = mTextures.size();
+		auto& texture = mTextures.emplace_back();
+		texture.mName = std::move(aName);
+		texture.mKey = aKey;
+		texture.mLoader = std::move(aLoader);
+		texture.mImageUsage = aImageUsage;
+
+		// Read the description of the texture from the cache, or load the texture and store all of its levels in the cache:
+		uint32_t format = 0;
+		std::vector<std::uint64_t> levelSizes;
+		std::optional<image_data> imageData;
+		if (mCache && mCache->get().load(header_entry_name(texture.mName), texture.mKey, format, texture.mWidth, texture.mHeight, texture.mFaces, levelSizes) && !levelSizes.empty()) {
+			texture.mFormat = static_cast<vk::Format>(format);
+			texture.mLevelSizes.assign(levelSizes.begin(), levelSizes.end());
+		}
+		else {
+			imageData.emplace(texture.mLoader());
+			load_with_mip_maps(*imageData, aImageUsage);
+			if (imageData->target() != vk::ImageType::e2D) {
+				throw avk::runtime_error(std::format("The image of texture '{}' is not a 2D image. Can't stream it.", texture.mName));
+			}
+			texture.mFormat = imageData->get_format();
+			texture.mWidth = imageData->extent().width;
+			texture.mHeight = imageData->extent().height;
+			texture.mFaces = imageData->faces();
+			for (uint32_t level = 0; level < std::max(imageData->levels(), 1u); ++level) {
+				texture.mLevelSizes.push_back(imageData->size(level) * texture.mFaces);
+			}
+
+			if (mCache) {
+				for (uint32_t level = 0; level < levels(index); ++level) {
+					std::vector<std::byte> data(texture.mLevelSizes[level]);
+					const auto faceSize = imageData->size(level);
+					for (uint32_t face = 0; face < texture.mFaces; ++face) {
+						std::memcpy(data.data() + face * faceSize, imageData->get_data(0, face, level), faceSize);
+					}
+					mCache->get().store_data(level_entry_name(texture.mName, level), texture.mKey, std::move(data));
+				}
+				// The header is stored last, s.t. textures whose levels have not been stored completely are not read from the cache:
+				format = static_cast<uint32_t>(texture.mFormat);
+				levelSizes.assign(texture.mLevelSizes.begin(), texture.mLevelSizes.end());
+				mCache->get().store(header_entry_name(texture.mName), texture.mKey, format, texture.mWidth, texture.mHeight, texture.mFaces, levelSizes);
+			}
+		}
+
+		// The tail begins with the first level which fits into the tail extent; nothing is resident yet:
+		const auto numLevels = levels(index);
+		while (texture.mTailLevel + 1 < numLevels && std::max(texture.mWidth >> texture.mTailLevel, texture.mHeight >> texture.mTailLevel) > mMipTailExtent) {
+			++texture.mTailLevel;
+		}
+		texture.mResidentLevel = numLevels;
+		texture.mRequestedLevel = texture.mTailLevel;
+
+		loaded_levels tail;
+		if (imageData) {
+			tail.mFirstLevel = texture.mTailLevel;
+			tail.mData = data_of_levels(*imageData, texture.mTailLevel, numLevels);
+		}
+		else {
+			tail = load_levels(load_job{ index, texture.mName, texture.mKey, texture.mLoader, aImageUsage, texture.mFaces, texture.mTailLevel, numLevels });
+			if (tail.mFailed) {
+				throw avk::runtime_error(std::format("Unable to load the mip tail of texture '{}'", texture.mName));
+			}
+		}
+		make_resident(texture, texture.mTailLevel, &tail);
+		return index;
+	}
+
+	size_t texture_streamer::add_sampler(size_t aTexture, avk::sampler aSampler)
+	{
+		auto& texture = mTextures[aTexture];
+		aSampler.enable_shared_ownership();
+		mImageSamplers.push_back(context().create_image_sampler(texture.mImageView, aSampler));
+		mImageSamplerTextures.push_back(aTexture);
+		texture.mImageSamplerIndices.push_back(mImageSamplers.size() - 1);
+		texture.mSamplers.push_back(std::move(aSampler));
+		return mImageSamplers.size() - 1;
+	}
+
+	size_t texture_streamer::add_resident_image_sampler(avk::image_sampler aImageSampler)
+	{
+		mImageSamplers.push_back(std::move(aImageSampler));
+		mImageSamplerTextures.push_back({});
+		return mImageSamplers.size() - 1;
+	}
+
+	void texture_streamer::request_level(size_t aImageSamplerIndex, uint32_t aLevel)
+	{
+		if (const auto textureIndex = mImageSamplerTextures[aImageSamplerIndex]) {
+			auto& texture = mTextures[*textureIndex];
+			texture.mRequestedLevel = std::min(texture.mRequestedLevel, aLevel);
+			texture.mLastUsedFrame = mFrame;
+		}
+	}
+
+	void texture_streamer::request_screen_size(size_t aImageSamplerIndex, float aSizeInPixels)
+	{
+		const auto textureIndex = mImageSamplerTextures[aImageSamplerIndex];
+		if (!textureIndex) {
+			return;
+		}
+
+		// One texel per pixel is needed, i.e., every level beyond that halves the texels per pixel:
+		const auto& texture = mTextures[*textureIndex];
+		const auto texels = static_cast<float>(std::max(texture.mWidth, texture.mHeight));
+		const auto level = aSizeInPixels >= texels ? 0u : static_cast<uint32_t>(std::floor(std::log2(texels / std::max(aSizeInPixels, 1.0f))));
+		request_level(aImageSamplerIndex, level);
+	}
+
+	void texture_streamer::apply_feedback(std::span<const int32_t> aFinestLevels)
+	{
+		const auto count = std::min(aFinestLevels.size(), mImageSamplers.size());
+		for (size_t i = 0; i < count; ++i) {
+			const auto textureIndex = mImageSamplerTextures[i];
+			if (!textureIndex || std::numeric_limits<int32_t>::max() == aFinestLevels[i]) {
+				continue;
+			}
+			// The levels are relative to the resident level, which is level 0 of the bound image:
+			const auto level = static_cast<int64_t>(mTextures[*textureIndex].mResidentLevel) + aFinestLevels[i];
+			request_level(i, static_cast<uint32_t>(std::max(level, int64_t{ 0 })));
+		}
+	}
+
+	bool texture_streamer::update()
+	{
+		// Stream in the levels which have been loaded since the last update, or as many of them as fit into the budget:
+		std::vector<loaded_levels> loaded;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			loaded.swap(mLoaded);
+		}
+		for (auto& levels : loaded) {
+			auto& texture = mTextures[levels.mTexture];
+			texture.mLoading = false;
+			if (levels.mFailed) {
+				texture.mFailed = true;
+				continue;
+			}
+
+			// Textures are not evicted while they are loading, i.e., the loaded levels end at the resident ones:
+			auto firstLevel = levels.mFirstLevel;
+			while (firstLevel < texture.mResidentLevel && !make_room(size_of_levels(texture, firstLevel, texture.mResidentLevel), texture)) {
+				++firstLevel;
+			}
+			if (firstLevel < texture.mResidentLevel) {
+				make_resident(texture, firstLevel, &levels);
+			}
+		}
+
+		// Load the requested levels, those of the textures which lack the most levels first:
+		std::vector<streamed_texture*> requested;
+		for (auto& texture : mTextures) {
+			if (!texture.mLoading && !texture.mFailed && texture.mRequestedLevel < texture.mResidentLevel) {
+				requested.push_back(&texture);
+			}
+		}
+		std::stable_sort(requested.begin(), requested.end(), [](const streamed_texture* a, const streamed_texture* b) {
+			return a->mResidentLevel - a->mRequestedLevel > b->mResidentLevel - b->mRequestedLevel;
+		});
+		if (!requested.empty()) {
+			std::lock_guard<std::mutex> lock(mMutex);
+			for (auto* texture : requested) {
+				texture->mLoading = true;
+				mJobs.push_back(load_job{ static_cast<size_t>(texture - mTextures.data()), texture->mName, texture->mKey, texture->mLoader, texture->mImageUsage, texture->mFaces, texture->mRequestedLevel, texture->mResidentLevel });
+			}
+		}
+		mJobsAvailable.notify_all();
+
+		// Requests are made per frame:
+		for (auto& texture : mTextures) {
+			texture.mRequestedLevel = texture.mTailLevel;
+		}
+
+		// Submit the copies, s.t. frames which are submitted afterwards sample the new images:
+		mUploadBatcher.flush();
+		++mFrame;
+		return std::exchange(mReplaced, false);
+	}
+
+	void texture_streamer::save_cache()
+	{
+		if (mCache) {
+			std::unique_lock<std::shared_mutex> lock(mCacheMutex);
+			mCache->get().save();
+		}
+	}
+
+	texture_streamer::loaded_levels texture_streamer::load_levels(const load_job& aJob) const
+	{
+		loaded_levels result;
+		result.mTexture = aJob.mTexture;
+		result.mFirstLevel = aJob.mFirstLevel;
+		try {
+			// The cache's data is only valid until it is saved, but the levels are uploaded in a later update(), hence, they are copied:
+			if (mCache) {
+				std::shared_lock<std::shared_mutex> lock(mCacheMutex);
+				for (uint32_t level = aJob.mFirstLevel; level < aJob.mEndLevel; ++level) {
+					auto data = mCache->get().load_data(level_entry_name(aJob.mName, level), aJob.mKey);
+					if (!data.has_value()) {
+						break;
+					}
+					const auto& copy = result.mCacheData.emplace_back(data->begin(), data->end());
+					const auto faceSize = copy.size() / aJob.mFaces;
+					auto& faces = result.mData.emplace_back();
+					for (uint32_t face = 0; face < aJob.mFaces; ++face) {
+						faces.emplace_back(copy.data() + face * faceSize, faceSize);
+					}
+				}
+				if (result.mData.size() == aJob.mEndLevel - aJob.mFirstLevel) {
+					return result;
+				}
+				result.mData.clear();
+				result.mCacheData.clear();
+			}
+
+			auto& imageData = result.mImageData.emplace(aJob.mLoader());
+			load_with_mip_maps(imageData, aJob.mImageUsage);
+			if (imageData.levels() < aJob.mEndLevel || imageData.faces() != aJob.mFaces) {
+				throw avk::runtime_error(std::format("The image data has {} levels and {} faces instead of {} levels and {} faces", imageData.levels(), imageData.faces(), aJob.mEndLevel, aJob.mFaces));
+			}
+			result.mData = data_of_levels(imageData, aJob.mFirstLevel, aJob.mEndLevel);
+		}
+		catch (const std::exception& e) {
+			LOG_WARNING(std::format("Unable to load levels {} to {} of texture '{}': {}", aJob.mFirstLevel, aJob.mEndLevel - 1, aJob.mName, e.what()));
+			result.mData.clear();
+			result.mFailed = true;
+		}
+		return result;
+	}
+
+	void texture_streamer::make_resident(streamed_texture& aTexture, uint32_t aFirstLevel, const loaded_levels* aLoaded)
+	{
+		const auto numLevels = static_cast<uint32_t>(aTexture.mLevelSizes.size());
+		auto image = context().create_image(std::max(aTexture.mWidth >> aFirstLevel, 1u), std::max(aTexture.mHeight >> aFirstLevel, 1u), aTexture.mFormat, aTexture.mFaces,
+			avk::memory_usage::device, aTexture.mImageUsage | avk::image_usage::transfer_source, [&](avk::image_t& bImage) {
+				bImage.create_info().mipLevels = numLevels - aFirstLevel;
+			});
+		mUploadBatcher.begin_image(*image);
+
+		// The levels which are resident already are copied on the GPU, only the others are uploaded:
+		const auto firstCopiedLevel = std::max(aFirstLevel, aTexture.mResidentLevel);
+		if (firstCopiedLevel < numLevels) {
+			const auto& previous = aTexture.mImageView->get_image();
+			std::vector<vk::ImageCopy> regions;
+			for (uint32_t level = firstCopiedLevel; level < numLevels; ++level) {
+				regions.push_back(vk::ImageCopy{}
+					.setSrcSubresource(vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, level - aTexture.mResidentLevel, 0u, aTexture.mFaces })
+					.setDstSubresource(vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, level - aFirstLevel, 0u, aTexture.mFaces })
+					.setExtent(vk::Extent3D{ std::max(aTexture.mWidth >> level, 1u), std::max(aTexture.mHeight >> level, 1u), 1u }));
+			}
+			// Frames which have been submitted before may still sample the previous image, and those submitted before the swap will:
+			mUploadBatcher.record(
+				avk::sync::image_memory_barrier(previous,
+					avk::stage::all_commands >> avk::stage::copy,
+					avk::access::none        >> avk::access::transfer_read
+				).with_layout_transition(avk::layout::shader_read_only_optimal >> avk::layout::transfer_src)
+			);
+			mUploadBatcher.record(
+				avk::command::custom_commands([src = previous.handle(), dst = image->handle(), regions = std::move(regions)](avk::command_buffer_t& cb) {
+					cb.handle().copyImage(src, vk::ImageLayout::eTransferSrcOptimal, dst, vk::ImageLayout::eTransferDstOptimal, regions, cb.root_ptr()->dispatch_loader_core());
+				})
+			);
+			mUploadBatcher.record(
+				avk::sync::image_memory_barrier(previous,
+					avk::stage::copy    >> avk::stage::all_commands,
+					avk::access::none   >> avk::access::memory_read
+				).with_layout_transition(avk::layout::transfer_src >> avk::layout::shader_read_only_optimal)
+			);
+		}
+		for (uint32_t level = aFirstLevel; level < firstCopiedLevel; ++level) {
+			assert(nullptr != aLoaded && level >= aLoaded->mFirstLevel);
+			const auto& faces = aLoaded->mData[level - aLoaded->mFirstLevel];
+			for (uint32_t face = 0; face < aTexture.mFaces; ++face) {
+				auto* staging = mUploadBatcher.stage_image_region(face, level - aFirstLevel, faces[face].size());
+				std::memcpy(staging, faces[face].data(), faces[face].size());
+			}
+		}
+		mUploadBatcher.end_image(avk::layout::shader_read_only_optimal);
+
+		// Replace the image samplers; the previous ones are kept alive until the frames in flight which use them have completed:
+		auto imageView = context().create_image_view(std::move(image));
+		imageView.enable_shared_ownership();
+		auto* wnd = context().main_window();
+		if (nullptr == wnd) {
+			mUploadBatcher.wait_idle();
+		}
+		for (size_t i = 0; i < aTexture.mImageSamplerIndices.size(); ++i) {
+			auto previous = std::exchange(mImageSamplers[aTexture.mImageSamplerIndices[i]], context().create_image_sampler(imageView, aTexture.mSamplers[i]));
+			if (nullptr != wnd) {
+				wnd->handle_lifetime(std::move(previous));
+			}
+		}
+		if (aTexture.mResidentLevel < numLevels && nullptr != wnd) {
+			wnd->handle_lifetime(std::move(aTexture.mImageView));
+		}
+		aTexture.mImageView = std::move(imageView);
+
+		mResidentSize = mResidentSize - size_of_levels(aTexture, aTexture.mResidentLevel, numLevels) + size_of_levels(aTexture, aFirstLevel, numLevels);
+		aTexture.mResidentLevel = aFirstLevel;
+		mReplaced = true;
+	}
+
+	bool texture_streamer::make_room(size_t aSize, const streamed_texture& aExcluded)
+	{
+		while (mResidentSize + aSize > mMemoryBudget) {
+			// Evict levels of the least recently used texture; textures which have been used in the current frame are kept:
+			streamed_texture* leastRecentlyUsed = nullptr;
+			for (auto& texture : mTextures) {
+				if (&texture != &aExcluded && !texture.mLoading && texture.mResidentLevel < texture.mTailLevel && texture.mLastUsedFrame < mFrame
+					&& (nullptr == leastRecentlyUsed || texture.mLastUsedFrame < leastRecentlyUsed->mLastUsedFrame)) {
+					leastRecentlyUsed = &texture;
+				}
+			}
+			if (nullptr == leastRecentlyUsed) {
+				return false;
+			}
+
+			// Evict its finest levels, as many as are needed:
+			auto firstLevel = leastRecentlyUsed->mResidentLevel;
+			do {
+				++firstLevel;
+			} while (firstLevel < leastRecentlyUsed->mTailLevel && mResidentSize - size_of_levels(*leastRecentlyUsed, leastRecentlyUsed->mResidentLevel, firstLevel) + aSize > mMemoryBudget);
+			make_resident(*leastRecentlyUsed, firstLevel, nullptr);
+		}
+		return true;
+	}
+
+	size_t texture_streamer::size_of_levels(const streamed_texture& aTexture, uint32_t aFirstLevel, uint32_t aEndLevel) const
+	{
+		size_t size = 0;
+		for (uint32_t level = aFirstLevel; level < aEndLevel; ++level) {
+			size += aTexture.mLevelSizes[level];
+		}
+		return size;
+	}
+
+	void texture_streamer::worker()
+	{
+		for (;;) {
+			std::optional<load_job> job;
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mJobsAvailable.wait(lock, [this] { return mStopping || !mJobs.empty(); });
+				if (mStopping) {
+					return;
+				}
+				job = std::move(mJobs.front());
+				mJobs.pop_front();
+			}
+
+			auto levels = load_levels(*job);
+			std::lock_guard<std::mutex> lock(mMutex);
+			mLoaded.push_back(std::move(levels));
+		}
+	}
+}
@@ -0,0 +1,220 @@
+#include "upload_batcher.hpp"
+#include <cstring>
+#include <numeric>
+
+namespace avk
+{
+	namespace
+	{
+		size_t align_up(size_t aOffset, size_t aAlignment)
+		{
+			return (aOffset + aAlignment - 1) / aAlignment * aAlignment;
+		}
+	}
+
+	upload_batcher::upload_batcher(avk::queue& aQueue, size_t aRingSize, uint32_t aNumSegments)
+		: mQueue(&aQueue)
+		, mSegmentSize(aRingSize / std::max(aNumSegments, 1u) / cMinStagingAlignment * cMinStagingAlignment)
+		, mNumSegments(std::max(aNumSegments, 1u))
+		, mSegmentFences(mNumSegments)
+	{
+		if (0 == mSegmentSize) {
+			throw avk::runtime_error(std::format("The staging buffer of {} bytes is too small for {} segments.", aRingSize, aNumSegments));
+		}
+
+		// Host-coherent, so that the data need not be flushed although the buffer stays mapped:
+		mRing = context().create_buffer(
+			avk::memory_usage::host_coherent,
+			vk::BufferUsageFlagBits::eTransferSrc,
+			avk::generic_buffer_meta::create_from_size(mSegmentSize * mNumSegments)
+		);
+		mRingMapping.reset(new auto(mRing->map_memory(avk::mapping_access::write)));
+		mRingData = static_cast<std::byte*>(mRingMapping->get());
+	}
+
+	upload_batcher::~upload_batcher()
+	{
+		wait_idle();
+	}
+
+	void upload_batcher::begin_image(avk::image_t& aImage)
+	{
+		assert(nullptr == mCurrentImage);
+		mCurrentImage = &aImage;
+
+		mPendingCommands.push_back(
+			avk::sync::image_memory_barrier(aImage, // No need to wait on the staging buffer since it is in host-visible memory
+				avk::stage::none  >> avk::stage::copy,
+				avk::access::none >> avk::access::transfer_write
+			).with_layout_transition(avk::layout::undefined >> avk::layout::transfer_dst)
+		);
+	}
+
+	std::byte* upload_batcher::stage_image_region(uint32_t aLayer, uint32_t aLevel, size_t aSize)
+	{
+		assert(nullptr != mCurrentImage);
+		const auto& createInfo = mCurrentImage->create_info();
+		const auto levelExtent = vk::Extent3D{
+			std::max(createInfo.extent.width >> aLevel, 1u),
+			std::max(createInfo.extent.height >> aLevel, 1u),
+			std::max(createInfo.extent.depth >> aLevel, 1u)
+		};
+
+		// The offset must also be a multiple of the texel size, e.g., of 3 bytes for 8 bit RGB:
+		size_t alignment = cMinStagingAlignment;
+		const size_t numTexels = size_t{ levelExtent.width } * levelExtent.height * levelExtent.depth;
+		if (!avk::is_block_compressed_format(createInfo.format) && aSize % numTexels == 0) {
+			alignment = std::lcm(alignment, std::max<size_t>(aSize / numTexels, 1));
+		}
+
+		auto region = vk::BufferImageCopy{}
+			.setBufferRowLength(0)
+			.setBufferImageHeight(0)
+			.setImageSubresource(vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, aLevel, aLayer, 1u })
+			.setImageOffset(vk::Offset3D{ 0, 0, 0 })
+			.setImageExtent(levelExtent);
+
+		if (auto offset = allocate(aSize, alignment)) {
+			mCurrentImageCopies.push_back(region.setBufferOffset(*offset));
+			return mRingData + *offset;
+		}
+
+		// Too large for a segment => stage it in a dedicated buffer, and copy it within the current batch:
+		auto& dedicated = mPendingDedicatedBuffers.emplace_back();
+		dedicated.mBuffer = context().create_buffer(
+			avk::memory_usage::host_coherent,
+			vk::BufferUsageFlagBits::eTransferSrc,
+			avk::generic_buffer_meta::create_from_size(aSize)
+		);
+		dedicated.mMapping.reset(new auto(dedicated.mBuffer->map_memory(avk::mapping_access::write)));
+		mPendingCommands.push_back(
+			avk::command::custom_commands([src = dedicated.mBuffer->handle(), dst = mCurrentImage->handle(), region = region.setBufferOffset(0)](avk::command_buffer_t& cb) {
+				cb.handle().copyBufferToImage(src, dst, vk::ImageLayout::eTransferDstOptimal, region, cb.root_ptr()->dispatch_loader_core());
+			})
+		);
+		return static_cast<std::byte*>(dedicated.mMapping->get());
+	}
+
+	void upload_batcher::end_image(avk::layout::image_layout aFinalLayout)
+	{
+		assert(nullptr != mCurrentImage);
+		record_image_copies();
+
+		mPendingCommands.push_back(
+			avk::sync::image_memory_barrier(*mCurrentImage,
+				avk::stage::copy            >> avk::stage::all_commands,
+				avk::access::transfer_write >> avk::access::memory_read
+			).with_layout_transition(avk::layout::transfer_dst >> aFinalLayout)
+		);
+		mCurrentImage = nullptr;
+	}
+
+	void upload_batcher::upload_buffer(const void* aData, size_t aSize, avk::buffer_t& aDstBuffer, size_t aDstOffset)
+	{
+		const auto dst = aDstBuffer.handle();
+		const std::byte* data = static_cast<const std::byte*>(aData);
+
+		// Split large data into chunks of a segment each, s.t. no dedicated staging buffer is needed:
+		while (aSize > 0) {
+			const auto chunkSize = std::min(aSize, mSegmentSize);
+			const auto offset = allocate(chunkSize, cMinStagingAlignment);
+			assert(offset.has_value());
+			std::memcpy(mRingData + *offset, data, chunkSize);
+
+			mPendingCommands.push_back(
+				avk::command::custom_commands([src = mRing->handle(), dst, region = vk::BufferCopy{ *offset, aDstOffset, chunkSize }](avk::command_buffer_t& cb) {
+					cb.handle().copyBuffer(src, dst, region, cb.root_ptr()->dispatch_loader_core());
+				})
+			);
+			mPendingCommands.push_back(
+				avk::sync::buffer_memory_barrier(aDstBuffer,
+					avk::stage::copy            >> avk::stage::all_commands,
+					avk::access::transfer_write >> avk::access::memory_read
+				)
+			);
+
+			data += chunkSize;
+			aDstOffset += chunkSize;
+			aSize -= chunkSize;
+		}
+	}
+
+	void upload_batcher::record(avk::recorded_commands_t aCommands)
+	{
+		// Keep the order with copies to the current image which have been staged already:
+		record_image_copies();
+		mPendingCommands.push_back(std::move(aCommands));
+	}
+
+	void upload_batcher::flush()
+	{
+		record_image_copies();
+		if (mPendingCommands.empty()) {
+			return;
+		}
+
+		auto fence = context().record_and_submit_with_fence(std::move(mPendingCommands), *mQueue);
+		mPendingCommands.clear();
+		for (auto& dedicated : mPendingDedicatedBuffers) {
+			dedicated.mMapping.reset();
+			fence->handle_lifetime_of(std::move(dedicated.mBuffer));
+		}
+		mPendingDedicatedBuffers.clear();
+		mSegmentFences[mCurrentSegment] = std::move(fence);
+
+		// Continue with the next segment, but wait until the GPU has finished copying from it:
+		mCurrentSegment = (mCurrentSegment + 1) % mNumSegments;
+		mSegmentOffset = 0;
+		if (auto& nextFence = mSegmentFences[mCurrentSegment]) {
+			nextFence.value()->wait_until_signalled();
+			nextFence.reset();
+		}
+	}
+
+	void upload_batcher::wait_idle()
+	{
+		flush();
+		for (auto& fence : mSegmentFences) {
+			if (fence) {
+				fence.value()->wait_until_signalled();
+				fence.reset();
+			}
+		}
+	}
+
+	std::optional<size_t> upload_batcher::allocate(size_t aSize, size_t aAlignment)
+	{
+		if (aSize > mSegmentSize) {
+			return {};
+		}
+
+		// Align the offset in the whole staging buffer, since segments need not begin at a multiple of the alignment:
+		auto segmentBegin = size_t{ mCurrentSegment } * mSegmentSize;
+		auto offset = align_up(segmentBegin + mSegmentOffset, aAlignment);
+		if (offset + aSize > segmentBegin + mSegmentSize) {
+			flush();
+			segmentBegin = size_t{ mCurrentSegment } * mSegmentSize;
+			offset = align_up(segmentBegin, aAlignment);
+			if (offset + aSize > segmentBegin + mSegmentSize) {
+				return {};
+			}
+		}
+		mSegmentOffset = offset + aSize - segmentBegin;
+		return offset;
+	}
+
+	void upload_batcher::record_image_copies()
+	{
+		if (mCurrentImageCopies.empty()) {
+			return;
+		}
+
+		// All levels and layers of an image which are staged in the same segment are copied with a single command:
+		mPendingCommands.push_back(
+			avk::command::custom_commands([src = mRing->handle(), dst = mCurrentImage->handle(), regions = std::move(mCurrentImageCopies)](avk::command_buffer_t& cb) {
+				cb.handle().copyBufferToImage(src, dst, vk::ImageLayout::eTransferDstOptimal, regions, cb.root_ptr()->dispatch_loader_core());
+			})
+		);
+		mCurrentImageCopies.clear();
+	}
+}
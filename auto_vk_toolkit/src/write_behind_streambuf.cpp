@@ -0,0 +1,116 @@
+#include "write_behind_streambuf.hpp"
+
+namespace avk
+{
+	write_behind_streambuf::write_behind_streambuf(std::streambuf& aSink, size_t aBufferSize, size_t aMaxQueuedBuffers)
+		: mSink{ aSink }
+		, mBufferSize{ std::max<size_t>(aBufferSize, 4096) }
+		, mMaxQueuedBuffers{ std::max<size_t>(aMaxQueuedBuffers, 1) }
+		, mBuffer(mBufferSize)
+	{
+		setp(mBuffer.data(), mBuffer.data() + mBuffer.size());
+		mWriter = std::thread([this]() { writer(); });
+	}
+
+	write_behind_streambuf::~write_behind_streambuf()
+	{
+		enqueue_buffer();
+		{
+			std::scoped_lock lock(mMutex);
+			mStop = true;
+		}
+		mCondition.notify_all();
+		mWriter.join();
+		mSink.pubsync();
+	}
+
+	void write_behind_streambuf::enqueue_buffer()
+	{
+		const auto size = static_cast<size_t>(pptr() - pbase());
+		if (0 == size) {
+			return;
+		}
+		mBuffer.resize(size);
+
+		std::unique_lock lock(mMutex);
+		mCondition.wait(lock, [this]() { return mQueue.size() < mMaxQueuedBuffers; });
+		mQueue.push_back(std::move(mBuffer));
+		mBytesEnqueued += size;
+		if (mFreeBuffers.empty()) {
+			mBuffer = std::vector<char>(mBufferSize);
+		}
+		else {
+			mBuffer = std::move(mFreeBuffers.back());
+			mFreeBuffers.pop_back();
+			mBuffer.resize(mBufferSize);
+		}
+		lock.unlock();
+		mCondition.notify_all();
+
+		setp(mBuffer.data(), mBuffer.data() + mBuffer.size());
+	}
+
+	void write_behind_streambuf::writer()
+	{
+		std::unique_lock lock(mMutex);
+		while (true) {
+			mCondition.wait(lock, [this]() { return mStop || !mQueue.empty(); });
+			if (mQueue.empty()) {
+				return; // => mStop
+			}
+			auto buffer = std::move(mQueue.front());
+			mQueue.pop_front();
+			mWriting = true;
+			lock.unlock();
+
+			const auto size = static_cast<std::streamsize>(buffer.size());
+			const auto success = mSink.sputn(buffer.data(), size) == size;
+
+			lock.lock();
+			mWriting = false;
+			mFailed = mFailed || !success;
+			mFreeBuffers.push_back(std::move(buffer));
+			mCondition.notify_all();
+		}
+	}
+
+	void write_behind_streambuf::wait_until_written() const
+	{
+		std::unique_lock lock(mMutex);
+		mCondition.wait(lock, [this]() { return mQueue.empty() && !mWriting; });
+	}
+
+	bool write_behind_streambuf::has_failed() const
+	{
+		std::scoped_lock lock(mMutex);
+		return mFailed;
+	}
+
+	write_behind_streambuf::int_type write_behind_streambuf::overflow(int_type aChar)
+	{
+		enqueue_buffer();
+		if (!traits_type::eq_int_type(aChar, traits_type::eof())) {
+			*pptr() = traits_type::to_char_type(aChar);
+			pbump(1);
+		}
+		return has_failed() ? traits_type::eof() : traits_type::not_eof(aChar);
+	}
+
+	int write_behind_streambuf::sync()
+	{
+		enqueue_buffer();
+		wait_until_written();
+		// The background thread is idle now => the sink may be accessed from this thread:
+		const auto result = mSink.pubsync();
+		return has_failed() ? -1 : result;
+	}
+
+	write_behind_streambuf::pos_type write_behind_streambuf::seekoff(off_type aOffset, std::ios_base::seekdir aDirection, std::ios_base::openmode aMode)
+	{
+		// Only reporting the current position is supported:
+		if (0 != aOffset || std::ios_base::cur != aDirection || !(aMode & std::ios_base::out)) {
+			return pos_type(off_type(-1));
+		}
+		return pos_type(static_cast<off_type>(mBytesEnqueued + static_cast<std::uint64_t>(pptr() - pbase())));
+	}
+}
@@ -219,126 +219,140 @@ public: // v== avk::invokee overrides which will be invoked by the framework ==v
 		// In update() it is not because the fence-wait that ensures that the resources are not used anymore, happens between update() and render().
 		mDestroyOldResourcesInFrame = avk::context().main_window()->current_frame() + avk::context().main_window()->number_of_frames_in_flight(); 
 		
-		avk::orca_scene orca;
-		std::unordered_map<avk::material_config, std::vector<avk::model_and_mesh_indices>> distinctMaterialsOrca;
-
 		const std::string cacheFilePath(aPathToOrcaScene + ".cache");
-		// If a cache file exists, i.e. the scene was serialized during a previous load, initialize the serializer in deserialize mode,
-		// else initialize the serializer in serialize mode to create the cache file while processing the scene.
-		auto serializer = avk::serializer(cacheFilePath, avk::does_cache_file_exist(cacheFilePath) ?
-			avk::serializer::mode::deserialize : avk::serializer::mode::serialize);
 
 		auto start = avk::context().get_time();
 		auto startPart = start;
 		auto endPart = 0.0;
 		std::vector<std::tuple<std::string, double>> times;
 
-		// Load orca scene for usage and serialization, loading the scene is not required if a cache file exists, i.e. mode == deserialize
-		if (serializer.mode() == avk::serializer::mode::serialize) {
-			// Load an ORCA scene from file:
-			orca = avk::orca_scene_t::load_from_file(aPathToOrcaScene);
-			// Get all the different materials from the whole scene:
-			distinctMaterialsOrca = orca->distinct_material_configs_for_all_models();
-
-			endPart = avk::context().get_time();
-			times.emplace_back(std::make_tuple("no cache file, loading orca file", endPart - startPart));
-			startPart = avk::context().get_time();
-		}
-
-		// Get number of distinc materials from orca scene and serialize it or retrieve the number from the serializer
-		size_t numDistinctMaterials = (serializer.mode() == avk::serializer::mode::serialize) ? distinctMaterialsOrca.size() : 0;
-		serializer.archive(numDistinctMaterials);
-
-		// The following loop gathers all the vertex and index data PER MATERIAL and constructs the buffers and materials.
-		// Later, we'll use ONE draw call PER MATERIAL to draw the whole scene.
-		std::vector<avk::material_config> allMatConfigs;
-		mDrawCalls.clear();
-		auto materials = distinctMaterialsOrca.begin();
-		for (int materialIndex = 0; materialIndex < numDistinctMaterials; ++materialIndex) {
-			// meshIndices is only needed during serialization, otherwise the serializer handles everything
-			// in the respective *_cached functions and meshIndices may be empty when passed to the
-			// respective functions.
-			size_t numMeshIndices;
-			std::vector<avk::model_and_mesh_indices> meshIndices;
+		const auto dependencies = avk::cache_dependencies{}
+			.add_file(aPathToOrcaScene)
+			.add_setting("loadTexturesInSrgb", false)
+			.add_setting("flipTextures", false)
+			.add_setting("textureCompression", "none");
+
+		// If an up-to-date cache file exists, i.e. the scene was serialized during a previous load and neither the scene file, nor any of
+		// its models or textures have changed since then, the serializer is initialized in deserialize mode, else it is initialized
+		// in serialize mode to (re)create the cache file while processing the scene.
+		// If the cache file turns out to be corrupted, with_serializer invokes the lambda once more in serialize mode to regenerate it.
+		auto [gpuMaterials, imageSamplers, materialCommands] = avk::with_serializer(cacheFilePath, dependencies, [&](avk::serializer& serializer) {
+			// Start over if the lambda is invoked once more:
+			avk::orca_scene orca;
+			std::unordered_map<avk::material_config, std::vector<avk::model_and_mesh_indices>> distinctMaterialsOrca;
+			times.clear();
+
+			// Load orca scene for usage and serialization, loading the scene is not required if a cache file exists, i.e. mode == deserialize
 			if (serializer.mode() == avk::serializer::mode::serialize) {
-				allMatConfigs.push_back(materials->first);
-				meshIndices = materials->second;
-				numMeshIndices = materials->second.size();
-				materials = std::next(materials);
-			}
-			// Serialize or retrieve the number of model_and_mesh_indices for the material
-			serializer.archive(numMeshIndices);
+				// Load an ORCA scene from file:
+				orca = avk::orca_scene_t::load_from_file(aPathToOrcaScene);
+				// Get all the different materials from the whole scene:
+				distinctMaterialsOrca = orca->distinct_material_configs_for_all_models();
+				// The models are inputs of the cache file as well (textures are added by the *_cached functions):
+				for (const auto& model : orca->models()) {
+					serializer.add_file_dependency(model.mFullPathName);
+				}
 
-			for (int meshIndicesIndex = 0; meshIndicesIndex < numMeshIndices; ++meshIndicesIndex) {
-				// Convinience function to retrieve the model data via the mesh indices from the orca scene while in serialize mode
-				auto getModelData = [&]() -> avk::model_data& { return orca->model_at_index(meshIndices[meshIndicesIndex].mModelIndex); };
+				endPart = avk::context().get_time();
+				times.emplace_back(std::make_tuple("no cache file, loading orca file", endPart - startPart));
+				startPart = avk::context().get_time();
+			}
 
-				// modelAndMeshes is only needed during serialization, otherwise the following buffers are filled by the
-				// serializer from the cache file in the repsective *_cached functions and modelAndMeshes may be empty.
-				std::vector<std::tuple<const avk::model_t&, std::vector<avk::mesh_index_t>>> modelAndMeshes;
+			// Get number of distinc materials from orca scene and serialize it or retrieve the number from the serializer
+			size_t numDistinctMaterials = (serializer.mode() == avk::serializer::mode::serialize) ? distinctMaterialsOrca.size() : 0;
+			serializer.archive(numDistinctMaterials);
+
+			// The following loop gathers all the vertex and index data PER MATERIAL and constructs the buffers and materials.
+			// Later, we'll use ONE draw call PER MATERIAL to draw the whole scene.
+			std::vector<avk::material_config> allMatConfigs;
+			mDrawCalls.clear();
+			auto materials = distinctMaterialsOrca.begin();
+			for (int materialIndex = 0; materialIndex < numDistinctMaterials; ++materialIndex) {
+				// meshIndices is only needed during serialization, otherwise the serializer handles everything
+				// in the respective *_cached functions and meshIndices may be empty when passed to the
+				// respective functions.
+				size_t numMeshIndices;
+				std::vector<avk::model_and_mesh_indices> meshIndices;
 				if (serializer.mode() == avk::serializer::mode::serialize) {
-					modelAndMeshes = avk::make_model_references_and_mesh_indices_selection(getModelData().mLoadedModel, meshIndices[meshIndicesIndex].mMeshIndices);
+					allMatConfigs.push_back(materials->first);
+					meshIndices = materials->second;
+					numMeshIndices = materials->second.size();
+					materials = std::next(materials);
 				}
+				// Serialize or retrieve the number of model_and_mesh_indices for the material
+				serializer.archive(numMeshIndices);
 
-				// Get a buffer containing all positions, and one containing all indices for all submeshes with this material
-				auto [positionsBuffer, indicesBuffer, posIndCommands] = avk::create_vertex_and_index_buffers_cached(serializer, modelAndMeshes, {});
+				for (int meshIndicesIndex = 0; meshIndicesIndex < numMeshIndices; ++meshIndicesIndex) {
+					// Convinience function to retrieve the model data via the mesh indices from the orca scene while in serialize mode
+					auto getModelData = [&]() -> avk::model_data& { return orca->model_at_index(meshIndices[meshIndicesIndex].mModelIndex); };
 
-				// Get a buffer containing all texture coordinates for all submeshes with this material
-				auto [texCoordsBuffer, tcoCommands] = avk::create_2d_texture_coordinates_flipped_buffer_cached<avk::vertex_buffer_meta>(serializer, modelAndMeshes);
+					// modelAndMeshes is only needed during serialization, otherwise the following buffers are filled by the
+					// serializer from the cache file in the repsective *_cached functions and modelAndMeshes may be empty.
+					std::vector<std::tuple<const avk::model_t&, std::vector<avk::mesh_index_t>>> modelAndMeshes;
+					if (serializer.mode() == avk::serializer::mode::serialize) {
+						modelAndMeshes = avk::make_model_references_and_mesh_indices_selection(getModelData().mLoadedModel, meshIndices[meshIndicesIndex].mMeshIndices);
+					}
 
-				// Get a buffer containing all normals for all submeshes with this material
-				auto [normalsBuffer, nrmCommands] = avk::create_normals_buffer_cached<avk::vertex_buffer_meta>(serializer, modelAndMeshes);
+					// Get a buffer containing all positions, and one containing all indices for all submeshes with this material
+					auto [positionsBuffer, indicesBuffer, posIndCommands] = avk::create_vertex_and_index_buffers_cached(serializer, modelAndMeshes, {});
 
-				// Get the number of instances from the model and serialize it or retrieve it from the serializer
-				size_t numInstances = (serializer.mode() == avk::serializer::mode::serialize) ? getModelData().mInstances.size() : 0;
-				serializer.archive(numInstances);
+					// Get a buffer containing all texture coordinates for all submeshes with this material
+					auto [texCoordsBuffer, tcoCommands] = avk::create_2d_texture_coordinates_flipped_buffer_cached<avk::vertex_buffer_meta>(serializer, modelAndMeshes);
 
-				// Submit all the fill commands to the queue:
-				auto fence = avk::context().record_and_submit_with_fence({
-					std::move(posIndCommands),
-					std::move(tcoCommands),
-					std::move(nrmCommands)
-					// ^ No need for any synchronization in-between, because the commands do not depend on each other.
-				}, *mQueue);
-				// Wait on the host until the device is done:
-				fence->wait_until_signalled();
+					// Get a buffer containing all normals for all submeshes with this material
+					auto [normalsBuffer, nrmCommands] = avk::create_normals_buffer_cached<avk::vertex_buffer_meta>(serializer, modelAndMeshes);
+
+					// Get the number of instances from the model and serialize it or retrieve it from the serializer
+					size_t numInstances = (serializer.mode() == avk::serializer::mode::serialize) ? getModelData().mInstances.size() : 0;
+					serializer.archive(numInstances);
+
+					// Submit all the fill commands to the queue:
+					auto fence = avk::context().record_and_submit_with_fence({
+						std::move(posIndCommands),
+						std::move(tcoCommands),
+						std::move(nrmCommands)
+						// ^ No need for any synchronization in-between, because the commands do not depend on each other.
+					}, *mQueue);
+					// Wait on the host until the device is done:
+					fence->wait_until_signalled();
 				
-				// Create a draw calls for instances with the current material
-				for (int instanceIndex = 0; instanceIndex < numInstances; ++instanceIndex) {
-					auto& newElement = mDrawCalls.emplace_back();
-					newElement.mMaterialIndex = materialIndex;
+					// Create a draw calls for instances with the current material
+					for (int instanceIndex = 0; instanceIndex < numInstances; ++instanceIndex) {
+						auto& newElement = mDrawCalls.emplace_back();
+						newElement.mMaterialIndex = materialIndex;
+
+						// Create model matrix of instance and serialize it or retrieve it from the serializer
+						if (serializer.mode() == avk::serializer::mode::serialize) {
+							auto instances = getModelData().mInstances;
+							newElement.mModelMatrix = avk::matrix_from_transforms(
+								instances[instanceIndex].mTranslation, glm::quat(instances[instanceIndex].mRotation), instances[instanceIndex].mScaling
+							);
+						}
+						serializer.archive(newElement.mModelMatrix);
 
-					// Create model matrix of instance and serialize it or retrieve it from the serializer
-					if (serializer.mode() == avk::serializer::mode::serialize) {
-						auto instances = getModelData().mInstances;
-						newElement.mModelMatrix = avk::matrix_from_transforms(
-							instances[instanceIndex].mTranslation, glm::quat(instances[instanceIndex].mRotation), instances[instanceIndex].mScaling
-						);
+						newElement.mPositionsBuffer = positionsBuffer;
+						newElement.mIndexBuffer = indicesBuffer;
+						newElement.mTexCoordsBuffer = texCoordsBuffer;
+						newElement.mNormalsBuffer = normalsBuffer;
 					}
-					serializer.archive(newElement.mModelMatrix);
 
-					newElement.mPositionsBuffer = positionsBuffer;
-					newElement.mIndexBuffer = indicesBuffer;
-					newElement.mTexCoordsBuffer = texCoordsBuffer;
-					newElement.mNormalsBuffer = normalsBuffer;
 				}
-
 			}
-		}
-		endPart = avk::context().get_time();
-		times.emplace_back(std::make_tuple("create materials config", endPart - startPart));
-		startPart = avk::context().get_time();
+			endPart = avk::context().get_time();
+			times.emplace_back(std::make_tuple("create materials config", endPart - startPart));
+			startPart = avk::context().get_time();
 
-		// Convert the materials that were gathered above into a GPU-compatible format and serialize it
-		// during the conversion in convert_for_gpu_usage_cached. If the serializer was initialized in
-		// mode deserialize, allMatConfigs may be empty since the serializer retreives everything needed
-		// from the cache file
-		auto [gpuMaterials, imageSamplers, materialCommands] = avk::convert_for_gpu_usage_cached<avk::material_gpu_data>(
-			serializer,
-			allMatConfigs, false, false,
-			avk::image_usage::general_texture,
-			avk::filter_mode::anisotropic_16x
-		);
+			// Convert the materials that were gathered above into a GPU-compatible format and serialize it
+			// during the conversion in convert_for_gpu_usage_cached. If the serializer was initialized in
+			// mode deserialize, allMatConfigs may be empty since the serializer retreives everything needed
+			// from the cache file
+			return avk::convert_for_gpu_usage_cached<avk::material_gpu_data>(
+				serializer,
+				allMatConfigs, false, false,
+				avk::image_usage::general_texture,
+				avk::filter_mode::anisotropic_16x
+			);
+		});
 
 		mImageSamplers = std::move(imageSamplers);
 
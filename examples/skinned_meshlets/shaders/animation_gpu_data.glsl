@@ -0,0 +1,44 @@
+// Data layouts matching avk::animated_node_gpu_data and avk::bone_target_gpu_data,
+// and the bindings shared by animation_sample_nodes.comp and animation_bone_matrices.comp
+
+struct animated_node
+{
+	mat4 mParentTransform;
+	mat4 mLocalTransform;
+	int  mAnimatedParentIndex; // -1 if the node has no animated parent
+	uint mPositionKeysOffset;
+	uint mPositionKeysCount;
+	uint mRotationKeysOffset;
+	uint mRotationKeysCount;
+	uint mScalingKeysOffset;
+	uint mScalingKeysCount;
+	uint mPadding;
+};
+
+struct bone_target
+{
+	mat4 mTargetSpaceMatrix;
+	mat4 mInverseBindPoseMatrix;
+	uint mAnimatedNodeIndex;
+	uint mTargetIndex;
+	uint mPadding[2];
+};
+
+layout(push_constant) uniform PushConstants
+{
+	uint mNumNodes;
+	uint mNumBoneTargets;
+	uint mNumInstances;
+	uint mBoneMatricesPerInstance;
+} pushConstants;
+
+layout(std430, set = 0, binding = 0) readonly buffer NodesBuffer       { animated_node mValues[]; } nodesBuffer;
+layout(std430, set = 0, binding = 1) readonly buffer KeyTimesBuffer    { float mValues[]; } keyTimesBuffer;
+layout(std430, set = 0, binding = 2) readonly buffer KeyValuesBuffer   { vec4 mValues[]; } keyValuesBuffer;
+layout(std430, set = 0, binding = 3) readonly buffer BoneTargetsBuffer { bone_target mValues[]; } boneTargetsBuffer;
+// One time (in ticks) per animated instance:
+layout(std430, set = 0, binding = 4) readonly buffer InstancesBuffer   { float mTimesInTicks[]; } instancesBuffer;
+// mNumNodes matrices per instance, each one containing parentTransform * localTransform of a node:
+layout(std430, set = 0, binding = 5) buffer LocalTransformsBuffer      { mat4 mValues[]; } localTransformsBuffer;
+// mBoneMatricesPerInstance matrices per instance:
+layout(std430, set = 0, binding = 6) writeonly buffer BoneMatricesBuffer { mat4 mValues[]; } boneMatricesBuffer;
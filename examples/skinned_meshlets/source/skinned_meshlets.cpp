@@ -1,6 +1,7 @@
 #include "auto_vk_toolkit.hpp"
 #include "imgui.h"
 
+#include "animation_gpu_data.hpp"
 #include "configure_and_compose.hpp"
 #include "imgui_manager.hpp"
 #include "invokee.hpp"
@@ -22,6 +23,14 @@
 
 #define USE_CACHE 1
 
+/**
+ *	USE_GPU_ANIMATION 0 ... Bone matrices are computed with avk::animation::animate on the CPU,
+ *	                        and uploaded into host-coherent buffers every frame.
+ *	USE_GPU_ANIMATION 1 ... The animation data is uploaded once, and the bone matrices are computed
+ *	                        by compute shaders directly into device-local buffers every frame.
+ */
+#define USE_GPU_ANIMATION 1
+
 static constexpr size_t sNumVertices = 64;
 static constexpr size_t sNumIndices = 378;
 static constexpr uint32_t cConcurrentFrames = 3u;
@@ -75,8 +84,29 @@ class skinned_meshlets_app : public avk::invokee
 	struct additional_animated_model_data
 	{
 		std::vector<glm::mat4> mBoneMatricesAni;
+#if USE_GPU_ANIMATION
+		uint32_t mNumNodes;
+		uint32_t mNumBoneTargets;
+		avk::buffer mNodesBuffer;
+		avk::buffer mKeyTimesBuffer;
+		avk::buffer mKeyValuesBuffer;
+		avk::buffer mBoneTargetsBuffer;
+		std::array<avk::buffer, cConcurrentFrames> mInstancesBuffers;
+		std::array<avk::buffer, cConcurrentFrames> mLocalTransformsBuffers;
+#endif
 	};
 
+#if USE_GPU_ANIMATION
+	/** Push constants for the animation compute shaders, see animation_gpu_data.glsl */
+	struct animation_push_constants
+	{
+		uint32_t mNumNodes;
+		uint32_t mNumBoneTargets;
+		uint32_t mNumInstances;
+		uint32_t mBoneMatricesPerInstance;
+	};
+#endif
+
 	/** Helper struct for the animations. */
 	struct animated_model_data
 	{
@@ -283,15 +313,19 @@ public: // v== avk::invokee overrides which will be invoked by the framework ==v
 				auto cpuMeshlets = avk::divide_into_meshlets(meshletSelection);
 #if !USE_REDIRECTED_GPU_DATA
 #if USE_CACHE
-				avk::serializer serializer("direct_meshlets-" + meshname + "-" + std::to_string(mpos) + ".cache");
-				auto [gpuMeshlets, _] = avk::convert_for_gpu_usage_cached<avk::meshlet_gpu_data<sNumVertices, sNumIndices>>(serializer, cpuMeshlets);
+				// If the cache file turns out to be corrupted, with_serializer regenerates it instead of failing:
+				auto [gpuMeshlets, _] = avk::with_serializer("direct_meshlets-" + meshname + "-" + std::to_string(mpos) + ".cache", [&](avk::serializer& aSerializer) {
+					return avk::convert_for_gpu_usage_cached<avk::meshlet_gpu_data<sNumVertices, sNumIndices>>(aSerializer, cpuMeshlets);
+				});
 #else
 				auto [gpuMeshlets, _] = avk::convert_for_gpu_usage<avk::meshlet_gpu_data<sNumVertices, sNumIndices>, sNumVertices, sNumIndices>(cpuMeshlets);
 #endif
 #else
 #if USE_CACHE
-				avk::serializer serializer("redirected_meshlets-" + meshname + "-" + std::to_string(mpos) + ".cache");
-				auto [gpuMeshlets, gpuIndicesData] = avk::convert_for_gpu_usage_cached<avk::meshlet_redirected_gpu_data, sNumVertices, sNumIndices>(serializer, cpuMeshlets);
+				// If the cache file turns out to be corrupted, with_serializer regenerates it instead of failing:
+				auto [gpuMeshlets, gpuIndicesData] = avk::with_serializer("redirected_meshlets-" + meshname + "-" + std::to_string(mpos) + ".cache", [&](avk::serializer& aSerializer) {
+					return avk::convert_for_gpu_usage_cached<avk::meshlet_redirected_gpu_data, sNumVertices, sNumIndices>(aSerializer, cpuMeshlets);
+				});
 #else
 				auto [gpuMeshlets, generatedMeshletData] = avk::convert_for_gpu_usage<avk::meshlet_redirected_gpu_data, sNumVertices, sNumIndices>(cpuMeshlets);
 #endif
@@ -322,13 +356,73 @@ public: // v== avk::invokee overrides which will be invoked by the framework ==v
 
 			// buffers for the animated bone matrices, will be populated before rendering
 			std::get<additional_animated_model_data>(animModel).mBoneMatricesAni.resize(std::get<animated_model_data>(animModel).mNumBoneMatrices);
+#if !USE_GPU_ANIMATION
 			for (size_t cfi = 0; cfi < cConcurrentFrames; ++cfi) {
 				mBoneMatricesBuffersAni[cfi].push_back(avk::context().create_buffer(
 					avk::memory_usage::host_coherent, {},
 					avk::storage_buffer_meta::create_from_data(std::get<additional_animated_model_data>(animModel).mBoneMatricesAni)
 				));
 			}
+#else
+			// Upload the animation data once; the bone matrices are written by the animation compute shaders directly:
+			auto& gpuAni = std::get<additional_animated_model_data>(animModel);
+			auto aniData = avk::convert_for_gpu_usage(std::get<animated_model_data>(animModel).mAnimation, avk::bone_matrices_space::model_space);
+			gpuAni.mNumNodes = static_cast<uint32_t>(aniData.mNodes.size());
+			gpuAni.mNumBoneTargets = static_cast<uint32_t>(aniData.mBoneTargets.size());
+			if (aniData.mKeyTimes.empty()) { // Storage buffers must not be empty
+				aniData.mKeyTimes.push_back(0.0f);
+				aniData.mKeyValues.push_back(glm::vec4{ 0.0f });
+			}
+			gpuAni.mNodesBuffer       = avk::context().create_buffer(avk::memory_usage::device, {}, avk::storage_buffer_meta::create_from_data(aniData.mNodes));
+			gpuAni.mKeyTimesBuffer    = avk::context().create_buffer(avk::memory_usage::device, {}, avk::storage_buffer_meta::create_from_data(aniData.mKeyTimes));
+			gpuAni.mKeyValuesBuffer   = avk::context().create_buffer(avk::memory_usage::device, {}, avk::storage_buffer_meta::create_from_data(aniData.mKeyValues));
+			gpuAni.mBoneTargetsBuffer = avk::context().create_buffer(avk::memory_usage::device, {}, avk::storage_buffer_meta::create_from_data(aniData.mBoneTargets));
+			avk::context().record_and_submit_with_fence({
+				gpuAni.mNodesBuffer->fill(aniData.mNodes.data(), 0),
+				gpuAni.mKeyTimesBuffer->fill(aniData.mKeyTimes.data(), 0),
+				gpuAni.mKeyValuesBuffer->fill(aniData.mKeyValues.data(), 0),
+				gpuAni.mBoneTargetsBuffer->fill(aniData.mBoneTargets.data(), 0)
+			}, *mQueue)->wait_until_signalled();
+
+			// This example animates one instance per model; for more instances, enlarge these buffers and the bone matrices buffers accordingly:
+			const std::vector<float> instanceTimes(1, 0.0f);
+			const std::vector<glm::mat4> localTransforms(gpuAni.mNumNodes * instanceTimes.size());
+			for (size_t cfi = 0; cfi < cConcurrentFrames; ++cfi) {
+				gpuAni.mInstancesBuffers[cfi] = avk::context().create_buffer(
+					avk::memory_usage::host_coherent, {},
+					avk::storage_buffer_meta::create_from_data(instanceTimes)
+				);
+				gpuAni.mLocalTransformsBuffers[cfi] = avk::context().create_buffer(
+					avk::memory_usage::device, {},
+					avk::storage_buffer_meta::create_from_data(localTransforms)
+				);
+				mBoneMatricesBuffersAni[cfi].push_back(avk::context().create_buffer(
+					avk::memory_usage::device, {},
+					avk::storage_buffer_meta::create_from_data(gpuAni.mBoneMatricesAni)
+				));
+			}
+#endif
 		}
+
+#if USE_GPU_ANIMATION
+		mAnimationSamplePipeline = avk::context().create_compute_pipeline_for(
+			"shaders/animation_sample_nodes.comp",
+			avk::push_constant_binding_data{ avk::shader_type::compute, 0, sizeof(animation_push_constants) },
+			avk::descriptor_binding(0, 0, std::get<additional_animated_model_data>(mAnimatedModels[0]).mNodesBuffer),
+			avk::descriptor_binding(0, 1, std::get<additional_animated_model_data>(mAnimatedModels[0]).mKeyTimesBuffer),
+			avk::descriptor_binding(0, 2, std::get<additional_animated_model_data>(mAnimatedModels[0]).mKeyValuesBuffer),
+			avk::descriptor_binding(0, 4, std::get<additional_animated_model_data>(mAnimatedModels[0]).mInstancesBuffers[0]),
+			avk::descriptor_binding(0, 5, std::get<additional_animated_model_data>(mAnimatedModels[0]).mLocalTransformsBuffers[0])
+		);
+		mAnimationBoneMatricesPipeline = avk::context().create_compute_pipeline_for(
+			"shaders/animation_bone_matrices.comp",
+			avk::push_constant_binding_data{ avk::shader_type::compute, 0, sizeof(animation_push_constants) },
+			avk::descriptor_binding(0, 0, std::get<additional_animated_model_data>(mAnimatedModels[0]).mNodesBuffer),
+			avk::descriptor_binding(0, 3, std::get<additional_animated_model_data>(mAnimatedModels[0]).mBoneTargetsBuffer),
+			avk::descriptor_binding(0, 5, std::get<additional_animated_model_data>(mAnimatedModels[0]).mLocalTransformsBuffers[0]),
+			avk::descriptor_binding(0, 6, mBoneMatricesBuffersAni[0][0])
+		);
+#endif
 		// create all the buffers for our drawcall data
 		add_draw_calls(dataForDrawCall, mDrawCalls);
 
@@ -434,6 +528,10 @@ public: // v== avk::invokee overrides which will be invoked by the framework ==v
 		// we want to use an updater, so create one:
 		mUpdater.emplace();
 		mUpdater->on(avk::shader_files_changed_event(mPipelineExt.as_reference())).update(mPipelineExt);
+#if USE_GPU_ANIMATION
+		mUpdater->on(avk::shader_files_changed_event(mAnimationSamplePipeline.as_reference())).update(mAnimationSamplePipeline);
+		mUpdater->on(avk::shader_files_changed_event(mAnimationBoneMatricesPipeline.as_reference())).update(mAnimationBoneMatricesPipeline);
+#endif
 
 		if (avk::context().supports_mesh_shader_nv(avk::context().physical_device())) {
 			vk::PhysicalDeviceMeshShaderPropertiesNV meshShaderPropsNv{};
@@ -564,11 +662,46 @@ public: // v== avk::invokee overrides which will be invoked by the framework ==v
 		auto inFlightIndex = mainWnd->current_in_flight_index();
 
 		// Animate all the meshes
+#if USE_GPU_ANIMATION
+		std::vector<recorded_commands_t> animationCommands;
+#endif
 		for (auto& model : mAnimatedModels) {
-			auto& animation = std::get<animated_model_data>(model).mAnimation;
 			auto& clip = std::get<animated_model_data>(model).mClip;
 			const auto doubleTime = fmod(time().absolute_time_dp(), std::get<animated_model_data>(model).duration_sec() * 2);
 			auto time = glm::lerp(std::get<animated_model_data>(model).start_sec(), std::get<animated_model_data>(model).end_sec(), (doubleTime > std::get<animated_model_data>(model).duration_sec() ? doubleTime - std::get<animated_model_data>(model).duration_sec() : doubleTime) / std::get<animated_model_data>(model).duration_sec());
+#if USE_GPU_ANIMATION
+			// Only the instance's time is uploaded; the compute shaders evaluate the animation:
+			const auto& gpuAni = std::get<additional_animated_model_data>(model);
+			const float timeInTicks = static_cast<float>(time * clip.mTicksPerSecond);
+			auto emptyTimeCmd = gpuAni.mInstancesBuffers[inFlightIndex]->fill(&timeInTicks, 0);
+
+			const auto pushConstants = animation_push_constants{ gpuAni.mNumNodes, gpuAni.mNumBoneTargets, 1u, std::get<animated_model_data>(model).mNumBoneMatrices };
+			// 1st pass: sample the keys of all nodes
+			animationCommands.emplace_back(command::bind_pipeline(mAnimationSamplePipeline.as_reference()));
+			animationCommands.emplace_back(command::bind_descriptors(mAnimationSamplePipeline->layout(), mDescriptorCache->get_or_create_descriptor_sets({
+				descriptor_binding(0, 0, gpuAni.mNodesBuffer),
+				descriptor_binding(0, 1, gpuAni.mKeyTimesBuffer),
+				descriptor_binding(0, 2, gpuAni.mKeyValuesBuffer),
+				descriptor_binding(0, 4, gpuAni.mInstancesBuffers[inFlightIndex]),
+				descriptor_binding(0, 5, gpuAni.mLocalTransformsBuffers[inFlightIndex])
+			})));
+			animationCommands.emplace_back(command::push_constants(mAnimationSamplePipeline->layout(), pushConstants));
+			animationCommands.emplace_back(command::dispatch(div_ceil(pushConstants.mNumNodes, 64u), pushConstants.mNumInstances, 1u));
+
+			animationCommands.emplace_back(sync::global_memory_barrier(stage::compute_shader + access::shader_storage_write >> stage::compute_shader + access::shader_storage_read));
+
+			// 2nd pass: apply the hierarchy and write one bone matrix per bone target
+			animationCommands.emplace_back(command::bind_pipeline(mAnimationBoneMatricesPipeline.as_reference()));
+			animationCommands.emplace_back(command::bind_descriptors(mAnimationBoneMatricesPipeline->layout(), mDescriptorCache->get_or_create_descriptor_sets({
+				descriptor_binding(0, 0, gpuAni.mNodesBuffer),
+				descriptor_binding(0, 3, gpuAni.mBoneTargetsBuffer),
+				descriptor_binding(0, 5, gpuAni.mLocalTransformsBuffers[inFlightIndex]),
+				descriptor_binding(0, 6, mBoneMatricesBuffersAni[inFlightIndex][std::get<animated_model_data>(model).mBoneMatricesBufferIndex])
+			})));
+			animationCommands.emplace_back(command::push_constants(mAnimationBoneMatricesPipeline->layout(), pushConstants));
+			animationCommands.emplace_back(command::dispatch(div_ceil(pushConstants.mNumBoneTargets, 64u), pushConstants.mNumInstances, 1u));
+#else
+			auto& animation = std::get<animated_model_data>(model).mAnimation;
 			auto targetMemory = std::get<additional_animated_model_data>(model).mBoneMatricesAni.data();
 
 			// Use lambda option 1 that takes as parameters: mesh_bone_info, inverse mesh root matrix, global node/bone transform w.r.t. the animation, inverse bind-pose matrix
@@ -578,6 +711,7 @@ public: // v== avk::invokee overrides which will be invoked by the framework ==v
 				//   2. Apply transformaton in bone space => MODEL SPACE
 				targetMemory[aInfo.mGlobalBoneIndexOffset + aInfo.mMeshLocalBoneIndex] = aTransformMatrix * aInverseBindPoseMatrix;
 			});
+#endif
 		}
 
 		auto viewProjMat = mQuakeCam.is_enabled()
@@ -615,10 +749,18 @@ public: // v== avk::invokee overrides which will be invoked by the framework ==v
 			    mTimestampPool->reset(firstQueryIndex, 2),     // reset the two values relevant for the current frame in flight
 			    mTimestampPool->write_timestamp(firstQueryIndex + 0, stage::all_commands), // measure before drawMeshTasks*
 
+#if !USE_GPU_ANIMATION
 				// Upload the updated bone matrices into the buffer for the current frame (considering that we have cConcurrentFrames-many concurrent frames):
 				command::one_for_each(mAnimatedModels, [this, inFlightIndex](const std::tuple<animated_model_data, additional_animated_model_data>& tpl){
 					return mBoneMatricesBuffersAni[inFlightIndex][std::get<animated_model_data>(tpl).mBoneMatricesBufferIndex]->fill(std::get<additional_animated_model_data>(tpl).mBoneMatricesAni.data(), 0);
 				}),
+#else
+				// Compute the bone matrices for the current frame directly into the buffers read by the mesh shaders:
+				animationCommands,
+
+				// Make the bone matrices visible to the mesh shaders:
+				sync::global_memory_barrier(stage::compute_shader + access::shader_storage_write >> stage::mesh_shader + access::shader_storage_read),
+#endif
 
 				command::render_pass(pipeline->renderpass_reference(), context().main_window()->current_backbuffer_reference(), {
 					command::bind_pipeline(pipeline.as_reference()),
@@ -682,6 +824,10 @@ private: // v== Member variables ==v
 	std::vector<data_for_draw_call> mDrawCalls;
 	avk::graphics_pipeline mPipelineExt;
 	avk::graphics_pipeline mPipelineNv;
+#if USE_GPU_ANIMATION
+	avk::compute_pipeline mAnimationSamplePipeline;
+	avk::compute_pipeline mAnimationBoneMatricesPipeline;
+#endif
 
 	avk::orbit_camera mOrbitCam;
 	avk::quake_camera mQuakeCam;
@@ -172,10 +172,12 @@ public: // v== avk::invokee overrides which will be invoked by the framework ==v
 				auto meshletSelection = avk::make_models_and_mesh_indices_selection(curModel, meshIndex);
 
 				auto cpuMeshlets = avk::divide_into_meshlets(meshletSelection);
-				avk::serializer serializer("direct_meshlets-" + meshname + "-" + std::to_string(mpos) + ".cache");
-				auto [gpuMeshlets, _] = avk::convert_for_gpu_usage_cached<avk::meshlet_gpu_data<sNumVertices, sNumIndices>>(serializer, cpuMeshlets);
-
-				serializer.flush();
+				// If the cache file turns out to be corrupted, with_serializer regenerates it instead of failing:
+				auto [gpuMeshlets, _] = avk::with_serializer("direct_meshlets-" + meshname + "-" + std::to_string(mpos) + ".cache", [&](avk::serializer& aSerializer) {
+					auto result = avk::convert_for_gpu_usage_cached<avk::meshlet_gpu_data<sNumVertices, sNumIndices>>(aSerializer, cpuMeshlets);
+					aSerializer.flush();
+					return result;
+				});
 
 				// fill our own meshlets with the loaded/generated data
 				for (size_t mshltidx = 0; mshltidx < gpuMeshlets.size(); ++mshltidx) {
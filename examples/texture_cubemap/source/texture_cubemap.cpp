@@ -51,48 +51,48 @@ public: // v== avk::invokee overrides which will be invoked by the framework ==v
 		mDescriptorCache = avk::context().create_descriptor_cache();
 
 		// Load cube map from file or from cache file:
+		// The cache file is regenerated if another option is selected, or if the cube map's image files change:
 		const std::string cacheFilePath("assets/cubemap.cache");
-		auto serializer = avk::serializer(cacheFilePath);
 
 		// Load a cubemap image file
 		// The cubemap texture coordinates start in the upper right corner of the skybox faces,
 		// which coincides with the memory layout of the textures. Therefore we don't need to flip them along the y axis.
 		// Note that lookup operations in a cubemap are defined in a left-handed coordinate system,
 		// i.e. when looking at the positive Z face from inside the cube, the positive X face is to the right.
-		avk::image cubemapImage;
-		avk::command::action_type_command loadImageCommand;
-
-		// Load the textures for all cubemap faces from one file (.ktx or .dds format), or from six individual files
-		if constexpr (gSelectedOption == options::one_dds_file) {
-			std::tie(cubemapImage, loadImageCommand) = avk::create_cubemap_from_file_cached(
-				serializer, 
-				"assets/yokohama_at_night-All-Mipmaps-Srgb-RGBA8-DXT1-SRGB.dds", 
-				true, // <-- load in HDR if possible 
-				true, // <-- load in sRGB if applicable
-				false // <-- flip along the y-axis
-			);
-		}
-		else if constexpr (gSelectedOption == options::one_ktx_file) {
-			std::tie(cubemapImage, loadImageCommand) = avk::create_cubemap_from_file_cached(
-				serializer,
-				"assets/yokohama_at_night-All-Mipmaps-Srgb-RGB8-DXT1-SRGB.ktx",
-				true, // <-- load in HDR if possible 
-				true, // <-- load in sRGB if applicable
-				false // <-- flip along the y-axis
-			);
-		}
-		else if constexpr (gSelectedOption == options::six_jpeg_files) {
-			std::tie(cubemapImage, loadImageCommand) = avk::create_cubemap_from_file_cached(
-				serializer,
-				{ "assets/posx.jpg", "assets/negx.jpg", "assets/posy.jpg", "assets/negy.jpg", "assets/posz.jpg", "assets/negz.jpg" },
-				true, // <-- load in HDR if possible 
-				true, // <-- load in sRGB if applicable
-				false // <-- flip along the y-axis
-			);
-		}
-		else {
-			throw std::logic_error("invalid option selected");
-		}
+		// If the cache file turns out to be corrupted, with_serializer regenerates it instead of failing:
+		auto [cubemapImage, loadImageCommand] = avk::with_serializer(cacheFilePath, avk::cache_dependencies{}.add_setting("option", static_cast<int>(gSelectedOption)), [](avk::serializer& aSerializer) {
+			// Load the textures for all cubemap faces from one file (.ktx or .dds format), or from six individual files
+			if constexpr (gSelectedOption == options::one_dds_file) {
+				return avk::create_cubemap_from_file_cached(
+					aSerializer, 
+					"assets/yokohama_at_night-All-Mipmaps-Srgb-RGBA8-DXT1-SRGB.dds", 
+					true, // <-- load in HDR if possible 
+					true, // <-- load in sRGB if applicable
+					false // <-- flip along the y-axis
+				);
+			}
+			else if constexpr (gSelectedOption == options::one_ktx_file) {
+				return avk::create_cubemap_from_file_cached(
+					aSerializer,
+					"assets/yokohama_at_night-All-Mipmaps-Srgb-RGB8-DXT1-SRGB.ktx",
+					true, // <-- load in HDR if possible 
+					true, // <-- load in sRGB if applicable
+					false // <-- flip along the y-axis
+				);
+			}
+			else if constexpr (gSelectedOption == options::six_jpeg_files) {
+				return avk::create_cubemap_from_file_cached(
+					aSerializer,
+					{ "assets/posx.jpg", "assets/negx.jpg", "assets/posy.jpg", "assets/negy.jpg", "assets/posz.jpg", "assets/negz.jpg" },
+					true, // <-- load in HDR if possible 
+					true, // <-- load in sRGB if applicable
+					false // <-- flip along the y-axis
+				);
+			}
+			else {
+				throw std::logic_error("invalid option selected");
+			}
+		});
 		avk::context().record_and_submit_with_fence({ std::move(loadImageCommand) }, *mQueue)->wait_until_signalled();
 
 		auto cubemapSampler = avk::context().create_sampler(avk::filter_mode::trilinear, avk::border_handling_mode::clamp_to_edge, static_cast<float>(cubemapImage->create_info().mipLevels));
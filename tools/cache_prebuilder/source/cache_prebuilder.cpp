@@ -0,0 +1,262 @@
+#include "material_image_helpers.hpp"
+#include "model.hpp"
+#include "orca_scene.hpp"
+#include "serializer.hpp"
+#include "transform.hpp"
+
+#include <thread>
+
+// Writes cache files for ORCA scenes (.fscene) and model files without a window or a Vulkan device.
+// The cache files have the same layout as those written by load_orca_scene_cached in the orca_loader
+// example, so that it loads the scene from the prebuilt cache file instead of recreating it.
+
+struct prebuild_options
+{
+	bool mLoadTexturesInSrgb = false;
+	bool mFlipTextures = false;
+	bool mCompressed = false;
+	bool mForce = false;
+	std::optional<avk::texture_compression> mTextureCompression;
+	unsigned int mNumThreads = 0;
+	std::vector<std::string> mInputs;
+};
+
+static void print_usage()
+{
+	std::cout <<
+		"Usage: cache_prebuilder [options] <file.fscene|model file>...\n"
+		"Writes <file>.cache for every input, without creating any Vulkan objects.\n"
+		"Options:\n"
+		"  --srgb          Load diffuse, ambient, and extra textures in sRGB format (setting loadTexturesInSrgb)\n"
+		"  --flip          Flip textures vertically (setting flipTextures)\n"
+		"  --compress      Write block-compressed cache files\n"
+		"  --bc            Encode textures to BC1/BC3/BC4/BC5/BC6H before writing them (setting textureCompression)\n"
+		"  --bc7           Like --bc, but encode 8 bit color textures to BC7\n"
+		"  --force         Regenerate cache files even if they are up to date\n"
+		"  --jobs <n>      Number of threads for loading meshes and textures (default: number of hardware threads)\n";
+}
+
+static std::optional<prebuild_options> parse_arguments(int argc, char* argv[])
+{
+	prebuild_options options;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (arg == "--srgb") {
+			options.mLoadTexturesInSrgb = true;
+		}
+		else if (arg == "--flip") {
+			options.mFlipTextures = true;
+		}
+		else if (arg == "--compress") {
+			options.mCompressed = true;
+		}
+		else if (arg == "--bc") {
+			options.mTextureCompression = avk::texture_compression{};
+		}
+		else if (arg == "--bc7") {
+			options.mTextureCompression = avk::texture_compression{ .mPreferBc7 = true };
+		}
+		else if (arg == "--force") {
+			options.mForce = true;
+		}
+		else if (arg == "--jobs" && i + 1 < argc) {
+			options.mNumThreads = static_cast<unsigned int>(std::max(std::atoi(argv[++i]), 0));
+		}
+		else if (arg.starts_with("--")) {
+			std::cerr << "Unknown option '" << arg << "'\n";
+			return {};
+		}
+		else {
+			options.mInputs.emplace_back(arg);
+		}
+	}
+	if (options.mInputs.empty()) {
+		return {};
+	}
+	if (0 == options.mNumThreads) {
+		options.mNumThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	return options;
+}
+
+// Invokes aFunction for every index in [0, aCount) on aNumThreads threads, and rethrows the first exception.
+template <typename F>
+static void parallel_for(size_t aCount, unsigned int aNumThreads, F aFunction)
+{
+	std::atomic<size_t> next = 0;
+	std::mutex errorMutex;
+	std::exception_ptr error;
+	auto worker = [&]() {
+		for (size_t i = next++; i < aCount; i = next++) {
+			try {
+				aFunction(i);
+			}
+			catch (...) {
+				std::scoped_lock lock(errorMutex);
+				if (!error) {
+					error = std::current_exception();
+				}
+				next = aCount;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < std::min<size_t>(aNumThreads, aCount); ++t) {
+		threads.emplace_back(worker);
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+// The data of one model_and_mesh_indices entry, i.e., what the *_cached buffer helpers write for it
+struct mesh_data
+{
+	std::tuple<std::vector<glm::vec3>, std::vector<uint32_t>> mVerticesAndIndices;
+	std::vector<glm::vec2> mTexCoords;
+	std::vector<glm::vec3> mNormals;
+	std::vector<glm::mat4> mInstanceMatrices;
+};
+
+// Writes the scene in the layout of load_orca_scene_cached. The mesh data is extracted in parallel,
+// and the textures are loaded in parallel by serialize_for_gpu_usage.
+static void write_scene(avk::serializer& aSerializer, const std::vector<avk::model_data>& aModels, const std::unordered_map<avk::material_config, std::vector<avk::model_and_mesh_indices>>& aDistinctMaterials, const prebuild_options& aOptions)
+{
+	// Flatten the distinct materials in the order in which they are written:
+	std::vector<avk::material_config> allMatConfigs;
+	std::vector<const avk::model_and_mesh_indices*> allMeshIndices;
+	for (const auto& [materialConfig, meshIndices] : aDistinctMaterials) {
+		allMatConfigs.push_back(materialConfig);
+		for (const auto& entry : meshIndices) {
+			allMeshIndices.push_back(&entry);
+		}
+	}
+
+	std::vector<mesh_data> meshes(allMeshIndices.size());
+	parallel_for(allMeshIndices.size(), aOptions.mNumThreads, [&](size_t aIndex) {
+		const auto& modelData = aModels[allMeshIndices[aIndex]->mModelIndex];
+		auto modelAndMeshes = avk::make_model_references_and_mesh_indices_selection(modelData.mLoadedModel, allMeshIndices[aIndex]->mMeshIndices);
+		auto& mesh = meshes[aIndex];
+		mesh.mVerticesAndIndices = avk::get_vertices_and_indices(modelAndMeshes);
+		mesh.mTexCoords = avk::get_2d_texture_coordinates_flipped(modelAndMeshes, 0);
+		mesh.mNormals = avk::get_normals(modelAndMeshes);
+		for (const auto& instance : modelData.mInstances) {
+			mesh.mInstanceMatrices.push_back(avk::matrix_from_transforms(instance.mTranslation, glm::quat(instance.mRotation), instance.mScaling));
+		}
+	});
+
+	size_t numDistinctMaterials = aDistinctMaterials.size();
+	aSerializer.archive(numDistinctMaterials);
+
+	size_t meshIndex = 0;
+	for (const auto& [materialConfig, meshIndices] : aDistinctMaterials) {
+		size_t numMeshIndices = meshIndices.size();
+		aSerializer.archive(numMeshIndices);
+
+		for (size_t i = 0; i < numMeshIndices; ++i) {
+			auto& mesh = meshes[meshIndex++];
+			avk::serialize_vertices_and_indices(aSerializer, mesh.mVerticesAndIndices);
+			avk::serialize_buffer_data(aSerializer, mesh.mTexCoords);
+			avk::serialize_buffer_data(aSerializer, mesh.mNormals);
+
+			size_t numInstances = mesh.mInstanceMatrices.size();
+			aSerializer.archive(numInstances);
+			for (auto& modelMatrix : mesh.mInstanceMatrices) {
+				aSerializer.archive(modelMatrix);
+			}
+
+			// Release the mesh's memory:
+			mesh = {};
+		}
+	}
+
+	avk::serialize_for_gpu_usage<avk::material_gpu_data>(
+		aSerializer,
+		allMatConfigs, aOptions.mLoadTexturesInSrgb, aOptions.mFlipTextures,
+		avk::image_usage::general_texture,
+		avk::filter_mode::anisotropic_16x,
+		aOptions.mNumThreads,
+		aOptions.mTextureCompression
+	);
+}
+
+// Loads an ORCA scene or a single model, which is treated like a scene with one instance of the model.
+static std::tuple<std::vector<avk::model_data>, std::unordered_map<avk::material_config, std::vector<avk::model_and_mesh_indices>>> load_scene(const std::string& aPath)
+{
+	std::vector<avk::model_data> models;
+	std::unordered_map<avk::material_config, std::vector<avk::model_and_mesh_indices>> distinctMaterials;
+
+	if (std::filesystem::path(aPath).extension() == ".fscene") {
+		auto orca = avk::orca_scene_t::load_from_file(aPath);
+		distinctMaterials = orca->distinct_material_configs_for_all_models();
+		models = std::move(orca->models());
+	}
+	else {
+		auto& modelData = models.emplace_back();
+		modelData.mFileName = std::filesystem::path(aPath).filename().string();
+		modelData.mName = modelData.mFileName;
+		modelData.mFullPathName = aPath;
+		modelData.mInstances.push_back(avk::model_instance_data{ modelData.mName, glm::vec3{ 0.0f }, glm::vec3{ 1.0f }, glm::vec3{ 0.0f } });
+		modelData.mLoadedModel = avk::model_t::load_from_file(aPath, aiProcess_Triangulate | aiProcess_PreTransformVertices);
+		for (auto& [materialConfig, meshIndices] : modelData.mLoadedModel->distinct_material_configs()) {
+			distinctMaterials[materialConfig].push_back(avk::model_and_mesh_indices{ 0, std::move(meshIndices) });
+		}
+	}
+
+	return std::make_tuple(std::move(models), std::move(distinctMaterials));
+}
+
+// Writes the cache file for the given input, unless it is up to date. Returns true if it has been written.
+static bool prebuild(const std::string& aPath, const prebuild_options& aOptions)
+{
+	const std::string cacheFilePath(aPath + ".cache");
+	auto dependencies = avk::cache_dependencies{}
+		.add_file(aPath)
+		.add_setting("loadTexturesInSrgb", aOptions.mLoadTexturesInSrgb)
+		.add_setting("flipTextures", aOptions.mFlipTextures)
+		.add_setting("textureCompression", !aOptions.mTextureCompression ? "none" : (aOptions.mTextureCompression->mPreferBc7 ? "bc7" : "bc"));
+
+	if (aOptions.mForce) {
+		avk::remove_cache_dependency_record(cacheFilePath);
+	}
+	auto serializer = avk::serializer(cacheFilePath, std::move(dependencies), avk::serializer_options{ .mCompressed = aOptions.mCompressed });
+	if (serializer.mode() == avk::serializer::mode::deserialize) {
+		return false;
+	}
+
+	auto [models, distinctMaterials] = load_scene(aPath);
+	for (const auto& model : models) {
+		serializer.add_file_dependency(model.mFullPathName);
+	}
+	write_scene(serializer, models, distinctMaterials, aOptions);
+	serializer.flush();
+	return true;
+}
+
+int main(int argc, char* argv[]) // <== Starting point ==
+{
+	auto options = parse_arguments(argc, argv);
+	if (!options) {
+		print_usage();
+		return EXIT_FAILURE;
+	}
+
+	int result = EXIT_SUCCESS;
+	for (const auto& input : options->mInputs) {
+		try {
+			const auto start = std::chrono::steady_clock::now();
+			const bool written = prebuild(input, *options);
+			const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+			std::cout << std::format("{}: {} ({:.3f}s)\n", input, written ? "cache file written" : "cache file is up to date", duration.count());
+		}
+		catch (const std::exception& e) {
+			std::cerr << std::format("{}: failed: {}\n", input, e.what());
+			result = EXIT_FAILURE;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,429 @@
+#include "animation.hpp"
+#include "material_gpu_data.hpp"
+#include "meshlet_helpers.hpp"
+#include "serializer.hpp"
+
+// Measures the read and write throughput of avk::serializer for representative payloads in each of its
+// modes, and the overhead per archive call. Results are written to stdout as JSON lines or CSV, one line
+// per measurement, so that they can be compared across toolkit versions.
+
+struct benchmark_options
+{
+	std::filesystem::path mDirectory = std::filesystem::temp_directory_path();
+	int mRepetitions = 5;
+	uint32_t mTextureSize = 8192;
+	size_t mNumCalls = 1 << 20;
+	bool mCsv = false;
+};
+
+static void print_usage()
+{
+	std::cout <<
+		"Usage: serializer_benchmark [options]\n"
+		"Options:\n"
+		"  --directory <dir>      Directory for the temporary cache files (default: the system's temporary directory)\n"
+		"  --repetitions <n>      Number of repetitions per measurement (default: 5)\n"
+		"  --texture-size <n>     Width and height of the base level of the RGBA mip chain (default: 8192)\n"
+		"  --calls <n>            Number of archive calls for measuring the overhead per call (default: 1048576)\n"
+		"  --format <json|csv>    Output format (default: json, one object per line)\n";
+}
+
+static std::optional<benchmark_options> parse_arguments(int argc, char* argv[])
+{
+	benchmark_options options;
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (arg == "--directory" && hasValue) {
+			options.mDirectory = argv[++i];
+		}
+		else if (arg == "--repetitions" && hasValue) {
+			options.mRepetitions = std::max(std::atoi(argv[++i]), 1);
+		}
+		else if (arg == "--texture-size" && hasValue) {
+			options.mTextureSize = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+		}
+		else if (arg == "--calls" && hasValue) {
+			options.mNumCalls = static_cast<size_t>(std::max(std::atoll(argv[++i]), 1ll));
+		}
+		else if (arg == "--format" && hasValue) {
+			const std::string_view format = argv[++i];
+			if (format != "json" && format != "csv") {
+				return {};
+			}
+			options.mCsv = format == "csv";
+		}
+		else {
+			return {};
+		}
+	}
+	return options;
+}
+
+// How cache files are written and read in one of the serializer's modes
+struct benchmark_mode
+{
+	std::string_view mName;
+	avk::serializer_options mWriteOptions;
+	avk::serializer_options mReadOptions;
+};
+
+static const std::array<benchmark_mode, 4> sModes = {
+	benchmark_mode{ "stream",        { .mMemoryMapped = false, .mWriteBehind = false }, { .mMemoryMapped = false } },
+	benchmark_mode{ "memory_mapped", { .mMemoryMapped = true,  .mWriteBehind = false }, { .mMemoryMapped = true  } },
+	benchmark_mode{ "compressed",    { .mCompressed = true,    .mWriteBehind = false }, { .mMemoryMapped = true  } },
+	benchmark_mode{ "async",         { .mWriteBehind = true },                           { .mMemoryMapped = true  } },
+};
+
+// A payload, with functions that archive it into a serializer in serialize mode, and read it back from one in deserialize mode
+struct benchmark_payload
+{
+	std::string_view mName;
+	size_t mBytes;
+	std::function<void(avk::serializer&)> mWrite;
+	std::function<void(avk::serializer&)> mRead;
+};
+
+// Deterministic pseudo-random numbers, so that every run writes the same data
+static uint32_t hash(uint32_t aValue)
+{
+	aValue ^= aValue >> 16;
+	aValue *= 0x7feb352du;
+	aValue ^= aValue >> 15;
+	aValue *= 0x846ca68bu;
+	aValue ^= aValue >> 16;
+	return aValue;
+}
+
+static float hash_float(uint32_t aValue)
+{
+	return static_cast<float>(hash(aValue) & 0xffffffu) / static_cast<float>(0xffffffu);
+}
+
+static std::tuple<std::vector<glm::vec3>, std::vector<uint32_t>> make_vertices_and_indices(size_t aNumVertices)
+{
+	std::vector<glm::vec3> positions(aNumVertices);
+	for (size_t i = 0; i < aNumVertices; ++i) {
+		const auto n = static_cast<uint32_t>(i * 3);
+		positions[i] = glm::vec3{ hash_float(n), hash_float(n + 1), hash_float(n + 2) } * 100.0f;
+	}
+	std::vector<uint32_t> indices(aNumVertices * 3);
+	for (size_t i = 0; i < indices.size(); ++i) {
+		indices[i] = hash(static_cast<uint32_t>(i)) % static_cast<uint32_t>(aNumVertices);
+	}
+	return std::make_tuple(std::move(positions), std::move(indices));
+}
+
+static std::vector<avk::meshlet_gpu_data<64, 378>> make_meshlets(size_t aNumMeshlets)
+{
+	std::vector<avk::meshlet_gpu_data<64, 378>> meshlets(aNumMeshlets);
+	for (size_t m = 0; m < aNumMeshlets; ++m) {
+		auto& meshlet = meshlets[m];
+		const auto base = static_cast<uint32_t>(m * 64);
+		for (uint32_t v = 0; v < 64; ++v) {
+			meshlet.mVertices[v] = base + v;
+		}
+		for (uint32_t i = 0; i < 378; ++i) {
+			meshlet.mIndices[i] = static_cast<uint8_t>(hash(base + i) % 64);
+		}
+		meshlet.mVertexCount = 64;
+		meshlet.mPrimitiveCount = 126;
+	}
+	return meshlets;
+}
+
+static std::vector<avk::material_gpu_data> make_materials(size_t aNumMaterials)
+{
+	std::vector<avk::material_gpu_data> materials(aNumMaterials);
+	for (size_t m = 0; m < aNumMaterials; ++m) {
+		auto& material = materials[m];
+		const auto n = static_cast<uint32_t>(m);
+		material.mDiffuseReflectivity = glm::vec4{ hash_float(n), hash_float(n + 1), hash_float(n + 2), 1.0f };
+		material.mAlbedo = material.mDiffuseReflectivity;
+		material.mOpacity = 1.0f;
+		material.mShininess = hash_float(n + 3) * 128.0f;
+		material.mRoughness = hash_float(n + 4);
+		material.mDiffuseTexIndex = static_cast<int>(n % 256);
+		material.mNormalsTexIndex = static_cast<int>((n + 1) % 256);
+		material.mDiffuseTexOffsetTiling = glm::vec4{ 0.0f, 0.0f, 1.0f, 1.0f };
+	}
+	return materials;
+}
+
+// avk::animation can only be created by avk::model_t or be deserialized. Therefore, synthetic animation data is
+// written in the layout of the serialize function for avk::animation and deserialized into an avk::animation.
+static avk::animation make_animation(const std::filesystem::path& aDirectory, size_t aNumNodes, size_t aNumKeys)
+{
+	const auto path = (aDirectory / "serializer_benchmark_animation.cache").string();
+	{
+		std::vector<avk::animated_node> nodes(aNumNodes);
+		for (size_t n = 0; n < aNumNodes; ++n) {
+			auto& node = nodes[n];
+			node.mNodeName = std::format("bone_{}", n);
+			for (size_t k = 0; k < aNumKeys; ++k) {
+				const auto time = static_cast<double>(k) / 30.0;
+				const auto h = static_cast<uint32_t>(n * aNumKeys + k);
+				node.mPositionKeys.push_back(avk::position_key{ time, glm::vec3{ hash_float(h), hash_float(h + 1), hash_float(h + 2) } });
+				node.mRotationKeys.push_back(avk::rotation_key{ time, glm::angleAxis(hash_float(h + 3), glm::vec3{ 0.0f, 1.0f, 0.0f }) });
+				node.mScalingKeys.push_back(avk::scaling_key{ time, glm::vec3{ 1.0f } });
+			}
+			node.mSameRotationAndPositionKeyTimes = true;
+			node.mSameScalingAndPositionKeyTimes = true;
+			node.mLocalTransform = glm::mat4{ 1.0f };
+			node.mGlobalTransform = glm::mat4{ 1.0f };
+			if (n > 0) {
+				node.mAnimatedParentIndex = (n - 1) / 2;
+			}
+			node.mParentTransform = glm::mat4{ 1.0f };
+			node.mBoneMeshTargets.push_back(avk::bone_mesh_data{ glm::mat4{ 1.0f }, glm::mat4{ 1.0f }, avk::mesh_bone_info{ 0, 0, static_cast<uint32_t>(n), 0 } });
+		}
+		uint32_t animationIndex = 0;
+		size_t maxNumBoneMatrices = aNumNodes;
+
+		avk::serializer serializer(path, avk::serializer::mode::serialize);
+		serializer.archive(nodes);
+		serializer.archive(animationIndex);
+		serializer.archive(maxNumBoneMatrices);
+	}
+
+	avk::animation result;
+	{
+		avk::serializer serializer(path, avk::serializer::mode::deserialize);
+		serializer.archive(result);
+	}
+	std::filesystem::remove(path);
+	return result;
+}
+
+// Base level and all mip levels down to 1x1 of an RGBA8 texture
+static std::vector<std::vector<uint8_t>> make_mip_chain(uint32_t aSize)
+{
+	std::vector<std::vector<uint8_t>> levels;
+	for (uint32_t size = aSize; ; size = std::max(size / 2, 1u)) {
+		auto& level = levels.emplace_back(static_cast<size_t>(size) * size * 4);
+		for (uint32_t y = 0; y < size; ++y) {
+			for (uint32_t x = 0; x < size; ++x) {
+				// A smooth gradient with some noise, which is roughly as compressible as a photographic texture:
+				const auto noise = hash(y * size + x) & 0x0fu;
+				auto* pixel = &level[(static_cast<size_t>(y) * size + x) * 4];
+				pixel[0] = static_cast<uint8_t>(x * 255 / size + noise);
+				pixel[1] = static_cast<uint8_t>(y * 255 / size + noise);
+				pixel[2] = static_cast<uint8_t>((x + y) * 127 / size);
+				pixel[3] = 255;
+			}
+		}
+		if (1 == size) {
+			break;
+		}
+	}
+	return levels;
+}
+
+template <typename T>
+static size_t vector_bytes(const std::vector<T>& aVector)
+{
+	return aVector.size() * sizeof(T);
+}
+
+static std::vector<benchmark_payload> make_payloads(const benchmark_options& aOptions)
+{
+	std::vector<benchmark_payload> payloads;
+
+	auto verticesAndIndices = std::make_shared<std::tuple<std::vector<glm::vec3>, std::vector<uint32_t>>>(make_vertices_and_indices(1 << 20));
+	payloads.push_back(benchmark_payload{
+		"vertices_and_indices",
+		vector_bytes(std::get<0>(*verticesAndIndices)) + vector_bytes(std::get<1>(*verticesAndIndices)),
+		[verticesAndIndices](avk::serializer& s) { s.archive(*verticesAndIndices); },
+		[](avk::serializer& s) { std::tuple<std::vector<glm::vec3>, std::vector<uint32_t>> data; s.archive(data); }
+	});
+
+	auto meshlets = std::make_shared<std::vector<avk::meshlet_gpu_data<64, 378>>>(make_meshlets(1 << 17));
+	payloads.push_back(benchmark_payload{
+		"meshlet_gpu_data_64_378",
+		vector_bytes(*meshlets),
+		[meshlets](avk::serializer& s) { s.archive(*meshlets); },
+		[](avk::serializer& s) { std::vector<avk::meshlet_gpu_data<64, 378>> data; s.archive(data); }
+	});
+
+	auto materials = std::make_shared<std::vector<avk::material_gpu_data>>(make_materials(1 << 12));
+	payloads.push_back(benchmark_payload{
+		"material_gpu_data",
+		vector_bytes(*materials),
+		[materials](avk::serializer& s) { s.archive(*materials); },
+		[](avk::serializer& s) { std::vector<avk::material_gpu_data> data; s.archive(data); }
+	});
+
+	constexpr size_t numNodes = 256;
+	constexpr size_t numKeys = 512;
+	auto animation = std::make_shared<avk::animation>(make_animation(aOptions.mDirectory, numNodes, numKeys));
+	payloads.push_back(benchmark_payload{
+		"animation",
+		numNodes * numKeys * (sizeof(avk::position_key) + sizeof(avk::rotation_key) + sizeof(avk::scaling_key)),
+		[animation](avk::serializer& s) { s.archive(*animation); },
+		[](avk::serializer& s) { avk::animation data; s.archive(data); }
+	});
+
+	// Written like create_image_from_image_data_cached writes the levels of an image:
+	auto mipChain = std::make_shared<std::vector<std::vector<uint8_t>>>(make_mip_chain(aOptions.mTextureSize));
+	size_t mipChainBytes = 0;
+	for (const auto& level : *mipChain) {
+		mipChainBytes += level.size();
+	}
+	payloads.push_back(benchmark_payload{
+		"rgba8_mip_chain",
+		mipChainBytes,
+		[mipChain](avk::serializer& s) {
+			size_t numLevels = mipChain->size();
+			s.archive(numLevels);
+			for (auto& level : *mipChain) {
+				size_t levelSize = level.size();
+				s.archive(levelSize);
+				s.archive_memory(level.data(), levelSize);
+			}
+		},
+		[](avk::serializer& s) {
+			size_t numLevels = 0;
+			s.archive(numLevels);
+			std::vector<std::vector<uint8_t>> levels(numLevels);
+			for (auto& level : levels) {
+				size_t levelSize = 0;
+				s.archive(levelSize);
+				level.resize(levelSize);
+				s.archive_memory(level.data(), levelSize);
+			}
+		}
+	});
+
+	return payloads;
+}
+
+// The result of one measurement
+struct benchmark_result
+{
+	std::string_view mPayload;
+	std::string_view mMode;
+	std::string_view mOperation;
+	size_t mBytes;
+	size_t mFileBytes;
+	size_t mCalls;
+	std::vector<double> mSeconds;
+};
+
+static void print_header(const benchmark_options& aOptions)
+{
+	if (aOptions.mCsv) {
+		std::cout << "payload,mode,operation,bytes,file_bytes,calls,repetitions,min_seconds,median_seconds,mib_per_second,ns_per_call\n";
+	}
+}
+
+static void print_result(const benchmark_options& aOptions, benchmark_result aResult)
+{
+	std::sort(std::begin(aResult.mSeconds), std::end(aResult.mSeconds));
+	const auto minSeconds = aResult.mSeconds.front();
+	const auto medianSeconds = aResult.mSeconds[aResult.mSeconds.size() / 2];
+	const auto mibPerSecond = static_cast<double>(aResult.mBytes) / (1024.0 * 1024.0) / minSeconds;
+	const auto nsPerCall = minSeconds * 1e9 / static_cast<double>(aResult.mCalls);
+	if (aOptions.mCsv) {
+		std::cout << std::format("{},{},{},{},{},{},{},{:.6f},{:.6f},{:.2f},{:.2f}\n",
+			aResult.mPayload, aResult.mMode, aResult.mOperation, aResult.mBytes, aResult.mFileBytes, aResult.mCalls,
+			aResult.mSeconds.size(), minSeconds, medianSeconds, mibPerSecond, nsPerCall);
+	}
+	else {
+		std::cout << std::format("{{\"payload\":\"{}\",\"mode\":\"{}\",\"operation\":\"{}\",\"bytes\":{},\"file_bytes\":{},\"calls\":{},\"repetitions\":{},\"min_seconds\":{:.6f},\"median_seconds\":{:.6f},\"mib_per_second\":{:.2f},\"ns_per_call\":{:.2f}}}\n",
+			aResult.mPayload, aResult.mMode, aResult.mOperation, aResult.mBytes, aResult.mFileBytes, aResult.mCalls,
+			aResult.mSeconds.size(), minSeconds, medianSeconds, mibPerSecond, nsPerCall);
+	}
+	std::cout.flush();
+}
+
+template <typename F>
+static double measure_seconds(F aFunction)
+{
+	const auto start = std::chrono::steady_clock::now();
+	aFunction();
+	const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+	return duration.count();
+}
+
+// Writes and reads the given payload with the given mode. The time includes opening and closing the cache
+// file, i.e., the time until all data has been written, or the file has been unmapped, respectively.
+static void run_payload(const benchmark_options& aOptions, const benchmark_payload& aPayload, const benchmark_mode& aMode)
+{
+	const auto path = (aOptions.mDirectory / std::format("serializer_benchmark_{}_{}.cache", aPayload.mName, aMode.mName)).string();
+	benchmark_result write{ aPayload.mName, aMode.mName, "write", aPayload.mBytes, 0, 1, {} };
+	benchmark_result read{ aPayload.mName, aMode.mName, "read", aPayload.mBytes, 0, 1, {} };
+	for (int r = 0; r < aOptions.mRepetitions; ++r) {
+		write.mSeconds.push_back(measure_seconds([&]() {
+			avk::serializer serializer(path, avk::serializer::mode::serialize, aMode.mWriteOptions);
+			aPayload.mWrite(serializer);
+			serializer.flush();
+		}));
+		read.mSeconds.push_back(measure_seconds([&]() {
+			avk::serializer serializer(path, avk::serializer::mode::deserialize, aMode.mReadOptions);
+			aPayload.mRead(serializer);
+		}));
+	}
+	write.mFileBytes = read.mFileBytes = static_cast<size_t>(std::filesystem::file_size(path));
+	std::filesystem::remove(path);
+	print_result(aOptions, std::move(write));
+	print_result(aOptions, std::move(read));
+}
+
+// Archives aOptions.mNumCalls individual values, to measure the fixed cost of an archive call
+static void run_per_call_overhead(const benchmark_options& aOptions, const benchmark_mode& aMode)
+{
+	const auto path = (aOptions.mDirectory / std::format("serializer_benchmark_calls_{}.cache", aMode.mName)).string();
+	benchmark_result write{ "per_call_uint32", aMode.mName, "write", aOptions.mNumCalls * sizeof(uint32_t), 0, aOptions.mNumCalls, {} };
+	benchmark_result read{ "per_call_uint32", aMode.mName, "read", aOptions.mNumCalls * sizeof(uint32_t), 0, aOptions.mNumCalls, {} };
+	for (int r = 0; r < aOptions.mRepetitions; ++r) {
+		write.mSeconds.push_back(measure_seconds([&]() {
+			avk::serializer serializer(path, avk::serializer::mode::serialize, aMode.mWriteOptions);
+			for (size_t i = 0; i < aOptions.mNumCalls; ++i) {
+				auto value = static_cast<uint32_t>(i);
+				serializer.archive(value);
+			}
+			serializer.flush();
+		}));
+		uint32_t checksum = 0;
+		read.mSeconds.push_back(measure_seconds([&]() {
+			avk::serializer serializer(path, avk::serializer::mode::deserialize, aMode.mReadOptions);
+			for (size_t i = 0; i < aOptions.mNumCalls; ++i) {
+				uint32_t value = 0;
+				serializer.archive(value);
+				checksum += value;
+			}
+		}));
+		if (checksum != static_cast<uint32_t>(aOptions.mNumCalls * (aOptions.mNumCalls - 1) / 2)) {
+			throw avk::runtime_error(std::format("Mode '{}' has read different values than it has written.", aMode.mName));
+		}
+	}
+	write.mFileBytes = read.mFileBytes = static_cast<size_t>(std::filesystem::file_size(path));
+	std::filesystem::remove(path);
+	print_result(aOptions, std::move(write));
+	print_result(aOptions, std::move(read));
+}
+
+int main(int argc, char* argv[]) // <== Starting point ==
+{
+	auto options = parse_arguments(argc, argv);
+	if (!options) {
+		print_usage();
+		return EXIT_FAILURE;
+	}
+
+	try {
+		const auto payloads = make_payloads(*options);
+		print_header(*options);
+		for (const auto& mode : sModes) {
+			for (const auto& payload : payloads) {
+				run_payload(*options, payload, mode);
+			}
+			run_per_call_overhead(*options, mode);
+		}
+	}
+	catch (const std::exception& e) {
+		std::cerr << "serializer_benchmark failed: " << e.what() << "\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}